@@ -1,18 +1,122 @@
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <exception>
 #include <iostream>
 #include <ostream>
+#include <vector>
 
+#include "vRenderer/BatchRenderer.h"
 #include "vRenderer/vRenderer.h"
 #include "vRenderer/camera/Camera.h"
 
+/// <summary>	Generates a grid of small colored point lights above the ground plane. </summary>
+/// <param name="a_CountPerAxis">	Number of lights along each axis.</param>
+/// <param name="a_Extent">		 	Half the size of the covered area.</param>
+/// <returns>	The lights. </returns>
+
+std::vector<PointLight> GenLightGrid(const int a_CountPerAxis, const float a_Extent)
+{
+	std::vector<PointLight> t_Lights;
+	t_Lights.reserve(static_cast<size_t>(a_CountPerAxis) * a_CountPerAxis);
+
+	const float t_Spacing = 2.0f * a_Extent / static_cast<float>(a_CountPerAxis - 1);
+
+	for (int y = 0; y < a_CountPerAxis; y++)
+	{
+		for (int x = 0; x < a_CountPerAxis; x++)
+		{
+			// spread the hues over the grid
+			const float t_Hue = static_cast<float>(x + y * a_CountPerAxis) * 0.618f;
+
+			PointLight t_Light = {};
+			t_Light.m_PositionRadius = {-a_Extent + x * t_Spacing, -a_Extent + y * t_Spacing, 0.5f, 1.5f * t_Spacing};
+			t_Light.m_ColorIntensity = {
+				0.5f + 0.5f * std::cos(6.283f * t_Hue), 0.5f + 0.5f * std::cos(6.283f * (t_Hue + 0.333f)),
+				0.5f + 0.5f * std::cos(6.283f * (t_Hue + 0.667f)), 0.1f
+			};
+
+			t_Lights.push_back(t_Light);
+		}
+	}
+
+	return t_Lights;
+}
+
+/// <summary>	Spins the test model around the x axis, a full turn every 20 seconds. </summary>
+/// <param name="a_Renderer">	The renderer.</param>
+/// <param name="a_Start">   	The time the animation started at.</param>
+
+void AnimateTestModel(VRenderer& a_Renderer, const std::chrono::high_resolution_clock::time_point a_Start)
+{
+	const float t_Time = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - a_Start).count();
+
+	a_Renderer.GetTransforms().SetRotation(a_Renderer.GetRenderableTransform(a_Renderer.GetTestModel()),
+	                                       glm::angleAxis(glm::radians(90.0f + t_Time * 18.0f),
+	                                                      glm::vec3(1.0f, 0.0f, 0.0f)));
+}
+
 void Run(VRenderer& a_Renderer, Camera& a_Camera)
 {
+	const auto t_Start = std::chrono::high_resolution_clock::now();
+
 	while (!a_Renderer.ShouldTerminate())
 	{
 		a_Camera.UpdateAspectRatio(a_Renderer.GetWindowExtent());
 
+		AnimateTestModel(a_Renderer, t_Start);
+		a_Renderer.Render(a_Camera);
+	}
+}
+
+/// <summary>
+/// 	Renders a fixed number of frames without a window and reads the last one back, used on
+/// 	machines without a display such as CI runners.
+/// </summary>
+/// <param name="a_Renderer">  	The headless renderer.</param>
+/// <param name="a_Camera">	   	The camera.</param>
+/// <param name="a_FrameCount">	Number of frames to render.</param>
+
+void RunHeadless(VRenderer& a_Renderer, Camera& a_Camera, const int a_FrameCount)
+{
+	const auto t_Start = std::chrono::high_resolution_clock::now();
+
+	for (int i = 0; i < a_FrameCount; i++)
+	{
+		AnimateTestModel(a_Renderer, t_Start);
 		a_Renderer.Render(a_Camera);
 	}
+
+	std::vector<uint8_t> t_Pixels;
+	a_Renderer.ReadbackFrame(t_Pixels);
+
+	std::cout << "Rendered " << a_FrameCount << " headless frames, last GPU frame time: "
+		<< a_Renderer.GetGpuFrameTime() << " ms" << std::endl;
+}
+
+/// <summary>	Generates shots on a circle around the model, all looking at its center. </summary>
+/// <param name="a_Model"> 	The model, placed at the origin in every shot.</param>
+/// <param name="a_Count"> 	Number of shots.</param>
+/// <param name="a_Radius">	Distance of the camera from the model's vertical axis.</param>
+/// <returns>	The shots. </returns>
+
+std::vector<BatchShot> GenOrbitShots(const Entity a_Model, const int a_Count, const float a_Radius)
+{
+	BatchPose t_ModelPose = {};
+	t_ModelPose.m_Entity = a_Model;
+	t_ModelPose.m_Transform = glm::mat4(3.0f);
+	t_ModelPose.m_Transform[3][3] = 1.0f;
+
+	std::vector<BatchShot> t_Shots(a_Count);
+
+	for (int i = 0; i < a_Count; i++)
+	{
+		const float t_Angle = 6.283f * static_cast<float>(i) / static_cast<float>(a_Count);
+		t_Shots[i].m_CameraPosition = {a_Radius * std::cos(t_Angle), a_Radius * std::sin(t_Angle), 1.0f};
+		t_Shots[i].m_Poses.push_back(t_ModelPose);
+	}
+
+	return t_Shots;
 }
 
 int main(int argc, char* argv[])
@@ -20,16 +124,91 @@ int main(int argc, char* argv[])
 	const int t_WindowWidth = 800;
 	const int t_WindowHeight = 600;
 
+	// --headless renders offscreen without GLFW, e.g. on CI runners without a display, --batch
+	// additionally writes an orbit around the model to PNG files, --capture records the presented
+	// frames to capture.y4m, --export shares them with other processes as /vRenderer-frames
+	bool t_Headless = false;
+	bool t_Batch = false;
+	bool t_Capture = false;
+	bool t_Export = false;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--headless") == 0)
+		{
+			t_Headless = true;
+		}
+		else if (strcmp(argv[i], "--batch") == 0)
+		{
+			t_Headless = true;
+			t_Batch = true;
+		}
+		else if (strcmp(argv[i], "--capture") == 0)
+		{
+			t_Capture = true;
+		}
+		else if (strcmp(argv[i], "--export") == 0)
+		{
+			t_Export = true;
+		}
+	}
+
 	Camera t_Camera = {{0.0f, 2.0f, 1.0f}, t_WindowWidth, t_WindowHeight};
 
+	// 4x MSAA without sample rate shading, can be changed at runtime through SetRenderSettings
+	RenderSettings t_RenderSettings = {};
+	t_RenderSettings.m_MSAASampleCount = VK_SAMPLE_COUNT_4_BIT;
+	t_RenderSettings.m_MinSampleShading = 0.0f;
+
 	VRenderer t_Renderer = {};
-	t_Renderer.Init(t_WindowWidth, t_WindowHeight);
+	if (t_Headless)
+	{
+		t_Renderer.InitHeadless(t_WindowWidth, t_WindowHeight, t_RenderSettings);
+	}
+	else
+	{
+		t_Renderer.Init(t_WindowWidth, t_WindowHeight, t_RenderSettings);
+	}
+
+	// 256 lights shaded through the clustered light lists, each only reaching its neighbours
+	t_Renderer.SetPointLights(GenLightGrid(16, 3.0f));
+	t_Renderer.SetAmbientLight(glm::vec3(0.1f));
 
 	// try to run the app and catch any potential exceptions.
     // If an exception is caught, print it
 	try
 	{
-		Run(t_Renderer, t_Camera);
+		if (t_Capture)
+		{
+			t_Renderer.StartCapture("capture.y4m", CaptureFormat::Y4M);
+		}
+
+		if (t_Export)
+		{
+			t_Renderer.StartFrameExport("/vRenderer-frames");
+			std::cout << "Exporting frames through " << (t_Renderer.GetFrameExportMode() == FrameExportMode::ExternalMemory
+				                                             ? "external memory"
+				                                             : "shared memory") << std::endl;
+		}
+
+		if (t_Batch)
+		{
+			BatchRenderer t_BatchRenderer;
+			t_BatchRenderer.Run(t_Renderer, t_Camera, GenOrbitShots(t_Renderer.GetTestModel(), 36, 2.2f), {});
+		}
+		else if (t_Headless)
+		{
+			RunHeadless(t_Renderer, t_Camera, 100);
+		}
+		else
+		{
+			Run(t_Renderer, t_Camera);
+		}
+
+		if (t_Capture)
+		{
+			t_Renderer.StopCapture();
+			std::cout << "Capture dropped " << t_Renderer.GetDroppedCaptureFrames() << " frames" << std::endl;
+		}
 	}
 	catch(const std::exception& t_Exceptions){
 		std::cerr << t_Exceptions.what() << std::endl;
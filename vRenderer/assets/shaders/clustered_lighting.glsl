@@ -0,0 +1,84 @@
+// clustered point lighting shared by the forward and the deferred lighting fragment shaders,
+// LIGHT_SET selects the descriptor set the light lists are bound to
+
+// the cluster grid has to match ClusteredLightCuller
+#define CLUSTERS_X 16
+#define CLUSTERS_Y 9
+#define CLUSTERS_Z 24
+#define MAX_LIGHTS_PER_CLUSTER 128
+
+struct PointLight {
+	// world space position in xyz, radius of influence in w
+	vec4 positionRadius;
+	// linear color in rgb, intensity in w
+	vec4 colorIntensity;
+};
+
+// lights and the per cluster light lists written by the light culling pass
+layout(std430, set = LIGHT_SET, binding = 0) readonly buffer Lights {
+	mat4 view;
+	// slope of the half extent of the view region in x and y, near and far plane
+	vec4 projection;
+	vec4 cameraPosition;
+	vec4 ambient;
+	vec2 inverseRenderExtent;
+	// slope of the center of the view region, 0 unless rendering an off-center tile
+	vec2 projectionOffset;
+	uint lightCount;
+	PointLight lights[];
+};
+layout(std430, set = LIGHT_SET, binding = 1) readonly buffer ClusterLightCounts { uint clusterLightCounts[]; };
+layout(std430, set = LIGHT_SET, binding = 2) readonly buffer ClusterLightIndices { uint clusterLightIndices[]; };
+
+uint GetCluster(vec2 fragCoord, float viewDepth) {
+	uvec2 tile = uvec2(fragCoord * inverseRenderExtent * vec2(CLUSTERS_X, CLUSTERS_Y));
+	tile = min(tile, uvec2(CLUSTERS_X - 1, CLUSTERS_Y - 1));
+
+	// inverse of the exponential slicing in the culling pass
+	float near = projection.z;
+	float far = projection.w;
+	float slice = log(viewDepth / near) / log(far / near) * float(CLUSTERS_Z);
+	uint z = uint(clamp(slice, 0.0, float(CLUSTERS_Z - 1)));
+
+	return tile.x + tile.y * CLUSTERS_X + z * CLUSTERS_X * CLUSTERS_Y;
+}
+
+// returns the ambient light plus the diffuse light of every light in the fragment's cluster
+vec3 ShadeClusteredLights(vec3 worldPos, vec3 normal, vec2 fragCoord, float viewDepth) {
+	vec3 lighting = ambient.rgb;
+
+	uint cluster = GetCluster(fragCoord, viewDepth);
+	uint count = clusterLightCounts[cluster];
+
+	for (uint i = 0; i < count; i++) {
+		PointLight light = lights[clusterLightIndices[cluster * MAX_LIGHTS_PER_CLUSTER + i]];
+
+		vec3 toLight = light.positionRadius.xyz - worldPos;
+		float distanceSquared = max(dot(toLight, toLight), 0.0001);
+
+		// inverse square falloff, windowed to reach zero at the radius the light was culled with
+		float ratio = distanceSquared / (light.positionRadius.w * light.positionRadius.w);
+		float window = clamp(1.0 - ratio * ratio, 0.0, 1.0);
+		float attenuation = window * window / distanceSquared;
+
+		float diffuse = max(dot(normal, toLight * inversesqrt(distanceSquared)), 0.0);
+		lighting += light.colorIntensity.rgb * light.colorIntensity.w * attenuation * diffuse;
+	}
+
+	return lighting;
+}
+
+// octahedron normal encoding, maps a unit vector to [-1, 1]^2
+vec2 OctEncode(vec3 n) {
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	vec2 wrapped = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	return n.z >= 0.0 ? n.xy : wrapped;
+}
+
+vec3 OctDecode(vec2 e) {
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = clamp(-n.z, 0.0, 1.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
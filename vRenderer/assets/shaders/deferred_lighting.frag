@@ -0,0 +1,40 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#define LIGHT_SET 1
+#include "clustered_lighting.glsl"
+
+// the G-buffer written by the first subpass, read at the current pixel only
+layout(input_attachment_index = 0, set = 0, binding = 0) uniform subpassInput gAlbedo;
+layout(input_attachment_index = 1, set = 0, binding = 1) uniform subpassInput gNormal;
+layout(input_attachment_index = 2, set = 0, binding = 2) uniform subpassInput gDepth;
+
+layout(push_constant) uniform LightingParameters {
+	mat4 inverseViewProjection;
+};
+
+layout(location = 0) out vec4 OutColor;
+
+void main() {
+	float depth = subpassLoad(gDepth).r;
+
+	// nothing was drawn here, keep the clear color
+	if (depth >= 1.0) {
+		OutColor = vec4(0.0, 0.0, 0.0, 1.0);
+		return;
+	}
+
+	// reconstruct the world position from the depth buffer
+	vec2 ndc = gl_FragCoord.xy * inverseRenderExtent * 2.0 - 1.0;
+	vec4 worldPos = inverseViewProjection * vec4(ndc, depth, 1.0);
+	worldPos /= worldPos.w;
+
+	float viewDepth = -(view * worldPos).z;
+
+	vec4 albedo = subpassLoad(gAlbedo);
+	vec3 normal = OctDecode(subpassLoad(gNormal).xy);
+
+	vec3 lighting = ShadeClusteredLights(worldPos.xyz, normal, gl_FragCoord.xy, viewDepth);
+
+	OutColor = vec4(albedo.rgb * lighting, albedo.a);
+}
@@ -1,13 +1,54 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
+#extension GL_GOOGLE_include_directive : require
+
+// compiled a second time with GBUFFER defined for the first subpass of the deferred path, which
+// writes albedo and normal instead of shading
+#define LIGHT_SET 2
+#include "clustered_lighting.glsl"
 
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTextCoord;
+layout(location = 2) in vec4 fragCurrentPos;
+layout(location = 3) in vec4 fragPreviousPos;
+layout(location = 4) flat in uint fragTextureIndex;
+layout(location = 5) in vec3 fragWorldPos;
+layout(location = 6) in float fragViewDepth;
 
+#ifdef GBUFFER
+layout(location = 0) out vec4 OutAlbedo;
+// octahedron encoded world space normal
+layout(location = 1) out vec2 OutNormal;
+#else
 layout(location = 0) out vec4 OutColor;
+// screen space motion in uv units, only written to an attachment when TAA is enabled
+layout(location = 1) out vec2 OutVelocity;
+#endif
 
-layout(binding = 1) uniform sampler2D texSampler;
-
+// bindless texture table
+layout(set = 1, binding = 0) uniform sampler texSampler;
+layout(set = 1, binding = 1) uniform texture2D textures[];
 
 void main() {
-	OutColor = texture(texSampler, fragTextCoord);
+	// the index may differ between instances covered by the same subgroup
+	vec4 albedo = texture(sampler2D(textures[nonuniformEXT(fragTextureIndex)], texSampler), fragTextCoord);
+
+	// meshes have no normals, use the face normal turned towards the camera
+	vec3 normal = normalize(cross(dFdx(fragWorldPos), dFdy(fragWorldPos)));
+	if (dot(normal, cameraPosition.xyz - fragWorldPos) < 0.0) {
+		normal = -normal;
+	}
+
+#ifdef GBUFFER
+	OutAlbedo = albedo;
+	OutNormal = OctEncode(normal);
+#else
+	vec3 lighting = ShadeClusteredLights(fragWorldPos, normal, gl_FragCoord.xy, fragViewDepth);
+
+	OutColor = vec4(albedo.rgb * lighting, albedo.a);
+
+	vec2 currentPos = fragCurrentPos.xy / fragCurrentPos.w;
+	vec2 previousPos = fragPreviousPos.xy / fragPreviousPos.w;
+	OutVelocity = (currentPos - previousPos) * 0.5;
+#endif
 }
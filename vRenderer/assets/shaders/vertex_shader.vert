@@ -3,18 +3,41 @@
 layout(location = 0) in vec3 inPos;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
+// per-instance
+layout(location = 3) in uint inTextureIndex;
+layout(location = 4) in mat4 inModel;
+// last frame's world matrix, used for the velocity buffer
+layout(location = 8) in mat4 inPrevModel;
 
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out vec4 fragCurrentPos;
+layout(location = 3) out vec4 fragPreviousPos;
+layout(location = 4) flat out uint fragTextureIndex;
+// used by the clustered lighting
+layout(location = 5) out vec3 fragWorldPos;
+layout(location = 6) out float fragViewDepth;
 
-layout(binding = 0) uniform UniformBufferObject {
-	mat4 model;
+// the main pass depth tests against the depth prepass, both have to compute identical positions
+invariant gl_Position;
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
 	mat4 view;
 	mat4 projection;
+	// unjittered, used for the velocity buffer
+	mat4 viewProj;
+	mat4 prevViewProj;
 } ubo;
 
 void main() {
-	gl_Position = ubo.projection * ubo.view * ubo.model * vec4(inPos, 1.0);
+	vec4 worldPos = inModel * vec4(inPos, 1.0);
+	gl_Position = ubo.projection * ubo.view * worldPos;
 	fragColor = inColor;
 	fragTexCoord = inTexCoord;
+	fragCurrentPos = ubo.viewProj * worldPos;
+	fragPreviousPos = ubo.prevViewProj * inPrevModel * vec4(inPos, 1.0);
+	fragTextureIndex = inTextureIndex;
+
+	fragWorldPos = worldPos.xyz;
+	fragViewDepth = -(ubo.view * worldPos).z;
 }
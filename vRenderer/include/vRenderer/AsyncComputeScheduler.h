@@ -0,0 +1,96 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "FrameArena.h"
+
+class Device;
+
+/// <summary>
+/// 	Schedules compute work that does not depend on the rasterization of the same frame, such as
+/// 	light binning, culling against data from earlier frames or simulations. On devices with a
+/// 	dedicated compute queue the work is submitted there ahead of the frame's graphics submission,
+/// 	so it overlaps with the rasterization of the previous frame. The graphics submission waits on
+/// 	the compute timeline only at the stages that consume the results.
+/// </summary>
+/// <remarks>
+/// 	Without a dedicated compute queue the same work is recorded at the start of the graphics
+/// 	command buffer, followed by a barrier, so callers do not have to handle both cases. Buffers
+/// 	written by scheduled work and read by graphics have to be created shared with compute.
+/// </remarks>
+class AsyncComputeScheduler
+{
+public:
+	AsyncComputeScheduler();
+	~AsyncComputeScheduler();
+
+	/// <summary>	Creates the command pool and one command buffer per frame in flight on the compute queue. </summary>
+	/// <exception cref="std::runtime_error">	Raised when any of the objects could not be created.</exception>
+	/// <param name="a_Device">		   	The device.</param>
+	/// <param name="a_FramesInFlight">	Number of frames in flight.</param>
+
+	void Create(const Device& a_Device, uint32_t a_FramesInFlight);
+
+	void Destroy(const VkDevice& a_LogicalDevice);
+
+	/// <summary>	Schedules compute work for the current frame. </summary>
+	/// <param name="a_Record">	  	Records the work, called with the command buffer it runs in.</param>
+	/// <param name="a_DstStage"> 	The graphics stages that read the results.</param>
+	/// <param name="a_DstAccess">	The kind of access the results are read with.</param>
+
+	void Schedule(std::function<void(VkCommandBuffer)> a_Record, VkPipelineStageFlags a_DstStage,
+	              VkAccessFlags a_DstAccess);
+
+	/// <summary>
+	/// 	Records and submits the scheduled work to the compute queue. Requires a device with async
+	/// 	compute, the command buffer of the frame must no longer be in use.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when recording or submitting fails.</exception>
+	/// <param name="a_Device">			  	The device.</param>
+	/// <param name="a_Frame">			  	The index of the frame in flight.</param>
+	/// <param name="a_GraphicsWaitValue">	(Optional) Value of the graphics timeline the work has to
+	/// 									wait for, 0 if it does not depend on earlier graphics work.</param>
+
+	void Submit(const Device& a_Device, uint32_t a_Frame, uint64_t a_GraphicsWaitValue = 0);
+
+	/// <summary>
+	/// 	Records the scheduled work into a graphics command buffer instead, followed by a barrier
+	/// 	making the results visible to the stages that read them.
+	/// </summary>
+	/// <param name="a_CommandBuffer">	The graphics command buffer, outside of a render pass.</param>
+
+	void RecordInline(VkCommandBuffer a_CommandBuffer);
+
+	/// <summary>
+	/// 	Appends the wait on the last submission to a graphics submission. Does nothing if the last
+	/// 	frame's work was recorded inline or nothing was scheduled.
+	/// </summary>
+	/// <param name="a_Device">	   	The device.</param>
+	/// <param name="a_Semaphores">	[in,out] The wait semaphores of the graphics submission.</param>
+	/// <param name="a_Stages">	   	[in,out] The wait stages of the graphics submission.</param>
+	/// <param name="a_Values">	   	[in,out] The wait values of the graphics submission, 0 for binary semaphores.</param>
+
+	void AddGraphicsWait(const Device& a_Device, FrameVector<VkSemaphore>& a_Semaphores,
+	                     FrameVector<VkPipelineStageFlags>& a_Stages, FrameVector<uint64_t>& a_Values);
+
+private:
+	struct ScheduledWork
+	{
+		std::function<void(VkCommandBuffer)> m_Record;
+		VkPipelineStageFlags m_DstStage;
+		VkAccessFlags m_DstAccess;
+	};
+
+	// records all scheduled work and clears the schedule, returns the union of the consumer stages and accesses
+	void RecordScheduledWork(VkCommandBuffer a_CommandBuffer, VkPipelineStageFlags& a_DstStage, VkAccessFlags& a_DstAccess);
+
+	VkCommandPool m_CommandPool = VK_NULL_HANDLE;
+	std::vector<VkCommandBuffer> m_CommandBuffers;
+
+	std::vector<ScheduledWork> m_ScheduledWork;
+
+	// value of the compute timeline and stages the next graphics submission has to wait for
+	uint64_t m_PendingWaitValue = 0;
+	VkPipelineStageFlags m_PendingWaitStage = 0;
+};
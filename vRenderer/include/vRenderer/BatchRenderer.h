@@ -0,0 +1,106 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <vulkan/vulkan_core.h>
+
+#include "EntityStore.h"
+
+class Camera;
+class VRenderer;
+
+/// <summary>	A renderable placed before a shot is rendered. </summary>
+struct BatchPose
+{
+	Entity m_Entity;
+	glm::mat4 m_Transform = glm::mat4(1.0f);
+};
+
+/// <summary>	A single image of a batch job. </summary>
+struct BatchShot
+{
+	glm::vec3 m_CameraPosition = glm::vec3(0.0f, 2.0f, 1.0f);
+	glm::vec3 m_CameraTarget = glm::vec3(0.0f);
+
+	// renderables not listed keep the transform they had in the previous shot
+	std::vector<BatchPose> m_Poses;
+};
+
+enum class BatchImageFormat
+{
+	// 8 bit RGB PNG
+	Png,
+	// headerless, tightly packed 8 bit RGBA rows
+	Raw
+};
+
+struct BatchJobSettings
+{
+	// the index of the shot and the file extension are appended
+	std::string m_OutputPrefix = "frame_";
+	BatchImageFormat m_Format = BatchImageFormat::Png;
+
+	uint32_t m_EncoderThreads = 2;
+
+	// frames read back but not yet written, bounds the memory held by the job
+	uint32_t m_MaxQueuedFrames = 4;
+};
+
+/// <summary>
+/// 	Renders a list of shots with a headless renderer and writes them to image files. The stages
+/// 	are pipelined: while the GPU renders shot N, shot N - 1 is read back from its readback buffer
+/// 	and encoder threads write shot N - 2 and earlier, so throughput is limited by the slowest stage
+/// 	rather than by round trips between them.
+/// </summary>
+class BatchRenderer
+{
+public:
+	BatchRenderer();
+	~BatchRenderer();
+
+	/// <summary>	Renders all shots and waits for their files to be written. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the renderer is not headless or a file could not be written.</exception>
+	/// <param name="a_Renderer">	The renderer, initialized with InitHeadless.</param>
+	/// <param name="a_Camera">  	The camera the shots are rendered from, its pose is changed per shot.</param>
+	/// <param name="a_Shots">   	The shots.</param>
+	/// <param name="a_Settings">	The output settings.</param>
+
+	void Run(VRenderer& a_Renderer, Camera& a_Camera, const std::vector<BatchShot>& a_Shots,
+	         const BatchJobSettings& a_Settings);
+
+	/// <summary>	Gets the path a shot is written to. </summary>
+	/// <param name="a_Settings">	The output settings.</param>
+	/// <param name="a_Index">   	Index of the shot.</param>
+	/// <returns>	The prefix followed by the zero padded index and the extension. </returns>
+
+	static std::string GetOutputPath(const BatchJobSettings& a_Settings, size_t a_Index);
+
+private:
+	struct EncodeJob
+	{
+		size_t m_Index;
+		std::vector<uint8_t> m_Pixels;
+	};
+
+	// reads back a rendered shot into a free buffer and queues it for encoding, blocks while all buffers are queued
+	void QueueReadback(VRenderer& a_Renderer, size_t a_Index, uint32_t a_FramesAgo);
+
+	void EncodeLoop(const BatchJobSettings& a_Settings, VkExtent2D a_Extent);
+
+	std::mutex m_Mutex;
+	std::condition_variable m_JobQueued;
+	std::condition_variable m_BufferFreed;
+
+	std::deque<EncodeJob> m_Jobs;
+	std::vector<std::vector<uint8_t>> m_FreeBuffers;
+	bool m_Finished = false;
+
+	// the first error of an encoder thread, rethrown on the render thread
+	std::exception_ptr m_Error;
+};
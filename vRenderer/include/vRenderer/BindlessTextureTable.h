@@ -0,0 +1,97 @@
+#pragma once
+#include <deque>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+class Device;
+
+/// <summary>
+/// 	Global table of sampled images shared by all draws. The table is a single descriptor set
+/// 	holding one immutable sampler and a large, partially bound array of sampled images that can
+/// 	be updated after it has been bound. Textures are registered into free slots and referenced
+/// 	by their slot index in per-instance data, so the set only has to be bound once per frame.
+/// </summary>
+/// <remarks>
+/// 	Requires the descriptor indexing features checked by the Device. Released slots are only
+/// 	reused once the graphics timeline has passed the last submission that may sample them.
+/// </remarks>
+class BindlessTextureTable
+{
+public:
+	BindlessTextureTable();
+	~BindlessTextureTable();
+
+	/// <summary>	Creates the sampler, the descriptor set layout, the pool and the descriptor set. </summary>
+	/// <exception cref="std::runtime_error">	Raised when any of the Vulkan objects could not be created.</exception>
+	/// <param name="a_Device">  	The device.</param>
+	/// <param name="a_Capacity">	(Optional) The requested number of slots, clamped to the device limit.</param>
+
+	void Create(const Device& a_Device, uint32_t a_Capacity = 4096);
+
+	void Destroy(const VkDevice& a_LogicalDevice);
+
+	/// <summary>	Writes an image view into a free slot of the table. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the table is full.</exception>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+	/// <param name="a_ImageView">	  	View of an image in the shader read only layout.</param>
+	/// <returns>	The slot index to pass to shaders. </returns>
+
+	uint32_t Register(const VkDevice& a_LogicalDevice, VkImageView a_ImageView);
+
+	/// <summary>
+	/// 	Releases a slot. The slot becomes available again once the timeline has reached the
+	/// 	retire value, the image itself has to be kept alive until then by the caller.
+	/// </summary>
+	/// <param name="a_Index">		 	The slot index returned by Register.</param>
+	/// <param name="a_RetireValue">	Timeline value of the last submission that may sample the slot.</param>
+
+	void Release(uint32_t a_Index, uint64_t a_RetireValue);
+
+	/// <summary>	Returns released slots that can no longer be in use to the free list. </summary>
+	/// <param name="a_CompletedValue">	The value the graphics timeline has reached.</param>
+
+	void Collect(uint64_t a_CompletedValue);
+
+	/// <summary>	Binds the table. </summary>
+	/// <param name="a_CommandBuffer"> 	The command buffer.</param>
+	/// <param name="a_BindPoint">	   	The pipeline bind point.</param>
+	/// <param name="a_PipelineLayout">	Layout of the bound pipeline.</param>
+	/// <param name="a_Set">		   	The set index the table is bound to.</param>
+
+	void Bind(VkCommandBuffer a_CommandBuffer, VkPipelineBindPoint a_BindPoint, VkPipelineLayout a_PipelineLayout,
+	          uint32_t a_Set) const;
+
+	VkDescriptorSetLayout GetDescriptorSetLayout() const;
+	VkDescriptorSet GetDescriptorSet() const;
+
+	uint32_t GetCapacity() const;
+
+	/// <summary>	Gets the number of slots currently registered or waiting to be reused. </summary>
+	/// <returns>	The number of slots in use. </returns>
+
+	uint32_t GetUsedSlotCount() const;
+
+	static constexpr uint32_t s_InvalidIndex = ~0u;
+
+private:
+	struct PendingRelease
+	{
+		uint32_t m_Index;
+		uint64_t m_RetireValue;
+	};
+
+	void CreateSampler(const Device& a_Device);
+
+	VkSampler m_Sampler = VK_NULL_HANDLE;
+	VkDescriptorSetLayout m_DescriptorSetLayout = VK_NULL_HANDLE;
+	VkDescriptorPool m_DescriptorPool = VK_NULL_HANDLE;
+	VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+
+	uint32_t m_Capacity = 0;
+
+	// slots below m_NextSlot that can be handed out again
+	std::vector<uint32_t> m_FreeSlots;
+	uint32_t m_NextSlot = 0;
+
+	std::deque<PendingRelease> m_PendingReleases;
+};
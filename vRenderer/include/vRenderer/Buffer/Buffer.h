@@ -16,8 +16,11 @@ public:
 	/// <param name="a_UsageFlag">	  	The usage flags.</param>
 	/// <param name="a_PropertyFlags">	The property flags.</param>
 	/// <param name="a_Device">		  	The logical device.</param>
+	/// <param name="a_SharedWithCompute">	(Optional) True if the buffer is accessed by the async compute
+	/// 									queue as well as the graphics queue.</param>
 
-	void CreateBuffer(VkDeviceSize a_Size, VkBufferUsageFlags a_UsageFlag, VkMemoryPropertyFlags a_PropertyFlags, const Device& a_Device);
+	void CreateBuffer(VkDeviceSize a_Size, VkBufferUsageFlags a_UsageFlag, VkMemoryPropertyFlags a_PropertyFlags, const Device& a_Device,
+	                  bool a_SharedWithCompute = false);
 
 	/// <summary>
 	/// 	Destroys the buffer using vkDestroyBuffer and also frees the allocated memory.
@@ -30,12 +33,12 @@ public:
 
 	/// <summary>	Copies the contents of this buffer into the destination buffer. </summary>
 	/// <param name="a_DstBuffer">	  	Destination Buffer the data is copied into.</param>
-	/// <param name="a_LogicalDevice">	The logical device.</param>
+	/// <param name="a_Device">	   	The device.</param>
 	/// <param name="a_DeviceSize">   	Size of the device.</param>
 	/// <param name="a_GraphicsQueue">	Queue used to execute the copy command.</param>
 	/// <param name="a_CommandPool">  	The command pool that should execute the transfer commands.</param>
 
-	void CopyInto(VkBuffer a_DstBuffer, VkDevice a_LogicalDevice, VkDeviceSize a_DeviceSize, VkQueue a_GraphicsQueue,
+	void CopyInto(VkBuffer a_DstBuffer, const Device& a_Device, VkDeviceSize a_DeviceSize, VkQueue a_GraphicsQueue,
 	              VkCommandPool a_CommandPool);
 
 	/// <summary>	Copies the buffer to a provided VkImage. </summary>
@@ -43,21 +46,21 @@ public:
 	/// <param name="a_Width">		  	The width.</param>
 	/// <param name="a_Height">		  	The height.</param>
 	/// <param name="a_CommandPool">  	[in,out] The command pool.</param>
-	/// <param name="a_LogicalDevice">	The logical device.</param>
+	/// <param name="a_Device">		  	The device.</param>
 	/// <param name="a_GraphicsQueue">	Graphics Queue.</param>
 	///
 	/// ### <param name="a_CommandBuffer">	[in,out] Buffer for command data.</param>
 
 	void CopyBufferToImage(const VkImage& a_Image, uint32_t a_Width, uint32_t a_Height, VkCommandPool& a_CommandPool,
-	                       const VkDevice& a_LogicalDevice, const VkQueue& a_GraphicsQueue) const;
+	                       const Device& a_Device, const VkQueue& a_GraphicsQueue) const;
 
 	/// <summary>	Fills the buffer with the provided data. </summary>
 	/// <param name="a_BufferSize">   	Size of the buffer.</param>
 	/// <param name="a_LogicalDevice">	The logical device.</param>
-	/// <param name="a_Data">		  	[in,out] If non-null, the data.</param>
+	/// <param name="a_Data">		  	The data.</param>
 
 	void FillBuffer(VkDeviceSize a_BufferSize, const VkDevice& a_LogicalDevice,
-	                void* a_Data);
+	                const void* a_Data);
 
 	/// <summary>	Gets available types of memory and returns the suitable memory types based on the type filter. </summary>
 	/// <param name="a_Device">	   	The device.</param>
@@ -67,6 +70,16 @@ public:
 
 	static uint32_t GetMemoryType(const Device& a_Device, uint32_t a_TypeFilter, VkMemoryPropertyFlags a_Properties);
 
+	/// <summary>	Looks for a memory type without throwing, used to check for optional memory properties. </summary>
+	/// <param name="a_Device">	   	The device.</param>
+	/// <param name="a_TypeFilter">	A filter specifying the type.</param>
+	/// <param name="a_Properties">	The properties.</param>
+	/// <param name="a_TypeIndex"> 	[out] The index of the memory type if one was found.</param>
+	/// <returns>	True if a suitable memory type exists. </returns>
+
+	static bool FindMemoryType(const Device& a_Device, uint32_t a_TypeFilter, VkMemoryPropertyFlags a_Properties,
+	                           uint32_t& a_TypeIndex);
+
 protected:
 
 	VkMemoryRequirements GetMemoryRequirements(const VkDevice& a_LogicalDevice) const;
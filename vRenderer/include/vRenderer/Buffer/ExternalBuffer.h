@@ -0,0 +1,71 @@
+#pragma once
+#include "vRenderer/Buffer/Buffer.h"
+
+/// <summary>
+/// 	A transfer destination buffer whose memory is shared with other processes, either exported
+/// 	from the device as an opaque file descriptor or imported from host memory such as a shared
+/// 	memory mapping. Either way the GPU writes straight into memory the other process can access.
+/// </summary>
+class ExternalBuffer : public Buffer
+{
+public:
+	ExternalBuffer();
+	~ExternalBuffer();
+
+	/// <summary>
+	/// 	Checks whether transfer destination buffers can be exported as opaque file descriptors.
+	/// 	Requires VK_KHR_external_memory_fd to be enabled.
+	/// </summary>
+	/// <param name="a_Device">	The device.</param>
+	/// <returns>	True if CreateExportable can be used. </returns>
+
+	static bool SupportsFdExport(const Device& a_Device);
+
+	/// <summary>
+	/// 	Gets the alignment host memory has to have in address and size to be imported. Requires
+	/// 	VK_EXT_external_memory_host to be enabled.
+	/// </summary>
+	/// <param name="a_Device">	The device.</param>
+	/// <returns>	The alignment in bytes, 0 if host memory cannot be imported. </returns>
+
+	static VkDeviceSize GetHostPointerAlignment(const Device& a_Device);
+
+	/// <summary>	Creates the buffer in device local memory that can be exported as a file descriptor. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the buffer could not be created.</exception>
+	/// <param name="a_Device">	The device.</param>
+	/// <param name="a_Size">  	The size of the buffer in bytes.</param>
+
+	void CreateExportable(const Device& a_Device, VkDeviceSize a_Size);
+
+	/// <summary>
+	/// 	Creates the buffer on top of existing host memory. The memory has to stay mapped until the
+	/// 	buffer is destroyed.
+	/// </summary>
+	/// <param name="a_Device"> 	The device.</param>
+	/// <param name="a_Pointer">	The memory, aligned to GetHostPointerAlignment.</param>
+	/// <param name="a_Size">   	The size of the memory in bytes, a multiple of GetHostPointerAlignment.</param>
+	/// <returns>	True if the memory was imported, false if the device cannot access it. </returns>
+
+	bool CreateFromHostPointer(const Device& a_Device, void* a_Pointer, VkDeviceSize a_Size);
+
+	/// <summary>
+	/// 	Exports the memory of an exportable buffer. Every call creates a new descriptor owned by
+	/// 	the caller, usually sent to the consuming process over a unix socket and closed afterwards.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when the memory could not be exported.</exception>
+	/// <param name="a_Device">	The device.</param>
+	/// <returns>	The file descriptor. </returns>
+
+	int ExportFd(const Device& a_Device) const;
+
+	/// <summary>	Gets the size of the allocation, which importers have to allocate with. </summary>
+	/// <returns>	The allocation size in bytes. </returns>
+
+	VkDeviceSize GetAllocationSize() const;
+
+private:
+	// creates the buffer handle with the external handle types it may be bound to
+	void CreateHandle(const Device& a_Device, VkDeviceSize a_Size, VkExternalMemoryHandleTypeFlags a_HandleTypes);
+
+	VkDeviceSize m_AllocationSize = 0;
+};
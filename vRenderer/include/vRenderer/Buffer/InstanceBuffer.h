@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+
+#include "vRenderer/Buffer/Buffer.h"
+#include "vRenderer/helper_structs/InstanceData.h"
+
+class InstanceBuffer : public Buffer
+{
+public:
+	InstanceBuffer();
+	~InstanceBuffer();
+
+	/// <summary>
+	/// 	Creates a host visible, persistently mapped buffer of per-instance data. Like the
+	/// 	uniform buffers it is intended to be written every frame, so one buffer per frame in
+	/// 	flight is needed.
+	/// </summary>
+	/// <param name="a_Device">		 	The device.</param>
+	/// <param name="a_MaxInstances">	The maximum number of instances the buffer can hold.</param>
+
+	void CreateInstanceBuffer(const Device& a_Device, uint32_t a_MaxInstances);
+
+	/// <summary>	Copies the instance data into the buffer. </summary>
+	/// <exception cref="std::runtime_error">	Raised when there are more instances than the buffer can hold.</exception>
+	/// <param name="a_Instances">	The instance data.</param>
+
+	void FillBuffer(const std::vector<InstanceData>& a_Instances);
+
+	uint32_t GetCapacity() const;
+
+	/// <summary>	Gets the mapped instance data, to write single instances or fields in place. </summary>
+	/// <returns>	The first instance. </returns>
+
+	InstanceData* GetMappedInstances() const;
+
+private:
+	void* m_AccessPointer{};
+	uint32_t m_Capacity = 0;
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include "vRenderer/Buffer/Buffer.h"
+
+/// <summary>
+/// 	A persistently mapped, host visible buffer the GPU copies images into so they can be read
+/// 	on the CPU, e.g. the frames of the headless mode.
+/// </summary>
+class ReadbackBuffer : public Buffer
+{
+public:
+	ReadbackBuffer();
+	~ReadbackBuffer();
+
+	/// <summary>	Creates the buffer and maps it. </summary>
+	/// <param name="a_Device">	The device.</param>
+	/// <param name="a_Size">  	The size of the buffer in bytes.</param>
+
+	void CreateReadbackBuffer(const Device& a_Device, VkDeviceSize a_Size);
+
+	/// <summary>
+	/// 	Records a tightly packed copy of a color image into the buffer, followed by a barrier
+	/// 	making the copy visible to the host once the submission has finished.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when the image does not fit into the buffer.</exception>
+	/// <param name="a_CommandBuffer">	The command buffer, outside of a render pass.</param>
+	/// <param name="a_Image">		  	The image, in the transfer source layout.</param>
+	/// <param name="a_Extent">		  	The extent of the image.</param>
+	/// <param name="a_TexelSize">	  	Size of a texel of the image in bytes.</param>
+
+	void RecordImageCopy(VkCommandBuffer a_CommandBuffer, VkImage a_Image, VkExtent2D a_Extent, uint32_t a_TexelSize) const;
+
+	/// <summary>	Copies data out of the buffer. The copy into it must have finished on the GPU. </summary>
+	/// <exception cref="std::runtime_error">	Raised when reading past the end of the buffer.</exception>
+	/// <param name="a_Data">  	[out] The destination, at least a_Size bytes large.</param>
+	/// <param name="a_Size">  	Size of the data in bytes.</param>
+	/// <param name="a_Offset">	(Optional) Offset into the buffer in bytes.</param>
+
+	void Read(void* a_Data, VkDeviceSize a_Size, VkDeviceSize a_Offset = 0) const;
+
+	/// <summary>	Gets the mapped memory, for reading in place without a copy. </summary>
+	/// <returns>	The start of the buffer. </returns>
+
+	const uint8_t* GetData() const;
+
+	VkDeviceSize GetSize() const;
+
+private:
+	void* m_AccessPointer{};
+	VkDeviceSize m_Size = 0;
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include "vRenderer/Buffer/Buffer.h"
+
+class StorageBuffer : public Buffer
+{
+public:
+	StorageBuffer();
+	~StorageBuffer();
+
+	/// <summary>
+	/// 	Creates a storage buffer. Host visible buffers are persistently mapped and intended to be
+	/// 	written every frame, device local buffers are only written by the GPU.
+	/// </summary>
+	/// <param name="a_Device">		   	The device.</param>
+	/// <param name="a_Size">		   	The size of the buffer in bytes.</param>
+	/// <param name="a_HostVisible">   	True to create a host visible, mapped buffer.</param>
+	/// <param name="a_AdditionalUsage">	(Optional) Usage flags in addition to the storage buffer usage.</param>
+	/// <param name="a_SharedWithCompute">	(Optional) True if the buffer is accessed by the async compute queue as well.</param>
+
+	void CreateStorageBuffer(const Device& a_Device, VkDeviceSize a_Size, bool a_HostVisible,
+	                         VkBufferUsageFlags a_AdditionalUsage = 0, bool a_SharedWithCompute = false);
+
+	/// <summary>	Copies data into a host visible buffer. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the buffer is not host visible or too small.</exception>
+	/// <param name="a_Data">  	The data.</param>
+	/// <param name="a_Size">  	Size of the data in bytes.</param>
+	/// <param name="a_Offset">	(Optional) Offset into the buffer in bytes.</param>
+
+	void FillBuffer(const void* a_Data, VkDeviceSize a_Size, VkDeviceSize a_Offset = 0);
+
+	VkDeviceSize GetSize() const;
+
+private:
+	void* m_AccessPointer{};
+	VkDeviceSize m_Size = 0;
+};
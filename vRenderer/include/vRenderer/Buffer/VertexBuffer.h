@@ -17,6 +17,6 @@ public:
 	/// <param name="a_GraphicsQueue">	Queue used to execute the copy command.</param>
 	/// <param name="a_CommandPool">  	The command pool that should execute the transfer commands.</param>
 
-	void CreateVertexBuffer(std::vector<Vertex>& a_Vertices, const Device& a_Device, VkQueue a_GraphicsQueue,
+	void CreateVertexBuffer(const std::vector<Vertex>& a_Vertices, const Device& a_Device, VkQueue a_GraphicsQueue,
 	              VkCommandPool a_CommandPool);
 };
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <vulkan/vulkan_core.h>
+
+#include "ComputePipeline.h"
+#include "Buffer/StorageBuffer.h"
+#include "helper_structs/PointLight.h"
+
+class Camera;
+class DescriptorAllocator;
+class Device;
+
+/// <summary>
+/// 	Light culling for clustered forward shading. The view frustum is split into a grid of
+/// 	clusters, tiles on screen that are sliced exponentially in depth between the camera's near
+/// 	and far plane. A compute pass tests every light's sphere of influence against every cluster
+/// 	and writes a list of light indices per cluster, the fragment shader only shades the lights of
+/// 	the cluster it falls into.
+/// </summary>
+/// <remarks>
+/// 	The descriptor set holding the lights and the lists is written by the compute pass and read
+/// 	by the fragment shader, so its layout is shared by the culling pipeline and the main pipeline.
+/// </remarks>
+class ClusteredLightCuller
+{
+public:
+	ClusteredLightCuller();
+	~ClusteredLightCuller();
+
+	/// <summary>	Creates the culling pipeline, the light and cluster buffers and their descriptor sets. </summary>
+	/// <exception cref="std::runtime_error">	Raised when any of the objects could not be created.</exception>
+	/// <param name="a_Device">		   		The device.</param>
+	/// <param name="a_DescriptorAllocator">	The allocator caching the descriptor sets.</param>
+	/// <param name="a_MaxLights">	   		The maximum number of lights per frame.</param>
+	/// <param name="a_FramesInFlight">		Number of frames in flight, one set of buffers is used per frame.</param>
+
+	void Create(const Device& a_Device, DescriptorAllocator& a_DescriptorAllocator, uint32_t a_MaxLights,
+	            uint32_t a_FramesInFlight);
+
+	void Destroy(const VkDevice& a_LogicalDevice);
+
+	/// <summary>	Uploads the lights and the cluster grid parameters of a frame. </summary>
+	/// <exception cref="std::runtime_error">	Raised when there are more lights than the buffers can hold.</exception>
+	/// <param name="a_Frame">		 	The index of the frame in flight.</param>
+	/// <param name="a_Camera">		 	The camera the frame is rendered with.</param>
+	/// <param name="a_RenderExtent">	The rendered part of the color target.</param>
+	/// <param name="a_Lights">		 	The lights.</param>
+	/// <param name="a_Ambient">	 	The ambient light added to every fragment.</param>
+
+	void UpdateLights(uint32_t a_Frame, const Camera& a_Camera, VkExtent2D a_RenderExtent,
+	                  const std::vector<PointLight>& a_Lights, const glm::vec3& a_Ambient);
+
+	/// <summary>
+	/// 	Records the culling pass. The caller makes the lists visible to the fragment shader, with a
+	/// 	barrier or a semaphore if the pass runs on the compute queue.
+	/// </summary>
+	/// <param name="a_CommandBuffer">	A graphics or compute command buffer, outside of a render pass.</param>
+	/// <param name="a_Frame">		  	The index of the frame in flight.</param>
+
+	void RecordLightCulling(VkCommandBuffer a_CommandBuffer, uint32_t a_Frame) const;
+
+	/// <summary>	Gets the layout of the lighting set, used as set 2 of the main pipeline. </summary>
+	/// <returns>	The descriptor set layout. </returns>
+
+	VkDescriptorSetLayout GetDescriptorSetLayout() const;
+
+	VkDescriptorSet GetDescriptorSet(uint32_t a_Frame) const;
+
+	// the grid has to match the defines in light_cull.comp and fragment_shader.frag
+	static constexpr uint32_t s_ClusterCountX = 16;
+	static constexpr uint32_t s_ClusterCountY = 9;
+	static constexpr uint32_t s_ClusterCountZ = 24;
+	static constexpr uint32_t s_ClusterCount = s_ClusterCountX * s_ClusterCountY * s_ClusterCountZ;
+	static constexpr uint32_t s_MaxLightsPerCluster = 128;
+
+private:
+	// header of the light buffer, laid out to match the std430 block in the shaders
+	struct ClusterParameters
+	{
+		glm::mat4 m_View;
+		// slope of the half extent of the view region in x and y, near and far plane
+		glm::vec4 m_Projection;
+		glm::vec4 m_CameraPosition;
+		glm::vec4 m_Ambient;
+		glm::vec2 m_InverseRenderExtent;
+		// slope of the center of the view region, 0 unless rendering an off-center tile
+		glm::vec2 m_ProjectionOffset;
+		uint32_t m_LightCount;
+		uint32_t m_Padding[3];
+	};
+
+	void CreateDescriptorSets(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator);
+
+	ComputePipeline m_CullPipeline;
+
+	// one set per frame in flight, owned by the descriptor allocator
+	std::vector<VkDescriptorSet> m_DescriptorSets;
+
+	// the parameters followed by the lights, written every frame
+	std::vector<StorageBuffer> m_LightBuffers;
+	// number of lights per cluster
+	std::vector<StorageBuffer> m_ClusterLightCountBuffers;
+	// s_MaxLightsPerCluster light indices per cluster
+	std::vector<StorageBuffer> m_ClusterLightIndexBuffers;
+
+	uint32_t m_MaxLights = 0;
+};
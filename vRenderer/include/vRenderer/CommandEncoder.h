@@ -0,0 +1,103 @@
+#pragma once
+#include <array>
+#include <vulkan/vulkan_core.h>
+
+struct DrawItem;
+
+/// <summary>	Number of state changes recorded by a CommandEncoder. </summary>
+struct BindStatistics
+{
+	uint32_t m_PipelineBinds = 0;
+	uint32_t m_DescriptorSetBinds = 0;
+	uint32_t m_VertexBufferBinds = 0;
+	uint32_t m_IndexBufferBinds = 0;
+	uint32_t m_DynamicStateSets = 0;
+
+	// calls that were dropped because the state was already set
+	uint32_t m_SkippedCalls = 0;
+
+	uint32_t m_Draws = 0;
+
+	uint32_t GetTotalBinds() const;
+};
+
+/// <summary>
+/// 	Records graphics commands while tracking the bound state, so vkCmdBind* and vkCmdSet* calls
+/// 	that would not change anything are skipped. Combined with draws sorted by their state this
+/// 	reduces the number of binds to the number of actual state changes.
+/// </summary>
+/// <remarks>
+/// 	An encoder without a command buffer records nothing and only counts the binds, which is used
+/// 	to measure a draw order before recording it. Commands recorded to the command buffer
+/// 	without the encoder are not tracked, call Invalidate afterwards.
+/// </remarks>
+class CommandEncoder
+{
+public:
+	CommandEncoder();
+	~CommandEncoder();
+
+	/// <summary>	Starts encoding into a command buffer, clearing the tracked state and the statistics. </summary>
+	/// <param name="a_CommandBuffer">	The command buffer in the recording state, VK_NULL_HANDLE to only count binds.</param>
+
+	void Begin(VkCommandBuffer a_CommandBuffer);
+
+	/// <summary>	Forgets the tracked state, the next call of each kind is always recorded. </summary>
+
+	void Invalidate();
+
+	void BindPipeline(VkPipeline a_Pipeline);
+
+	/// <summary>
+	/// 	Binds descriptor sets. Only the range starting at the first set that differs from the
+	/// 	bound sets is recorded. Changing the pipeline layout invalidates all bound sets.
+	/// </summary>
+	/// <param name="a_PipelineLayout">	The pipeline layout.</param>
+	/// <param name="a_FirstSet">	   	Index of the first set.</param>
+	/// <param name="a_SetCount">	   	Number of sets.</param>
+	/// <param name="a_Sets">		   	The descriptor sets.</param>
+
+	void BindDescriptorSets(VkPipelineLayout a_PipelineLayout, uint32_t a_FirstSet, uint32_t a_SetCount,
+	                        const VkDescriptorSet* a_Sets);
+
+	void BindVertexBuffers(uint32_t a_FirstBinding, uint32_t a_BindingCount, const VkBuffer* a_Buffers,
+	                       const VkDeviceSize* a_Offsets);
+
+	void BindIndexBuffer(VkBuffer a_Buffer, VkDeviceSize a_Offset, VkIndexType a_IndexType);
+
+	void SetViewport(const VkViewport& a_Viewport);
+
+	void SetScissor(const VkRect2D& a_Scissor);
+
+	/// <summary>
+	/// 	Binds the state of a draw item and records its draw, an indirect draw if the item has an
+	/// 	indirect buffer.
+	/// </summary>
+	/// <param name="a_DrawItem">	The draw item.</param>
+
+	void Draw(const DrawItem& a_DrawItem);
+
+	const BindStatistics& GetStatistics() const;
+
+	static constexpr uint32_t s_MaxDescriptorSets = 4;
+	static constexpr uint32_t s_MaxVertexBuffers = 4;
+
+private:
+	VkCommandBuffer m_CommandBuffer = VK_NULL_HANDLE;
+
+	VkPipeline m_Pipeline = VK_NULL_HANDLE;
+	VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+	std::array<VkDescriptorSet, s_MaxDescriptorSets> m_DescriptorSets = {};
+	std::array<VkBuffer, s_MaxVertexBuffers> m_VertexBuffers = {};
+	std::array<VkDeviceSize, s_MaxVertexBuffers> m_VertexBufferOffsets = {};
+	VkBuffer m_IndexBuffer = VK_NULL_HANDLE;
+	VkDeviceSize m_IndexBufferOffset = 0;
+	VkIndexType m_IndexType = VK_INDEX_TYPE_UINT32;
+
+	VkViewport m_Viewport = {};
+	VkRect2D m_Scissor = {};
+	bool m_ViewportSet = false;
+	bool m_ScissorSet = false;
+
+	BindStatistics m_Statistics;
+};
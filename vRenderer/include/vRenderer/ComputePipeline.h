@@ -0,0 +1,63 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+class ComputePipeline
+{
+public:
+	ComputePipeline();
+	~ComputePipeline();
+
+	/// <summary>
+	/// 	Creates a compute pipeline from a compiled compute shader, together with a descriptor set
+	/// 	layout (set 0) and a pipeline layout.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when any of the objects could not be created.</exception>
+	/// <param name="a_LogicalDevice">	  	The logical device.</param>
+	/// <param name="a_ShaderPath">		  	Path to the compiled .spv compute shader.</param>
+	/// <param name="a_Bindings">		  	The descriptor bindings of set 0.</param>
+	/// <param name="a_PushConstantSize">	(Optional) Size of the push constant block in bytes, 0 if none.</param>
+	/// <param name="a_AdditionalLayouts">	(Optional) Descriptor set layouts for sets 1 and up.</param>
+
+	void Create(const VkDevice& a_LogicalDevice, const std::string& a_ShaderPath,
+	            const std::vector<VkDescriptorSetLayoutBinding>& a_Bindings, uint32_t a_PushConstantSize = 0,
+	            const std::vector<VkDescriptorSetLayout>& a_AdditionalLayouts = {});
+
+	/// <summary>	Destroys the pipeline, its layout and its descriptor set layout. </summary>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+
+	void Destroy(const VkDevice& a_LogicalDevice);
+
+	/// <summary>	Binds the pipeline and a descriptor set to set 0. </summary>
+	/// <param name="a_CommandBuffer">	The command buffer.</param>
+	/// <param name="a_DescriptorSet">	The descriptor set to bind.</param>
+
+	void Bind(VkCommandBuffer a_CommandBuffer, VkDescriptorSet a_DescriptorSet) const;
+
+	/// <summary>	Updates the push constant block. </summary>
+	/// <param name="a_CommandBuffer">	The command buffer.</param>
+	/// <param name="a_Data">		  	The push constant data.</param>
+	/// <param name="a_Size">		  	Size of the data in bytes.</param>
+
+	void PushConstants(VkCommandBuffer a_CommandBuffer, const void* a_Data, uint32_t a_Size) const;
+
+	/// <summary>
+	/// 	Dispatches enough work groups to cover a two dimensional domain of the given size.
+	/// </summary>
+	/// <param name="a_CommandBuffer">	The command buffer.</param>
+	/// <param name="a_Width">		  	Width of the domain (e.g. image width).</param>
+	/// <param name="a_Height">		  	Height of the domain (e.g. image height).</param>
+	/// <param name="a_GroupSize">	  	(Optional) The local work group size used by the shader in x and y.</param>
+
+	static void Dispatch2D(VkCommandBuffer a_CommandBuffer, uint32_t a_Width, uint32_t a_Height, uint32_t a_GroupSize = 8);
+
+	VkPipeline GetPipeline() const;
+	VkPipelineLayout GetPipelineLayout() const;
+	VkDescriptorSetLayout GetDescriptorSetLayout() const;
+
+private:
+	VkPipeline m_Pipeline = VK_NULL_HANDLE;
+	VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+	VkDescriptorSetLayout m_DescriptorSetLayout = VK_NULL_HANDLE;
+};
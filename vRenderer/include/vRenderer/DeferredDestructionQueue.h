@@ -0,0 +1,42 @@
+#pragma once
+#include <deque>
+#include <functional>
+
+/// <summary>
+/// 	Defers the destruction of GPU resources until the submissions that may still use them have
+/// 	completed. Each deletion is tagged with the timeline value of the last submission using the
+/// 	resource and runs once the timeline has reached that value, so no CPU wait is required.
+/// </summary>
+class DeferredDestructionQueue
+{
+public:
+	DeferredDestructionQueue();
+	~DeferredDestructionQueue();
+
+	/// <summary>	Queues a deletion. </summary>
+	/// <param name="a_RetireValue">	Timeline value after which the resource is no longer in use.</param>
+	/// <param name="a_Destroy">		Destroys the resource.</param>
+
+	void Push(uint64_t a_RetireValue, std::function<void()> a_Destroy);
+
+	/// <summary>	Runs all deletions whose retire value has been reached. </summary>
+	/// <param name="a_CompletedValue">	The value the timeline has reached.</param>
+
+	void Collect(uint64_t a_CompletedValue);
+
+	/// <summary>	Runs all remaining deletions. The device has to be idle. </summary>
+
+	void Flush();
+
+	size_t GetPendingCount() const;
+
+private:
+	struct PendingDestruction
+	{
+		uint64_t m_RetireValue;
+		std::function<void()> m_Destroy;
+	};
+
+	// retire values only grow, so the queue stays sorted
+	std::deque<PendingDestruction> m_Pending;
+};
@@ -0,0 +1,95 @@
+#pragma once
+#include <glm/mat4x4.hpp>
+#include <vulkan/vulkan_core.h>
+
+#include "Image.h"
+
+class DescriptorAllocator;
+class Device;
+
+/// <summary>
+/// 	The G-buffer and lighting subpass of the deferred shading path. The main render pass writes
+/// 	albedo and an octahedron encoded normal next to the depth buffer in its first subpass, the
+/// 	second subpass reads them as input attachments and shades a fullscreen triangle with the
+/// 	clustered light lists.
+/// </summary>
+/// <remarks>
+/// 	The G-buffer is never stored, it is created as transient attachments in lazily allocated
+/// 	memory where available, so tile based GPUs can keep it in tile memory for the whole pass.
+/// </remarks>
+class DeferredLighting
+{
+public:
+	DeferredLighting();
+	~DeferredLighting();
+
+	/// <summary>	Creates the input attachment descriptor set layout. </summary>
+	/// <exception cref="std::runtime_error">	Raised when any of the objects could not be created.</exception>
+	/// <param name="a_Device">	The device.</param>
+
+	void Create(const Device& a_Device);
+
+	/// <summary>	Destroys all resources including the targets and the pipeline. </summary>
+	/// <param name="a_LogicalDevice">		The logical device.</param>
+	/// <param name="a_DescriptorAllocator">	The allocator caching the input attachment set.</param>
+
+	void Destroy(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator);
+
+	/// <summary>	Creates the lighting pipeline for the second subpass of the render pass. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the pipeline could not be created.</exception>
+	/// <param name="a_Device">		   	The device.</param>
+	/// <param name="a_RenderPass">	   	The deferred main render pass.</param>
+	/// <param name="a_LightSetLayout">	The layout of the clustered lighting set, bound as set 1.</param>
+
+	void CreatePipeline(const Device& a_Device, VkRenderPass a_RenderPass, VkDescriptorSetLayout a_LightSetLayout);
+
+	void DestroyPipeline(const VkDevice& a_LogicalDevice);
+
+	/// <summary>	Creates the G-buffer targets and the input attachment set pointing to them. </summary>
+	/// <param name="a_Device">				The device.</param>
+	/// <param name="a_DescriptorAllocator">	The allocator caching the input attachment set.</param>
+	/// <param name="a_Extent">				The extent of the targets.</param>
+	/// <param name="a_DepthImage">			The depth buffer, must have been created with input attachment usage.</param>
+
+	void CreateTargets(const Device& a_Device, DescriptorAllocator& a_DescriptorAllocator, VkExtent2D a_Extent,
+	                   const Image& a_DepthImage);
+
+	/// <summary>	Destroys the G-buffer targets and frees the input attachment set. </summary>
+	/// <param name="a_LogicalDevice">		The logical device.</param>
+	/// <param name="a_DescriptorAllocator">	The allocator caching the input attachment set.</param>
+
+	void DestroyTargets(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator);
+
+	/// <summary>
+	/// 	Advances to the lighting subpass and records the fullscreen lighting draw.
+	/// </summary>
+	/// <param name="a_CommandBuffer">		   	The command buffer, inside the first subpass.</param>
+	/// <param name="a_LightSet">			   	The clustered lighting set of the current frame.</param>
+	/// <param name="a_InverseViewProjection">	Inverse of the view projection the G-buffer was rendered with.</param>
+	/// <param name="a_RenderExtent">		   	The rendered part of the targets.</param>
+
+	void RecordLighting(VkCommandBuffer a_CommandBuffer, VkDescriptorSet a_LightSet,
+	                    const glm::mat4& a_InverseViewProjection, VkExtent2D a_RenderExtent) const;
+
+	const Image& GetAlbedo() const;
+	const Image& GetNormal() const;
+
+	static constexpr VkFormat s_AlbedoFormat = VK_FORMAT_R8G8B8A8_UNORM;
+	static constexpr VkFormat s_NormalFormat = VK_FORMAT_R16G16_SNORM;
+
+private:
+	struct LightingParameters
+	{
+		glm::mat4 m_InverseViewProjection;
+	};
+
+	VkDescriptorSetLayout m_DescriptorSetLayout = VK_NULL_HANDLE;
+	// owned by the descriptor allocator
+	VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+
+	VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+	VkPipeline m_Pipeline = VK_NULL_HANDLE;
+
+	Image m_Albedo;
+	Image m_Normal;
+};
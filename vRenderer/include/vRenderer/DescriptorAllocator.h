@@ -0,0 +1,171 @@
+#pragma once
+#include <initializer_list>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+/// <summary>	A single buffer or image descriptor written into a set. </summary>
+struct DescriptorBinding
+{
+	uint32_t m_Binding = 0;
+	VkDescriptorType m_Type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	VkDescriptorBufferInfo m_BufferInfo = {};
+	VkDescriptorImageInfo m_ImageInfo = {};
+
+	static DescriptorBinding Buffer(uint32_t a_Binding, VkDescriptorType a_Type, VkBuffer a_Buffer,
+	                                VkDeviceSize a_Offset = 0, VkDeviceSize a_Range = VK_WHOLE_SIZE);
+
+	static DescriptorBinding Image(uint32_t a_Binding, VkDescriptorType a_Type, VkImageView a_ImageView,
+	                               VkSampler a_Sampler, VkImageLayout a_Layout);
+
+	bool IsImage() const;
+
+	bool operator==(const DescriptorBinding& a_Other) const;
+};
+
+/// <summary>
+/// 	Allocates descriptor sets from growable pools.
+/// 	Transient sets are allocated from a list of pools per frame in flight. When a pool runs out of
+/// 	memory the next one is used, or a larger one is created, and all pools of a frame are reset
+/// 	at once when the frame is reused.
+/// 	Sets whose contents never change are cached by their layout and bindings and allocated from
+/// 	separate pools that are only reset explicitly, or freed one by one once an image view they
+/// 	point to is destroyed.
+/// </summary>
+class DescriptorAllocator
+{
+public:
+	DescriptorAllocator();
+	~DescriptorAllocator();
+
+	/// <summary>	Initializes the allocator. No pools are created until the first allocation. </summary>
+	/// <param name="a_FramesInFlight">	Number of frames in flight, one list of transient pools is kept per frame.</param>
+	/// <param name="a_InitialSets">   	(Optional) Number of sets the first pool of each list can hold.</param>
+
+	void Create(uint32_t a_FramesInFlight, uint32_t a_InitialSets = 64);
+
+	/// <summary>	Destroys all pools, freeing all sets allocated from them. </summary>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+
+	void Destroy(const VkDevice& a_LogicalDevice);
+
+	/// <summary>
+	/// 	Resets the transient pools of a frame and makes it the frame transient sets are allocated
+	/// 	for. Has to be called after the frame's previous submission has completed.
+	/// </summary>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+	/// <param name="a_Frame">		  	Index of the frame in flight.</param>
+
+	void BeginFrame(const VkDevice& a_LogicalDevice, uint32_t a_Frame);
+
+	/// <summary>
+	/// 	Allocates a set that is only valid until the current frame is reused, e.g. for a pass whose
+	/// 	inputs change from frame to frame. Does not allocate any memory on the heap once the
+	/// 	frame's pools are large enough.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when the set could not be allocated.</exception>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+	/// <param name="a_Layout">		  	The descriptor set layout.</param>
+	/// <param name="a_Bindings">	  	(Optional) Descriptors written into the set.</param>
+	/// <returns>	The descriptor set. </returns>
+
+	VkDescriptorSet AllocateTransient(const VkDevice& a_LogicalDevice, VkDescriptorSetLayout a_Layout,
+	                                  std::initializer_list<DescriptorBinding> a_Bindings = {});
+
+	/// <summary>
+	/// 	Gets a set with the given layout and contents. The set is allocated and written the first
+	/// 	time, afterwards the cached set is returned.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when the set could not be allocated.</exception>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+	/// <param name="a_Layout">		  	The descriptor set layout.</param>
+	/// <param name="a_Bindings">	  	Descriptors written into the set.</param>
+	/// <returns>	The descriptor set. </returns>
+
+	VkDescriptorSet GetCached(const VkDevice& a_LogicalDevice, VkDescriptorSetLayout a_Layout,
+	                          const std::vector<DescriptorBinding>& a_Bindings);
+
+	/// <summary>
+	/// 	Frees all cached sets, e.g. after the resources they point to were recreated. The sets
+	/// 	must not be in use anymore.
+	/// </summary>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+
+	void ResetCache(const VkDevice& a_LogicalDevice);
+
+	/// <summary>
+	/// 	Frees the cached sets that point to any of the image views, which are about to be
+	/// 	destroyed, e.g. when the render targets are recreated on a resize. A view created later
+	/// 	may reuse the handle, so the sets must not be found anymore. The sets must not be in use.
+	/// </summary>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+	/// <param name="a_ImageViews">   	The image views.</param>
+
+	void InvalidateImageViews(const VkDevice& a_LogicalDevice, const std::vector<VkImageView>& a_ImageViews);
+
+	/// <summary>	Writes descriptors into a set. </summary>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+	/// <param name="a_Set">		  	The descriptor set.</param>
+	/// <param name="a_Bindings">	  	The descriptors.</param>
+	/// <param name="a_Count">		  	The number of descriptors.</param>
+
+	static void Write(const VkDevice& a_LogicalDevice, VkDescriptorSet a_Set, const DescriptorBinding* a_Bindings,
+	                  size_t a_Count);
+
+	/// <summary>	Gets the number of pools created so far, used to monitor growth. </summary>
+	/// <returns>	The number of pools. </returns>
+
+	size_t GetPoolCount() const;
+
+private:
+	struct PoolList
+	{
+		std::vector<VkDescriptorPool> m_UsedPools;
+		std::vector<VkDescriptorPool> m_FreePools;
+
+		// capacity of the next pool that is created
+		uint32_t m_NextPoolSets = 0;
+
+		VkDescriptorPoolCreateFlags m_Flags = 0;
+	};
+
+	struct CachedSet
+	{
+		VkDescriptorSet m_Set;
+		VkDescriptorPool m_Pool;
+	};
+
+	struct CacheKey
+	{
+		VkDescriptorSetLayout m_Layout;
+		std::vector<DescriptorBinding> m_Bindings;
+
+		bool operator==(const CacheKey& a_Other) const;
+	};
+
+	struct CacheKeyHash
+	{
+		size_t operator()(const CacheKey& a_Key) const;
+	};
+
+	VkDescriptorSet Allocate(const VkDevice& a_LogicalDevice, PoolList& a_Pools, VkDescriptorSetLayout a_Layout,
+	                         VkDescriptorPool* a_Pool = nullptr);
+
+	VkDescriptorPool CreatePool(const VkDevice& a_LogicalDevice, PoolList& a_Pools);
+
+	static void ResetPools(const VkDevice& a_LogicalDevice, PoolList& a_Pools);
+
+	static void DestroyPools(const VkDevice& a_LogicalDevice, PoolList& a_Pools);
+
+	std::vector<PoolList> m_FramePools;
+	PoolList m_CachePools;
+
+	std::unordered_map<CacheKey, CachedSet, CacheKeyHash> m_Cache;
+
+	uint32_t m_CurrentFrame = 0;
+	uint32_t m_InitialSets = 64;
+	size_t m_PoolCount = 0;
+
+	// pools grow up to this many sets
+	const uint32_t m_MaxPoolSets = 4096;
+};
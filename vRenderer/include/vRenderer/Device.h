@@ -1,7 +1,11 @@
 #pragma once
+#include <optional>
+#include <string>
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
+#include "vRenderer/TimelineSemaphore.h"
+
 class SwapChain;
 class Device
 {
@@ -10,7 +14,7 @@ public:
 
 	/// <summary>	Selects a physical device. </summary>
 	/// <param name="a_Instance">				  	The Vulkan instance.</param>
-	/// <param name="a_Surface">				  	The window surface.</param>
+	/// <param name="a_Surface">				  	The window surface, VK_NULL_HANDLE to select a device for headless rendering.</param>
 	/// <param name="a_RequestedDeviceExtensions">	The requested device extensions.</param>
 
 	VkPhysicalDevice ChoosePhysicalDevice(VkInstance& a_Instance, VkSurfaceKHR a_Surface, const std::vector<const char*>& a_RequestedDeviceExtensions);
@@ -31,15 +35,89 @@ public:
 	VkPhysicalDevice GetPhysicalDevice() const;
 	VkDevice GetLogicalDevice() const;
 
+	/// <summary>	Gets the MSAA sample count currently used for rendering. </summary>
+	/// <returns>	The active MSAA sample count. </returns>
+
+	VkSampleCountFlagBits GetMSAASampleCount() const;
+
 	/// <summary>	Gets maximum MSAA samples the physical device supports. </summary>
 	/// <returns>	The maximum MSAA sample count. </returns>
 
-	VkSampleCountFlagBits GetMSAASampleCount() const;
+	VkSampleCountFlagBits GetMaxMSAASampleCount() const;
+
+	/// <summary>
+	/// 	Sets the MSAA sample count used for rendering. The requested count is clamped to the
+	/// 	highest count supported by the physical device that does not exceed it.
+	/// </summary>
+	/// <param name="a_RequestedSampleCount">	The requested MSAA sample count.</param>
+	/// <returns>	The sample count that is actually used. </returns>
+
+	VkSampleCountFlagBits SetMSAASampleCount(VkSampleCountFlagBits a_RequestedSampleCount);
+
+	/// <summary>	Checks whether the physical device supports sample rate shading. </summary>
+	/// <returns>	True if sample rate shading is supported, false if not. </returns>
+
+	bool SupportsSampleRateShading() const;
+
+	/// <summary>	Checks whether the graphics queue supports timestamp queries. </summary>
+	/// <returns>	True if timestamps can be written on the graphics queue, false if not. </returns>
+
+	bool SupportsTimestamps() const;
+
+	/// <summary>	Gets the number of nanoseconds it takes for a timestamp query to be incremented by 1. </summary>
+	/// <returns>	The timestamp period in nanoseconds. </returns>
+
+	float GetTimestampPeriod() const;
+
+	/// <summary>	Gets the maximum number of sampled images a single shader stage can access. </summary>
+	/// <returns>	The maximum number of sampled images. </returns>
+
+	uint32_t GetMaxSampledImages() const;
+
+	/// <summary>
+	/// 	Gets the timeline semaphore tracking the graphics queue. All submissions to the graphics
+	/// 	queue go through it, so its values order frames and uploads alike.
+	/// </summary>
+	/// <returns>	The graphics queue timeline. </returns>
+
+	TimelineSemaphore& GetGraphicsTimeline() const;
+
+	/// <summary>
+	/// 	Checks whether the device has a queue family dedicated to compute. Only then compute work
+	/// 	submitted to the compute queue can run alongside rasterization.
+	/// </summary>
+	/// <returns>	True if a separate compute queue was created with the logical device. </returns>
+
+	bool HasAsyncCompute() const;
+
+	/// <summary>	Gets the queue of the dedicated compute queue family. </summary>
+	/// <returns>	The compute queue, VK_NULL_HANDLE if the device has no async compute. </returns>
+
+	VkQueue GetComputeQueue() const;
+
+	uint32_t GetGraphicsQueueFamily() const;
+	uint32_t GetComputeQueueFamily() const;
+
+	/// <summary>	Gets the timeline semaphore tracking the compute queue. </summary>
+	/// <returns>	The compute queue timeline. </returns>
+
+	TimelineSemaphore& GetComputeTimeline() const;
+
+	/// <summary>
+	/// 	Checks whether a device extension is enabled, either because it was requested or because
+	/// 	it is one of the optional extensions enabled whenever the device supports them.
+	/// </summary>
+	/// <param name="a_Extension">	The name of the extension.</param>
+	/// <returns>	True if the extension is enabled on the logical device. </returns>
+
+	bool IsExtensionEnabled(const char* a_Extension) const;
 
 private:
 
 	bool CheckDeviceSuitability(VkPhysicalDevice a_Device, VkSurfaceKHR a_Surface, const std::vector<const char*>& a_RequestedDeviceExtensions) const;
 
+	static bool CheckVulkan12FeatureSupport(const VkPhysicalDevice& a_Device);
+
 	static bool CheckSwapChainCompatibility(const VkPhysicalDevice& a_Device, const VkSurfaceKHR& a_WindowSurface);
 
 	bool CheckDeviceExtensionSupport(VkPhysicalDevice a_Device, const std::vector<const char*>& a_RequestedDeviceExtensions) const;
@@ -49,6 +127,27 @@ private:
 	VkPhysicalDevice m_PhysicalDevice;
 	VkDevice m_LogicalDevice;
 
-	VkSampleCountFlagBits m_MSAASampleCount;
+	VkSampleCountFlagBits m_MSAASampleCount = VK_SAMPLE_COUNT_1_BIT;
+	VkSampleCountFlagBits m_MaxMSAASampleCount = VK_SAMPLE_COUNT_1_BIT;
+	VkSampleCountFlags m_SupportedMSAASampleCounts = VK_SAMPLE_COUNT_1_BIT;
+
+	bool m_SampleRateShadingSupported = false;
+
+	bool m_TimestampsSupported = false;
+	float m_TimestampPeriod = 1.0f;
+
+	uint32_t m_MaxSampledImages = 16;
+
+	uint32_t m_GraphicsFamily = 0;
+
+	// only set if the device has a queue family with compute but without graphics support
+	std::optional<uint32_t> m_AsyncComputeFamily;
+	VkQueue m_ComputeQueue = VK_NULL_HANDLE;
+
+	// signaling is not a change to the device itself, so the timeline can be used through const references
+	mutable TimelineSemaphore m_GraphicsTimeline;
+	mutable TimelineSemaphore m_ComputeTimeline;
+
+	std::vector<std::string> m_EnabledExtensions;
 };
 
@@ -0,0 +1,127 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "vRenderer/CommandEncoder.h"
+#include "vRenderer/FrameArena.h"
+
+class JobSystem;
+
+/// <summary>	Everything needed to record a single indexed draw. </summary>
+struct DrawItem
+{
+	uint64_t m_SortKey = 0;
+
+	VkPipeline m_Pipeline = VK_NULL_HANDLE;
+	VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+
+	std::array<VkDescriptorSet, CommandEncoder::s_MaxDescriptorSets> m_DescriptorSets = {};
+	uint32_t m_DescriptorSetCount = 0;
+
+	std::array<VkBuffer, CommandEncoder::s_MaxVertexBuffers> m_VertexBuffers = {};
+	std::array<VkDeviceSize, CommandEncoder::s_MaxVertexBuffers> m_VertexBufferOffsets = {};
+	uint32_t m_VertexBufferCount = 0;
+
+	VkBuffer m_IndexBuffer = VK_NULL_HANDLE;
+	VkIndexType m_IndexType = VK_INDEX_TYPE_UINT32;
+
+	uint32_t m_IndexCount = 0;
+	uint32_t m_FirstIndex = 0;
+	int32_t m_VertexOffset = 0;
+	uint32_t m_InstanceCount = 1;
+	uint32_t m_FirstInstance = 0;
+
+	// if set, the draw arguments above are ignored and read from a VkDrawIndexedIndirectCommand
+	// in this buffer instead, e.g. one written by the occlusion culling pass
+	VkBuffer m_IndirectBuffer = VK_NULL_HANDLE;
+	VkDeviceSize m_IndirectOffset = 0;
+};
+
+/// <summary>
+/// 	Collects the visible draws of a frame and orders them by a 64 bit sort key, so draws sharing
+/// 	a pipeline, material or mesh end up next to each other and redundant binds can be skipped.
+/// </summary>
+/// <remarks>
+/// 	Opaque keys, from the most to the least significant bits:
+/// 	pass (4) | translucent = 0 (1) | pipeline (11) | material (16) | mesh (16) | depth (16).
+/// 	Translucent keys:
+/// 	pass (4) | translucent = 1 (1) | inverted depth (24) | pipeline (11) | material (12) | mesh (12).
+/// 	Opaque draws are therefore grouped by state and front to back within equal state, translucent
+/// 	draws are drawn after all opaque draws of a pass and strictly back to front.
+/// </remarks>
+class DrawQueue
+{
+public:
+	DrawQueue();
+	~DrawQueue();
+
+	/// <summary>	Builds the sort key of an opaque draw. Ids are truncated to their bit widths. </summary>
+	/// <param name="a_Pass">	 	The pass (0 - 15).</param>
+	/// <param name="a_Pipeline">	Id of the pipeline.</param>
+	/// <param name="a_Material">	Id of the material.</param>
+	/// <param name="a_Mesh">	 	Id of the mesh.</param>
+	/// <param name="a_Depth">	 	View depth normalized to [0, 1], 0 is closest to the camera.</param>
+	/// <returns>	The sort key. </returns>
+
+	static uint64_t MakeOpaqueKey(uint32_t a_Pass, uint32_t a_Pipeline, uint32_t a_Material, uint32_t a_Mesh,
+	                              float a_Depth);
+
+	/// <summary>	Builds the sort key of a translucent draw. Ids are truncated to their bit widths. </summary>
+	/// <param name="a_Pass">	 	The pass (0 - 15).</param>
+	/// <param name="a_Pipeline">	Id of the pipeline.</param>
+	/// <param name="a_Material">	Id of the material.</param>
+	/// <param name="a_Mesh">	 	Id of the mesh.</param>
+	/// <param name="a_Depth">	 	View depth normalized to [0, 1], 0 is closest to the camera.</param>
+	/// <returns>	The sort key. </returns>
+
+	static uint64_t MakeTranslucentKey(uint32_t a_Pass, uint32_t a_Pipeline, uint32_t a_Material, uint32_t a_Mesh,
+	                                   float a_Depth);
+
+	/// <summary>
+	/// 	Removes all draws. The storage of the next draws is taken from the given arena, which has
+	/// 	to stay alive and unreset until they are recorded.
+	/// </summary>
+	/// <param name="a_Arena">	(Optional) The frame's arena, nullptr to use the heap.</param>
+
+	void Clear(LinearArena* a_Arena = nullptr);
+
+	void Add(const DrawItem& a_DrawItem);
+
+	/// <summary>	Sorts the draws by their keys. Draws with equal keys keep the order they were added in. </summary>
+	/// <param name="a_JobSystem">	The job system the sort is spread over.</param>
+
+	void Sort(JobSystem& a_JobSystem);
+
+	/// <summary>	Records all draws in their current order. </summary>
+	/// <param name="a_Encoder">	The encoder to record with.</param>
+
+	void Record(CommandEncoder& a_Encoder) const;
+
+	/// <summary>	Counts the binds the draws need in their current order, without recording anything. </summary>
+	/// <returns>	The bind statistics. </returns>
+
+	BindStatistics CountBinds() const;
+
+	size_t GetSize() const;
+
+	/// <summary>
+	/// 	Sorts key / value pairs by key with a least significant digit radix sort. Each pass
+	/// 	histograms and scatters the input in slices, one job per slice. Passes over digits that are
+	/// 	equal for all keys are skipped.
+	/// </summary>
+	/// <param name="a_Keys">	  	[in,out] The keys, their allocator also provides the scratch memory.</param>
+	/// <param name="a_Values">   	[in,out] The values, reordered along with the keys.</param>
+	/// <param name="a_JobSystem">	The job system running the slices.</param>
+
+	static void RadixSort(FrameVector<uint64_t>& a_Keys, FrameVector<uint32_t>& a_Values, JobSystem& a_JobSystem);
+
+private:
+	FrameVector<DrawItem> m_Items;
+
+	// draw order after sorting, indices into m_Items
+	FrameVector<uint32_t> m_Order;
+
+	// scratch buffer for the keys
+	FrameVector<uint64_t> m_Keys;
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <vulkan/vulkan_core.h>
+
+/// <summary>
+/// 	Chooses the render resolution scale from measured GPU frame times. The frame time is
+/// 	smoothed and the scale only changes if it leaves a band below the target budget, so small
+/// 	fluctuations do not cause the resolution to oscillate.
+/// </summary>
+class DynamicResolution
+{
+public:
+	DynamicResolution();
+	~DynamicResolution();
+
+	/// <summary>	Sets the frame time budget and the scale limits, and resets the controller. </summary>
+	/// <param name="a_TargetFrameTime">	The GPU frame time budget in milliseconds.</param>
+	/// <param name="a_MinScale">			The minimum scale per axis.</param>
+	/// <param name="a_MaxScale">			(Optional) The maximum scale per axis.</param>
+
+	void Configure(float a_TargetFrameTime, float a_MinScale, float a_MaxScale = 1.0f);
+
+	/// <summary>	Feeds a new GPU frame time measurement and adjusts the scale if required. </summary>
+	/// <param name="a_GpuFrameTime">	The measured GPU frame time in milliseconds.</param>
+	/// <returns>	True if the scale changed, false if not. </returns>
+
+	bool Update(float a_GpuFrameTime);
+
+	/// <summary>	Resets the scale to the maximum and discards the frame time history. </summary>
+	void Reset();
+
+	/// <summary>	Gets the current scale per axis. </summary>
+	/// <returns>	The scale, between the configured minimum and maximum. </returns>
+
+	float GetScale() const;
+
+	/// <summary>	Gets the smoothed GPU frame time. </summary>
+	/// <returns>	The smoothed frame time in milliseconds. </returns>
+
+	float GetSmoothedFrameTime() const;
+
+	/// <summary>	Applies the current scale to an extent. </summary>
+	/// <param name="a_FullExtent">	The full resolution extent.</param>
+	/// <returns>	The scaled extent, at least one pixel in each direction. </returns>
+
+	VkExtent2D GetRenderExtent(VkExtent2D a_FullExtent) const;
+
+private:
+	float m_TargetFrameTime = 1000.0f / 60.0f;
+	float m_MinScale = 0.5f;
+	float m_MaxScale = 1.0f;
+
+	float m_Scale = 1.0f;
+	float m_SmoothedFrameTime = 0.0f;
+	uint32_t m_FramesSinceChange = 0;
+
+	// weight of a new measurement in the exponential moving average
+	const float m_Smoothing = 0.1f;
+
+	// the scale is increased only if the frame time is this fraction below the target
+	const float m_Hysteresis = 0.15f;
+
+	// scales are snapped to multiples of this to avoid tiny changes
+	const float m_ScaleStep = 0.05f;
+
+	// largest change of the scale in a single adjustment
+	const float m_MaxScaleChange = 0.1f;
+
+	// frames to wait after a change before the next one, so the new scale shows up in the measurements
+	const uint32_t m_CooldownFrames = 10;
+};
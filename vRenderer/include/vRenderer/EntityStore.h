@@ -0,0 +1,321 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "JobSystem.h"
+
+/// <summary>
+/// 	Identifies an entity. Once the entity is destroyed the handle becomes stale, its index is
+/// 	reused with a new generation.
+/// </summary>
+struct Entity
+{
+	uint32_t m_Index = UINT32_MAX;
+	uint32_t m_Generation = 0;
+
+	bool operator==(const Entity& a_Other) const
+	{
+		return m_Index == a_Other.m_Index && m_Generation == a_Other.m_Generation;
+	}
+
+	bool operator!=(const Entity& a_Other) const
+	{
+		return !(*this == a_Other);
+	}
+};
+
+// one bit per component type
+using ComponentMask = uint64_t;
+
+/// <summary>
+/// 	Stores entities grouped by the set of components they have (their archetype). Each archetype
+/// 	keeps its entities in fixed size chunks, every chunk holds one contiguous array per component,
+/// 	so systems stream through exactly the components they read without chasing pointers.
+/// </summary>
+/// <remarks>
+/// 	Components have to be trivially copyable, they are moved with memcpy when entities change
+/// 	their archetype or fill the gap left by a destroyed entity. Chunks stay densely packed, so
+/// 	component pointers and rows are only valid until the next structural change (Create, Destroy,
+/// 	Add, Remove). Structural changes must not happen while iterating.
+/// </remarks>
+class EntityStore
+{
+public:
+	static constexpr uint32_t s_ChunkSize = 16 * 1024;
+	static constexpr uint32_t s_MaxComponentTypes = 64;
+
+	EntityStore();
+	~EntityStore();
+
+	EntityStore(const EntityStore&) = delete;
+	EntityStore& operator=(const EntityStore&) = delete;
+
+	/// <summary>	Creates an entity with the given components. </summary>
+	/// <exception cref="std::runtime_error">	Raised when a component type is passed twice.</exception>
+	/// <param name="a_Components">	The components.</param>
+	/// <returns>	The entity. </returns>
+
+	template<typename... Ts>
+	Entity Create(const Ts&... a_Components)
+	{
+		const ComponentMask t_Mask = MakeMask<Ts...>();
+		if (CountComponents(t_Mask) != sizeof...(Ts))
+		{
+			throw std::runtime_error("Error! An entity cannot have the same component twice!");
+		}
+
+		const Entity t_Entity = AllocateEntity();
+		AddRow(GetArchetypeIndex(t_Mask), t_Entity);
+
+		// the fold writes each component into its array
+		(WriteComponent(t_Entity, a_Components), ...);
+
+		return t_Entity;
+	}
+
+	/// <summary>	Destroys an entity, the last entity of its archetype takes its place. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the entity does not exist.</exception>
+	/// <param name="a_Entity">	The entity.</param>
+
+	void Destroy(Entity a_Entity);
+
+	/// <summary>	Destroys all entities, handles to them become stale. </summary>
+	void Clear();
+
+	bool IsAlive(Entity a_Entity) const;
+	uint32_t GetEntityCount() const;
+
+	template<typename T>
+	bool Has(const Entity a_Entity) const
+	{
+		return (m_Archetypes[GetRecord(a_Entity).m_Archetype]->m_Mask & GetComponentBit<T>()) != 0;
+	}
+
+	/// <summary>	Gets a component of an entity. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the entity does not exist or lacks the component.</exception>
+	/// <param name="a_Entity">	The entity.</param>
+	/// <returns>	The component, valid until the next structural change. </returns>
+
+	template<typename T>
+	T& Get(const Entity a_Entity)
+	{
+		const EntityRecord& t_Record = GetRecord(a_Entity);
+		Archetype& t_Archetype = *m_Archetypes[t_Record.m_Archetype];
+
+		if (!(t_Archetype.m_Mask & GetComponentBit<T>()))
+		{
+			throw std::runtime_error("Error! The entity does not have the requested component!");
+		}
+
+		return GetArray<T>(t_Archetype, t_Archetype.m_Chunks[t_Record.m_Chunk])[t_Record.m_Row];
+	}
+
+	/// <summary>	Adds a component to an entity, moving it to another archetype, or replaces it. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the entity does not exist.</exception>
+	/// <param name="a_Entity">   	The entity.</param>
+	/// <param name="a_Component">	The component.</param>
+
+	template<typename T>
+	void Add(const Entity a_Entity, const T& a_Component)
+	{
+		const ComponentMask t_Mask = m_Archetypes[GetRecord(a_Entity).m_Archetype]->m_Mask;
+
+		if (!(t_Mask & GetComponentBit<T>()))
+		{
+			MoveEntity(a_Entity, t_Mask | GetComponentBit<T>());
+		}
+
+		WriteComponent(a_Entity, a_Component);
+	}
+
+	/// <summary>	Removes a component from an entity, moving it to another archetype. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the entity does not exist.</exception>
+	/// <param name="a_Entity">	The entity.</param>
+
+	template<typename T>
+	void Remove(const Entity a_Entity)
+	{
+		const ComponentMask t_Mask = m_Archetypes[GetRecord(a_Entity).m_Archetype]->m_Mask;
+
+		if (t_Mask & GetComponentBit<T>())
+		{
+			MoveEntity(a_Entity, t_Mask & ~GetComponentBit<T>());
+		}
+	}
+
+	/// <summary>
+	/// 	Calls a function for every chunk of entities having all of the given components, with the
+	/// 	number of entities in the chunk, their handles and one array per component.
+	/// </summary>
+	/// <param name="a_Function">	Called as a_Function(uint32_t a_Count, const Entity* a_Entities, Ts* ...).</param>
+
+	template<typename... Ts, typename Function>
+	void ForEachChunk(Function&& a_Function)
+	{
+		const ComponentMask t_Mask = MakeMask<Ts...>();
+
+		for (const std::unique_ptr<Archetype>& t_Archetype : m_Archetypes)
+		{
+			if ((t_Archetype->m_Mask & t_Mask) != t_Mask)
+			{
+				continue;
+			}
+
+			for (Chunk& t_Chunk : t_Archetype->m_Chunks)
+			{
+				a_Function(t_Chunk.m_Count, GetEntities(t_Chunk), GetArray<Ts>(*t_Archetype, t_Chunk)...);
+			}
+		}
+	}
+
+	/// <summary>
+	/// 	Like ForEachChunk, but the chunks are spread over the job system's threads. The function
+	/// 	may only write to the components of the chunk it is called with.
+	/// </summary>
+	/// <param name="a_JobSystem">	The job system.</param>
+	/// <param name="a_Function"> 	Called as a_Function(uint32_t a_Count, const Entity* a_Entities, Ts* ...).</param>
+	/// <param name="a_Name">	  	(Optional) The name the jobs are profiled with.</param>
+
+	template<typename... Ts, typename Function>
+	void ParallelForEachChunk(JobSystem& a_JobSystem, Function&& a_Function, const char* a_Name = "Entity chunks")
+	{
+		const ComponentMask t_Mask = MakeMask<Ts...>();
+
+		std::vector<std::pair<Archetype*, Chunk*>> t_Chunks;
+		for (const std::unique_ptr<Archetype>& t_Archetype : m_Archetypes)
+		{
+			if ((t_Archetype->m_Mask & t_Mask) == t_Mask)
+			{
+				for (Chunk& t_Chunk : t_Archetype->m_Chunks)
+				{
+					t_Chunks.emplace_back(t_Archetype.get(), &t_Chunk);
+				}
+			}
+		}
+
+		a_JobSystem.ParallelFor(t_Chunks.size(), 1, [&](const size_t a_Begin, const size_t a_End)
+		{
+			for (size_t i = a_Begin; i < a_End; i++)
+			{
+				Archetype& t_Archetype = *t_Chunks[i].first;
+				Chunk& t_Chunk = *t_Chunks[i].second;
+
+				a_Function(t_Chunk.m_Count, GetEntities(t_Chunk), GetArray<Ts>(t_Archetype, t_Chunk)...);
+			}
+		}, a_Name);
+	}
+
+	/// <summary>	Gets the id of a component type, assigned on first use. </summary>
+	/// <exception cref="std::runtime_error">	Raised when there are more than s_MaxComponentTypes types.</exception>
+	/// <returns>	The id. </returns>
+
+	template<typename T>
+	static uint32_t GetComponentId()
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Components have to be trivially copyable");
+		static_assert(alignof(T) <= s_ArrayAlignment, "Components cannot be aligned to more than 16 bytes");
+
+		static const uint32_t s_Id = RegisterComponent(sizeof(T));
+		return s_Id;
+	}
+
+private:
+	static constexpr uint32_t s_NoArchetype = UINT32_MAX;
+	static constexpr uint32_t s_NoOffset = UINT32_MAX;
+
+	// component arrays start at this alignment within a chunk
+	static constexpr uint32_t s_ArrayAlignment = 16;
+
+	struct Chunk
+	{
+		// the entity handles first, then the component arrays
+		std::unique_ptr<uint8_t[]> m_Data;
+		uint32_t m_Count = 0;
+	};
+
+	struct Archetype
+	{
+		ComponentMask m_Mask = 0;
+
+		// entities per chunk
+		uint32_t m_Capacity = 0;
+
+		// offset of each component's array in a chunk, s_NoOffset for components not in the archetype
+		std::array<uint32_t, s_MaxComponentTypes> m_Offsets = {};
+
+		// ids and sizes of the components in the archetype
+		std::vector<uint32_t> m_Components;
+		std::vector<uint32_t> m_Sizes;
+
+		// all chunks but the last are full
+		std::vector<Chunk> m_Chunks;
+	};
+
+	struct EntityRecord
+	{
+		uint32_t m_Generation = 0;
+		uint32_t m_Archetype = s_NoArchetype;
+		uint32_t m_Chunk = 0;
+		uint32_t m_Row = 0;
+	};
+
+	static uint32_t RegisterComponent(uint32_t a_Size);
+	static uint32_t CountComponents(ComponentMask a_Mask);
+
+	template<typename T>
+	static ComponentMask GetComponentBit()
+	{
+		return static_cast<ComponentMask>(1) << GetComponentId<T>();
+	}
+
+	template<typename... Ts>
+	static ComponentMask MakeMask()
+	{
+		return (static_cast<ComponentMask>(0) | ... | GetComponentBit<Ts>());
+	}
+
+	template<typename T>
+	static T* GetArray(const Archetype& a_Archetype, Chunk& a_Chunk)
+	{
+		return reinterpret_cast<T*>(a_Chunk.m_Data.get() + a_Archetype.m_Offsets[GetComponentId<T>()]);
+	}
+
+	static const Entity* GetEntities(const Chunk& a_Chunk)
+	{
+		return reinterpret_cast<const Entity*>(a_Chunk.m_Data.get());
+	}
+
+	template<typename T>
+	void WriteComponent(const Entity a_Entity, const T& a_Component)
+	{
+		std::memcpy(&Get<T>(a_Entity), &a_Component, sizeof(T));
+	}
+
+	const EntityRecord& GetRecord(Entity a_Entity) const;
+
+	uint32_t GetArchetypeIndex(ComponentMask a_Mask);
+
+	Entity AllocateEntity();
+
+	// appends an entity to the last chunk of an archetype and points its record there
+	void AddRow(uint32_t a_Archetype, Entity a_Entity);
+
+	// fills the row with the last entity of the archetype
+	void RemoveRow(uint32_t a_Archetype, uint32_t a_Chunk, uint32_t a_Row);
+
+	// moves an entity to the archetype of a_Mask, keeping the components both have
+	void MoveEntity(Entity a_Entity, ComponentMask a_Mask);
+
+	std::vector<std::unique_ptr<Archetype>> m_Archetypes;
+	std::unordered_map<ComponentMask, uint32_t> m_ArchetypeIndices;
+
+	std::vector<EntityRecord> m_Records;
+	std::vector<uint32_t> m_FreeIndices;
+	uint32_t m_EntityCount = 0;
+};
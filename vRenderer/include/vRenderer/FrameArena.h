@@ -0,0 +1,174 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/// <summary>
+/// 	Bump allocator that hands out memory from a single block and frees it all at once on Reset.
+/// 	Allocations that do not fit are served from overflow blocks, on the next Reset the block is
+/// 	grown to hold everything that was allocated, so a steady workload stops touching the heap
+/// 	after its first round.
+/// </summary>
+/// <remarks>	Not thread safe, jobs should allocate before they are started or use their own arena. </remarks>
+class LinearArena
+{
+public:
+	LinearArena();
+	~LinearArena();
+
+	LinearArena(const LinearArena&) = delete;
+	LinearArena& operator=(const LinearArena&) = delete;
+	LinearArena(LinearArena&&) = default;
+	LinearArena& operator=(LinearArena&&) = default;
+
+	/// <summary>	Allocates the block. </summary>
+	/// <param name="a_Capacity">	The initial size of the block in bytes.</param>
+
+	void Create(size_t a_Capacity);
+
+	void Destroy();
+
+	/// <summary>	Allocates memory that stays valid until the next Reset. </summary>
+	/// <param name="a_Size">	  	The size in bytes.</param>
+	/// <param name="a_Alignment">	The alignment, a power of two.</param>
+	/// <returns>	The memory, never nullptr. </returns>
+
+	void* Allocate(size_t a_Size, size_t a_Alignment);
+
+	/// <summary>	Frees all allocations at once, growing the block if it overflowed. </summary>
+
+	void Reset();
+
+	size_t GetUsedSize() const;
+	size_t GetCapacity() const;
+
+private:
+	std::unique_ptr<uint8_t[]> m_Block;
+	size_t m_Capacity = 0;
+	size_t m_Offset = 0;
+
+	// blocks allocated after the main one ran out, freed on Reset
+	std::vector<std::unique_ptr<uint8_t[]>> m_OverflowBlocks;
+	size_t m_OverflowSize = 0;
+};
+
+/// <summary>
+/// 	STL allocator handing out memory from a linear arena. Deallocation does nothing, the memory
+/// 	is reclaimed when the arena is reset. Without an arena it falls back to the heap, so
+/// 	containers can be default constructed and bound to an arena later by assigning them.
+/// </summary>
+/// <remarks>
+/// 	Containers must not be used after the arena was reset, they have to be assigned a new one
+/// 	first. The arena propagates on assignment and swap, which keeps both sides' memory valid.
+/// </remarks>
+template<typename T>
+class ArenaAllocator
+{
+public:
+	using value_type = T;
+	using propagate_on_container_copy_assignment = std::true_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
+	ArenaAllocator() = default;
+
+	explicit ArenaAllocator(LinearArena* a_Arena) : m_Arena(a_Arena)
+	{
+	}
+
+	template<typename U>
+	ArenaAllocator(const ArenaAllocator<U>& a_Other) : m_Arena(a_Other.GetArena())
+	{
+	}
+
+	T* allocate(const size_t a_Count)
+	{
+		if (m_Arena == nullptr)
+		{
+			return std::allocator<T>().allocate(a_Count);
+		}
+
+		return static_cast<T*>(m_Arena->Allocate(sizeof(T) * a_Count, alignof(T)));
+	}
+
+	void deallocate(T* a_Pointer, const size_t a_Count)
+	{
+		if (m_Arena == nullptr)
+		{
+			std::allocator<T>().deallocate(a_Pointer, a_Count);
+		}
+	}
+
+	LinearArena* GetArena() const
+	{
+		return m_Arena;
+	}
+
+	template<typename U>
+	bool operator==(const ArenaAllocator<U>& a_Other) const
+	{
+		return m_Arena == a_Other.GetArena();
+	}
+
+	template<typename U>
+	bool operator!=(const ArenaAllocator<U>& a_Other) const
+	{
+		return m_Arena != a_Other.GetArena();
+	}
+
+private:
+	LinearArena* m_Arena = nullptr;
+};
+
+/// <summary>	A vector whose storage lives in a linear arena, see ArenaAllocator. </summary>
+template<typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+/// <summary>
+/// 	One linear arena per frame in flight for the transient CPU data of a frame, e.g. draw lists,
+/// 	sort keys, culling input and submission lists. A frame's arena is rewound when the frame is
+/// 	reused, after its previous submission completed, so the data may be referenced until then.
+/// </summary>
+class FrameArena
+{
+public:
+	FrameArena();
+	~FrameArena();
+
+	/// <summary>	Allocates one arena per frame in flight. </summary>
+	/// <param name="a_FramesInFlight">	Number of frames in flight.</param>
+	/// <param name="a_InitialCapacity">	(Optional) The initial size of each arena in bytes.</param>
+
+	void Create(uint32_t a_FramesInFlight, size_t a_InitialCapacity = 1 << 20);
+
+	void Destroy();
+
+	/// <summary>
+	/// 	Rewinds the arena of a frame and makes it the current one. Has to be called after the
+	/// 	frame's previous submission has completed.
+	/// </summary>
+	/// <param name="a_Frame">	Index of the frame in flight.</param>
+	/// <returns>	The frame's arena. </returns>
+
+	LinearArena& BeginFrame(uint32_t a_Frame);
+
+	/// <summary>	Gets the arena of the frame passed to the last BeginFrame. </summary>
+	/// <returns>	The current arena. </returns>
+
+	LinearArena& GetCurrent();
+
+	/// <summary>	Creates an empty vector allocating from the current arena. </summary>
+	/// <returns>	The vector. </returns>
+
+	template<typename T>
+	FrameVector<T> MakeVector()
+	{
+		return FrameVector<T>(ArenaAllocator<T>(&GetCurrent()));
+	}
+
+private:
+	std::vector<LinearArena> m_Arenas;
+	uint32_t m_CurrentFrame = 0;
+};
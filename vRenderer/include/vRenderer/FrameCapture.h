@@ -0,0 +1,157 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "Buffer/ReadbackBuffer.h"
+
+class Device;
+
+enum class CaptureFormat
+{
+	// headerless, tightly packed 8 bit RGBA frames
+	Raw,
+	// YUV4MPEG2 with 4:2:0 chroma subsampling, readable by most video tools
+	Y4M
+};
+
+/// <summary>
+/// 	Captures the presented frames to a video file without stalling the frame loop. Each frame the
+/// 	swap chain image is copied into a free slot of a ring of readback buffers in the frame's own
+/// 	submission. Slots are polled against the graphics timeline a few frames later and handed to an
+/// 	encoder thread, which converts and writes them straight from the mapped memory.
+/// </summary>
+/// <remarks>
+/// 	The render thread never waits for the GPU or the encoder, if no slot is free the frame is
+/// 	dropped from the capture instead. A video file has one size, so after a resize the capture
+/// 	continues in a new file, see Restart.
+/// </remarks>
+class FrameCapture
+{
+public:
+	FrameCapture();
+	~FrameCapture();
+
+	/// <summary>	Creates the readback ring and starts the encoder thread. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the format is not supported or the file could not be opened.</exception>
+	/// <param name="a_Device">	   	The device.</param>
+	/// <param name="a_Extent">	   	The extent of the captured images.</param>
+	/// <param name="a_ImageFormat">	The format of the captured images, 8 bit RGBA or BGRA.</param>
+	/// <param name="a_FilePath">  	The path of the video file.</param>
+	/// <param name="a_Format">	   	The format of the video file.</param>
+	/// <param name="a_FrameRate"> 	The frame rate written to the Y4M header.</param>
+	/// <param name="a_RingSize">  	(Optional) Number of readback slots, frames in flight plus the
+	/// 							frames the encoder may lag behind.</param>
+
+	void Start(const Device& a_Device, VkExtent2D a_Extent, VkFormat a_ImageFormat, const std::string& a_FilePath,
+	           CaptureFormat a_Format, uint32_t a_FrameRate, uint32_t a_RingSize = 6);
+
+	/// <summary>
+	/// 	Writes all captured frames and stops the encoder thread. Waits for the device to become
+	/// 	idle, so it is not meant to be called every frame.
+	/// </summary>
+	/// <param name="a_Device">	The device.</param>
+
+	void Stop(const Device& a_Device);
+
+	/// <summary>
+	/// 	Finishes the current file and continues the capture at a new extent in the next segment,
+	/// 	"capture.y4m" is continued in "capture_1.y4m", "capture_2.y4m" and so on. The frame counters
+	/// 	carry over. Does nothing if not capturing or the extent did not change.
+	/// </summary>
+	/// <exception cref="std::runtime_error">
+	/// 	Raised when the next segment could not be opened, the capture is stopped then.
+	/// </exception>
+	/// <param name="a_Device">	   	The device.</param>
+	/// <param name="a_Extent">	   	The new extent of the captured images.</param>
+	/// <param name="a_ImageFormat">	The format of the captured images.</param>
+
+	void Restart(const Device& a_Device, VkExtent2D a_Extent, VkFormat a_ImageFormat);
+
+	bool IsCapturing() const;
+
+	/// <summary>
+	/// 	Hands the slots whose submissions have finished to the encoder, in submission order.
+	/// </summary>
+	/// <param name="a_CompletedValue">	The completed value of the graphics timeline.</param>
+
+	void Poll(uint64_t a_CompletedValue);
+
+	/// <summary>
+	/// 	Records the copy of the image into a free slot, or drops the frame if there is none. Images
+	/// 	of a different extent are skipped until the capture is restarted. The image is left in the
+	/// 	layout it was in.
+	/// </summary>
+	/// <param name="a_CommandBuffer">	The command buffer, outside of a render pass.</param>
+	/// <param name="a_Image">		  	The image to capture.</param>
+	/// <param name="a_Extent">		  	The extent of the image.</param>
+	/// <param name="a_Layout">		  	The layout the image is in, e.g. the present layout.</param>
+
+	void RecordCapture(VkCommandBuffer a_CommandBuffer, VkImage a_Image, VkExtent2D a_Extent, VkImageLayout a_Layout);
+
+	/// <summary>	Sets the timeline value of the submission the last recorded copy is part of. </summary>
+	/// <param name="a_SubmitValue">	The value the submission signals on the graphics timeline.</param>
+
+	void SetSubmitValue(uint64_t a_SubmitValue);
+
+	/// <summary>	Gets the number of frames written since the capture started. </summary>
+	uint64_t GetCapturedFrames() const;
+
+	/// <summary>	Gets the number of frames dropped since the capture started. </summary>
+	uint64_t GetDroppedFrames() const;
+
+private:
+	enum class SlotState
+	{
+		Free,
+		Recorded,
+		InFlight,
+		Encoding
+	};
+
+	struct Slot
+	{
+		ReadbackBuffer m_Buffer;
+		SlotState m_State = SlotState::Free;
+		uint64_t m_SubmitValue = 0;
+	};
+
+	void EncodeLoop();
+
+	// converts a frame and writes it to the file, called on the encoder thread
+	void WriteFrame(const uint8_t* a_Pixels);
+
+	std::vector<Slot> m_Slots;
+	// slots submitted to the GPU, oldest first
+	std::deque<uint32_t> m_InFlight;
+	int32_t m_RecordedSlot = -1;
+
+	VkExtent2D m_Extent = {};
+	bool m_SwapRedBlue = false;
+	CaptureFormat m_Format = CaptureFormat::Raw;
+	std::ofstream m_File;
+
+	// the path given to Start, segments after a resize are named after it
+	std::string m_FilePath;
+	uint32_t m_Segment = 0;
+	uint32_t m_FrameRate = 0;
+
+	// converted frame, reused for every frame
+	std::vector<uint8_t> m_Scratch;
+
+	std::thread m_Encoder;
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_SlotQueued;
+	std::deque<uint32_t> m_EncodeQueue;
+	bool m_Capturing = false;
+	bool m_Stopping = false;
+
+	uint64_t m_CapturedFrames = 0;
+	uint64_t m_DroppedFrames = 0;
+};
@@ -0,0 +1,225 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+#include "FrameArena.h"
+#include "Buffer/ExternalBuffer.h"
+#include "Buffer/ReadbackBuffer.h"
+
+class Device;
+
+enum class FrameExportMode
+{
+	// the frames are written to device memory exported as a file descriptor, consumers import it
+	// into their own Vulkan device and wait on the exported timeline semaphore
+	ExternalMemory,
+	// the frames are written to the pixel slots of the shared memory ring
+	SharedMemory
+};
+
+/// <summary>
+/// 	Layout of the shared memory ring consumers map to find the exported frames. Frame N, counted
+/// 	from 1, is written to slot (N - 1) % m_SlotCount at m_DataOffset + slot * m_SlotSize, either in
+/// 	the ring itself or in the exported memory. The rows are tightly packed, 4 bytes per pixel in
+/// 	m_Format.
+/// </summary>
+/// <remarks>
+/// 	m_Sequence is incremented for every published frame and can be waited on with a futex, see
+/// 	FrameExporter::WaitForFrame. A slot's frame number is 0 while it is being overwritten, CPU
+/// 	consumers compare it before and after reading the pixels to detect frames overwritten in
+/// 	between. m_Ended is set, and waiters are woken, once the producer stops writing to the ring or
+/// 	replaces it with one of a new extent, consumers then open the name again.
+/// </remarks>
+struct SharedFrameRing
+{
+	static constexpr uint32_t s_Magic = 0x52465276; // "vRFR"
+	static constexpr uint32_t s_Version = 2;
+	static constexpr uint32_t s_MaxSlots = 8;
+
+	uint32_t m_Magic;
+	uint32_t m_Version;
+	uint32_t m_Width;
+	uint32_t m_Height;
+	uint32_t m_Format;
+	uint32_t m_SlotCount;
+	uint32_t m_Mode;
+	uint32_t m_Padding;
+	uint64_t m_SlotSize;
+	uint64_t m_DataOffset;
+	// size the exported memory has to be imported with, 0 in the shared memory mode
+	uint64_t m_MemorySize;
+	// identifies the physical device the exported memory belongs to
+	uint8_t m_DeviceUuid[VK_UUID_SIZE];
+
+	std::atomic<uint32_t> m_Sequence;
+	std::atomic<uint32_t> m_Ended;
+	std::atomic<uint64_t> m_LatestFrame;
+	std::atomic<uint64_t> m_SlotFrames[s_MaxSlots];
+};
+
+/// <summary>
+/// 	Exports the rendered frames to other local processes without copying them on the CPU. Each
+/// 	frame the swap chain image is copied on the GPU into a slot of a ring that lives in memory
+/// 	the consumer maps as well: device memory exported through VK_KHR_external_memory_fd where
+/// 	available, otherwise a POSIX shared memory ring imported into the device through
+/// 	VK_EXT_external_memory_host.
+/// </summary>
+/// <remarks>
+/// 	Only if neither extension is available the frames are read back into host memory and copied
+/// 	into the ring once they finished. The ring never waits for consumers, they have to keep up
+/// 	within the number of slots. External memory and futexes are only available on Linux.
+/// </remarks>
+class FrameExporter
+{
+public:
+	FrameExporter();
+	~FrameExporter();
+
+	/// <summary>	Creates the shared memory ring and the memory the frames are written to. </summary>
+	/// <exception cref="std::runtime_error">
+	/// 	Raised when the format is not 8 bit RGBA or BGRA, the platform has no shared memory
+	/// 	support or any of the objects could not be created.
+	/// </exception>
+	/// <param name="a_Device">	   	The device.</param>
+	/// <param name="a_Extent">	   	The extent of the exported images.</param>
+	/// <param name="a_Format">	   	The format of the exported images.</param>
+	/// <param name="a_Name">	   	The name of the shared memory object, e.g. "/vRenderer-frames".</param>
+	/// <param name="a_SlotCount"> 	Number of slots, more than the frames in flight.</param>
+	/// <param name="a_PreferredMode">	(Optional) The mode to use if the device supports it.</param>
+
+	void Create(const Device& a_Device, VkExtent2D a_Extent, VkFormat a_Format, const std::string& a_Name,
+	            uint32_t a_SlotCount, FrameExportMode a_PreferredMode = FrameExportMode::ExternalMemory);
+
+	/// <summary>
+	/// 	Marks the ring as ended, destroys all resources and unlinks the shared memory object. The
+	/// 	device must be idle.
+	/// </summary>
+	/// <param name="a_Device">	The device.</param>
+
+	void Destroy(const Device& a_Device);
+
+	/// <summary>
+	/// 	Ends the ring and creates a new one of the same name at a new extent, consumers still
+	/// 	mapping the old one see it ended. Does nothing if not exporting or the extent did not
+	/// 	change. The device must be idle.
+	/// </summary>
+	/// <exception cref="std::runtime_error">
+	/// 	Raised when the new ring could not be created, the export is stopped then.
+	/// </exception>
+	/// <param name="a_Device">	The device.</param>
+	/// <param name="a_Extent">	The new extent of the exported images.</param>
+
+	void Resize(const Device& a_Device, VkExtent2D a_Extent);
+
+	bool IsExporting() const;
+
+	FrameExportMode GetMode() const;
+
+	/// <summary>
+	/// 	Publishes the frames whose copies have finished, in the shared memory mode. Frames in the
+	/// 	external memory mode are published on submission instead.
+	/// </summary>
+	/// <param name="a_CompletedValue">	The completed value of the graphics timeline.</param>
+
+	void Poll(uint64_t a_CompletedValue);
+
+	/// <summary>
+	/// 	Records the copy of the image into the next slot. Frames of a different extent than the
+	/// 	ring was created with are skipped until it is resized. The image is left in the layout it
+	/// 	was in.
+	/// </summary>
+	/// <param name="a_CommandBuffer">	The command buffer, outside of a render pass.</param>
+	/// <param name="a_Image">		  	The image to export.</param>
+	/// <param name="a_Extent">		  	The extent of the image.</param>
+	/// <param name="a_Layout">		  	The layout the image is in, e.g. the present layout.</param>
+
+	void RecordExport(VkCommandBuffer a_CommandBuffer, VkImage a_Image, VkExtent2D a_Extent, VkImageLayout a_Layout);
+
+	/// <summary>
+	/// 	Appends the exported timeline semaphore to the signal semaphores of the submission the
+	/// 	last recorded copy is part of. Does nothing if nothing was recorded or in the shared
+	/// 	memory mode.
+	/// </summary>
+	/// <param name="a_Semaphores">	[in,out] The signal semaphores of the submission.</param>
+	/// <param name="a_Values">	   	[in,out] The signal values of the submission.</param>
+
+	void AddSignal(FrameVector<VkSemaphore>& a_Semaphores, FrameVector<uint64_t>& a_Values) const;
+
+	/// <summary>	Sets the timeline value of the submission the last recorded copy is part of. </summary>
+	/// <param name="a_SubmitValue">	The value the submission signals on the graphics timeline.</param>
+
+	void SetSubmitValue(uint64_t a_SubmitValue);
+
+	/// <summary>
+	/// 	Exports the memory holding the pixel slots in the external memory mode. Every call creates
+	/// 	a new descriptor owned by the caller, usually sent to the consumer over a unix socket.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when not in the external memory mode.</exception>
+	/// <param name="a_Device">	The device.</param>
+	/// <returns>	The file descriptor. </returns>
+
+	int ExportMemoryFd(const Device& a_Device) const;
+
+	/// <summary>
+	/// 	Exports the timeline semaphore signaled with the frame number once a frame's copy finished,
+	/// 	in the external memory mode. Every call creates a new descriptor owned by the caller.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when not in the external memory mode.</exception>
+	/// <param name="a_Device">	The device.</param>
+	/// <returns>	The file descriptor. </returns>
+
+	int ExportSemaphoreFd(const Device& a_Device) const;
+
+	/// <summary>
+	/// 	Blocks a consumer until a frame after the given sequence number has been published, for
+	/// 	use by the processes mapping the ring.
+	/// </summary>
+	/// <param name="a_Ring">		   	The mapped ring.</param>
+	/// <param name="a_LastSequence">	The sequence number the consumer has seen last.</param>
+	/// <param name="a_TimeoutMs">   	The maximum time to wait in milliseconds.</param>
+	/// <returns>	The current sequence number, equal to a_LastSequence on timeout. </returns>
+
+	static uint32_t WaitForFrame(const SharedFrameRing& a_Ring, uint32_t a_LastSequence, uint32_t a_TimeoutMs);
+
+private:
+	struct PendingFrame
+	{
+		uint64_t m_Frame;
+		uint64_t m_SubmitValue;
+	};
+
+	void CreateExportedSemaphore(const Device& a_Device);
+
+	// makes a frame's slot visible to consumers and wakes them
+	void Publish(uint64_t a_Frame);
+
+	FrameExportMode m_Mode = FrameExportMode::SharedMemory;
+	FrameExportMode m_PreferredMode = FrameExportMode::ExternalMemory;
+	VkFormat m_Format = VK_FORMAT_UNDEFINED;
+	bool m_Exporting = false;
+
+	std::string m_Name;
+	SharedFrameRing* m_Ring = nullptr;
+	size_t m_RingSize = 0;
+	int m_RingFd = -1;
+
+	VkExtent2D m_Extent = {};
+	VkDeviceSize m_SlotSize = 0;
+
+	// holds all slots in exported device memory or on top of the mapped ring
+	ExternalBuffer m_SlotBuffer;
+	bool m_HasSlotBuffer = false;
+
+	// only used if the ring cannot be imported, the slots are copied into it once complete
+	std::vector<ReadbackBuffer> m_StagingBuffers;
+
+	VkSemaphore m_ExportedSemaphore = VK_NULL_HANDLE;
+
+	uint64_t m_NextFrame = 1;
+	uint64_t m_RecordedFrame = 0;
+	std::deque<PendingFrame> m_PendingFrames;
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+class Device;
+
+/// <summary>
+/// 	Measures GPU execution time with timestamp queries. Holds one pair of timestamps per frame
+/// 	in flight, so results of a frame can be read once its timeline value has been waited on.
+/// </summary>
+class GpuTimer
+{
+public:
+	GpuTimer();
+	~GpuTimer();
+
+	/// <summary>	Creates the timestamp query pool. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the query pool could not be created.</exception>
+	/// <param name="a_Device">	   	The device.</param>
+	/// <param name="a_FrameCount">	Number of frames in flight.</param>
+
+	void Create(const Device& a_Device, uint32_t a_FrameCount);
+
+	void Destroy(const VkDevice& a_LogicalDevice);
+
+	/// <summary>	Records the start timestamp of a frame. </summary>
+	/// <param name="a_CommandBuffer">	The command buffer, outside of a render pass.</param>
+	/// <param name="a_Frame">		  	Index of the frame in flight.</param>
+
+	void Begin(VkCommandBuffer a_CommandBuffer, uint32_t a_Frame);
+
+	/// <summary>	Records the end timestamp of a frame. </summary>
+	/// <param name="a_CommandBuffer">	The command buffer, outside of a render pass.</param>
+	/// <param name="a_Frame">		  	Index of the frame in flight.</param>
+
+	void End(VkCommandBuffer a_CommandBuffer, uint32_t a_Frame);
+
+	/// <summary>
+	/// 	Reads the GPU time between Begin and End of the last submission of a frame. Does not
+	/// 	block, the frame's timeline value should have been waited on before.
+	/// </summary>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+	/// <param name="a_Frame">		  	Index of the frame in flight.</param>
+	/// <param name="a_Milliseconds"> 	[out] The elapsed GPU time in milliseconds.</param>
+	/// <returns>	True if a result was available, false if not (or timestamps are unsupported). </returns>
+
+	bool GetElapsedMilliseconds(const VkDevice& a_LogicalDevice, uint32_t a_Frame, float& a_Milliseconds) const;
+
+private:
+	VkQueryPool m_QueryPool = VK_NULL_HANDLE;
+
+	float m_TimestampPeriod = 1.0f;
+	bool m_Supported = false;
+
+	// whether timestamps have been written for a frame at least once
+	std::vector<bool> m_Recorded;
+};
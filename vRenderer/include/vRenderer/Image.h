@@ -49,21 +49,21 @@ public:
 	const VkImageView GetImageView() const;
 
 	void TransitionImageLayout(VkImageLayout a_OldLayout, VkImageLayout a_NewLayout,
-	                           VkCommandPool& a_CommandPool, const VkQueue& a_GraphicsQueue, const VkDevice& a_LogicalDevice, uint32_t a_MipLevel);
+	                           VkCommandPool& a_CommandPool, const VkQueue& a_GraphicsQueue, const Device& a_Device, uint32_t a_MipLevel);
 
 	uint32_t GetMipLevels();
 
 private:
-	void AllocateImageMemory(Device a_Device, VkMemoryPropertyFlags a_PropertyFlags);
+	void AllocateImageMemory(const Device& a_Device, VkMemoryPropertyFlags a_PropertyFlags);
 
 	VkImageMemoryBarrier GenImageBarrier(VkImageLayout a_OldLayout, VkImageLayout a_NewLayout,
 	                                     VkPipelineStageFlags& a_SourceStage,
 	                                     VkPipelineStageFlags& a_DestinationStage, uint32_t a_MipLevel) const;
 
-	VkImage m_Image;
-	VkDeviceMemory m_ImageMemory;
+	VkImage m_Image = VK_NULL_HANDLE;
+	VkDeviceMemory m_ImageMemory = VK_NULL_HANDLE;
 
-	VkImageView m_ImageView;
-	uint32_t m_Miplevels;
+	VkImageView m_ImageView = VK_NULL_HANDLE;
+	uint32_t m_Miplevels = 1;
 };
 
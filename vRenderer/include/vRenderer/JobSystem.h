@@ -0,0 +1,179 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobCounter;
+
+struct JobSystemSettings
+{
+	// number of worker threads, 0 starts one per core except the one of the calling thread
+	uint32_t m_WorkerCount = 0;
+
+	// pins worker i to core i + 1, leaving the first core to the main thread
+	bool m_PinWorkers = true;
+};
+
+/// <summary>
+/// 	Callbacks around every job, e.g. to forward them to a profiler. They are called on the
+/// 	thread running the job, with the job's name or nullptr if it has none.
+/// </summary>
+struct JobProfilingHooks
+{
+	std::function<void(const char* a_Name, uint32_t a_Thread)> m_OnBegin;
+	std::function<void(const char* a_Name, uint32_t a_Thread, uint64_t a_Nanoseconds)> m_OnEnd;
+};
+
+struct Job
+{
+	std::function<void()> m_Function;
+	// decremented once the job has finished
+	JobCounter* m_Counter = nullptr;
+	const char* m_Name = nullptr;
+};
+
+/// <summary>
+/// 	Counts the unfinished jobs of a group. Jobs can be made to wait for a counter to reach zero
+/// 	through JobSystem::RunAfter, threads through JobSystem::Wait.
+/// </summary>
+class JobCounter
+{
+public:
+	JobCounter();
+	~JobCounter();
+
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	bool IsDone() const;
+
+private:
+	friend class JobSystem;
+
+	std::atomic<uint32_t> m_Pending{0};
+
+	// guards the continuations and the transition to zero
+	std::mutex m_Mutex;
+	std::vector<Job> m_Continuations;
+};
+
+/// <summary>
+/// 	Work-stealing job scheduler. Every worker owns a deque it pushes to and pops from at the back,
+/// 	so the jobs a job spawns run on the same core while they are still in cache. Idle workers
+/// 	steal from the front of the other deques, which holds the oldest and usually largest work.
+/// 	Threads that are not workers push to a shared deque and run jobs themselves while they wait.
+/// </summary>
+/// <remarks>
+/// 	Jobs must not throw, errors have to be passed to the waiting thread. Before Start and after
+/// 	Stop jobs run immediately on the calling thread, so code using the system works without it.
+/// </remarks>
+class JobSystem
+{
+public:
+	JobSystem();
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	/// <summary>	Starts the worker threads, restarting them if already running. </summary>
+	/// <param name="a_Settings">	The settings.</param>
+
+	void Start(const JobSystemSettings& a_Settings);
+
+	/// <summary>
+	/// 	Runs all queued jobs and stops the worker threads. Jobs still waiting for a counter are
+	/// 	discarded.
+	/// </summary>
+
+	void Stop();
+
+	bool IsRunning() const;
+
+	uint32_t GetWorkerCount() const;
+
+	/// <summary>	Gets the number of threads running jobs while one thread waits, the workers plus the waiting one. </summary>
+	/// <returns>	The thread count. </returns>
+
+	uint32_t GetThreadCount() const;
+
+	/// <summary>	Sets the profiling hooks. Must not be called while jobs are running. </summary>
+	/// <param name="a_Hooks">	The hooks, empty functions are skipped.</param>
+
+	void SetProfilingHooks(const JobProfilingHooks& a_Hooks);
+
+	/// <summary>	Queues a job. </summary>
+	/// <param name="a_Function">	The work.</param>
+	/// <param name="a_Counter"> 	(Optional) Counter incremented now and decremented when the job finished.</param>
+	/// <param name="a_Name">	 	(Optional) Name passed to the profiling hooks, has to outlive the job.</param>
+
+	void Run(std::function<void()> a_Function, JobCounter* a_Counter = nullptr, const char* a_Name = nullptr);
+
+	/// <summary>	Queues a job once all jobs of a counter have finished, without blocking. </summary>
+	/// <param name="a_Dependency">	The counter to wait for, has to outlive the job's queuing.</param>
+	/// <param name="a_Function">  	The work.</param>
+	/// <param name="a_Counter">   	(Optional) Counter incremented now and decremented when the job finished.</param>
+	/// <param name="a_Name">	   	(Optional) Name passed to the profiling hooks.</param>
+
+	void RunAfter(JobCounter& a_Dependency, std::function<void()> a_Function, JobCounter* a_Counter = nullptr,
+	              const char* a_Name = nullptr);
+
+	/// <summary>	Runs jobs on the calling thread until all jobs of a counter have finished. </summary>
+	/// <param name="a_Counter">	The counter.</param>
+
+	void Wait(JobCounter& a_Counter);
+
+	/// <summary>
+	/// 	Splits a range into batches, runs them as jobs and waits for them, helping on the calling
+	/// 	thread. Small ranges run on the calling thread directly.
+	/// </summary>
+	/// <param name="a_Count">	  	The size of the range.</param>
+	/// <param name="a_MinBatchSize">	The smallest batch worth a job of its own.</param>
+	/// <param name="a_Function"> 	Called with the beginning and end of each batch.</param>
+	/// <param name="a_Name">	  	(Optional) Name passed to the profiling hooks.</param>
+
+	void ParallelFor(size_t a_Count, size_t a_MinBatchSize, const std::function<void(size_t, size_t)>& a_Function,
+	                 const char* a_Name = nullptr);
+
+	/// <summary>	Gets the index of the calling thread within this system. </summary>
+	/// <returns>	The worker index, GetWorkerCount for any other thread. </returns>
+
+	uint32_t GetCurrentThreadIndex() const;
+
+private:
+	struct WorkQueue
+	{
+		std::mutex m_Mutex;
+		std::deque<Job> m_Jobs;
+	};
+
+	void WorkerLoop(uint32_t a_Worker);
+
+	// pushes to the calling worker's queue, or the shared queue for other threads
+	void Push(Job&& a_Job);
+
+	// pops the newest job of the own queue or steals the oldest of another
+	bool TryPop(uint32_t a_Queue, Job& a_Job);
+
+	void Execute(Job& a_Job);
+
+	// decrements a counter and queues its continuations once it reaches zero
+	void Complete(JobCounter& a_Counter);
+
+	// one queue per worker followed by the queue shared by all other threads
+	std::vector<std::unique_ptr<WorkQueue>> m_Queues;
+	std::vector<std::thread> m_Workers;
+
+	std::atomic<uint32_t> m_QueuedJobs{0};
+	std::mutex m_SleepMutex;
+	std::condition_variable m_WakeUp;
+	bool m_Stopping = false;
+
+	JobProfilingHooks m_Hooks;
+};
@@ -1,24 +1,31 @@
 #pragma once
 #include "vRenderer/Texture.h"
 #include "vRenderer/helper_structs/Mesh.h"
+#include <glm/gtc/quaternion.hpp>
 
 #define TINYOBJLOADER_IMPLEMENTATION
 
+class JobSystem;
+
 class Model
 {
 public:
 	Model();
 	~Model();
 
-	/// <summary>	Loads an obj file and texture from the specified paths. </summary>
+	/// <summary>
+	/// 	Loads an obj file and texture from the specified paths. With a job system the texture is
+	/// 	decoded in a job while the obj file is parsed, only the upload runs on the calling thread.
+	/// </summary>
 	/// <param name="a_ModelPath">	  	Full pathname of the model file.</param>
 	/// <param name="a_TexturePath">  	Full pathname of the texture file.</param>
 	/// <param name="a_Device">		  	The device.</param>
 	/// <param name="a_CommandPool">  	[in,out] The command pool.</param>
 	/// <param name="a_GraphicsQueue">	Graphics Queue.</param>
+	/// <param name="a_JobSystem">	  	(Optional) The job system to decode the texture on.</param>
 
 	void Load(const char* a_ModelPath, const char* a_TexturePath, const Device& a_Device, VkCommandPool& a_CommandPool,
-	          const VkQueue& a_GraphicsQueue);
+	          const VkQueue& a_GraphicsQueue, JobSystem* a_JobSystem = nullptr);
 
 	void CreateFromMesh(Mesh& a_Mesh, const char* a_TexturePath, const Device& a_Device,
                  VkCommandPool& a_CommandPool, const VkQueue& a_GraphicsQueue);
@@ -28,8 +35,25 @@ public:
 	const Texture& GetTexture();
 	Mesh& GetMesh();
 
+	/// <summary>	Sets the slot of the model's texture in the bindless texture table. </summary>
+	/// <param name="a_TextureIndex">	The slot index returned when registering the texture.</param>
+
+	void SetTextureIndex(uint32_t a_TextureIndex);
+	uint32_t GetTextureIndex() const;
+
+	/// <summary>	Applies a rotation on top of the current one. </summary>
+	/// <param name="a_Angle">	The angle in degrees.</param>
+	/// <param name="a_Axis"> 	The axis to rotate around.</param>
+
 	void Rotate(float a_Angle, glm::vec3 a_Axis);
+
+	/// <summary>	Replaces the rotation. </summary>
+	/// <param name="a_Angle">	The angle in degrees.</param>
+	/// <param name="a_Axis"> 	The axis to rotate around.</param>
+
+	void SetRotation(float a_Angle, glm::vec3 a_Axis);
 	glm::mat4 GetRotation();
+	const glm::quat& GetOrientation() const;
 
 	void SetScale(float a_Scale);
 	glm::mat4 GetScale();
@@ -39,14 +63,46 @@ public:
 
 	glm::mat4 GetModelMatrix();
 
+	/// <summary>	Gets the bounding sphere of the mesh in object space. </summary>
+	/// <returns>	The center in xyz and the radius in w. </returns>
+
+	const glm::vec4& GetBoundingSphere() const;
+
+	/// <summary>	Gets the axis aligned bounding box of the mesh in object space. </summary>
+
+	const glm::vec3& GetBoundsMin() const;
+	const glm::vec3& GetBoundsMax() const;
+
+	/// <summary>
+	/// 	Marks the model as an occluder. Occluders are rasterized by the software occlusion culler
+	/// 	and hide the models behind them, they should be large and closed.
+	/// </summary>
+	/// <param name="a_Occluder">	True if the model occludes other models.</param>
+
+	void SetOccluder(bool a_Occluder);
+	bool IsOccluder() const;
+
 private:
 	void LoadMesh(const char* a_ModelPath);
 
+	/// <summary>
+	/// 	Computes the bounding box of the mesh and the bounding sphere around the box's center.
+	/// </summary>
+
+	void ComputeBounds();
+
 	Mesh m_Mesh;
 	Texture m_Texture;
+	uint32_t m_TextureIndex = 0;
 
 	glm::vec3 m_Position{};
 	float m_Scale;
-	glm::mat4 m_Rotation{};
+	glm::quat m_Rotation{};
+
+	glm::vec4 m_BoundingSphere{};
+	glm::vec3 m_BoundsMin{};
+	glm::vec3 m_BoundsMax{};
+
+	bool m_Occluder = false;
 };
 
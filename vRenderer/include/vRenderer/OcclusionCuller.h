@@ -0,0 +1,182 @@
+#pragma once
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <vulkan/vulkan_core.h>
+
+#include "ComputePipeline.h"
+#include "FrameArena.h"
+#include "Image.h"
+#include "Buffer/StorageBuffer.h"
+#include "helper_structs/InstanceBounds.h"
+
+class DescriptorAllocator;
+class Device;
+
+/// <summary>
+/// 	Two phase occlusion culling against a hierarchical depth (Hi-Z) pyramid built in compute.
+/// 	The first phase selects the instances that were visible last frame and still are inside the
+/// 	frustum, which are drawn into the depth buffer by a depth prepass. The pyramid is built from
+/// 	that depth buffer and the second phase tests every instance against it, writing the indirect
+/// 	draws of the main pass and the visibility used by the next frame's first phase.
+/// </summary>
+/// <remarks>
+/// 	Culled instances keep their draw with an instance count of 0, so the indirect buffers can be
+/// 	drawn from without a GPU written draw count. Newly visible instances are found in the second
+/// 	phase of the frame they become visible in, so nothing pops in late. The phases, the depth
+/// 	prepass and the pyramid build are scheduled and synchronized by the renderer's prepass render
+/// 	graph.
+/// </remarks>
+class OcclusionCuller
+{
+public:
+	OcclusionCuller();
+	~OcclusionCuller();
+
+	/// <summary>	Creates the culling and pyramid pipelines, the sampler and the instance buffers. </summary>
+	/// <param name="a_Device">		   	The device.</param>
+	/// <param name="a_MaxInstances">  	The maximum number of instances culled per frame.</param>
+	/// <param name="a_FramesInFlight">	Number of frames in flight, one bounds buffer is used per frame.</param>
+
+	void Create(const Device& a_Device, uint32_t a_MaxInstances, uint32_t a_FramesInFlight);
+
+	/// <summary>	Destroys all resources including the targets. </summary>
+	/// <param name="a_LogicalDevice">		The logical device.</param>
+	/// <param name="a_DescriptorAllocator">	The allocator caching the descriptor sets.</param>
+
+	void Destroy(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator);
+
+	/// <summary>	Creates the pyramid and the descriptor sets reading the depth buffer. </summary>
+	/// <exception cref="std::runtime_error">	Raised when any of the objects could not be created.</exception>
+	/// <param name="a_Device">				The device.</param>
+	/// <param name="a_DescriptorAllocator">	The allocator caching the descriptor sets.</param>
+	/// <param name="a_DepthImage">			The depth buffer, must have been created with sampled usage.</param>
+	/// <param name="a_Extent">				The extent of the depth buffer.</param>
+	/// <param name="a_SampleCount">			The sample count of the depth buffer.</param>
+
+	void CreateTargets(const Device& a_Device, DescriptorAllocator& a_DescriptorAllocator, const Image& a_DepthImage,
+	                   VkExtent2D a_Extent, VkSampleCountFlagBits a_SampleCount);
+
+	/// <summary>	Destroys the pyramid and frees the cached descriptor sets pointing to it. </summary>
+	/// <param name="a_LogicalDevice">		The logical device.</param>
+	/// <param name="a_DescriptorAllocator">	The allocator caching the descriptor sets.</param>
+
+	void DestroyTargets(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator);
+
+	/// <summary>	Uploads the bounds and draw arguments of the instances culled this frame. </summary>
+	/// <exception cref="std::runtime_error">	Raised when there are more instances than the buffers can hold.</exception>
+	/// <param name="a_Frame"> 	The index of the frame in flight.</param>
+	/// <param name="a_Bounds">	The instance bounds, the index of an instance is its slot in the indirect buffers.</param>
+
+	void UpdateInstances(uint32_t a_Frame, const FrameVector<InstanceBounds>& a_Bounds);
+
+	/// <summary>
+	/// 	Clears the visibility buffer if the targets were recreated since the last frame. Records
+	/// 	nothing otherwise.
+	/// </summary>
+	/// <param name="a_CommandBuffer">	The command buffer, outside of a render pass.</param>
+
+	void RecordVisibilityReset(VkCommandBuffer a_CommandBuffer);
+
+	/// <summary>
+	/// 	Records the first phase, writing the draws of last frame's visible instances into the
+	/// 	depth prepass indirect buffer.
+	/// </summary>
+	/// <param name="a_CommandBuffer"> 	The command buffer, outside of a render pass.</param>
+	/// <param name="a_Frame">		   	The index of the frame in flight.</param>
+	/// <param name="a_ViewProjection">	The view projection matrix the frame is rendered with.</param>
+
+	void RecordPrepassCulling(VkCommandBuffer a_CommandBuffer, uint32_t a_Frame, const glm::mat4& a_ViewProjection) const;
+
+	/// <summary>
+	/// 	Builds the pyramid from the depth buffer, sampled in the depth read only layout, and leaves
+	/// 	it in the general layout.
+	/// </summary>
+	/// <param name="a_CommandBuffer">	The command buffer, outside of a render pass.</param>
+	/// <param name="a_RenderExtent"> 	The rendered part of the depth buffer.</param>
+
+	void RecordPyramidBuild(VkCommandBuffer a_CommandBuffer, VkExtent2D a_RenderExtent) const;
+
+	/// <summary>
+	/// 	Records the second phase, testing every instance against the pyramid and writing the draws
+	/// 	of all unoccluded instances into the main indirect buffer.
+	/// </summary>
+	/// <param name="a_CommandBuffer"> 	The command buffer, outside of a render pass.</param>
+	/// <param name="a_Frame">		   	The index of the frame in flight.</param>
+	/// <param name="a_ViewProjection">	The view projection matrix the frame is rendered with.</param>
+	/// <param name="a_RenderExtent">  	The rendered part of the depth buffer.</param>
+
+	void RecordOcclusionCulling(VkCommandBuffer a_CommandBuffer, uint32_t a_Frame, const glm::mat4& a_ViewProjection,
+	                            VkExtent2D a_RenderExtent) const;
+
+	/// <summary>	Gets the pyramid, read in the general layout by the second phase. </summary>
+	const Image& GetPyramid() const;
+
+	VkBuffer GetVisibilityBuffer() const;
+
+	/// <summary>	Gets the indirect buffer the depth prepass draws from. </summary>
+	/// <returns>	One VkDrawIndexedIndirectCommand per instance slot. </returns>
+
+	VkBuffer GetPrepassDrawBuffer() const;
+
+	/// <summary>	Gets the indirect buffer the main pass draws from. </summary>
+	/// <returns>	One VkDrawIndexedIndirectCommand per instance slot. </returns>
+
+	VkBuffer GetDrawBuffer() const;
+
+	static constexpr VkDeviceSize s_DrawCommandStride = sizeof(VkDrawIndexedIndirectCommand);
+	static constexpr VkFormat s_Format = VK_FORMAT_R32_SFLOAT;
+
+private:
+	struct CopyParameters
+	{
+		glm::ivec2 m_RenderExtent;
+		int32_t m_SampleCount;
+	};
+
+	struct CullParameters
+	{
+		glm::mat4 m_ViewProjection;
+		glm::vec2 m_RenderExtent;
+		uint32_t m_InstanceCount;
+		uint32_t m_Phase;
+	};
+
+	void CreateDescriptorSets(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator,
+	                          const Image& a_DepthImage);
+
+	void DispatchCulling(VkCommandBuffer a_CommandBuffer, uint32_t a_Frame, const glm::mat4& a_ViewProjection,
+	                     VkExtent2D a_RenderExtent, uint32_t a_Phase) const;
+
+	ComputePipeline m_DepthCopyPipeline;
+	ComputePipeline m_DepthCopyMSPipeline;
+	ComputePipeline m_ReducePipeline;
+	ComputePipeline m_CullPipeline;
+
+	VkSampler m_Sampler = VK_NULL_HANDLE;
+
+	// the sets are owned by the descriptor allocator
+	VkDescriptorSet m_CopyDescriptorSet = VK_NULL_HANDLE;
+	// one set per pyramid level after the first, reading the previous level
+	std::vector<VkDescriptorSet> m_ReduceDescriptorSets;
+	// one set per frame in flight, the bounds buffers differ
+	std::vector<VkDescriptorSet> m_CullDescriptorSets;
+
+	// farthest depth of the covered pixels per texel, level 0 matches the depth buffer
+	Image m_HiZ;
+	std::vector<VkImageView> m_HiZLevelViews;
+	VkExtent2D m_Extent = {};
+
+	VkSampleCountFlagBits m_SampleCount = VK_SAMPLE_COUNT_1_BIT;
+
+	std::vector<StorageBuffer> m_BoundsBuffers;
+	StorageBuffer m_VisibilityBuffer;
+	StorageBuffer m_PrepassDrawBuffer;
+	StorageBuffer m_DrawBuffer;
+
+	uint32_t m_MaxInstances = 0;
+	uint32_t m_InstanceCount = 0;
+
+	// the visibility buffer is cleared before its first use, nothing counts as visible until tested
+	bool m_ResetVisibility = true;
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+/// <summary>
+/// 	Writes 8 bit RGB PNG images row by row, so images of any size can be written without holding
+/// 	them in memory. The image data is stored in uncompressed deflate blocks, which keeps encoding
+/// 	limited by disk bandwidth rather than by the CPU.
+/// </summary>
+class PngWriter
+{
+public:
+	PngWriter();
+	~PngWriter();
+
+	/// <summary>	Creates the file and writes the image header. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the file could not be opened.</exception>
+	/// <param name="a_FilePath">	The path of the image.</param>
+	/// <param name="a_Width">   	The width of the image.</param>
+	/// <param name="a_Height">  	The height of the image.</param>
+
+	void Open(const std::string& a_FilePath, uint32_t a_Width, uint32_t a_Height);
+
+	/// <summary>	Appends rows to the image, top to bottom. The alpha channel is dropped. </summary>
+	/// <exception cref="std::runtime_error">	Raised when more rows than the image height are written.</exception>
+	/// <param name="a_Pixels">  	Tightly packed 8 bit RGBA rows.</param>
+	/// <param name="a_RowCount">	Number of rows.</param>
+
+	void WriteRows(const uint8_t* a_Pixels, uint32_t a_RowCount);
+
+	/// <summary>	Finishes the image and closes the file. </summary>
+	/// <exception cref="std::runtime_error">	Raised when not all rows were written.</exception>
+
+	void Close();
+
+	/// <summary>	Writes a whole image. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the file could not be written.</exception>
+	/// <param name="a_FilePath">	The path of the image.</param>
+	/// <param name="a_Pixels">  	Tightly packed 8 bit RGBA rows, starting at the top left.</param>
+	/// <param name="a_Width">   	The width of the image.</param>
+	/// <param name="a_Height">  	The height of the image.</param>
+
+	static void WriteImage(const std::string& a_FilePath, const uint8_t* a_Pixels, uint32_t a_Width, uint32_t a_Height);
+
+private:
+	// writes a chunk of the given type, the length and checksum are added
+	void WriteChunk(const char* a_Type, const uint8_t* a_Data, uint32_t a_Size);
+
+	static uint32_t UpdateCrc(uint32_t a_Crc, const uint8_t* a_Data, size_t a_Size);
+
+	std::ofstream m_File;
+	uint32_t m_Width = 0;
+	uint32_t m_Height = 0;
+	uint32_t m_RowsWritten = 0;
+
+	// checksum over the uncompressed data, including the filter byte of each row
+	uint32_t m_Adler = 1;
+};
@@ -0,0 +1,348 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+class Device;
+
+using RenderGraphResource = uint32_t;
+using RenderGraphPass = uint32_t;
+
+/// <summary>
+/// 	How a pass accesses an image or buffer. Determines layout, pipeline stage and access mask.
+/// 	Attachment, sampled and depth usages only apply to images, indirect reads only to buffers.
+/// </summary>
+enum class ResourceUsage
+{
+	ColorAttachment,
+	DepthAttachment,
+	SampledFragment,
+	SampledCompute,
+	// sampled depth that stays in the depth read only layout, e.g. to be loaded by a later render pass
+	DepthSampledCompute,
+	StorageReadCompute,
+	StorageWriteCompute,
+	StorageReadWriteCompute,
+	IndirectRead,
+	TransferSource,
+	TransferDestination
+};
+
+enum class PassType
+{
+	// executed inside a render pass created by the graph from the pass' attachments
+	Graphics,
+	Compute,
+	Transfer
+};
+
+/// <summary>	Description of an image owned by the render graph. </summary>
+struct TransientImageDesc
+{
+	VkFormat m_Format = VK_FORMAT_R8G8B8A8_UNORM;
+	VkExtent2D m_Extent = {};
+	VkImageAspectFlags m_Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+	VkSampleCountFlagBits m_Samples = VK_SAMPLE_COUNT_1_BIT;
+};
+
+/// <summary>
+/// 	Frame graph of passes that declare which images and buffers they read and write. Compiling
+/// 	the graph orders the passes by their dependencies, culls passes that do not contribute to an
+/// 	imported resource, computes the layout transitions and batches the barriers of each pass,
+/// 	creates render passes for graphics passes and places transient images whose lifetimes do not
+/// 	overlap in the same memory.
+/// </summary>
+/// <remarks>
+/// 	Passes writing the same resource run in the order they were added, passes only reading it run
+/// 	after all of them. Passes that do not depend on each other keep the order they were added in.
+/// 	The barriers are recorded from lists built by Compile, executing the graph does not allocate.
+/// 	Transient images do not keep their contents between frames.
+/// </remarks>
+class RenderGraph
+{
+public:
+	using ExecuteCallback = std::function<void(VkCommandBuffer)>;
+
+	RenderGraph();
+	~RenderGraph();
+
+	/// <summary>	Declares an image that is created and owned by the graph. </summary>
+	/// <param name="a_Name">	   	Name of the image, used in error messages.</param>
+	/// <param name="a_Description">	The image description.</param>
+	/// <returns>	Handle of the image. </returns>
+
+	RenderGraphResource CreateImage(const std::string& a_Name, const TransientImageDesc& a_Description);
+
+	/// <summary>
+	/// 	Declares an image that is owned outside of the graph, e.g. a swap chain image or a
+	/// 	history buffer. Imported images are never culled or aliased.
+	/// </summary>
+	/// <param name="a_Name">		   	Name of the image, used in error messages.</param>
+	/// <param name="a_Image">		   	The image, may be VK_NULL_HANDLE until UpdateImportedImage.</param>
+	/// <param name="a_ImageView">	   	The image view, used for attachments.</param>
+	/// <param name="a_Description">   	Format, extent, aspect and sample count of the image.</param>
+	/// <param name="a_InitialLayout"> 	The layout of the image when the graph starts executing,
+	/// 								VK_IMAGE_LAYOUT_UNDEFINED discards its contents.</param>
+	/// <param name="a_FinalLayout">   	The layout the image is transitioned to after the last pass,
+	/// 								VK_IMAGE_LAYOUT_UNDEFINED if it does not matter.</param>
+	/// <returns>	Handle of the image. </returns>
+
+	RenderGraphResource ImportImage(const std::string& a_Name, VkImage a_Image, VkImageView a_ImageView,
+	                                const TransientImageDesc& a_Description, VkImageLayout a_InitialLayout,
+	                                VkImageLayout a_FinalLayout);
+
+	/// <summary>
+	/// 	Declares a buffer that is owned outside of the graph. Writes are made visible to all
+	/// 	commands recorded after the graph.
+	/// </summary>
+	/// <param name="a_Name">  	Name of the buffer, used in error messages.</param>
+	/// <param name="a_Buffer">	The buffer.</param>
+	/// <returns>	Handle of the buffer. </returns>
+
+	RenderGraphResource ImportBuffer(const std::string& a_Name, VkBuffer a_Buffer);
+
+	/// <summary>
+	/// 	Replaces the handles of an imported image, e.g. with the swap chain image acquired this
+	/// 	frame or the recreated target after a resize. The format has to stay the same. Patches the
+	/// 	compiled barriers, so it may be called every frame.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when the image is not imported.</exception>
+	/// <param name="a_Resource"> 	The imported image.</param>
+	/// <param name="a_Image">	  	The image.</param>
+	/// <param name="a_ImageView">	The image view.</param>
+	/// <param name="a_Extent">   	The extent of the image.</param>
+
+	void UpdateImportedImage(RenderGraphResource a_Resource, VkImage a_Image, VkImageView a_ImageView,
+	                         VkExtent2D a_Extent);
+
+	/// <summary>
+	/// 	Changes the layout an imported image is in when the graph starts executing, e.g. for a
+	/// 	history that has not been written yet. Patches the compiled barriers.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when the image is not imported.</exception>
+	/// <param name="a_Resource">	  	The imported image.</param>
+	/// <param name="a_InitialLayout">	The layout.</param>
+
+	void SetInitialLayout(RenderGraphResource a_Resource, VkImageLayout a_InitialLayout);
+
+	/// <summary>	Adds a pass. Its accesses are declared with Read and Write. </summary>
+	/// <param name="a_Name">	 	Name of the pass.</param>
+	/// <param name="a_Type">	 	The pass type.</param>
+	/// <param name="a_Callback">	Records the commands of the pass.</param>
+	/// <returns>	Handle of the pass. </returns>
+
+	RenderGraphPass AddPass(const std::string& a_Name, PassType a_Type, ExecuteCallback a_Callback);
+
+	/// <summary>	Declares that a pass reads an image or buffer. </summary>
+	/// <exception cref="std::runtime_error">
+	/// 	Raised when the pass already accesses the resource or the usage does not apply to it.
+	/// </exception>
+	/// <param name="a_Pass">	 	The pass.</param>
+	/// <param name="a_Resource">	The resource.</param>
+	/// <param name="a_Usage">   	How the resource is read.</param>
+
+	void Read(RenderGraphPass a_Pass, RenderGraphResource a_Resource, ResourceUsage a_Usage);
+
+	/// <summary>	Declares that a pass writes an image or buffer. </summary>
+	/// <exception cref="std::runtime_error">
+	/// 	Raised when the pass already accesses the resource or the usage does not apply to it.
+	/// </exception>
+	/// <param name="a_Pass">	   	The pass.</param>
+	/// <param name="a_Resource">  	The resource.</param>
+	/// <param name="a_Usage">	   	How the resource is written.</param>
+	/// <param name="a_LoadOp">	   	(Optional) Load operation if the image is an attachment.</param>
+	/// <param name="a_ClearValue">	(Optional) Clear value if the load operation is a clear.</param>
+
+	void Write(RenderGraphPass a_Pass, RenderGraphResource a_Resource, ResourceUsage a_Usage,
+	           VkAttachmentLoadOp a_LoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR, VkClearValue a_ClearValue = {});
+
+	/// <summary>
+	/// 	Sets the part of the attachments a graphics pass renders to, starting at the top left. The
+	/// 	whole attachments are rendered to by default.
+	/// </summary>
+	/// <param name="a_Pass">	   	The graphics pass.</param>
+	/// <param name="a_RenderArea">	The extent of the render area.</param>
+
+	void SetRenderArea(RenderGraphPass a_Pass, VkExtent2D a_RenderArea);
+
+	/// <summary>
+	/// 	Orders and culls the passes, allocates and aliases transient images, creates the render
+	/// 	passes and precomputes all barriers. Has to be called again after the graph changed.
+	/// </summary>
+	/// <exception cref="std::runtime_error">
+	/// 	Raised when the passes depend on each other in a cycle or a pass reads a transient image
+	/// 	no pass writes.
+	/// </exception>
+	/// <param name="a_Device">	The device.</param>
+
+	void Compile(const Device& a_Device);
+
+	/// <summary>	Records all passes and their barriers. </summary>
+	/// <param name="a_CommandBuffer">	The command buffer, outside of a render pass.</param>
+
+	void Execute(VkCommandBuffer a_CommandBuffer);
+
+	/// <summary>
+	/// 	Destroys the cached frame buffers attached to any of the given views. Has to be called
+	/// 	before imported views are destroyed, as new views may reuse their handles.
+	/// </summary>
+	/// <param name="a_ImageViews">	The image views about to be destroyed.</param>
+
+	void InvalidateImageViews(const std::vector<VkImageView>& a_ImageViews);
+
+	/// <summary>	Destroys all Vulkan objects created by the graph and removes all passes and resources. </summary>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+
+	void Destroy(const VkDevice& a_LogicalDevice);
+
+	/// <summary>	Gets the render pass of a graphics pass, used to create compatible pipelines. </summary>
+	/// <param name="a_Pass">	The pass.</param>
+	/// <returns>	The render pass, VK_NULL_HANDLE if the pass was culled or is not a graphics pass. </returns>
+
+	VkRenderPass GetRenderPass(RenderGraphPass a_Pass) const;
+
+	VkImage GetImage(RenderGraphResource a_Resource) const;
+	VkImageView GetImageView(RenderGraphResource a_Resource) const;
+
+	/// <summary>	Checks whether a pass survived culling. </summary>
+	/// <param name="a_Pass">	The pass.</param>
+	/// <returns>	True if the pass is executed, false if it was culled. </returns>
+
+	bool IsPassActive(RenderGraphPass a_Pass) const;
+
+	/// <summary>	Gets the device memory allocated for transient images after aliasing. </summary>
+	/// <returns>	The allocated size in bytes. </returns>
+
+	VkDeviceSize GetTransientMemorySize() const;
+
+private:
+	struct ResourceAccess
+	{
+		RenderGraphResource m_Resource;
+		ResourceUsage m_Usage;
+		VkAttachmentLoadOp m_LoadOp;
+		VkClearValue m_ClearValue;
+	};
+
+	struct ResourceState
+	{
+		VkImageLayout m_Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkPipelineStageFlags m_Stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		VkAccessFlags m_Access = 0;
+	};
+
+	/// <summary>	Position of an image barrier in the compiled batches, patched when an imported image changes. </summary>
+	struct BarrierLocation
+	{
+		// index of the pass, -1 for the final barriers
+		int m_Pass;
+		uint32_t m_Index;
+	};
+
+	struct Resource
+	{
+		std::string m_Name;
+		TransientImageDesc m_Description;
+		bool m_Imported = false;
+		bool m_IsBuffer = false;
+
+		VkImage m_Image = VK_NULL_HANDLE;
+		VkImageView m_ImageView = VK_NULL_HANDLE;
+		VkBuffer m_Buffer = VK_NULL_HANDLE;
+		VkImageLayout m_InitialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkImageLayout m_FinalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		// filled in by Compile, pass indices are positions in the execution order
+		VkImageUsageFlags m_Usage = 0;
+		int m_FirstPass = -1;
+		int m_LastPass = -1;
+		int m_MemoryBlock = -1;
+		std::vector<BarrierLocation> m_Barriers;
+	};
+
+	struct BarrierBatch
+	{
+		VkPipelineStageFlags m_SourceStage = 0;
+		VkPipelineStageFlags m_DestinationStage = 0;
+		std::vector<VkImageMemoryBarrier> m_ImageBarriers;
+		std::vector<VkBufferMemoryBarrier> m_BufferBarriers;
+	};
+
+	struct CachedFramebuffer
+	{
+		std::vector<VkImageView> m_Views;
+		VkFramebuffer m_Framebuffer = VK_NULL_HANDLE;
+	};
+
+	struct Pass
+	{
+		std::string m_Name;
+		PassType m_Type;
+		ExecuteCallback m_Callback;
+		std::vector<ResourceAccess> m_Reads;
+		std::vector<ResourceAccess> m_Writes;
+		VkExtent2D m_RenderArea = {};
+
+		// filled in by Compile
+		bool m_Active = false;
+		BarrierBatch m_Barriers;
+		VkRenderPass m_RenderPass = VK_NULL_HANDLE;
+		std::vector<RenderGraphResource> m_Attachments;
+		std::vector<VkClearValue> m_ClearValues;
+
+		// one frame buffer per combination of attachment views, imported images may change
+		std::vector<CachedFramebuffer> m_Framebuffers;
+	};
+
+	struct MemoryBlock
+	{
+		VkDeviceMemory m_Memory = VK_NULL_HANDLE;
+		VkDeviceSize m_Size = 0;
+		uint32_t m_MemoryTypeBits = ~0u;
+
+		// resources placed in this block, in order of execution
+		std::vector<RenderGraphResource> m_Resources;
+	};
+
+	static ResourceState GetUsageState(ResourceUsage a_Usage);
+	static VkImageUsageFlags GetUsageFlags(ResourceUsage a_Usage);
+	static bool IsWrite(ResourceUsage a_Usage);
+	static bool SupportsUsage(const Resource& a_Resource, ResourceUsage a_Usage);
+
+	bool AccessesResource(const Pass& a_Pass, RenderGraphResource a_Resource) const;
+	void AddAccess(RenderGraphPass a_Pass, const ResourceAccess& a_Access, bool a_Write);
+
+	void SortPasses();
+	void CullPasses();
+	void ComputeLifetimes();
+	void AllocateTransientImages(const Device& a_Device);
+	void ComputeBarriers();
+	void CreateRenderPasses(const VkDevice& a_LogicalDevice);
+
+	/// <summary>	Adds the barrier moving a resource from one state to the next to a batch. </summary>
+	void AddBarrier(BarrierBatch& a_Batch, int a_Pass, RenderGraphResource a_Resource, const ResourceState& a_Current,
+	                const ResourceState& a_Next);
+
+	VkImageMemoryBarrier& GetImageBarrier(const BarrierLocation& a_Location);
+
+	/// <summary>	Checks whether a resource is accessed after a position in the execution order, or leaves the graph. </summary>
+	bool IsReadAfter(RenderGraphResource a_Resource, uint32_t a_Position) const;
+
+	static void RecordBarriers(VkCommandBuffer a_CommandBuffer, const BarrierBatch& a_Batch);
+	VkFramebuffer GetFramebuffer(Pass& a_Pass);
+
+	void DestroyCompiledObjects();
+
+	std::vector<Resource> m_Resources;
+	std::vector<Pass> m_Passes;
+	std::vector<MemoryBlock> m_MemoryBlocks;
+
+	// indices of the passes in the order they are executed
+	std::vector<uint32_t> m_ExecutionOrder;
+
+	// transitions of imported resources to their final layout after the last pass
+	BarrierBatch m_FinalBarriers;
+
+	VkDevice m_LogicalDevice = VK_NULL_HANDLE;
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+
+#include "EntityStore.h"
+#include "FrameArena.h"
+#include "helper_structs/InstanceBounds.h"
+#include "helper_structs/RenderComponents.h"
+
+class DrawQueue;
+class JobSystem;
+class SceneBvh;
+class SoftwareOcclusionCuller;
+class TransformStore;
+struct DrawItem;
+struct GpuMesh;
+
+// systems over the renderable entities, each streams through the chunks holding the components it needs
+
+/// <summary>
+/// 	Copies the world matrices that changed since the last sync into the entities, moves their
+/// 	world bounds and passes those on to the scene hierarchy.
+/// </summary>
+/// <param name="a_Entities">	  	The entities.</param>
+/// <param name="a_Transforms">   	The updated transforms.</param>
+/// <param name="a_SyncedSerial"> 	[in,out] The serial of the last transform update synced, 0 initially.</param>
+/// <param name="a_SceneBvh">	  	The scene hierarchy, holding the bounds of each transform.</param>
+/// <param name="a_JobSystem">	  	The job system the chunks are spread over.</param>
+
+void SyncRenderableTransforms(EntityStore& a_Entities, const TransformStore& a_Transforms, uint64_t& a_SyncedSerial,
+                              SceneBvh& a_SceneBvh, JobSystem& a_JobSystem);
+
+/// <summary>
+/// 	Sets the visibility of every renderable entity from the scene hierarchy's frustum query and,
+/// 	if given, the software occlusion culler's rasterized occluders.
+/// </summary>
+/// <param name="a_Entities">		  	The entities.</param>
+/// <param name="a_SceneBvh">		  	The built scene hierarchy.</param>
+/// <param name="a_ViewProjection">   	The view projection matrix.</param>
+/// <param name="a_OcclusionCuller">  	(Nullable) The occlusion culler, with the frame's occluders rasterized.</param>
+/// <param name="a_Arena">			  	The arena the frame's temporary lists are allocated from.</param>
+/// <param name="a_JobSystem">		  	The job system the chunks are spread over.</param>
+/// <returns>	The number of visible entities. </returns>
+
+uint32_t CullRenderables(EntityStore& a_Entities, const SceneBvh& a_SceneBvh, const glm::mat4& a_ViewProjection,
+                         const SoftwareOcclusionCuller* a_OcclusionCuller, LinearArena& a_Arena,
+                         JobSystem& a_JobSystem);
+
+/// <summary>	Adds the occluder of every entity that is not hidden to the software occlusion culler. </summary>
+/// <param name="a_Entities">		 	The entities.</param>
+/// <param name="a_OcclusionCuller">	[in,out] The occlusion culler, between BeginFrame and RasterizeOccluders.</param>
+
+void AddRenderableOccluders(EntityStore& a_Entities, SoftwareOcclusionCuller& a_OcclusionCuller);
+
+/// <summary>	Adds a draw for every visible entity, sorted by material, mesh and depth. </summary>
+/// <param name="a_Entities">	The entities.</param>
+/// <param name="a_Meshes">  	The meshes the entities refer to.</param>
+/// <param name="a_Template">	The pipeline, sets and instance buffer the draws share.</param>
+/// <param name="a_View">	 	The view matrix.</param>
+/// <param name="a_FarPlane">	The distance to the far plane, depths are normalized by it.</param>
+/// <param name="a_DrawQueue">	[in,out] The queue the draws are added to.</param>
+
+void AddRenderableDraws(EntityStore& a_Entities, const ResourcePool<GpuMesh>& a_Meshes, const DrawItem& a_Template,
+                        const glm::mat4& a_View, float a_FarPlane, DrawQueue& a_DrawQueue);
+
+/// <summary>
+/// 	Adds an indirect draw for every visible entity to the main and depth prepass queues and
+/// 	writes the bounds the occlusion culling tests it with. An entity's slot in the culling
+/// 	buffers is its transform, so the visibility kept for the slot stays with the entity from
+/// 	frame to frame.
+/// </summary>
+/// <param name="a_Entities">		 	The entities.</param>
+/// <param name="a_Meshes">			 	The meshes the entities refer to.</param>
+/// <param name="a_Template">		 	The main pass draw, with the culling's main indirect buffer.</param>
+/// <param name="a_PrepassTemplate">	The depth prepass draw, with the culling's prepass indirect buffer.</param>
+/// <param name="a_View">			 	The view matrix.</param>
+/// <param name="a_FarPlane">		 	The distance to the far plane, depths are normalized by it.</param>
+/// <param name="a_Instances">		 	[out] The bounds of every slot up to the last one drawn, unused
+/// 									slots draw nothing.</param>
+/// <param name="a_DrawQueue">		 	[in,out] The queue the main pass draws are added to.</param>
+/// <param name="a_PrepassQueue">	 	[in,out] The queue the depth prepass draws are added to.</param>
+
+void AddRenderableIndirectDraws(EntityStore& a_Entities, const ResourcePool<GpuMesh>& a_Meshes,
+                                const DrawItem& a_Template, const DrawItem& a_PrepassTemplate,
+                                const glm::mat4& a_View, float a_FarPlane, FrameVector<InstanceBounds>& a_Instances,
+                                DrawQueue& a_DrawQueue, DrawQueue& a_PrepassQueue);
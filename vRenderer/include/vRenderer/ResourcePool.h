@@ -0,0 +1,355 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// 	32 bit handle to a resource of type T in a ResourcePool, the low bits index a slot and the
+/// 	high bits hold the slot's generation when the handle was issued. Trivially copyable, so it can
+/// 	be kept in hot data such as entity components in place of the resource itself.
+/// </summary>
+template<typename T>
+struct ResourceHandle
+{
+	static constexpr uint32_t s_IndexBits = 20;
+	static constexpr uint32_t s_IndexMask = (1u << s_IndexBits) - 1;
+	static constexpr uint32_t s_GenerationMask = (1u << (32 - s_IndexBits)) - 1;
+
+	// 0 is never issued, generations start at 1
+	uint32_t m_Value = 0;
+
+	static ResourceHandle Make(const uint32_t a_Index, const uint32_t a_Generation)
+	{
+		return {a_Generation << s_IndexBits | a_Index};
+	}
+
+	uint32_t GetIndex() const
+	{
+		return m_Value & s_IndexMask;
+	}
+
+	uint32_t GetGeneration() const
+	{
+		return m_Value >> s_IndexBits;
+	}
+
+	bool IsNull() const
+	{
+		return m_Value == 0;
+	}
+
+	bool operator==(const ResourceHandle& a_Other) const
+	{
+		return m_Value == a_Other.m_Value;
+	}
+
+	bool operator!=(const ResourceHandle& a_Other) const
+	{
+		return m_Value != a_Other.m_Value;
+	}
+};
+
+template<typename T>
+class UniqueResource;
+
+/// <summary>
+/// 	Owns resources of type T, packed densely in one array so they can be iterated without gaps,
+/// 	and hands out generational handles to them. Released resources are destroyed through the
+/// 	defer function, usually once the GPU has finished the submissions that may still use them,
+/// 	while their handles become stale immediately.
+/// </summary>
+/// <remarks>
+/// 	Stale handles are detected by IsValid, and by Get in debug builds only so lookups stay a pair
+/// 	of loads in release builds. A slot's generation wraps after 4095 reuses. Not thread safe.
+/// </remarks>
+template<typename T>
+class ResourcePool
+{
+public:
+	using DestroyFunction = std::function<void(T&)>;
+	using DeferFunction = std::function<void(std::function<void()>)>;
+
+	static constexpr uint32_t s_MaxResources = ResourceHandle<T>::s_IndexMask + 1;
+
+	/// <summary>	Sets how the resources are destroyed. </summary>
+	/// <param name="a_Destroy">	Destroys a resource.</param>
+	/// <param name="a_Defer">  	(Optional) Runs a destruction later, otherwise released resources are
+	/// 						destroyed immediately.</param>
+
+	void Create(DestroyFunction a_Destroy, DeferFunction a_Defer = nullptr)
+	{
+		m_Destroy = std::move(a_Destroy);
+		m_Defer = std::move(a_Defer);
+	}
+
+	/// <summary>	Takes ownership of a resource. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the pool is full.</exception>
+	/// <param name="a_Resource">	The resource.</param>
+	/// <returns>	The handle to the resource. </returns>
+
+	ResourceHandle<T> Insert(T a_Resource)
+	{
+		uint32_t t_Index;
+
+		if (!m_FreeSlots.empty())
+		{
+			t_Index = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+		else
+		{
+			if (m_Slots.size() == s_MaxResources)
+			{
+				throw std::runtime_error("Error! The Resource Pool is full!");
+			}
+
+			t_Index = static_cast<uint32_t>(m_Slots.size());
+			m_Slots.emplace_back();
+		}
+
+		Slot& t_Slot = m_Slots[t_Index];
+		t_Slot.m_Dense = static_cast<uint32_t>(m_Resources.size());
+		m_Resources.push_back(std::move(a_Resource));
+		m_DenseSlots.push_back(t_Index);
+
+		return ResourceHandle<T>::Make(t_Index, t_Slot.m_Generation);
+	}
+
+	/// <summary>	Takes ownership of a resource, which is released when the returned owner goes away. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the pool is full.</exception>
+	/// <param name="a_Resource">	The resource.</param>
+	/// <returns>	The owner of the resource. </returns>
+
+	UniqueResource<T> InsertUnique(T a_Resource);
+
+	/// <summary>	Releases a resource, destroying it through the defer function. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the handle is stale.</exception>
+	/// <param name="a_Handle">	The handle.</param>
+
+	void Release(const ResourceHandle<T> a_Handle)
+	{
+		if (!IsValid(a_Handle))
+		{
+			throw std::runtime_error("Error! Released a stale Resource Handle!");
+		}
+
+		const uint32_t t_Dense = m_Slots[a_Handle.GetIndex()].m_Dense;
+		T t_Resource = std::move(m_Resources[t_Dense]);
+
+		// the last resource fills the gap so the array stays dense
+		const uint32_t t_Last = static_cast<uint32_t>(m_Resources.size() - 1);
+		if (t_Dense != t_Last)
+		{
+			m_Resources[t_Dense] = std::move(m_Resources[t_Last]);
+			m_DenseSlots[t_Dense] = m_DenseSlots[t_Last];
+			m_Slots[m_DenseSlots[t_Dense]].m_Dense = t_Dense;
+		}
+
+		m_Resources.pop_back();
+		m_DenseSlots.pop_back();
+		FreeSlot(a_Handle.GetIndex());
+
+		if (m_Defer)
+		{
+			m_Defer([t_Destroy = m_Destroy, t_Resource = std::move(t_Resource)]() mutable
+			{
+				t_Destroy(t_Resource);
+			});
+		}
+		else
+		{
+			m_Destroy(t_Resource);
+		}
+	}
+
+	/// <summary>	Destroys all resources immediately, their handles become stale. The device has to be idle. </summary>
+	void DestroyAll()
+	{
+		for (T& t_Resource : m_Resources)
+		{
+			m_Destroy(t_Resource);
+		}
+
+		for (const uint32_t t_Index : m_DenseSlots)
+		{
+			FreeSlot(t_Index);
+		}
+
+		m_Resources.clear();
+		m_DenseSlots.clear();
+	}
+
+	bool IsValid(const ResourceHandle<T> a_Handle) const
+	{
+		return a_Handle.GetIndex() < m_Slots.size() && m_Slots[a_Handle.GetIndex()].m_Dense != s_NoResource &&
+			m_Slots[a_Handle.GetIndex()].m_Generation == a_Handle.GetGeneration();
+	}
+
+	/// <summary>	Gets a resource. </summary>
+	/// <exception cref="std::runtime_error">	Raised in debug builds when the handle is stale.</exception>
+	/// <param name="a_Handle">	The handle.</param>
+	/// <returns>	The resource, valid until the next Insert or Release. </returns>
+
+	T& Get(const ResourceHandle<T> a_Handle)
+	{
+		return m_Resources[GetDenseIndex(a_Handle)];
+	}
+
+	const T& Get(const ResourceHandle<T> a_Handle) const
+	{
+		return m_Resources[GetDenseIndex(a_Handle)];
+	}
+
+	uint32_t GetCount() const
+	{
+		return static_cast<uint32_t>(m_Resources.size());
+	}
+
+	/// <summary>	Calls a function with the handle of every resource and the resource, in memory order. </summary>
+	/// <param name="a_Function">	Called as a_Function(ResourceHandle&lt;T&gt; a_Handle, T&amp; a_Resource).</param>
+
+	template<typename Function>
+	void ForEach(Function&& a_Function)
+	{
+		for (size_t i = 0; i < m_Resources.size(); i++)
+		{
+			const uint32_t t_Index = m_DenseSlots[i];
+			a_Function(ResourceHandle<T>::Make(t_Index, m_Slots[t_Index].m_Generation), m_Resources[i]);
+		}
+	}
+
+private:
+	static constexpr uint32_t s_NoResource = UINT32_MAX;
+
+	struct Slot
+	{
+		uint32_t m_Generation = 1;
+		// index into m_Resources, s_NoResource while the slot is free
+		uint32_t m_Dense = s_NoResource;
+	};
+
+	uint32_t GetDenseIndex(const ResourceHandle<T> a_Handle) const
+	{
+#ifdef _DEBUG
+		if (!IsValid(a_Handle))
+		{
+			throw std::runtime_error("Error! Accessed a stale Resource Handle!");
+		}
+#endif
+
+		return m_Slots[a_Handle.GetIndex()].m_Dense;
+	}
+
+	// makes the slot's handles stale and lets it be reused
+	void FreeSlot(const uint32_t a_Index)
+	{
+		Slot& t_Slot = m_Slots[a_Index];
+		t_Slot.m_Dense = s_NoResource;
+
+		// 0 is reserved for null handles
+		t_Slot.m_Generation = (t_Slot.m_Generation + 1) & ResourceHandle<T>::s_GenerationMask;
+		if (t_Slot.m_Generation == 0)
+		{
+			t_Slot.m_Generation = 1;
+		}
+
+		m_FreeSlots.push_back(a_Index);
+	}
+
+	std::vector<Slot> m_Slots;
+	std::vector<uint32_t> m_FreeSlots;
+
+	// the resources without gaps, and the slot pointing to each
+	std::vector<T> m_Resources;
+	std::vector<uint32_t> m_DenseSlots;
+
+	DestroyFunction m_Destroy;
+	DeferFunction m_Defer;
+};
+
+/// <summary>
+/// 	Move-only owner of a resource in a ResourcePool, releasing it when destroyed or reassigned.
+/// 	The pool has to outlive its owners.
+/// </summary>
+template<typename T>
+class UniqueResource
+{
+public:
+	UniqueResource() = default;
+
+	UniqueResource(ResourcePool<T>* a_Pool, const ResourceHandle<T> a_Handle) : m_Pool(a_Pool), m_Handle(a_Handle)
+	{
+	}
+
+	~UniqueResource()
+	{
+		Reset();
+	}
+
+	UniqueResource(const UniqueResource&) = delete;
+	UniqueResource& operator=(const UniqueResource&) = delete;
+
+	UniqueResource(UniqueResource&& a_Other) noexcept : m_Pool(a_Other.m_Pool), m_Handle(a_Other.m_Handle)
+	{
+		a_Other.m_Pool = nullptr;
+		a_Other.m_Handle = {};
+	}
+
+	UniqueResource& operator=(UniqueResource&& a_Other) noexcept
+	{
+		if (this != &a_Other)
+		{
+			Reset();
+			m_Pool = a_Other.m_Pool;
+			m_Handle = a_Other.m_Handle;
+			a_Other.m_Pool = nullptr;
+			a_Other.m_Handle = {};
+		}
+
+		return *this;
+	}
+
+	/// <summary>	Releases the resource, if any. </summary>
+	void Reset()
+	{
+		if (m_Pool && !m_Handle.IsNull())
+		{
+			m_Pool->Release(m_Handle);
+		}
+
+		m_Pool = nullptr;
+		m_Handle = {};
+	}
+
+	ResourceHandle<T> GetHandle() const
+	{
+		return m_Handle;
+	}
+
+	T& operator*() const
+	{
+		return m_Pool->Get(m_Handle);
+	}
+
+	T* operator->() const
+	{
+		return &m_Pool->Get(m_Handle);
+	}
+
+	explicit operator bool() const
+	{
+		return m_Pool && !m_Handle.IsNull();
+	}
+
+private:
+	ResourcePool<T>* m_Pool = nullptr;
+	ResourceHandle<T> m_Handle;
+};
+
+template<typename T>
+UniqueResource<T> ResourcePool<T>::InsertUnique(T a_Resource)
+{
+	return UniqueResource<T>(this, Insert(std::move(a_Resource)));
+}
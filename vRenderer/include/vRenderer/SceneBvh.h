@@ -0,0 +1,251 @@
+#pragma once
+#include <atomic>
+#include <cfloat>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include "FrameArena.h"
+#include "helper_structs/BoundingBox.h"
+
+class JobSystem;
+class JobCounter;
+
+struct BvhRay
+{
+	glm::vec3 m_Origin = glm::vec3(0.0f);
+	glm::vec3 m_Direction = glm::vec3(0.0f, 0.0f, -1.0f);
+	float m_MaxDistance = FLT_MAX;
+};
+
+struct BvhRayHit
+{
+	// UINT32_MAX if nothing was hit
+	uint32_t m_Object = UINT32_MAX;
+
+	// in multiples of the ray's direction
+	float m_Distance = FLT_MAX;
+};
+
+/// <summary>
+/// 	Called for the objects whose bounding box a ray hits, closer than the closest hit so far.
+/// 	Receives the index of the ray in its packet, the object and the distance to the box, which
+/// 	may be replaced by the exact distance. Returns whether the object was actually hit.
+/// </summary>
+using BvhRayIntersector = std::function<bool(uint32_t a_Ray, uint32_t a_Object, float& a_Distance)>;
+
+/// <summary>
+/// 	Bounding volume hierarchy over the world space bounding boxes of the scene's objects, for
+/// 	frustum culling, range queries and picking on the CPU in logarithmic instead of linear time.
+/// 	Every node holds the boxes of up to four children as one array per component, so a node is
+/// 	tested with a handful of SSE instructions.
+/// </summary>
+/// <remarks>
+/// 	The tree is built with the binned surface area heuristic, splitting large ranges in parallel
+/// 	jobs. Moving objects only refit the boxes on their path to the root, which keeps the tree
+/// 	valid but slowly degrades it, so it should be rebuilt from time to time when objects travel
+/// 	far. Queries are safe to run from multiple threads while the tree is not changed.
+/// </remarks>
+class SceneBvh
+{
+public:
+	static constexpr uint32_t s_NoObject = UINT32_MAX;
+	static constexpr uint32_t s_MaxPacketSize = 32;
+
+	SceneBvh();
+	~SceneBvh();
+
+	/// <summary>	Adds an object. It is only found by queries after the next Build. </summary>
+	/// <param name="a_Bounds">	The world space bounding box.</param>
+	/// <returns>	The index of the object. </returns>
+
+	uint32_t Insert(const BoundingBox& a_Bounds);
+
+	/// <summary>	Moves an object. The tree follows on the next Refit or Build. </summary>
+	/// <param name="a_Object">	Index of the object.</param>
+	/// <param name="a_Bounds">	The new world space bounding box.</param>
+
+	void SetBounds(uint32_t a_Object, const BoundingBox& a_Bounds);
+
+	const BoundingBox& GetBounds(uint32_t a_Object) const;
+
+	/// <summary>	Removes all objects and the tree. </summary>
+	void Clear();
+
+	uint32_t GetObjectCount() const;
+	uint32_t GetNodeCount() const;
+
+	/// <summary>	Checks whether objects were added since the last Build. </summary>
+	/// <returns>	True if the tree has to be built before it contains all objects. </returns>
+
+	bool NeedsBuild() const;
+
+	/// <summary>	Builds the tree over all objects. </summary>
+	/// <param name="a_JobSystem">	The job system large ranges are split on.</param>
+
+	void Build(JobSystem& a_JobSystem);
+
+	/// <summary>	Updates the boxes of the nodes above the objects moved since the last Build or Refit. </summary>
+	void Refit();
+
+	/// <summary>	Finds the objects whose boxes intersect the view frustum. </summary>
+	/// <param name="a_ViewProjection">	The view projection matrix.</param>
+	/// <param name="a_Objects">	   	[in,out] The objects, appended in no particular order.</param>
+
+	void QueryFrustum(const glm::mat4& a_ViewProjection, FrameVector<uint32_t>& a_Objects) const;
+
+	/// <summary>	Finds the objects whose boxes intersect a sphere. </summary>
+	/// <param name="a_Center">		The center of the sphere.</param>
+	/// <param name="a_Radius">		The radius of the sphere.</param>
+	/// <param name="a_Objects">	[in,out] The objects, appended in no particular order.</param>
+
+	void QuerySphere(const glm::vec3& a_Center, float a_Radius, FrameVector<uint32_t>& a_Objects) const;
+
+	/// <summary>	Finds the closest object hit by a ray, visiting nearer nodes first. </summary>
+	/// <param name="a_Ray">	  	The ray.</param>
+	/// <param name="a_Hit">	  	[out] The closest hit.</param>
+	/// <param name="a_Intersect">	(Optional) Tests objects exactly, otherwise their boxes count as hits.</param>
+	/// <returns>	True if an object was hit. </returns>
+
+	bool Raycast(const BvhRay& a_Ray, BvhRayHit& a_Hit, const BvhRayIntersector& a_Intersect = nullptr) const;
+
+	/// <summary>
+	/// 	Finds the closest objects hit by a packet of rays that traverse the tree together, which
+	/// 	loads every node once for all rays. Best for coherent rays, e.g. picking a region of the
+	/// 	screen or shooting rays from the same point.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when there are more than s_MaxPacketSize rays.</exception>
+	/// <param name="a_Rays">	  	The rays.</param>
+	/// <param name="a_RayCount"> 	Number of rays.</param>
+	/// <param name="a_Hits">	  	[out] The closest hit of each ray.</param>
+	/// <param name="a_Intersect">	(Optional) Tests objects exactly, otherwise their boxes count as hits.</param>
+
+	void RaycastPacket(const BvhRay* a_Rays, uint32_t a_RayCount, BvhRayHit* a_Hits,
+	                   const BvhRayIntersector& a_Intersect = nullptr) const;
+
+private:
+	// children with this bit set are objects, the others nodes
+	static constexpr uint32_t s_LeafBit = 0x80000000u;
+	static constexpr uint32_t s_EmptyChild = UINT32_MAX;
+
+	static constexpr uint32_t s_BinCount = 16;
+
+	// smaller ranges are split at the median, binning them costs more than it gains
+	static constexpr uint32_t s_MinBinnedCount = 16;
+
+	// ranges larger than this are binned, partitioned and built in parallel
+	static constexpr uint32_t s_ParallelThreshold = 32768;
+
+	// deeper nodes are split at the median, which bounds the depth of the tree
+	static constexpr uint32_t s_MaxSahDepth = 48;
+	static constexpr uint32_t s_MaxStackSize = 256;
+
+	struct alignas(64) Node
+	{
+		// boxes of the four children, one array per component
+		float m_MinX[4];
+		float m_MinY[4];
+		float m_MinZ[4];
+		float m_MaxX[4];
+		float m_MaxY[4];
+		float m_MaxZ[4];
+
+		// child nodes, or objects with s_LeafBit set. Used children come first
+		uint32_t m_Children[4];
+		uint32_t m_ChildCount;
+
+		// node * 4 + slot of the child pointing here, unused by the root
+		uint32_t m_Parent;
+	};
+
+	// an object during the build, the references are partitioned in place so every pass over a
+	// range reads memory sequentially
+	struct BuildReference
+	{
+		BoundingBox m_Bounds;
+		uint32_t m_Object;
+
+		glm::vec3 GetCentroid() const
+		{
+			return m_Bounds.GetCenter();
+		}
+	};
+
+	// references m_BuildReferences[m_Begin, m_End) during the build
+	struct BuildRange
+	{
+		uint32_t m_Begin = 0;
+		uint32_t m_End = 0;
+		BoundingBox m_Bounds;
+		BoundingBox m_CentroidBounds;
+
+		uint32_t GetCount() const
+		{
+			return m_End - m_Begin;
+		}
+	};
+
+	struct Bin
+	{
+		BoundingBox m_Bounds;
+		BoundingBox m_CentroidBounds;
+		uint32_t m_Count = 0;
+	};
+
+	struct BinGrid
+	{
+		Bin m_Bins[s_BinCount];
+	};
+
+	// maps centroids to bins, evenly spaced along the longest axis of a range's centroid bounds
+	struct BinMapping
+	{
+		int m_Axis;
+		float m_Min;
+		float m_Scale;
+
+		uint32_t GetBin(const glm::vec3& a_Centroid) const
+		{
+			const uint32_t t_Bin = static_cast<uint32_t>((a_Centroid[m_Axis] - m_Min) * m_Scale);
+			return t_Bin < s_BinCount ? t_Bin : s_BinCount - 1;
+		}
+	};
+
+	BuildRange ComputeRange(uint32_t a_Begin, uint32_t a_End, JobSystem& a_JobSystem) const;
+	void GrowRange(uint32_t a_Begin, uint32_t a_End, BuildRange& a_Range) const;
+	void BinObjects(uint32_t a_Begin, uint32_t a_End, const BinMapping& a_Mapping, BinGrid& a_Bins) const;
+	void BuildNode(uint32_t a_Node, const BuildRange& a_Range, uint32_t a_Depth, JobSystem& a_JobSystem,
+	               JobCounter& a_Counter);
+	void SplitRange(const BuildRange& a_Range, uint32_t a_Depth, JobSystem& a_JobSystem, BuildRange& a_Left,
+	                BuildRange& a_Right);
+	void SplitMedian(const BuildRange& a_Range, JobSystem& a_JobSystem, BuildRange& a_Left, BuildRange& a_Right);
+
+	void SetSlot(uint32_t a_Node, uint32_t a_Slot, const BoundingBox& a_Bounds);
+	BoundingBox GetSlot(uint32_t a_Node, uint32_t a_Slot) const;
+	BoundingBox GetNodeBounds(uint32_t a_Node) const;
+
+	// appends all objects below a node
+	void CollectObjects(uint32_t a_Node, FrameVector<uint32_t>& a_Objects) const;
+
+	std::vector<BoundingBox> m_Bounds;
+
+	// node * 4 + slot holding each object
+	std::vector<uint32_t> m_ObjectSlots;
+
+	// objects moved since the last refit, flagged to add each only once
+	std::vector<uint32_t> m_MovedObjects;
+	std::vector<uint8_t> m_Moved;
+
+	// allocated for the largest possible tree but only touched up to m_NodeCount
+	std::unique_ptr<Node[]> m_Nodes;
+	uint32_t m_NodeCapacity = 0;
+	std::atomic<uint32_t> m_NodeCount{0};
+	uint32_t m_BuiltObjectCount = 0;
+
+	// kept to avoid allocating on every build
+	std::vector<BuildReference> m_BuildReferences;
+	std::vector<BuildReference> m_BuildScratch;
+};
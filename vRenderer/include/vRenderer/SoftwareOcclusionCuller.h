@@ -0,0 +1,157 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include "helper_structs/Mesh.h"
+
+class JobSystem;
+
+/// <summary>
+/// 	Occlusion culling on the CPU in the style of masked occlusion culling. Occluder meshes are
+/// 	rasterized into a low resolution depth buffer split into 32x8 pixel tiles, occludees are
+/// 	tested against it by their bounding boxes before their draws are recorded.
+/// </summary>
+/// <remarks>
+/// 	Triangles are transformed, set up and binned to the tiles they overlap in parallel jobs, then
+/// 	each tile is rasterized by a single job, so no two threads write the same pixels. The inner
+/// 	loops process 8 pixels at once with AVX2 if the CPU supports it and fall back to scalar code
+/// 	otherwise. Each tile also keeps its farthest depth, which lets most occludee tests finish
+/// 	without looking at individual pixels.
+/// </remarks>
+class SoftwareOcclusionCuller
+{
+public:
+	SoftwareOcclusionCuller();
+	~SoftwareOcclusionCuller();
+
+	/// <summary>	Sets the resolution of the depth buffer, rounded up to whole tiles. </summary>
+	/// <param name="a_Width"> 	The width in pixels.</param>
+	/// <param name="a_Height">	The height in pixels.</param>
+
+	void Resize(uint32_t a_Width, uint32_t a_Height);
+
+	/// <summary>	Clears the depth buffer and the occluders of the previous frame. </summary>
+	/// <param name="a_ViewProjection">	The view projection matrix the frame is rendered with.</param>
+
+	void BeginFrame(const glm::mat4& a_ViewProjection);
+
+	/// <summary>
+	/// 	Adds an occluder. Back faces are culled like in the main pipeline (counter clockwise
+	/// 	front faces). The mesh is only referenced and has to stay alive until the occluders are
+	/// 	rasterized.
+	/// </summary>
+	/// <param name="a_Mesh"> 	The occluder mesh, ideally a simplified version of the rendered mesh
+	/// 						that does not extend past it.</param>
+	/// <param name="a_Model">	The model matrix.</param>
+
+	void AddOccluder(const Mesh& a_Mesh, const glm::mat4& a_Model);
+
+	/// <summary>	Rasterizes all occluders added since BeginFrame. </summary>
+	/// <param name="a_JobSystem">	The job system the setup and the tiles are spread over.</param>
+
+	void RasterizeOccluders(JobSystem& a_JobSystem);
+
+	/// <summary>
+	/// 	Tests whether any part of a bounding box may be visible. Boxes crossing the near plane
+	/// 	always count as visible, boxes outside the screen never do. Safe to call from multiple
+	/// 	threads once the occluders are rasterized.
+	/// </summary>
+	/// <param name="a_BoundsMin">	The minimum corner of the box in object space.</param>
+	/// <param name="a_BoundsMax">	The maximum corner of the box in object space.</param>
+	/// <param name="a_Model">	  	The model matrix.</param>
+	/// <returns>	False if the box is completely hidden behind the occluders. </returns>
+
+	bool IsVisible(const glm::vec3& a_BoundsMin, const glm::vec3& a_BoundsMax, const glm::mat4& a_Model) const;
+
+	/// <summary>
+	/// 	Writes the depth buffer to a binary PGM image for debugging. Covered pixels are scaled
+	/// 	from dark gray (farthest) to white (nearest), uncovered pixels are black.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when the file could not be written.</exception>
+	/// <param name="a_FilePath">	The path of the image.</param>
+
+	void WriteDepthImage(const std::string& a_FilePath) const;
+
+	/// <summary>	Checks whether the AVX2 code paths are used. </summary>
+	/// <returns>	True if the CPU and the operating system support AVX2. </returns>
+
+	static bool SupportsAVX2();
+
+	uint32_t GetWidth() const;
+	uint32_t GetHeight() const;
+
+	static constexpr uint32_t s_TileWidth = 32;
+	static constexpr uint32_t s_TileHeight = 8;
+	static constexpr uint32_t s_TileSize = s_TileWidth * s_TileHeight;
+
+private:
+	struct Occluder
+	{
+		const Mesh* m_Mesh;
+		glm::mat4 m_ModelViewProjection;
+	};
+
+	// a triangle in screen space, set up for rasterization
+	struct ScreenTriangle
+	{
+		// edge functions A * x + B * y + C, positive inside
+		float m_EdgeA[3];
+		float m_EdgeB[3];
+		float m_EdgeC[3];
+
+		// depth plane Z + DzDx * x + DzDy * y
+		float m_Z;
+		float m_DzDx;
+		float m_DzDy;
+
+		// bounding box in pixels, inclusive and clamped to the screen
+		int32_t m_MinX;
+		int32_t m_MinY;
+		int32_t m_MaxX;
+		int32_t m_MaxY;
+	};
+
+	// triangles set up by one thread and the tiles they were binned to
+	struct Bin
+	{
+		std::vector<ScreenTriangle> m_Triangles;
+
+		// per tile, indices into m_Triangles
+		std::vector<std::vector<uint32_t>> m_TileTriangles;
+	};
+
+	void SetupTriangles(Bin& a_Bin, size_t a_FirstTriangle, size_t a_EndTriangle) const;
+
+	void RasterizeTile(uint32_t a_Tile);
+
+	void RasterizeTriangleScalar(const ScreenTriangle& a_Triangle, uint32_t a_TileX, uint32_t a_TileY, float* a_Depth) const;
+	void RasterizeTriangleAVX2(const ScreenTriangle& a_Triangle, uint32_t a_TileX, uint32_t a_TileY, float* a_Depth) const;
+
+	bool IsRectVisibleScalar(const float* a_Depth, uint32_t a_TileX, uint32_t a_TileY, int32_t a_MinX, int32_t a_MinY,
+	                         int32_t a_MaxX, int32_t a_MaxY, float a_NearestDepth) const;
+	bool IsRectVisibleAVX2(const float* a_Depth, uint32_t a_TileX, uint32_t a_TileY, int32_t a_MinX, int32_t a_MinY,
+	                       int32_t a_MaxX, int32_t a_MaxY, float a_NearestDepth) const;
+
+	uint32_t m_Width = 0;
+	uint32_t m_Height = 0;
+	uint32_t m_TilesX = 0;
+	uint32_t m_TilesY = 0;
+
+	// depth per pixel, stored tile by tile with s_TileSize pixels each
+	std::vector<float> m_Depth;
+
+	// farthest depth per tile
+	std::vector<float> m_TileMaxDepth;
+
+	glm::mat4 m_ViewProjection = glm::mat4(1.0f);
+
+	std::vector<Occluder> m_Occluders;
+
+	// one bin per setup thread, kept to avoid allocating every frame
+	std::vector<Bin> m_Bins;
+	size_t m_ActiveBinCount = 0;
+
+	bool m_UseAVX2 = false;
+};
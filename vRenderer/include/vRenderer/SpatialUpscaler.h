@@ -0,0 +1,112 @@
+#pragma once
+#include <glm/vec2.hpp>
+#include <vulkan/vulkan_core.h>
+
+#include "ComputePipeline.h"
+#include "Image.h"
+#include "helper_structs/RenderSettings.h"
+
+class DescriptorAllocator;
+class Device;
+
+/// <summary>
+/// 	Spatial upscaling in the style of FSR1. An edge adaptive upsampling pass (EASU) scales the
+/// 	rendered part of the offscreen target to output resolution, followed by a contrast adaptive
+/// 	sharpening pass (RCAS). Both run as compute shaders, the result is copied into the swap
+/// 	chain image. The passes are scheduled by the renderer's post-processing render graph.
+/// </summary>
+class SpatialUpscaler
+{
+public:
+	SpatialUpscaler();
+	~SpatialUpscaler();
+
+	/// <summary>	Creates the EASU and RCAS pipelines and the sampler. </summary>
+	/// <param name="a_Device">	The device.</param>
+
+	void Create(const Device& a_Device);
+
+	/// <summary>	Destroys all resources including the targets. </summary>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+
+	void Destroy(const VkDevice& a_LogicalDevice);
+
+	/// <summary>	Creates the intermediate and output targets and keeps the input image to read from. </summary>
+	/// <param name="a_Device">		 	The device.</param>
+	/// <param name="a_Input">		 	The image the main pass renders into, must be sampled in the shader read only layout.</param>
+	/// <param name="a_OutputExtent">	The output extent, usually the swap chain extent.</param>
+
+	void CreateTargets(const Device& a_Device, const Image& a_Input, VkExtent2D a_OutputExtent);
+
+	void DestroyTargets(const VkDevice& a_LogicalDevice);
+
+	/// <summary>
+	/// 	Records the upscaling pass from the input into the upscaled target. The barriers around it
+	/// 	are recorded by the render graph.
+	/// </summary>
+	/// <param name="a_LogicalDevice">		The logical device.</param>
+	/// <param name="a_DescriptorAllocator">	The allocator the frame's EASU set is allocated from.</param>
+	/// <param name="a_CommandBuffer">  	The command buffer, outside of a render pass.</param>
+	/// <param name="a_InputExtent">	 	The rendered part of the input image, starting at the top left.</param>
+
+	void Upscale(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator,
+	             VkCommandBuffer a_CommandBuffer, VkExtent2D a_InputExtent) const;
+
+	/// <summary>	Records the sharpening pass from the upscaled target, read in the general layout, into the output. </summary>
+	/// <param name="a_LogicalDevice">		The logical device.</param>
+	/// <param name="a_DescriptorAllocator">	The allocator the frame's RCAS set is allocated from.</param>
+	/// <param name="a_CommandBuffer">  	The command buffer, outside of a render pass.</param>
+	/// <param name="a_Sharpness">		 	The sharpening strength in stops, 0.0 is the strongest.</param>
+
+	void Sharpen(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator,
+	             VkCommandBuffer a_CommandBuffer, float a_Sharpness) const;
+
+	/// <summary>
+	/// 	Copies the output into a swap chain image. The output has to be in the transfer source and the
+	/// 	swap chain image in the transfer destination layout.
+	/// </summary>
+	/// <param name="a_CommandBuffer"> 	The command buffer, outside of a render pass.</param>
+	/// <param name="a_SwapChainImage">	The swap chain image to present.</param>
+
+	void CopyToSwapChain(VkCommandBuffer a_CommandBuffer, VkImage a_SwapChainImage) const;
+
+	const Image& GetUpscaled() const;
+	const Image& GetOutput() const;
+
+	/// <summary>	Gets the render scale per axis of an upscaling preset. </summary>
+	/// <param name="a_Preset">	The preset.</param>
+	/// <returns>	The render scale, e.g. 1 / 1.5 for UpscalingPreset::Quality. </returns>
+
+	static float GetRenderScale(UpscalingPreset a_Preset);
+
+	static constexpr VkFormat s_Format = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+private:
+	struct EasuParameters
+	{
+		glm::vec2 m_InputExtent;
+		glm::vec2 m_OutputExtent;
+	};
+
+	struct RcasParameters
+	{
+		glm::vec2 m_OutputExtent;
+		float m_Sharpness;
+	};
+
+	ComputePipeline m_EasuPipeline;
+	ComputePipeline m_RcasPipeline;
+
+	VkSampler m_Sampler = VK_NULL_HANDLE;
+
+	// the image the main pass renders into, owned by the renderer
+	VkImageView m_InputView = VK_NULL_HANDLE;
+
+	// EASU output, read by RCAS
+	Image m_Upscaled;
+
+	// RCAS output, copied into the swap chain
+	Image m_Output;
+
+	VkExtent2D m_OutputExtent = {};
+};
@@ -3,6 +3,7 @@
 #include <vector>
 #include <GLFW/glfw3.h>
 
+#include "Image.h"
 #include "helper_structs/RenderingHelpers.h"
 
 
@@ -18,6 +19,20 @@ public:
 	/// <param name="a_Window">		  	[in,out] If non-null, the window.</param>
 
 	void Create(const Device& a_Device, const VkSurfaceKHR& a_WindowSurface, GLFWwindow* a_Window);
+
+	/// <summary>
+	/// 	Creates offscreen images in place of a swap chain for headless rendering. They are exposed
+	/// 	through the same getters, including their image views, so CreateImageViews must not be
+	/// 	called afterwards. The images can be copied from to read the rendered frames back.
+	/// </summary>
+	/// <param name="a_Device">	   	The device.</param>
+	/// <param name="a_Extent">	   	The extent of the images.</param>
+	/// <param name="a_ImageCount">	Number of images, usually the number of frames in flight.</param>
+	/// <param name="a_Format">	   	(Optional) The format of the images.</param>
+
+	void CreateHeadless(const Device& a_Device, VkExtent2D a_Extent, uint32_t a_ImageCount,
+	                    VkFormat a_Format = VK_FORMAT_R8G8B8A8_SRGB);
+
 	void Cleanup(VkDevice a_LogicalDevice, std::vector<VkFramebuffer>& a_FramebufferVector);
 
 	VkSwapchainKHR GetSwapChain();
@@ -25,6 +40,7 @@ public:
 	void CreateImageViews(const VkDevice& a_LogicalDevice);
 	void DestroyImageViews(VkDevice a_LogicalDevice);
 	std::vector<VkImageView>& GetImageViews();
+	const std::vector<VkImage>& GetImages() const;
 
 	/// <summary>
 	/// 	Retrieves information about the Surface Formats, Present Modes and Surface Capabilities
@@ -41,6 +57,16 @@ public:
 
 	VkFormat GetFormat();
 
+	/// <summary>	Gets the usage the images were created with. </summary>
+	/// <returns>	The image usage, transfer usage depends on what the surface supports. </returns>
+
+	VkImageUsageFlags GetUsage() const;
+
+	/// <summary>	Checks whether the images are offscreen images created by CreateHeadless. </summary>
+	/// <returns>	True if there is no surface to present to, false if not. </returns>
+
+	bool IsHeadless() const;
+
 private:
 
 	VkSurfaceFormatKHR PickSwapChainSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& a_AvailableFormats) const;
@@ -49,10 +75,14 @@ private:
 
 	VkExtent2D PickSwapExtent(const VkSurfaceCapabilitiesKHR& a_SurfaceCapabilities, GLFWwindow* a_Window) const;
 
-	VkSwapchainKHR m_SwapChain;
+	VkSwapchainKHR m_SwapChain = VK_NULL_HANDLE;
 	std::vector<VkImage> m_Images;
+
+	// owns the images and views when rendering headless
+	std::vector<Image> m_HeadlessImages;
 	std::vector<VkImageView> m_ImageViews;
 	VkFormat m_Format;
 	VkExtent2D m_Extent;
+	VkImageUsageFlags m_Usage = 0;
 };
 
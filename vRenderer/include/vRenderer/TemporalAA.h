@@ -0,0 +1,124 @@
+#pragma once
+#include <array>
+#include <glm/vec2.hpp>
+#include <vulkan/vulkan_core.h>
+
+#include "ComputePipeline.h"
+#include "Image.h"
+
+class DescriptorAllocator;
+class Device;
+
+/// <summary>
+/// 	Temporal anti-aliasing. The scene is rendered at one sample per pixel with a sub-pixel
+/// 	jittered projection into an offscreen color target together with a velocity buffer. A
+/// 	compute pass then reprojects the accumulated history using the velocity, clamps it to the
+/// 	neighborhood of the current pixel and blends it with the current frame.
+/// </summary>
+class TemporalAA
+{
+public:
+	TemporalAA();
+	~TemporalAA();
+
+	/// <summary>
+	/// 	Creates the resolve pipeline and the sampler. Targets are created separately through
+	/// 	CreateTargets.
+	/// </summary>
+	/// <param name="a_Device">	The device.</param>
+
+	void Create(const Device& a_Device);
+
+	/// <summary>	Destroys all resources including the targets. </summary>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+
+	void Destroy(const VkDevice& a_LogicalDevice);
+
+	/// <summary>	Creates the scene color, velocity and history targets. The history is reset. </summary>
+	/// <param name="a_Device">	The device.</param>
+	/// <param name="a_Extent">	The render extent.</param>
+
+	void CreateTargets(const Device& a_Device, VkExtent2D a_Extent);
+
+	/// <summary>	Destroys the scene color, velocity and history targets. </summary>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+
+	void DestroyTargets(const VkDevice& a_LogicalDevice);
+
+	/// <summary>
+	/// 	Gets the sub-pixel jitter for the current frame, in normalized device coordinates.
+	/// </summary>
+	/// <returns>	The jitter offset to add to the projection. </returns>
+
+	glm::vec2 GetJitter() const;
+
+	/// <summary>
+	/// 	Records the resolve pass, reading the previous history in the shader read only layout and
+	/// 	writing the current one in the general layout. The barriers around it are recorded by the
+	/// 	render graph.
+	/// </summary>
+	/// <param name="a_LogicalDevice">		The logical device.</param>
+	/// <param name="a_DescriptorAllocator">	The allocator the frame's resolve set is allocated from.</param>
+	/// <param name="a_CommandBuffer"> 		The command buffer, outside of a render pass.</param>
+
+	void Resolve(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator,
+	             VkCommandBuffer a_CommandBuffer) const;
+
+	/// <summary>
+	/// 	Copies the current history into a swap chain image. The history has to be in the transfer
+	/// 	source and the swap chain image in the transfer destination layout.
+	/// </summary>
+	/// <param name="a_CommandBuffer">  	The command buffer, outside of a render pass.</param>
+	/// <param name="a_SwapChainImage">	The swap chain image to present.</param>
+	/// <param name="a_SwapChainExtent">	Extent of the swap chain image.</param>
+
+	void CopyToSwapChain(VkCommandBuffer a_CommandBuffer, VkImage a_SwapChainImage, VkExtent2D a_SwapChainExtent) const;
+
+	/// <summary>	Advances the jitter sequence and swaps the histories, after the frame's resolve was recorded. </summary>
+	void AdvanceFrame();
+
+	/// <summary>	Discards the accumulated history, e.g. after a camera cut. </summary>
+	void ResetHistory();
+
+	const Image& GetSceneColor() const;
+	const Image& GetVelocity() const;
+
+	/// <summary>	Gets the history written this frame. </summary>
+	const Image& GetHistory() const;
+
+	/// <summary>	Gets the history written last frame, read by this frame's resolve. </summary>
+	const Image& GetPreviousHistory() const;
+
+	/// <summary>	Checks whether the previous history holds a resolved frame. </summary>
+	bool IsHistoryValid() const;
+
+	static constexpr VkFormat s_ColorFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+	static constexpr VkFormat s_VelocityFormat = VK_FORMAT_R16G16_SFLOAT;
+
+private:
+	struct ResolveParameters
+	{
+		glm::vec2 m_TexelSize;
+		float m_BlendFactor;
+		float m_ResetHistory;
+	};
+
+	ComputePipeline m_ResolvePipeline;
+
+	VkSampler m_Sampler = VK_NULL_HANDLE;
+
+	Image m_SceneColor;
+	Image m_Velocity;
+	std::array<Image, 2> m_History;
+
+	VkExtent2D m_Extent = {};
+
+	uint32_t m_FrameIndex = 0;
+	bool m_HistoryValid = false;
+
+	// weight of the current frame when blending with the history
+	float m_BlendFactor = 0.1f;
+
+	// length of the jitter sequence before it repeats
+	const uint32_t m_JitterSequenceLength = 8;
+};
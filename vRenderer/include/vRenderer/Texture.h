@@ -1,8 +1,23 @@
 #pragma once
 #define STB_IMAGE_IMPLEMENTATION
+#include <memory>
+
 #include "Image.h"
 #include "Buffer/Buffer.h"
 
+/// <summary>	8 bit RGBA pixels decoded from an image file, not yet uploaded to the device. </summary>
+struct DecodedImage
+{
+	struct PixelDeleter
+	{
+		void operator()(uint8_t* a_Pixels) const;
+	};
+
+	std::unique_ptr<uint8_t, PixelDeleter> m_Pixels;
+	int m_Width = 0;
+	int m_Height = 0;
+};
+
 // todo remove parenting to buffer
 class Texture : private Buffer
 {
@@ -23,6 +38,25 @@ public:
 
 	void CreateTextureFromImage(const char* a_FilePath, const Device& a_Device, VkCommandPool& a_CommandPool, const VkQueue& a_GraphicsQueue);
 
+	/// <summary>
+	/// 	Decodes an image file without touching the device, so it can run on any thread while the
+	/// 	device is used elsewhere.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when the file could not be decoded.</exception>
+	/// <param name="a_FilePath">	Full pathname of the file.</param>
+	/// <returns>	The decoded pixels. </returns>
+
+	static DecodedImage DecodeImage(const char* a_FilePath);
+
+	/// <summary>	Uploads decoded pixels into an Image object and generates its mip maps. </summary>
+	/// <param name="a_DecodedImage"> 	The decoded pixels.</param>
+	/// <param name="a_Device">		  	The device.</param>
+	/// <param name="a_CommandPool">  	[in,out] The command pool.</param>
+	/// <param name="a_GraphicsQueue">	Graphics Queue.</param>
+
+	void CreateTextureFromDecodedImage(const DecodedImage& a_DecodedImage, const Device& a_Device,
+	                                   VkCommandPool& a_CommandPool, const VkQueue& a_GraphicsQueue);
+
 	/// <summary>	Creates a sampler to be used in texture sampling. </summary>
 	/// <param name="a_Device">	[in,out] The device.</param>
 
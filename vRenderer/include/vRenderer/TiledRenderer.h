@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "BatchRenderer.h"
+#include "PngWriter.h"
+
+class Camera;
+class VRenderer;
+
+/// <summary>
+/// 	Renders a single image larger than the device can render at once, e.g. prints far above
+/// 	maxImageDimension2D. The view is split into tiles the size of the headless renderer's
+/// 	targets, each rendered with an off-center projection of the camera, and the tiles are
+/// 	streamed to the output file as soon as they are read back.
+/// </summary>
+/// <remarks>
+/// 	Raw output writes every tile straight to its place in the file, so memory stays at one tile
+/// 	regardless of the output size. PNG rows have to be complete, so one row of tiles is held,
+/// 	which grows with the output width only.
+/// </remarks>
+class TiledRenderer
+{
+public:
+	TiledRenderer();
+	~TiledRenderer();
+
+	/// <summary>	Renders the shot into an image of the given size. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the renderer is not headless or the file could not be written.</exception>
+	/// <param name="a_Renderer">	The renderer, initialized with InitHeadless at the tile size.</param>
+	/// <param name="a_Camera">  	The camera, its pose is set from the shot and restored to the whole view afterwards.</param>
+	/// <param name="a_Shot">	 	The camera pose and model transform.</param>
+	/// <param name="a_Width">   	Width of the output image.</param>
+	/// <param name="a_Height">  	Height of the output image.</param>
+	/// <param name="a_FilePath">	The path of the output image.</param>
+	/// <param name="a_Format">  	(Optional) The format of the output image.</param>
+
+	void Render(VRenderer& a_Renderer, Camera& a_Camera, const BatchShot& a_Shot, uint32_t a_Width, uint32_t a_Height,
+	            const std::string& a_FilePath, BatchImageFormat a_Format = BatchImageFormat::Png);
+
+private:
+	// copies the read back tile into the strip or the file, writing the strip once its last tile arrived
+	void StoreTile(uint32_t a_TileX, uint32_t a_TileY);
+
+	BatchImageFormat m_Format = BatchImageFormat::Png;
+	uint32_t m_Width = 0;
+	uint32_t m_Height = 0;
+	uint32_t m_TileWidth = 0;
+	uint32_t m_TileHeight = 0;
+	uint32_t m_TilesX = 0;
+
+	std::vector<uint8_t> m_Tile;
+	std::vector<uint8_t> m_Strip;
+	PngWriter m_PngWriter;
+	std::ofstream m_RawFile;
+};
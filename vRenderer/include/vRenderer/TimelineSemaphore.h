@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+/// <summary>
+/// 	Timeline semaphore tracking the progress of a queue. Every submission through Submit signals
+/// 	the next value of a monotonically increasing counter, so the completion of any earlier
+/// 	submission can be checked or waited for by comparing against a single value.
+/// </summary>
+class TimelineSemaphore
+{
+public:
+	TimelineSemaphore();
+	~TimelineSemaphore();
+
+	TimelineSemaphore(const TimelineSemaphore&) = delete;
+	TimelineSemaphore& operator=(const TimelineSemaphore&) = delete;
+
+	/// <summary>	Creates the semaphore. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the semaphore could not be created.</exception>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+
+	void Create(const VkDevice& a_LogicalDevice);
+
+	void Destroy(const VkDevice& a_LogicalDevice);
+
+	/// <summary>
+	/// 	Submits work to a queue and additionally signals the next timeline value. Wait and signal
+	/// 	semaphores already in the submit info may be other timelines if their values are provided.
+	/// </summary>
+	/// <exception cref="std::runtime_error">
+	/// 	Raised when the submission fails or signals more than s_MaxSignalSemaphores semaphores.
+	/// </exception>
+	/// <param name="a_Queue">		 	The queue this timeline tracks.</param>
+	/// <param name="a_SubmitInfo">	 	The submission.</param>
+	/// <param name="a_WaitValues">	 	(Optional) One value per wait semaphore, ignored for binary
+	/// 								semaphores. Required if any of them is a timeline.</param>
+	/// <param name="a_SignalValues">	(Optional) One value per signal semaphore, ignored for binary
+	/// 								semaphores. Required if any of them is a timeline.</param>
+	/// <returns>	The value signaled once the submitted work has completed. </returns>
+
+	uint64_t Submit(VkQueue a_Queue, const VkSubmitInfo& a_SubmitInfo, const uint64_t* a_WaitValues = nullptr,
+	                const uint64_t* a_SignalValues = nullptr);
+
+	/// <summary>	Checks whether the work that signals a value has completed, without blocking. </summary>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+	/// <param name="a_Value">		  	The timeline value.</param>
+	/// <returns>	True if the value has been reached. </returns>
+
+	bool IsComplete(const VkDevice& a_LogicalDevice, uint64_t a_Value);
+
+	/// <summary>	Blocks until a value has been reached. Returns immediately if it is already known to be reached. </summary>
+	/// <exception cref="std::runtime_error">	Raised when waiting fails, e.g. because the device was lost.</exception>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+	/// <param name="a_Value">		  	The timeline value.</param>
+
+	void Wait(const VkDevice& a_LogicalDevice, uint64_t a_Value);
+
+	/// <summary>	Queries the value the GPU has reached. </summary>
+	/// <param name="a_LogicalDevice">	The logical device.</param>
+	/// <returns>	The completed value. </returns>
+
+	uint64_t GetCompletedValue(const VkDevice& a_LogicalDevice);
+
+	/// <summary>	Gets the value signaled by the most recent submission. </summary>
+	/// <returns>	The last submitted value, 0 if nothing was submitted yet. </returns>
+
+	uint64_t GetLastSubmittedValue() const;
+
+	VkSemaphore GetSemaphore() const;
+
+	// signal semaphores a submission may have in addition to the timeline
+	static constexpr uint32_t s_MaxSignalSemaphores = 8;
+
+private:
+	VkSemaphore m_Semaphore = VK_NULL_HANDLE;
+
+	// submissions may happen from several threads, e.g. uploads while a frame is recorded
+	std::atomic<uint64_t> m_LastSubmittedValue{0};
+
+	// last value read back from the GPU, avoids querying the semaphore for values known to be complete
+	std::atomic<uint64_t> m_CompletedValue{0};
+};
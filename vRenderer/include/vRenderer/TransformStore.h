@@ -0,0 +1,142 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+class InstanceBuffer;
+class JobSystem;
+
+/// <summary>
+/// 	Stores the transforms of many objects as separate arrays per component (structure of arrays)
+/// 	and caches their world matrices. Only transforms changed since the last Update, and the
+/// 	children of changed transforms, are recomputed, four at a time with SSE and in parallel jobs.
+/// </summary>
+/// <remarks>
+/// 	Parents always have a lower index than their children, so a single pass in index order sees
+/// 	every parent's world matrix before its children. The index of a transform is also the slot
+/// 	its world matrix is written to in the instance buffer.
+/// </remarks>
+class TransformStore
+{
+public:
+	static constexpr uint32_t s_NoParent = UINT32_MAX;
+
+	TransformStore();
+	~TransformStore();
+
+	/// <summary>	Adds a transform, marked as changed. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the parent does not exist yet.</exception>
+	/// <param name="a_Position">	(Optional) The position relative to the parent.</param>
+	/// <param name="a_Rotation">	(Optional) The rotation relative to the parent.</param>
+	/// <param name="a_Scale">   	(Optional) The scale relative to the parent.</param>
+	/// <param name="a_Parent">  	(Optional) Index of the parent transform.</param>
+	/// <returns>	The index of the transform. </returns>
+
+	uint32_t Create(const glm::vec3& a_Position = glm::vec3(0.0f), const glm::quat& a_Rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+	                const glm::vec3& a_Scale = glm::vec3(1.0f), uint32_t a_Parent = s_NoParent);
+
+	void Clear();
+
+	uint32_t GetCount() const;
+
+	void SetPosition(uint32_t a_Index, const glm::vec3& a_Position);
+	void SetRotation(uint32_t a_Index, const glm::quat& a_Rotation);
+	void SetScale(uint32_t a_Index, const glm::vec3& a_Scale);
+
+	/// <summary>	Applies a rotation on top of the current one. </summary>
+	/// <param name="a_Index">   	Index of the transform.</param>
+	/// <param name="a_Rotation">	The rotation to apply.</param>
+
+	void Rotate(uint32_t a_Index, const glm::quat& a_Rotation);
+
+	/// <summary>
+	/// 	Moves a transform without motion, its previous world matrix after the next Update is the new
+	/// 	one. Used when a transform is reused for another object.
+	/// </summary>
+	/// <param name="a_Index">   	Index of the transform.</param>
+	/// <param name="a_Position">	The position relative to the parent.</param>
+	/// <param name="a_Rotation">	The rotation relative to the parent.</param>
+	/// <param name="a_Scale">   	The scale relative to the parent.</param>
+
+	void Teleport(uint32_t a_Index, const glm::vec3& a_Position, const glm::quat& a_Rotation, const glm::vec3& a_Scale);
+
+	glm::vec3 GetPosition(uint32_t a_Index) const;
+	glm::quat GetRotation(uint32_t a_Index) const;
+	glm::vec3 GetScale(uint32_t a_Index) const;
+	uint32_t GetParent(uint32_t a_Index) const;
+
+	/// <summary>	Forces the world matrix of a transform to be recomputed and written again. </summary>
+	/// <param name="a_Index">	Index of the transform.</param>
+
+	void MarkDirty(uint32_t a_Index);
+
+	/// <summary>	Recomputes the world matrices of all changed transforms and their children. </summary>
+	/// <param name="a_JobSystem">	The job system the batches are spread over.</param>
+
+	void Update(JobSystem& a_JobSystem);
+
+	/// <summary>	Gets the world matrix computed by the last Update. </summary>
+	/// <param name="a_Index">	Index of the transform.</param>
+	/// <returns>	The world matrix. </returns>
+
+	const glm::mat4& GetWorldMatrix(uint32_t a_Index) const;
+
+	/// <summary>	Gets the world matrix before the last Update, used for motion vectors. </summary>
+	/// <param name="a_Index">	Index of the transform.</param>
+	/// <returns>	The previous world matrix, the current one if the transform did not move in the last Update. </returns>
+
+	const glm::mat4& GetPreviousWorldMatrix(uint32_t a_Index) const;
+
+	/// <summary>	Gets the serial of the Update that last changed a world matrix. </summary>
+	/// <param name="a_Index">	Index of the transform.</param>
+	/// <returns>	The serial, 0 if no Update computed the matrix yet. </returns>
+
+	uint64_t GetChangedSerial(uint32_t a_Index) const;
+
+	/// <summary>	Gets the serial of the last Update that changed any world matrix. </summary>
+	/// <returns>	The serial, 0 before the first change. </returns>
+
+	uint64_t GetUpdateSerial() const;
+
+	/// <summary>
+	/// 	Writes the current and previous world matrices that changed since a buffer was last written
+	/// 	into its mapped instance data. Each frame in flight has its own buffer and therefore its own
+	/// 	serial.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when the buffer cannot hold all transforms.</exception>
+	/// <param name="a_Buffer">		  	The instance buffer.</param>
+	/// <param name="a_WrittenSerial">	[in,out] The serial of the last Update written to the buffer, 0 initially.</param>
+	/// <param name="a_JobSystem">	  	The job system the copies are spread over.</param>
+
+	void WriteWorldMatrices(InstanceBuffer& a_Buffer, uint64_t& a_WrittenSerial, JobSystem& a_JobSystem) const;
+
+private:
+	// computes the local matrices of four transforms at once
+	void ComputeLocalMatrices(const uint32_t* a_Indices, uint32_t a_Count);
+
+	std::vector<float> m_PositionX;
+	std::vector<float> m_PositionY;
+	std::vector<float> m_PositionZ;
+	std::vector<float> m_RotationX;
+	std::vector<float> m_RotationY;
+	std::vector<float> m_RotationZ;
+	std::vector<float> m_RotationW;
+	std::vector<float> m_ScaleX;
+	std::vector<float> m_ScaleY;
+	std::vector<float> m_ScaleZ;
+	std::vector<uint32_t> m_Parents;
+
+	std::vector<uint8_t> m_Dirty;
+	// serial of the Update that last changed each world matrix
+	std::vector<uint64_t> m_ChangedSerials;
+	std::vector<glm::mat4> m_WorldMatrices;
+	std::vector<glm::mat4> m_PreviousWorldMatrices;
+
+	// transforms recomputed by the current Update, kept to avoid allocating every frame
+	std::vector<uint32_t> m_DirtyIndices;
+	// transforms recomputed by the Update before, their previous matrix catches up in the next one
+	std::vector<uint32_t> m_MovedIndices;
+	uint64_t m_UpdateSerial = 0;
+};
@@ -13,10 +13,48 @@ public:
 	glm::mat4 GetViewMat() const;
 	glm::mat4 GetProjectionMat() const;
 
+	/// <summary>	Gets the projection matrix without the sub-pixel jitter applied. </summary>
+	/// <returns>	The unjittered projection matrix. </returns>
+
+	glm::mat4 GetUnjitteredProjectionMat() const;
+
+	/// <summary>
+	/// 	Sets a sub-pixel offset that is applied to the projection matrix, used by temporal
+	/// 	anti-aliasing.
+	/// </summary>
+	/// <param name="a_Jitter">	The offset in normalized device coordinates.</param>
+
+	void SetJitter(const glm::vec2& a_Jitter);
+	glm::vec2 GetJitter() const;
+
+	/// <summary>
+	/// 	Restricts the projection to a region of the view, so the region fills the whole image.
+	/// 	Used to render the view in tiles, the aspect ratio stays the one of the whole view.
+	/// </summary>
+	/// <param name="a_Min">	The top left corner of the region, (0, 0) is the top left of the view.</param>
+	/// <param name="a_Max">	The bottom right corner of the region, (1, 1) is the bottom right of the view.</param>
+
+	void SetViewRegion(const glm::vec2& a_Min, const glm::vec2& a_Max);
+
+	/// <summary>	Resets the view region to the whole view. </summary>
+	void ResetViewRegion();
+
+	glm::vec2 GetViewRegionMin() const;
+	glm::vec2 GetViewRegionMax() const;
+
 	glm::vec3 GetPosition() const;
 
 	void SetPosition(const glm::vec3& a_Position);
 
+	float GetNearPlane() const;
+	float GetFarPlane() const;
+
+	/// <summary>	Gets the vertical field of view. </summary>
+	/// <returns>	The field of view in degrees. </returns>
+
+	float GetFOV() const;
+	float GetAspectRatio() const;
+
 	/// <summary>	Updates the aspect ratio. </summary>
 	/// <param name="a_WindowWidth"> 	Width of the window.</param>
 	/// <param name="a_WindowHeight">	Height of the window.</param>
@@ -41,5 +79,10 @@ private:
 	float m_Aspect;
 
 	glm::mat4 m_View;
+
+	glm::vec2 m_Jitter = {0.0f, 0.0f};
+
+	glm::vec2 m_ViewRegionMin = {0.0f, 0.0f};
+	glm::vec2 m_ViewRegionMax = {1.0f, 1.0f};
 };
 
@@ -0,0 +1,55 @@
+#pragma once
+#include <cfloat>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+// axis aligned bounding box, empty boxes have a minimum above their maximum
+struct BoundingBox
+{
+	glm::vec3 m_Min = glm::vec3(FLT_MAX);
+	glm::vec3 m_Max = glm::vec3(-FLT_MAX);
+
+	void Grow(const glm::vec3& a_Point)
+	{
+		m_Min = glm::min(m_Min, a_Point);
+		m_Max = glm::max(m_Max, a_Point);
+	}
+
+	void Grow(const BoundingBox& a_Box)
+	{
+		m_Min = glm::min(m_Min, a_Box.m_Min);
+		m_Max = glm::max(m_Max, a_Box.m_Max);
+	}
+
+	glm::vec3 GetCenter() const
+	{
+		return (m_Min + m_Max) * 0.5f;
+	}
+
+	// half the surface area, which is all the surface area heuristic needs
+	float GetHalfArea() const
+	{
+		const glm::vec3 t_Extent = glm::max(m_Max - m_Min, glm::vec3(0.0f));
+		return t_Extent.x * t_Extent.y + t_Extent.y * t_Extent.z + t_Extent.z * t_Extent.x;
+	}
+
+	// box around the transformed box, from the transformed center and extent (Arvo's method)
+	BoundingBox Transform(const glm::mat4& a_Matrix) const
+	{
+		const glm::vec3 t_Center = glm::vec3(a_Matrix * glm::vec4(GetCenter(), 1.0f));
+		const glm::vec3 t_HalfExtent = (m_Max - m_Min) * 0.5f;
+
+		glm::vec3 t_NewHalfExtent = glm::vec3(0.0f);
+		for (int i = 0; i < 3; i++)
+		{
+			for (int j = 0; j < 3; j++)
+			{
+				t_NewHalfExtent[i] += std::abs(a_Matrix[j][i]) * t_HalfExtent[j];
+			}
+		}
+
+		return {t_Center - t_NewHalfExtent, t_Center + t_NewHalfExtent};
+	}
+};
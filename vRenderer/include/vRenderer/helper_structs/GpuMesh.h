@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+
+#include "BoundingBox.h"
+#include "vRenderer/Buffer/IndexBuffer.h"
+#include "vRenderer/Buffer/VertexBuffer.h"
+
+// a mesh uploaded to the device, drawn from its own vertex and index buffers
+struct GpuMesh
+{
+	VertexBuffer m_VertexBuffer;
+	IndexBuffer m_IndexBuffer;
+	uint32_t m_IndexCount = 0;
+
+	// object space bounds of the vertices
+	BoundingBox m_Bounds;
+};
@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+#include <glm/vec4.hpp>
+
+// per-instance input of the occlusion culling pass, laid out to match the std430 struct in the shader
+struct InstanceBounds
+{
+	// world space bounding sphere, xyz is the center and w the radius
+	glm::vec4 m_Sphere = glm::vec4(0.0f);
+
+	// arguments of the instance's indexed draw
+	uint32_t m_IndexCount = 0;
+	uint32_t m_FirstIndex = 0;
+	int32_t m_VertexOffset = 0;
+	uint32_t m_FirstInstance = 0;
+};
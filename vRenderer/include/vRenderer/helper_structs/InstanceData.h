@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <vulkan/vulkan_core.h>
+
+// per-instance attributes, read from vertex input binding 1
+struct InstanceData
+{
+	// world matrix of this and the previous frame, written by the transform store
+	glm::mat4 m_Model = glm::mat4(1.0f);
+	glm::mat4 m_PreviousModel = glm::mat4(1.0f);
+
+	// slot of the instance's texture in the bindless texture table
+	uint32_t m_TextureIndex = 0;
+
+	static VkVertexInputBindingDescription GenInputBindingDesc()
+	{
+		VkVertexInputBindingDescription t_Desc = {};
+
+		t_Desc.binding = 1;
+		t_Desc.stride = sizeof(InstanceData);
+		t_Desc.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+		return t_Desc;
+	}
+
+	static std::array<VkVertexInputAttributeDescription, 9> GenInputAttributeDesc()
+	{
+		std::array<VkVertexInputAttributeDescription, 9> t_Desc = {};
+
+		// desc for m_TextureIndex, locations 0 - 2 are used by the vertex attributes
+		t_Desc[0].binding = 1;
+		t_Desc[0].location = 3;
+		t_Desc[0].format = VK_FORMAT_R32_UINT;
+		t_Desc[0].offset = offsetof(InstanceData, m_TextureIndex);
+
+		// desc for m_Model and m_PreviousModel, a matrix attribute takes one location per column
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			t_Desc[i + 1].binding = 1;
+			t_Desc[i + 1].location = 4 + i;
+			t_Desc[i + 1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+			t_Desc[i + 1].offset = static_cast<uint32_t>(offsetof(InstanceData, m_Model) + sizeof(glm::vec4) * i);
+
+			t_Desc[i + 5].binding = 1;
+			t_Desc[i + 5].location = 8 + i;
+			t_Desc[i + 5].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+			t_Desc[i + 5].offset = static_cast<uint32_t>(offsetof(InstanceData, m_PreviousModel) + sizeof(glm::vec4) * i);
+		}
+
+		return t_Desc;
+	}
+};
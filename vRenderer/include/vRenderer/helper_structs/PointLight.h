@@ -0,0 +1,12 @@
+#pragma once
+#include <glm/vec4.hpp>
+
+// a dynamic point light, laid out to match the std430 struct in the shaders
+struct PointLight
+{
+	// world space position in xyz, distance at which the light's influence ends in w
+	glm::vec4 m_PositionRadius = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+	// linear color in rgb, intensity in w
+	glm::vec4 m_ColorIntensity = glm::vec4(1.0f);
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+
+#include "BoundingBox.h"
+#include "vRenderer/ResourcePool.h"
+
+struct GpuMesh;
+struct Mesh;
+
+// components of renderable entities, stored in the chunks of the entity store
+
+// a transform in the transform store, which is also the entity's instance and its object in the scene hierarchy
+struct TransformComponent
+{
+	uint32_t m_Transform = 0;
+};
+
+// copy of the transform's world matrix, so systems stream through it instead of looking it up
+struct WorldMatrixComponent
+{
+	glm::mat4 m_Matrix = glm::mat4(1.0f);
+};
+
+// the drawn range of a mesh's index buffer
+struct MeshComponent
+{
+	ResourceHandle<GpuMesh> m_Mesh;
+	uint32_t m_IndexCount = 0;
+	uint32_t m_FirstIndex = 0;
+	int32_t m_VertexOffset = 0;
+};
+
+// m_Material is the index of the texture in the bindless table, written to the instance data and
+// used to sort draws by material
+struct MaterialComponent
+{
+	uint32_t m_Material = 0;
+};
+
+// the mesh on the CPU, rasterized by the software occlusion culler and owned by the application
+struct OccluderComponent
+{
+	const Mesh* m_Mesh = nullptr;
+};
+
+struct BoundsComponent
+{
+	BoundingBox m_Local;
+	BoundingBox m_World;
+};
+
+struct VisibilityComponent
+{
+	// passed the culling this frame
+	static constexpr uint32_t s_Visible = 1u << 0;
+	// never drawn, set by the application
+	static constexpr uint32_t s_Hidden = 1u << 1;
+
+	uint32_t m_Flags = 0;
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <vulkan/vulkan_core.h>
+
+enum class AntiAliasingMode
+{
+	// multisampled rendering, optionally with sample rate shading
+	MSAA,
+	// single sampled rendering with a jittered projection, resolved against the previous frames
+	TAA
+};
+
+enum class UpscalingPreset
+{
+	// render at swap chain resolution, no spatial upscaling
+	Native,
+	// render at 1 / 1.3 of the swap chain resolution per axis
+	UltraQuality,
+	// render at 1 / 1.5 of the swap chain resolution per axis
+	Quality,
+	// render at 1 / 2 of the swap chain resolution per axis
+	Performance
+};
+
+enum class OcclusionCullingMode
+{
+	// every instance is drawn
+	Disabled,
+	// the instances visible last frame are drawn into the depth buffer first, all instances are culled
+	// against a depth pyramid built from it in a compute pass and drawn indirectly
+	GPU,
+	// models marked as occluders are rasterized on the CPU at low resolution, the bounding boxes of all
+	// models are tested against it before their draws are recorded
+	CPU
+};
+
+enum class ShadingPath
+{
+	// every fragment is lit in the main pass with the clustered light lists
+	Forward,
+	// the first subpass writes albedo and normals into a G-buffer that is lit in a second subpass through
+	// input attachments. Always renders at one sample per pixel, so MSAA and TAA are disabled
+	Deferred
+};
+
+struct RenderSettings
+{
+	AntiAliasingMode m_AntiAliasingMode = AntiAliasingMode::MSAA;
+
+	// requested MSAA sample count, clamped to what the physical device supports. Ignored for TAA.
+	// VK_SAMPLE_COUNT_1_BIT renders straight into the swap chain without a resolve attachment
+	VkSampleCountFlagBits m_MSAASampleCount = VK_SAMPLE_COUNT_4_BIT;
+
+	// minimum fraction of samples shaded per fragment (0.0 - 1.0), 0.0 disables sample rate shading
+	float m_MinSampleShading = 0.0f;
+
+	// render the main pass into an offscreen target at a scale chosen from the measured GPU frame
+	// time and upscale it to the swap chain. Not combined with TAA
+	bool m_DynamicResolution = false;
+
+	// GPU frame time budget in milliseconds the dynamic resolution scale is adjusted against
+	float m_TargetFrameTime = 1000.0f / 60.0f;
+
+	// lower limit of the dynamic resolution scale per axis (0.1 - 1.0)
+	float m_MinRenderScale = 0.5f;
+
+	// renders below swap chain resolution and upscales with the edge adaptive upscaler and sharpening.
+	// With dynamic resolution the preset scale is the upper limit of the dynamic scale. Not combined with TAA
+	UpscalingPreset m_UpscalingPreset = UpscalingPreset::Native;
+
+	// sharpening strength in stops (0.0 - 2.0), 0.0 is the strongest
+	float m_Sharpness = 0.2f;
+
+	OcclusionCullingMode m_OcclusionCullingMode = OcclusionCullingMode::GPU;
+
+	ShadingPath m_ShadingPath = ShadingPath::Forward;
+};
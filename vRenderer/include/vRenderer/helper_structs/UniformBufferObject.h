@@ -4,7 +4,11 @@
 struct UniformBufferObject
 {
 	// explicit memory alignment for members
-	alignas(16) glm::mat4 m_Model = {};
 	alignas(16) glm::mat4 m_View = {};
 	alignas(16) glm::mat4 m_Projection = {};
+
+	// unjittered view-projection of this and the previous frame, applied to the instances' current
+	// and previous world matrices to write the velocity buffer
+	alignas(16) glm::mat4 m_ViewProjection = {};
+	alignas(16) glm::mat4 m_PreviousViewProjection = {};
 };
@@ -1,8 +1,10 @@
 #pragma once
 #include "vulkan/vulkan_core.h"
 
+#include <optional>
 #include <vector>
 
+#include "vRenderer/Device.h"
 #include "vRenderer/helper_structs/Vertex.h"
 
 inline VkPipelineDynamicStateCreateInfo GenDynamicStateCreateInfo(const std::vector<VkDynamicState>& a_DynamicStates)
@@ -17,13 +19,14 @@ inline VkPipelineDynamicStateCreateInfo GenDynamicStateCreateInfo(const std::vec
 }
 
 inline VkPipelineVertexInputStateCreateInfo GenVertexInputStateCreateInfo(
-	VkVertexInputBindingDescription& a_BindingDesc, std::array<VkVertexInputAttributeDescription, 3>& a_AttributeDesc)
+	const std::vector<VkVertexInputBindingDescription>& a_BindingDesc,
+	const std::vector<VkVertexInputAttributeDescription>& a_AttributeDesc)
 {
 	VkPipelineVertexInputStateCreateInfo t_VertexInputStateCreateInfo = {};
 	t_VertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-	t_VertexInputStateCreateInfo.vertexBindingDescriptionCount = 1;
-	t_VertexInputStateCreateInfo.pVertexBindingDescriptions = &a_BindingDesc;
+	t_VertexInputStateCreateInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(a_BindingDesc.size());
+	t_VertexInputStateCreateInfo.pVertexBindingDescriptions = a_BindingDesc.data();
 
 	t_VertexInputStateCreateInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(a_AttributeDesc.size());
 	t_VertexInputStateCreateInfo.pVertexAttributeDescriptions = a_AttributeDesc.data();
@@ -97,14 +100,23 @@ inline VkPipelineRasterizationStateCreateInfo GenRasterizationStateCreateInfo()
 	return t_RasterizationStateCreateInfo;
 }
 
-inline VkPipelineMultisampleStateCreateInfo GenMultisamplingStateCreateInfo(VkSampleCountFlagBits a_MSAASampleCount)
+/// <summary>	Generates the multisample state of a graphics pipeline. </summary>
+/// <param name="a_MSAASampleCount"> 	The MSAA sample count.</param>
+/// <param name="a_MinSampleShading">	The minimum fraction of samples to shade, 0 disables sample
+/// 									rate shading.</param>
+/// <returns>	The multisample state create info. </returns>
+
+inline VkPipelineMultisampleStateCreateInfo GenMultisamplingStateCreateInfo(VkSampleCountFlagBits a_MSAASampleCount, float a_MinSampleShading)
 {
 	VkPipelineMultisampleStateCreateInfo t_MultisampleState = {};
 
+	// sample rate shading only makes sense if there is more than one sample per pixel
+	const bool t_SampleShading = a_MSAASampleCount != VK_SAMPLE_COUNT_1_BIT && a_MinSampleShading > 0.0f;
+
 	t_MultisampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-	t_MultisampleState.sampleShadingEnable = VK_TRUE;
+	t_MultisampleState.sampleShadingEnable = t_SampleShading ? VK_TRUE : VK_FALSE;
 	t_MultisampleState.rasterizationSamples = a_MSAASampleCount;
-	t_MultisampleState.minSampleShading = 0.2f;
+	t_MultisampleState.minSampleShading = t_SampleShading ? a_MinSampleShading : 0.0f;
 	t_MultisampleState.pSampleMask = nullptr;
 	t_MultisampleState.alphaToCoverageEnable = VK_FALSE;
 	t_MultisampleState.alphaToOneEnable = VK_FALSE;
@@ -128,15 +140,16 @@ inline VkPipelineColorBlendAttachmentState GenColorBlendAttachStateCreateInfo()
 	return t_ColorBlend;
 }
 
-inline VkPipelineColorBlendStateCreateInfo GenColorBlendStateCreateInfo(const VkPipelineColorBlendAttachmentState& a_ColorBlendAttachmentState)
+inline VkPipelineColorBlendStateCreateInfo GenColorBlendStateCreateInfo(const VkPipelineColorBlendAttachmentState* a_ColorBlendAttachmentStates,
+                                                                        const uint32_t a_AttachmentCount = 1)
 {
 	VkPipelineColorBlendStateCreateInfo t_ColorBlendStateCreateInfo = {};
 
 	t_ColorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
 	t_ColorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
 	t_ColorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY;
-	t_ColorBlendStateCreateInfo.attachmentCount = 1;
-	t_ColorBlendStateCreateInfo.pAttachments = &a_ColorBlendAttachmentState;
+	t_ColorBlendStateCreateInfo.attachmentCount = a_AttachmentCount;
+	t_ColorBlendStateCreateInfo.pAttachments = a_ColorBlendAttachmentStates;
 	t_ColorBlendStateCreateInfo.blendConstants[0] = 0.0f;
 	t_ColorBlendStateCreateInfo.blendConstants[1] = 0.0f;
 	t_ColorBlendStateCreateInfo.blendConstants[2] = 0.0f;
@@ -158,6 +171,82 @@ inline VkPipelineLayoutCreateInfo GenPipelineCreateInfo(const int a_LayoutCount,
 	return t_PipelineLayoutCreateInfo;
 }
 
+/// <summary>	Creates a shader module from the provided SPIR-V bytecode. </summary>
+/// <exception cref="std::runtime_error">	Raised when the shader module could not be created.</exception>
+/// <param name="a_CodeData">	  	The shader bytecode loaded from a compiled .spv file.</param>
+/// <param name="a_LogicalDevice">	The logical device.</param>
+/// <returns>	The shader module. </returns>
+
+inline VkShaderModule CreateShaderModule(const std::vector<char>& a_CodeData, const VkDevice& a_LogicalDevice)
+{
+	VkShaderModuleCreateInfo t_ShaderModuleCreateInfo = {};
+	t_ShaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	t_ShaderModuleCreateInfo.codeSize = a_CodeData.size();
+	t_ShaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t*>(a_CodeData.data());
+
+	VkShaderModule t_Module;
+	if (vkCreateShaderModule(a_LogicalDevice, &t_ShaderModuleCreateInfo, nullptr, &t_Module) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Could not create Shader Module!");
+	}
+
+	return t_Module;
+}
+
+/// <summary>	Records a pipeline barrier that transitions all mip levels of an image. </summary>
+/// <param name="a_CommandBuffer">	The command buffer to record the barrier to.</param>
+/// <param name="a_Image">		  	The image.</param>
+/// <param name="a_AspectMask">   	The aspect of the image that is transitioned.</param>
+/// <param name="a_OldLayout">	  	The current layout of the image.</param>
+/// <param name="a_NewLayout">	  	The layout to transition to.</param>
+/// <param name="a_SourceStage">	The pipeline stages that have to finish first.</param>
+/// <param name="a_SourceAccess">	The memory accesses that have to be made available.</param>
+/// <param name="a_DestStage">	  	The pipeline stages that wait for the barrier.</param>
+/// <param name="a_DestAccess">   	The memory accesses that wait for the barrier.</param>
+/// <param name="a_MipLevels">	  	(Optional) The number of mip levels of the image.</param>
+
+inline void InsertImageBarrier(VkCommandBuffer a_CommandBuffer, VkImage a_Image, VkImageAspectFlags a_AspectMask,
+                               VkImageLayout a_OldLayout, VkImageLayout a_NewLayout,
+                               VkPipelineStageFlags a_SourceStage, VkAccessFlags a_SourceAccess,
+                               VkPipelineStageFlags a_DestStage, VkAccessFlags a_DestAccess, uint32_t a_MipLevels = 1)
+{
+	VkImageMemoryBarrier t_Barrier = {};
+	t_Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	t_Barrier.oldLayout = a_OldLayout;
+	t_Barrier.newLayout = a_NewLayout;
+	t_Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	t_Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	t_Barrier.image = a_Image;
+	t_Barrier.subresourceRange.aspectMask = a_AspectMask;
+	t_Barrier.subresourceRange.baseMipLevel = 0;
+	t_Barrier.subresourceRange.levelCount = a_MipLevels;
+	t_Barrier.subresourceRange.baseArrayLayer = 0;
+	t_Barrier.subresourceRange.layerCount = 1;
+	t_Barrier.srcAccessMask = a_SourceAccess;
+	t_Barrier.dstAccessMask = a_DestAccess;
+
+	vkCmdPipelineBarrier(a_CommandBuffer, a_SourceStage, a_DestStage, 0, 0, nullptr, 0, nullptr, 1, &t_Barrier);
+}
+
+/// <summary>	Records a global memory barrier, covering all buffers and images. </summary>
+/// <param name="a_CommandBuffer">	The command buffer to record the barrier to.</param>
+/// <param name="a_SourceStage">	The pipeline stages that have to finish first.</param>
+/// <param name="a_SourceAccess">	The memory accesses that have to be made available.</param>
+/// <param name="a_DestStage">	  	The pipeline stages that wait for the barrier.</param>
+/// <param name="a_DestAccess">   	The memory accesses that wait for the barrier.</param>
+
+inline void InsertMemoryBarrier(VkCommandBuffer a_CommandBuffer, VkPipelineStageFlags a_SourceStage,
+                                VkAccessFlags a_SourceAccess, VkPipelineStageFlags a_DestStage,
+                                VkAccessFlags a_DestAccess)
+{
+	VkMemoryBarrier t_Barrier = {};
+	t_Barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	t_Barrier.srcAccessMask = a_SourceAccess;
+	t_Barrier.dstAccessMask = a_DestAccess;
+
+	vkCmdPipelineBarrier(a_CommandBuffer, a_SourceStage, a_DestStage, 0, 1, &t_Barrier, 0, nullptr, 0, nullptr);
+}
+
 inline void DestroyFrameBuffers(std::vector<VkFramebuffer>& a_FramebufferVector, const VkDevice& a_Device)
 {
 	for (VkFramebuffer t_Buffer : a_FramebufferVector)
@@ -203,7 +292,9 @@ inline bool CheckQueueFamilySupportsPresentation(VkPhysicalDevice a_Device, uint
 /// 	Gets all queue families the device supports. Also checks whether any of them supports the
 /// 	operations required by this application.
 /// </summary>
-/// <param name="a_Device">	The device for which to check the supported queue families.</param>
+/// <param name="a_Device"> 	The device for which to check the supported queue families.</param>
+/// <param name="a_Surface">	The window surface, VK_NULL_HANDLE when rendering headless in which case the
+/// 						graphics family doubles as the present family.</param>
 /// <returns>	The SupportedQueueFamilies. </returns>
 inline SupportedQueueFamilies CheckSupportedQueueFamilies(const VkPhysicalDevice a_Device, VkSurfaceKHR a_Surface)
 {
@@ -225,7 +316,11 @@ inline SupportedQueueFamilies CheckSupportedQueueFamilies(const VkPhysicalDevice
 			t_QueueFamilies.m_GraphicsFamily = i;
 		}
 
-		if (CheckQueueFamilySupportsPresentation(a_Device, i, a_Surface))
+		if (a_Surface == VK_NULL_HANDLE)
+		{
+			t_QueueFamilies.m_PresentFamily = t_QueueFamilies.m_GraphicsFamily;
+		}
+		else if (CheckQueueFamilySupportsPresentation(a_Device, i, a_Surface))
 		{
 			t_QueueFamilies.m_PresentFamily = i;
 		}
@@ -239,6 +334,34 @@ inline SupportedQueueFamilies CheckSupportedQueueFamilies(const VkPhysicalDevice
 	return  t_QueueFamilies;
 }
 
+/// <summary>
+/// 	Looks for a queue family that supports compute but not graphics. Queues of such families
+/// 	usually map to separate hardware queues whose work can overlap with rasterization.
+/// </summary>
+/// <param name="a_Device">	The physical device.</param>
+/// <returns>	The index of the queue family, empty if the device has none. </returns>
+
+inline std::optional<uint32_t> FindAsyncComputeQueueFamily(const VkPhysicalDevice a_Device)
+{
+	uint32_t t_NumQueueFamilies = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(a_Device, &t_NumQueueFamilies, nullptr);
+
+	std::vector<VkQueueFamilyProperties> t_QueueFamilyProperties(t_NumQueueFamilies);
+	vkGetPhysicalDeviceQueueFamilyProperties(a_Device, &t_NumQueueFamilies, t_QueueFamilyProperties.data());
+
+	for (uint32_t i = 0; i < t_NumQueueFamilies; i++)
+	{
+		const VkQueueFlags t_Flags = t_QueueFamilyProperties[i].queueFlags;
+
+		if ((t_Flags & VK_QUEUE_COMPUTE_BIT) != 0 && (t_Flags & VK_QUEUE_GRAPHICS_BIT) == 0)
+		{
+			return i;
+		}
+	}
+
+	return std::nullopt;
+}
+
 /// <summary>	Begins single time command. </summary>
 /// <param name="a_CommandPool">  	[in,out] The command pool.</param>
 /// <param name="a_LogicalDevice">	The logical device.</param>
@@ -266,14 +389,17 @@ inline VkCommandBuffer BeginSingleTimeCommand(VkCommandPool& a_CommandPool, cons
 	return  t_CommandBuffer;
 }
 
-/// <summary>	Ends single time commands. </summary>
+/// <summary>
+/// 	Ends single time commands, submits them and waits until they have completed. Only the
+/// 	timeline value of this submission is waited for, frames in flight keep running.
+/// </summary>
 /// <param name="a_CommandBuffer">	Buffer for command data.</param>
 /// <param name="a_GraphicsQueue">	Queue of graphics.</param>
-/// <param name="a_LogicalDevice">	The logical device.</param>
+/// <param name="a_Device">		  	The device.</param>
 /// <param name="a_CommandPool">  	The command pool.</param>
 
 inline void EndSingleTimeCommands(VkCommandBuffer a_CommandBuffer, const VkQueue& a_GraphicsQueue,
-                                  const VkDevice& a_LogicalDevice, const VkCommandPool& a_CommandPool)
+                                  const Device& a_Device, const VkCommandPool& a_CommandPool)
 {
 	// end recording command buffer
 	vkEndCommandBuffer(a_CommandBuffer);
@@ -283,11 +409,12 @@ inline void EndSingleTimeCommands(VkCommandBuffer a_CommandBuffer, const VkQueue
 	t_SubmitInfo.commandBufferCount = 1;
 	t_SubmitInfo.pCommandBuffers = &a_CommandBuffer;
 
-	vkQueueSubmit(a_GraphicsQueue, 1, &t_SubmitInfo, VK_NULL_HANDLE);
-	vkQueueWaitIdle(a_GraphicsQueue);
+	// callers free their staging resources right after, so the upload has to be complete
+	TimelineSemaphore& t_Timeline = a_Device.GetGraphicsTimeline();
+	t_Timeline.Wait(a_Device.GetLogicalDevice(), t_Timeline.Submit(a_GraphicsQueue, t_SubmitInfo));
 
 	// cleanup 
-	vkFreeCommandBuffers(a_LogicalDevice,a_CommandPool, 1, &a_CommandBuffer);
+	vkFreeCommandBuffers(a_Device.GetLogicalDevice(),a_CommandPool, 1, &a_CommandBuffer);
 }
 
 /// <summary>	Searches for the first supported format. </summary>
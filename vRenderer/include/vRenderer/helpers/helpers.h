@@ -28,3 +28,23 @@ static std::vector<char> ReadFile(const std::string& a_FilePath)
 
 	return t_Buffer;
 }
+
+/// <summary>	Gets an element of the Halton low discrepancy sequence. </summary>
+/// <param name="a_Index">	One-based index into the sequence.</param>
+/// <param name="a_Base"> 	The base of the sequence (usually a prime, e.g. 2 or 3).</param>
+/// <returns>	The sequence element in the range [0, 1). </returns>
+
+inline float Halton(uint32_t a_Index, const uint32_t a_Base)
+{
+	float t_Fraction = 1.0f;
+	float t_Result = 0.0f;
+
+	while (a_Index > 0)
+	{
+		t_Fraction /= static_cast<float>(a_Base);
+		t_Result += t_Fraction * static_cast<float>(a_Index % a_Base);
+		a_Index /= a_Base;
+	}
+
+	return t_Result;
+}
@@ -1,14 +1,42 @@
 #pragma once
+#include <optional>
 #include <vector>
 #include <glm/vec2.hpp>
+#include <glm/mat4x4.hpp>
 #include <vulkan/vulkan_core.h>
 
+#include "AsyncComputeScheduler.h"
+#include "BindlessTextureTable.h"
+#include "ClusteredLightCuller.h"
+#include "Buffer/InstanceBuffer.h"
+#include "Buffer/ReadbackBuffer.h"
 #include "Buffer/VertexBuffer.h"
 #include "Device.h"
+#include "helper_structs/GpuMesh.h"
 #include "helper_structs/RenderingHelpers.h"
+#include "helper_structs/RenderSettings.h"
 #include <vRenderer/SwapChain.h>
 
+#include "DeferredDestructionQueue.h"
+#include "DeferredLighting.h"
+#include "DescriptorAllocator.h"
+#include "DrawQueue.h"
+#include "DynamicResolution.h"
+#include "EntityStore.h"
+#include "FrameArena.h"
+#include "FrameCapture.h"
+#include "FrameExporter.h"
+#include "GpuTimer.h"
+#include "JobSystem.h"
 #include "Model.h"
+#include "OcclusionCuller.h"
+#include "RenderGraph/RenderGraph.h"
+#include "ResourcePool.h"
+#include "SceneBvh.h"
+#include "SoftwareOcclusionCuller.h"
+#include "SpatialUpscaler.h"
+#include "TemporalAA.h"
+#include "TransformStore.h"
 #include "Texture.h"
 #include "Buffer/IndexBuffer.h"
 #include "Buffer/UniformBuffer.h"
@@ -25,17 +53,119 @@ public:
 	/// <summary>	Initializes the Renderer. </summary>
 	/// <param name="a_WindowWidth">			  	(Optional) Width of the window.</param>
 	/// <param name="a_WindowHeight">			  	(Optional) Height of the window.</param>
+	/// <param name="a_RenderSettings">			  	(Optional) The initial render settings (MSAA, sample shading).</param>
 	/// <param name="a_EnabledValidationLayers">  	(Optional) The enabled validation layers.</param>
 	/// <param name="a_RequestedDeviceExtensions">	(Optional) The requested device extensions.</param>
 	/// <returns>	True if it succeeds, false if it fails. </returns>
 
-	bool Init(int a_WindowWidth = 800, int a_WindowHeight = 600,
+	bool Init(int a_WindowWidth = 800, int a_WindowHeight = 600, const RenderSettings& a_RenderSettings = {},
 	          const std::vector<const char*>& a_EnabledValidationLayers = {"VK_LAYER_KHRONOS_validation"},
 	          const std::vector<const char*>& a_RequestedDeviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME});
 
+	/// <summary>
+	/// 	Initializes the Renderer without a window, surface or swap chain, for machines without a
+	/// 	display. Frames are rendered into offscreen images of the requested size and read back
+	/// 	through ReadbackFrame, the device is selected without requiring present support.
+	/// </summary>
+	/// <param name="a_Width">					  	Width of the rendered frames.</param>
+	/// <param name="a_Height">				  	Height of the rendered frames.</param>
+	/// <param name="a_RenderSettings">			  	(Optional) The initial render settings.</param>
+	/// <param name="a_EnabledValidationLayers">  	(Optional) The enabled validation layers.</param>
+	/// <param name="a_RequestedDeviceExtensions">	(Optional) The requested device extensions, the swap chain
+	/// 											extension is ignored.</param>
+	/// <returns>	True if it succeeds, false if it fails. </returns>
+
+	bool InitHeadless(uint32_t a_Width, uint32_t a_Height, const RenderSettings& a_RenderSettings = {},
+	                  const std::vector<const char*>& a_EnabledValidationLayers = {"VK_LAYER_KHRONOS_validation"},
+	                  const std::vector<const char*>& a_RequestedDeviceExtensions = {});
+
 	bool Terminate();
 	void Render(Camera& a_Camera);
 
+	/// <summary>	Checks whether the renderer was initialized without a window. </summary>
+	/// <returns>	True if frames are rendered offscreen and read back, false if they are presented. </returns>
+
+	bool IsHeadless() const;
+
+	/// <summary>
+	/// 	Reads back the most recently rendered frame of the headless mode, waiting for it to finish
+	/// 	on the GPU. The pixels are tightly packed rows of 8 bit RGBA in the sRGB color space,
+	/// 	starting at the top left.
+	/// </summary>
+	/// <exception cref="std::runtime_error">
+	/// 	Raised when not headless, the frame was not rendered or is no longer in flight.
+	/// </exception>
+	/// <param name="a_Pixels">	  	[out] The pixels, resized to width * height * 4 bytes.</param>
+	/// <param name="a_FramesAgo">	(Optional) How many frames before the most recent one to read, less
+	/// 							than the number of frames in flight. Reading an earlier frame lets the
+	/// 							GPU keep working on the later ones.</param>
+
+	void ReadbackFrame(std::vector<uint8_t>& a_Pixels, uint32_t a_FramesAgo = 0);
+
+	/// <summary>
+	/// 	Starts capturing every presented frame to a video file. The copies are recorded into the
+	/// 	frames' own submissions and written on a separate thread once they finished, so the frame
+	/// 	loop never waits for them. Frames are dropped from the capture when the writer falls behind.
+	/// 	After a resize the capture continues in a new file, see FrameCapture::Restart.
+	/// </summary>
+	/// <exception cref="std::runtime_error">
+	/// 	Raised when the swap chain images cannot be copied from, their format is not 8 bit RGBA or
+	/// 	BGRA, or the file could not be opened.
+	/// </exception>
+	/// <param name="a_FilePath"> 	The path of the video file.</param>
+	/// <param name="a_Format">   	The format of the video file.</param>
+	/// <param name="a_FrameRate">	(Optional) The frame rate written to the Y4M header.</param>
+
+	void StartCapture(const std::string& a_FilePath, CaptureFormat a_Format, uint32_t a_FrameRate = 60);
+
+	/// <summary>	Writes the remaining captured frames and closes the file. Waits for the device to become idle. </summary>
+	void StopCapture();
+
+	bool IsCapturing() const;
+
+	/// <summary>	Gets the number of frames dropped from the running or last capture. </summary>
+	uint64_t GetDroppedCaptureFrames() const;
+
+	/// <summary>
+	/// 	Starts exporting every presented frame to other local processes through a shared memory
+	/// 	ring, with the pixels in exported device memory if the device supports it. See
+	/// 	SharedFrameRing for the layout consumers map. A resize ends the ring and creates a new one
+	/// 	of the same name at the new extent.
+	/// </summary>
+	/// <exception cref="std::runtime_error">
+	/// 	Raised when the swap chain images cannot be copied from, their format is not 8 bit RGBA or
+	/// 	BGRA, or the ring could not be created.
+	/// </exception>
+	/// <param name="a_Name">		  	The name of the shared memory object, e.g. "/vRenderer-frames".</param>
+	/// <param name="a_PreferredMode">	(Optional) The mode to use if the device supports it.</param>
+
+	void StartFrameExport(const std::string& a_Name, FrameExportMode a_PreferredMode = FrameExportMode::ExternalMemory);
+
+	/// <summary>	Stops exporting frames and removes the shared memory object. Waits for the device to become idle. </summary>
+	void StopFrameExport();
+
+	/// <summary>	Gets the mode frames are exported with, which depends on what the device supports. </summary>
+	/// <returns>	The mode of the running export. </returns>
+
+	FrameExportMode GetFrameExportMode() const;
+
+	/// <summary>
+	/// 	Exports the memory holding the frames in the external memory mode, owned by the caller.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when not exporting through external memory.</exception>
+	/// <returns>	The file descriptor. </returns>
+
+	int ExportFrameMemoryFd() const;
+
+	/// <summary>
+	/// 	Exports the timeline semaphore signaled with each frame's number in the external memory
+	/// 	mode, owned by the caller.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when not exporting through external memory.</exception>
+	/// <returns>	The file descriptor. </returns>
+
+	int ExportFrameSemaphoreFd() const;
+
 	bool ShouldTerminate() const;
 
 	/// <summary>	Gets window extent. </summary>
@@ -43,6 +173,203 @@ public:
 
 	glm::ivec2 GetWindowExtent();
 
+	/// <summary>
+	/// 	Applies new render settings at runtime. Waits for the device to become idle and rebuilds
+	/// 	the render pass, the graphics pipeline, the MSAA or TAA targets and the frame buffers.
+	/// </summary>
+	/// <param name="a_RenderSettings">	The requested render settings.</param>
+
+	void SetRenderSettings(const RenderSettings& a_RenderSettings);
+
+	/// <summary>
+	/// 	Gets the render settings currently in use. Values may differ from the requested ones if
+	/// 	the device does not support them.
+	/// </summary>
+	/// <returns>	The active render settings. </returns>
+
+	const RenderSettings& GetRenderSettings() const;
+
+	/// <summary>
+	/// 	Sets the worker count and pinning of the job system. Before Init they are used when it is
+	/// 	started, afterwards the workers are restarted right away.
+	/// </summary>
+	/// <param name="a_Settings">	The job system settings.</param>
+
+	void SetJobSystemSettings(const JobSystemSettings& a_Settings);
+
+	/// <summary>
+	/// 	Gets the job system the renderer spreads its CPU work over, e.g. to set profiling hooks or
+	/// 	to run application jobs on the same workers.
+	/// </summary>
+	/// <returns>	The job system. </returns>
+
+	JobSystem& GetJobSystem();
+
+	/// <summary>
+	/// 	Gets the arena of the frame being built, for data that only has to live until the frame's
+	/// 	submission has completed. Rewound at the start of Render.
+	/// </summary>
+	/// <returns>	The current frame's arena. </returns>
+
+	LinearArena& GetFrameArena();
+
+	/// <summary>	Gets the scale the main pass is currently rendered at. </summary>
+	/// <returns>	The render scale per axis, 1.0 unless dynamic resolution is enabled. </returns>
+
+	float GetRenderScale() const;
+
+	/// <summary>	Gets the most recently measured GPU frame time. </summary>
+	/// <returns>	The GPU frame time in milliseconds, 0.0 if timestamps are not supported. </returns>
+
+	float GetGpuFrameTime() const;
+
+	/// <summary>	Gets the binds the last frame's draws would have needed in the order they were queued. </summary>
+	/// <returns>	The bind statistics before sorting. </returns>
+
+	const BindStatistics& GetUnsortedBindStatistics() const;
+
+	/// <summary>	Gets the binds recorded for the last frame's draws after sorting them by their keys. </summary>
+	/// <returns>	The bind statistics after sorting. </returns>
+
+	const BindStatistics& GetBindStatistics() const;
+
+	/// <summary>
+	/// 	Writes the last frame's software occlusion buffer to a PGM image. Only filled while CPU
+	/// 	occlusion culling is enabled.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when the file could not be written.</exception>
+	/// <param name="a_FilePath">	The path of the image.</param>
+
+	void DumpOcclusionBuffer(const std::string& a_FilePath) const;
+
+	/// <summary>
+	/// 	Sets the dynamic point lights. They are culled against a clustered grid every frame, so
+	/// 	the shading cost depends on how many lights overlap a fragment rather than on the total.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when there are more lights than supported.</exception>
+	/// <param name="a_Lights">	The lights, replacing the previous ones.</param>
+
+	void SetPointLights(const std::vector<PointLight>& a_Lights);
+
+	/// <summary>	Sets the ambient light added to every fragment, white by default so unlit scenes show their textures. </summary>
+	/// <param name="a_Ambient">	The ambient light in linear rgb.</param>
+
+	void SetAmbientLight(const glm::vec3& a_Ambient);
+
+	/// <summary>	Uploads a mesh to be drawn by renderables. Waits for the upload to finish. </summary>
+	/// <param name="a_Mesh">	The mesh.</param>
+	/// <returns>	The handle of the mesh. </returns>
+
+	ResourceHandle<GpuMesh> CreateMesh(const Mesh& a_Mesh);
+
+	/// <summary>
+	/// 	Releases a mesh, its buffers are destroyed once the frames in flight are done with them.
+	/// 	No renderable may use it anymore.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when the handle is stale.</exception>
+	/// <param name="a_Mesh">	The handle of the mesh.</param>
+
+	void DestroyMesh(ResourceHandle<GpuMesh> a_Mesh);
+
+	/// <summary>	Adds a texture to the bindless table, so renderables can be drawn with it. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the table is full.</exception>
+	/// <param name="a_Texture">	The texture, has to outlive its registration.</param>
+	/// <returns>	The index of the texture. </returns>
+
+	uint32_t RegisterTexture(const Texture& a_Texture);
+
+	/// <summary>
+	/// 	Removes a texture from the bindless table. Its slot is reused once the frames in flight are
+	/// 	done with it, the texture has to live until then.
+	/// </summary>
+	/// <param name="a_TextureIndex">	The index returned by RegisterTexture.</param>
+
+	void ReleaseTexture(uint32_t a_TextureIndex);
+
+	/// <summary>
+	/// 	Adds an object that is drawn every frame until it is destroyed. It gets its own transform,
+	/// 	which is also its instance and its object in the scene hierarchy.
+	/// </summary>
+	/// <exception cref="std::runtime_error">
+	/// 	Raised when the mesh handle is stale or all instances are in use.
+	/// </exception>
+	/// <param name="a_Mesh">		 	The mesh, drawn in full.</param>
+	/// <param name="a_TextureIndex">	The index returned by RegisterTexture.</param>
+	/// <param name="a_Position">	 	(Optional) The position.</param>
+	/// <param name="a_Rotation">	 	(Optional) The rotation.</param>
+	/// <param name="a_Scale">		 	(Optional) The scale.</param>
+	/// <param name="a_Occluder">	 	(Optional) The mesh on the CPU, rasterized as an occluder by CPU
+	/// 								occlusion culling. Has to outlive the renderable.</param>
+	/// <returns>	The entity of the renderable. </returns>
+
+	Entity CreateRenderable(ResourceHandle<GpuMesh> a_Mesh, uint32_t a_TextureIndex,
+	                        const glm::vec3& a_Position = glm::vec3(0.0f),
+	                        const glm::quat& a_Rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+	                        const glm::vec3& a_Scale = glm::vec3(1.0f), const Mesh* a_Occluder = nullptr);
+
+	/// <summary>	Removes a renderable, its transform is reused by the renderables created later. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the entity does not exist.</exception>
+	/// <param name="a_Entity">	The entity of the renderable.</param>
+
+	void DestroyRenderable(Entity a_Entity);
+
+	/// <summary>	Gets the transform of a renderable, which is moved through GetTransforms. </summary>
+	/// <exception cref="std::runtime_error">	Raised when the entity does not exist.</exception>
+	/// <param name="a_Entity">	The entity of the renderable.</param>
+	/// <returns>	The index of the transform, also the renderable's instance. </returns>
+
+	uint32_t GetRenderableTransform(Entity a_Entity);
+
+	/// <summary>	Gets the transforms of the renderables, the world matrices are updated by Render. </summary>
+	/// <returns>	The transform store. </returns>
+
+	TransformStore& GetTransforms();
+
+	/// <summary>
+	/// 	Places a renderable with a model to world matrix, without motion. The matrix is split into
+	/// 	position, rotation and scale, so it must not shear.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when the entity does not exist.</exception>
+	/// <param name="a_Entity">   	The entity of the renderable.</param>
+	/// <param name="a_Transform">	The model to world matrix.</param>
+
+	void SetRenderableTransform(Entity a_Entity, const glm::mat4& a_Transform);
+
+	/// <summary>	Gets the model loaded by Init, destroyed like any other renderable. </summary>
+	/// <returns>	The entity of the test model. </returns>
+
+	Entity GetTestModel() const;
+
+	/// <summary>	Finds the closest instance whose bounding box lies under a point of the view. </summary>
+	/// <param name="a_Camera">		 	The camera the view is rendered with.</param>
+	/// <param name="a_ViewPosition">	The point, (0, 0) is the top left and (1, 1) the bottom right of the view.</param>
+	/// <returns>	The instance, nothing if the point shows the background. </returns>
+
+	std::optional<uint32_t> PickInstance(const Camera& a_Camera, const glm::vec2& a_ViewPosition) const;
+
+	/// <summary>
+	/// 	Gets the hierarchy over the world space bounds of the instances, for queries on the CPU.
+	/// 	Updated by Render before the frame is culled against it.
+	/// </summary>
+	/// <returns>	The scene hierarchy. </returns>
+
+	const SceneBvh& GetSceneBvh() const;
+
+	/// <summary>
+	/// 	Discards the temporal anti-aliasing history, e.g. when the next frame shows an unrelated
+	/// 	view. Does nothing without TAA.
+	/// </summary>
+
+	void ResetTemporalHistory();
+
+	/// <summary>
+	/// 	Destroys a resource once all frames submitted so far have finished on the GPU, without
+	/// 	waiting for them.
+	/// </summary>
+	/// <param name="a_Destroy">	Destroys the resource.</param>
+
+	void DeferDestruction(std::function<void()> a_Destroy);
+
 	const int m_MaxInFlightFrames = 2;
 
 private:
@@ -65,6 +392,9 @@ private:
 
 	void CreateWindowSurface();
 
+	/// <summary>	Sets up how the pooled meshes and pipelines are destroyed, deferred until the GPU is done with them. </summary>
+	void CreateResourcePools();
+
 	void CreateGraphicsPipeline();
 
 	VkShaderModule GenShaderModule(const std::vector<char>& a_CodeData);
@@ -72,6 +402,32 @@ private:
 
 	void CreateRenderPass();
 
+	/// <summary>
+	/// 	Declares and compiles the passes around the main render pass: the occlusion culling phases,
+	/// 	the depth prepass and the pyramid build before it and the TAA resolve, the upscaling or the
+	/// 	copy into the swap chain after it. The images are bound by BindRenderGraphImages.
+	/// </summary>
+	void CreateRenderGraphs();
+
+	/// <summary>	Binds the targets created by CreateRenderTargets to the render graphs. </summary>
+	void BindRenderGraphImages();
+
+	/// <summary>
+	/// 	Creates the render pass used for TAA, rendering into the offscreen scene color and
+	/// 	velocity targets which are read by the resolve pass afterwards.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when render pass can not be created.</exception>
+
+	void CreateTemporalAARenderPass();
+
+	/// <summary>
+	/// 	Creates the render pass used for deferred shading. The first subpass writes the G-buffer and
+	/// 	depth, the second one reads them as input attachments and writes the lit output.
+	/// </summary>
+	/// <exception cref="std::runtime_error">	Raised when render pass can not be created.</exception>
+
+	void CreateDeferredRenderPass();
+
 	void CreateFrameBuffers();
 
 	void CreateCommandPool();
@@ -80,12 +436,19 @@ private:
 
 	void RecordCommandBuffer(VkCommandBuffer a_CommandBuffer, uint32_t a_ImageIndex);
 
+	/// <summary>
+	/// 	Fills the draw queue with the visible draws of the current frame and sorts them by their
+	/// 	state and view depth.
+	/// </summary>
+	/// <param name="a_Camera">	The camera the frame is rendered from.</param>
+
+	void BuildDrawQueue(const Camera& a_Camera);
+
 	void CreateUniformBuffers();
+	void CreateInstanceBuffers();
 	void UpdateUniformBuffers(uint32_t a_CurrentImage, Camera& a_Camera);
 
-	VkDescriptorPool CreateDescriptorPool(int a_DescriptorCount, const VkDevice& a_LogicalDevice);
-	void CreateDescriptorSets(int a_Count, VkDevice a_LogicalDevice, VkDescriptorSetLayout& a_DescriptorSetLayout,
-	                          VkDescriptorPool& a_DescriptorPool, std::vector<VkDescriptorSet>& a_DescriptorSets);
+	void CreateDescriptorSets();
 
 
 	void CreateSyncObjects();
@@ -98,11 +461,101 @@ private:
 	// MSAA
 	void CreateColorResources();
 
+	/// <summary>	Checks whether rendering uses a multisampled color target that is resolved. </summary>
+	/// <returns>	True if MSAA is enabled, false if rendering directly into the swap chain. </returns>
+
+	bool UsesMSAAResolve() const;
+
+	/// <summary>	Checks whether temporal anti-aliasing is enabled. </summary>
+	/// <returns>	True if the scene is rendered offscreen and resolved by the TAA pass. </returns>
+
+	bool UsesTAA() const;
+
+	/// <summary>	Checks whether occlusion culling runs on the GPU. </summary>
+	/// <returns>
+	/// 	True if a depth prepass is rendered and the main pass draws the instances that pass the
+	/// 	culling.
+	/// </returns>
+
+	bool UsesGpuOcclusionCulling() const;
+
+	/// <summary>	Checks whether occlusion culling runs on the CPU. </summary>
+	/// <returns>	True if draws are only queued for models that are not hidden by occluders. </returns>
+
+	bool UsesCpuOcclusionCulling() const;
+
+	/// <summary>	Checks whether the deferred shading path is used. </summary>
+	/// <returns>	True if the main pass writes a G-buffer that is lit in a second subpass. </returns>
+
+	bool UsesDeferredShading() const;
+
+	/// <summary>	Checks whether the main pass renders into the offscreen target. </summary>
+	/// <returns>
+	/// 	True if dynamic resolution or spatial upscaling is enabled, false if rendering at swap chain
+	/// 	resolution.
+	/// </returns>
+
+	bool UsesOffscreenTarget() const;
+
+	/// <summary>	Checks whether the offscreen target is upscaled by the spatial upscaler. </summary>
+	/// <returns>	True if an upscaling preset is selected, false if a bilinear copy is used. </returns>
+
+	bool UsesSpatialUpscaler() const;
+
+	/// <summary>	Gets the format of the image the main pass outputs to. </summary>
+	/// <returns>	The offscreen format when using the offscreen target, else the swap chain format. </returns>
+
+	VkFormat GetOutputFormat();
+
+	/// <summary>	Gets the extent the main pass is rendered at. </summary>
+	/// <returns>	The swap chain extent scaled by the current render scale. </returns>
+
+	VkExtent2D GetRenderExtent();
+
+	void CreateOffscreenResources();
+
+	/// <summary>
+	/// 	Records the upscaling copy of the rendered part of the offscreen target into a swap chain
+	/// 	image. The offscreen target has to be in the transfer source and the swap chain image in the
+	/// 	transfer destination layout.
+	/// </summary>
+	/// <param name="a_CommandBuffer">  	The command buffer.</param>
+	/// <param name="a_SwapChainImage">	The swap chain image.</param>
+
+	void BlitToSwapChain(VkCommandBuffer a_CommandBuffer, VkImage a_SwapChainImage);
+
+	void ApplyRenderSettings(const RenderSettings& a_RenderSettings);
+
+	void DestroyRenderTargets();
+	void CreateRenderTargets();
+
 	void HandleResize();
 
+	/// <summary>	Gets the layout the swap chain images are left in at the end of a frame. </summary>
+	/// <returns>	The present layout, or the transfer source layout when the frames are read back. </returns>
+
+	VkImageLayout GetPresentLayout() const;
+
 	// GLFW members
 	GLFWwindow* m_Window;
-	VkSurfaceKHR m_WindowSurface;
+	VkSurfaceKHR m_WindowSurface = VK_NULL_HANDLE;
+
+	// used for headless rendering, the swap chain holds offscreen images that are copied into the
+	// readback buffer of their frame
+	bool m_Headless = false;
+	VkExtent2D m_HeadlessExtent = {};
+	std::vector<ReadbackBuffer> m_ReadbackBuffers;
+	static constexpr VkFormat s_HeadlessFormat = VK_FORMAT_R8G8B8A8_SRGB;
+
+	FrameCapture m_FrameCapture;
+	FrameExporter m_FrameExporter;
+
+	// started first in InitVulkan so loading can already use it
+	JobSystem m_JobSystem;
+	JobSystemSettings m_JobSystemSettings;
+
+	// transient CPU data of the frames in flight, a frame's arena is rewound after its timeline wait
+	FrameArena m_FrameArena;
 
 	// Vulkan members
 	VkInstance m_VInstance = nullptr;
@@ -113,18 +566,94 @@ private:
 	Device m_Device;
 	SwapChain m_SwapChain;
 
+	// released resources are destroyed once the GPU has finished the frames using them, the pools
+	// have to outlive the owners below
+	ResourcePool<GpuMesh> m_Meshes;
+	ResourcePool<VkPipeline> m_Pipelines;
+
 	VkQueue m_GraphicsQueue;
 	VkQueue m_PresentQueue;
 
 	VkRenderPass m_MainRenderPass;
 	VkDescriptorSetLayout m_DescriptorSetLayout;
 	VkPipelineLayout m_PipelineLayout;
-	VkPipeline m_GraphicsPipeline;
+	UniqueResource<VkPipeline> m_GraphicsPipeline;
 
 	std::vector<UniformBuffer> m_UniformBuffers{};
-	VkDescriptorPool m_DescriptorPool;
+	DescriptorAllocator m_DescriptorAllocator;
 	std::vector<VkDescriptorSet> m_DescriptorSets;
 
+	// per-instance data, one buffer per frame in flight
+	std::vector<InstanceBuffer> m_InstanceBuffers{};
+
+	// world matrices of all instances, the index of a transform is its instance
+	TransformStore m_Transforms;
+	// serial of the transform update last written to each frame's instance buffer
+	std::vector<uint64_t> m_WrittenTransformSerials;
+	// world bounds of all instances, the index of an object is its instance
+	SceneBvh m_SceneBvh;
+	// renderable entities, culling and draw building stream through their chunks
+	EntityStore m_Entities;
+	// serial of the transform update last copied into the entities
+	uint64_t m_SyncedTransformSerial = 0;
+	// the renderable using each transform, the transforms of destroyed ones are reused
+	std::vector<Entity> m_TransformEntities;
+	std::vector<uint32_t> m_FreeTransforms;
+	const uint32_t m_MaxInstances = 1024;
+
+	BindlessTextureTable m_TextureTable;
+
+	DrawQueue m_DrawQueue;
+	CommandEncoder m_CommandEncoder;
+	BindStatistics m_UnsortedBindStatistics;
+
+	// used for occlusion culling, the depth prepass draws the instances visible last frame
+	OcclusionCuller m_OcclusionCuller;
+	UniqueResource<VkPipeline> m_DepthPrepassPipeline;
+	DrawQueue m_DepthPrepassQueue;
+	glm::mat4 m_ViewProjection = glm::mat4(1.0f);
+
+	// images and buffers imported into the render graphs, owned by the renderer and its passes
+	struct RenderGraphResources
+	{
+		RenderGraphResource m_Depth = 0;
+		RenderGraphResource m_Pyramid = 0;
+		RenderGraphResource m_Visibility = 0;
+		RenderGraphResource m_PrepassDraws = 0;
+		RenderGraphResource m_Draws = 0;
+
+		RenderGraphResource m_SwapChain = 0;
+		RenderGraphResource m_SceneColor = 0;
+		RenderGraphResource m_Velocity = 0;
+		RenderGraphResource m_History = 0;
+		RenderGraphResource m_PreviousHistory = 0;
+		RenderGraphResource m_Offscreen = 0;
+		RenderGraphResource m_Upscaled = 0;
+		RenderGraphResource m_UpscalerOutput = 0;
+	};
+
+	// the passes before and after the main render pass, rebuilt together with it
+	RenderGraph m_PrepassGraph;
+	RenderGraph m_PostProcessGraph;
+	RenderGraphResources m_GraphResources;
+	RenderGraphPass m_DepthPrepass = 0;
+
+	// used for CPU occlusion culling, occluders are rasterized at a fixed low resolution
+	SoftwareOcclusionCuller m_SoftwareOcclusionCuller;
+	static constexpr uint32_t s_SoftwareOcclusionWidth = 320;
+	static constexpr uint32_t s_SoftwareOcclusionHeight = 192;
+
+	ClusteredLightCuller m_LightCuller;
+	std::vector<PointLight> m_PointLights;
+	glm::vec3 m_AmbientLight = glm::vec3(1.0f);
+	const uint32_t m_MaxLights = 4096;
+
+	// compute work independent of the frame's rasterization, submitted to the compute queue if there is one
+	AsyncComputeScheduler m_AsyncCompute;
+
+	// G-buffer and lighting subpass, only used with the deferred shading path
+	DeferredLighting m_DeferredLighting;
+
 	std::vector<VkFramebuffer> m_Framebuffers;
 
 	VkCommandPool m_CommandPool;
@@ -132,18 +661,37 @@ private:
 
 	std::vector<VkSemaphore> m_ImageAcquiredSemaphores;
 	std::vector<VkSemaphore> m_RenderFinishedSemaphores;
-	std::vector<VkFence> m_InFlightFences;
+	// binary semaphores are kept for acquire & present, frames are throttled with the graphics timeline
+	std::vector<uint64_t> m_FrameTimelineValues;
 	uint32_t m_CurrentFrame = 0;
 
-	VertexBuffer m_VertexBuffer;
-	IndexBuffer m_IndexBuffer;
+	DeferredDestructionQueue m_DeferredDestruction;
+
+	UniqueResource<GpuMesh> m_TestMesh;
 
 	Model m_TestModel;
+	Entity m_TestModelEntity;
 
 	Image m_DepthImage;
 
 	// used for MSAA
 	Image m_ColorImage;
 
+	// used for TAA
+	TemporalAA m_TemporalAA;
+	glm::mat4 m_PreviousViewProjection = glm::mat4(1.0f);
+
+	// used for dynamic resolution and spatial upscaling, allocated at swap chain resolution and
+	// partially rendered to
+	Image m_OffscreenImage;
+	const VkFormat m_OffscreenFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+	GpuTimer m_GpuTimer;
+	DynamicResolution m_DynamicResolution;
+	SpatialUpscaler m_SpatialUpscaler;
+	float m_GpuFrameTime = 0.0f;
+
+	RenderSettings m_RenderSettings;
+
 	bool m_FrameBufferResized = false;
 };
\ No newline at end of file
@@ -22,6 +22,7 @@
 #include "vRenderer/helpers/helpers.h"
 #include "vRenderer/helper_structs/Mesh.h"
 #include "vRenderer/helper_structs/RenderingHelpers.h"
+#include "vRenderer/helper_structs/RenderSettings.h"
 #include "vRenderer/helper_structs/Vertex.h"
 
 #endif //PCH_H
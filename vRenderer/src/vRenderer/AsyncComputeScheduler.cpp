@@ -0,0 +1,155 @@
+#include "pch.h"
+#include "vRenderer/AsyncComputeScheduler.h"
+
+#include <stdexcept>
+
+#include "vRenderer/Device.h"
+#include "vRenderer/helpers/VulkanHelpers.h"
+
+AsyncComputeScheduler::AsyncComputeScheduler()
+= default;
+
+AsyncComputeScheduler::~AsyncComputeScheduler()
+= default;
+
+void AsyncComputeScheduler::Create(const Device& a_Device, const uint32_t a_FramesInFlight)
+{
+	// work is only submitted to the compute queue if it is a separate one
+	if (!a_Device.HasAsyncCompute())
+	{
+		return;
+	}
+
+	VkCommandPoolCreateInfo t_CommandPoolCreateInfo = {};
+	t_CommandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	t_CommandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	t_CommandPoolCreateInfo.queueFamilyIndex = a_Device.GetComputeQueueFamily();
+
+	if (vkCreateCommandPool(a_Device.GetLogicalDevice(), &t_CommandPoolCreateInfo, nullptr, &m_CommandPool) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not create compute Command Pool!");
+	}
+
+	m_CommandBuffers.resize(a_FramesInFlight);
+
+	VkCommandBufferAllocateInfo t_AllocateInfo = {};
+	t_AllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	t_AllocateInfo.commandPool = m_CommandPool;
+	t_AllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	t_AllocateInfo.commandBufferCount = a_FramesInFlight;
+
+	if (vkAllocateCommandBuffers(a_Device.GetLogicalDevice(), &t_AllocateInfo, m_CommandBuffers.data()) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not allocate compute Command Buffers!");
+	}
+}
+
+void AsyncComputeScheduler::Destroy(const VkDevice& a_LogicalDevice)
+{
+	// the command buffers are freed with the pool
+	vkDestroyCommandPool(a_LogicalDevice, m_CommandPool, nullptr);
+	m_CommandPool = VK_NULL_HANDLE;
+	m_CommandBuffers.clear();
+	m_ScheduledWork.clear();
+}
+
+void AsyncComputeScheduler::Schedule(std::function<void(VkCommandBuffer)> a_Record, const VkPipelineStageFlags a_DstStage,
+                                     const VkAccessFlags a_DstAccess)
+{
+	m_ScheduledWork.push_back({std::move(a_Record), a_DstStage, a_DstAccess});
+}
+
+void AsyncComputeScheduler::Submit(const Device& a_Device, const uint32_t a_Frame, const uint64_t a_GraphicsWaitValue)
+{
+	if (m_ScheduledWork.empty())
+	{
+		return;
+	}
+
+	// the graphics submission of the frame waited on this one, so the host wait for the frame
+	// guarantees the command buffer has finished executing
+	const VkCommandBuffer t_CommandBuffer = m_CommandBuffers[a_Frame];
+	vkResetCommandBuffer(t_CommandBuffer, 0);
+
+	VkCommandBufferBeginInfo t_BeginInfo = {};
+	t_BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	t_BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	if (vkBeginCommandBuffer(t_CommandBuffer, &t_BeginInfo) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not begin recording the compute Command Buffer!");
+	}
+
+	// the semaphore wait of the graphics submission makes the results visible, the consumer
+	// accesses are not needed
+	VkAccessFlags t_DstAccess = 0;
+	RecordScheduledWork(t_CommandBuffer, m_PendingWaitStage, t_DstAccess);
+
+	if (vkEndCommandBuffer(t_CommandBuffer) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not record the compute Command Buffer!");
+	}
+
+	VkSubmitInfo t_SubmitInfo = {};
+	t_SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	t_SubmitInfo.commandBufferCount = 1;
+	t_SubmitInfo.pCommandBuffers = &t_CommandBuffer;
+
+	// only wait for graphics work the results depend on, anything else overlaps
+	const VkSemaphore t_WaitSemaphore = a_Device.GetGraphicsTimeline().GetSemaphore();
+	const VkPipelineStageFlags t_WaitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+	if (a_GraphicsWaitValue > 0)
+	{
+		t_SubmitInfo.waitSemaphoreCount = 1;
+		t_SubmitInfo.pWaitSemaphores = &t_WaitSemaphore;
+		t_SubmitInfo.pWaitDstStageMask = &t_WaitStage;
+	}
+
+	m_PendingWaitValue = a_Device.GetComputeTimeline().Submit(a_Device.GetComputeQueue(), t_SubmitInfo,
+	                                                          &a_GraphicsWaitValue);
+}
+
+void AsyncComputeScheduler::RecordInline(VkCommandBuffer a_CommandBuffer)
+{
+	if (m_ScheduledWork.empty())
+	{
+		return;
+	}
+
+	VkPipelineStageFlags t_DstStage = 0;
+	VkAccessFlags t_DstAccess = 0;
+	RecordScheduledWork(a_CommandBuffer, t_DstStage, t_DstAccess);
+
+	InsertMemoryBarrier(a_CommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+	                    t_DstStage, t_DstAccess);
+}
+
+void AsyncComputeScheduler::AddGraphicsWait(const Device& a_Device, FrameVector<VkSemaphore>& a_Semaphores,
+                                            FrameVector<VkPipelineStageFlags>& a_Stages, FrameVector<uint64_t>& a_Values)
+{
+	if (m_PendingWaitValue == 0)
+	{
+		return;
+	}
+
+	a_Semaphores.push_back(a_Device.GetComputeTimeline().GetSemaphore());
+	a_Stages.push_back(m_PendingWaitStage);
+	a_Values.push_back(m_PendingWaitValue);
+
+	m_PendingWaitValue = 0;
+	m_PendingWaitStage = 0;
+}
+
+void AsyncComputeScheduler::RecordScheduledWork(VkCommandBuffer a_CommandBuffer, VkPipelineStageFlags& a_DstStage,
+                                                VkAccessFlags& a_DstAccess)
+{
+	for (const ScheduledWork& t_Work : m_ScheduledWork)
+	{
+		t_Work.m_Record(a_CommandBuffer);
+		a_DstStage |= t_Work.m_DstStage;
+		a_DstAccess |= t_Work.m_DstAccess;
+	}
+
+	m_ScheduledWork.clear();
+}
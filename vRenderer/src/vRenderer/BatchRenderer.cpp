@@ -0,0 +1,187 @@
+#include "pch.h"
+#include "vRenderer/BatchRenderer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "vRenderer/PngWriter.h"
+#include "vRenderer/vRenderer.h"
+#include "vRenderer/camera/Camera.h"
+
+BatchRenderer::BatchRenderer()
+= default;
+
+BatchRenderer::~BatchRenderer()
+= default;
+
+void BatchRenderer::Run(VRenderer& a_Renderer, Camera& a_Camera, const std::vector<BatchShot>& a_Shots,
+                        const BatchJobSettings& a_Settings)
+{
+	if (!a_Renderer.IsHeadless())
+	{
+		throw std::runtime_error("Error! Batch jobs require a headless renderer!");
+	}
+
+	const glm::ivec2 t_Extent = a_Renderer.GetWindowExtent();
+	a_Camera.UpdateAspectRatio(t_Extent);
+
+	m_Jobs.clear();
+	m_FreeBuffers.assign(std::max(a_Settings.m_MaxQueuedFrames, 1u), {});
+	m_Finished = false;
+	m_Error = nullptr;
+
+	std::vector<std::thread> t_Encoders;
+	for (uint32_t i = 0; i < std::max(a_Settings.m_EncoderThreads, 1u); i++)
+	{
+		t_Encoders.emplace_back(&BatchRenderer::EncodeLoop, this, std::cref(a_Settings),
+		                        VkExtent2D{static_cast<uint32_t>(t_Extent.x), static_cast<uint32_t>(t_Extent.y)});
+	}
+
+	try
+	{
+		for (size_t i = 0; i < a_Shots.size(); i++)
+		{
+			a_Camera.SetPosition(a_Shots[i].m_CameraPosition);
+			a_Camera.UpdateViewMat(a_Shots[i].m_CameraTarget);
+			for (const BatchPose& t_Pose : a_Shots[i].m_Poses)
+			{
+				a_Renderer.SetRenderableTransform(t_Pose.m_Entity, t_Pose.m_Transform);
+			}
+
+			// shots are unrelated views, nothing is accumulated across them
+			a_Renderer.ResetTemporalHistory();
+			a_Renderer.Render(a_Camera);
+
+			// the previous shot has usually finished while this one was recorded, waiting for it
+			// leaves the GPU busy with this one
+			if (i > 0)
+			{
+				QueueReadback(a_Renderer, i - 1, 1);
+			}
+		}
+
+		if (!a_Shots.empty())
+		{
+			QueueReadback(a_Renderer, a_Shots.size() - 1, 0);
+		}
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> t_Lock(m_Mutex);
+		if (!m_Error)
+		{
+			m_Error = std::current_exception();
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> t_Lock(m_Mutex);
+		m_Finished = true;
+	}
+	m_JobQueued.notify_all();
+
+	for (std::thread& t_Encoder : t_Encoders)
+	{
+		t_Encoder.join();
+	}
+
+	if (m_Error)
+	{
+		std::rethrow_exception(m_Error);
+	}
+}
+
+std::string BatchRenderer::GetOutputPath(const BatchJobSettings& a_Settings, const size_t a_Index)
+{
+	std::ostringstream t_Path;
+	t_Path << a_Settings.m_OutputPrefix << std::setw(6) << std::setfill('0') << a_Index
+		<< (a_Settings.m_Format == BatchImageFormat::Png ? ".png" : ".rgba");
+	return t_Path.str();
+}
+
+void BatchRenderer::QueueReadback(VRenderer& a_Renderer, const size_t a_Index, const uint32_t a_FramesAgo)
+{
+	std::vector<uint8_t> t_Pixels;
+
+	{
+		std::unique_lock<std::mutex> t_Lock(m_Mutex);
+		m_BufferFreed.wait(t_Lock, [this] { return !m_FreeBuffers.empty() || m_Error; });
+
+		if (m_Error)
+		{
+			std::rethrow_exception(m_Error);
+		}
+
+		t_Pixels = std::move(m_FreeBuffers.back());
+		m_FreeBuffers.pop_back();
+	}
+
+	// the buffers are reused, so after the first frames this does not allocate
+	a_Renderer.ReadbackFrame(t_Pixels, a_FramesAgo);
+
+	{
+		std::lock_guard<std::mutex> t_Lock(m_Mutex);
+		m_Jobs.push_back({a_Index, std::move(t_Pixels)});
+	}
+	m_JobQueued.notify_one();
+}
+
+void BatchRenderer::EncodeLoop(const BatchJobSettings& a_Settings, const VkExtent2D a_Extent)
+{
+	while (true)
+	{
+		EncodeJob t_Job;
+
+		{
+			std::unique_lock<std::mutex> t_Lock(m_Mutex);
+			m_JobQueued.wait(t_Lock, [this] { return !m_Jobs.empty() || m_Finished; });
+
+			if (m_Jobs.empty())
+			{
+				return;
+			}
+
+			t_Job = std::move(m_Jobs.front());
+			m_Jobs.pop_front();
+		}
+
+		try
+		{
+			const std::string t_Path = GetOutputPath(a_Settings, t_Job.m_Index);
+
+			if (a_Settings.m_Format == BatchImageFormat::Png)
+			{
+				PngWriter::WriteImage(t_Path, t_Job.m_Pixels.data(), a_Extent.width, a_Extent.height);
+			}
+			else
+			{
+				std::ofstream t_File(t_Path, std::ios::binary);
+				t_File.write(reinterpret_cast<const char*>(t_Job.m_Pixels.data()),
+				             static_cast<std::streamsize>(t_Job.m_Pixels.size()));
+
+				if (!t_File)
+				{
+					throw std::runtime_error("Error! Could not write raw image!");
+				}
+			}
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> t_Lock(m_Mutex);
+			if (!m_Error)
+			{
+				m_Error = std::current_exception();
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> t_Lock(m_Mutex);
+			m_FreeBuffers.push_back(std::move(t_Job.m_Pixels));
+		}
+		m_BufferFreed.notify_one();
+	}
+}
@@ -0,0 +1,227 @@
+#include "pch.h"
+#include "vRenderer/BindlessTextureTable.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#include "vRenderer/Device.h"
+
+BindlessTextureTable::BindlessTextureTable()
+= default;
+
+BindlessTextureTable::~BindlessTextureTable()
+= default;
+
+void BindlessTextureTable::Create(const Device& a_Device, const uint32_t a_Capacity)
+{
+	const VkDevice t_LogicalDevice = a_Device.GetLogicalDevice();
+
+	m_Capacity = std::min(a_Capacity, a_Device.GetMaxSampledImages());
+
+	CreateSampler(a_Device);
+
+	// binding 0 is the shared sampler, binding 1 the texture array
+	std::array<VkDescriptorSetLayoutBinding, 2> t_Bindings = {};
+	t_Bindings[0].binding = 0;
+	t_Bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+	t_Bindings[0].descriptorCount = 1;
+	t_Bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	t_Bindings[0].pImmutableSamplers = &m_Sampler;
+
+	t_Bindings[1].binding = 1;
+	t_Bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+	t_Bindings[1].descriptorCount = m_Capacity;
+	t_Bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	// slots that were never written may stay empty, and slots may be written while the set is bound
+	// as long as the draws in flight do not sample them
+	std::array<VkDescriptorBindingFlags, 2> t_BindingFlags = {
+		0,
+		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+		VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT
+	};
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo t_BindingFlagsCreateInfo = {};
+	t_BindingFlagsCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	t_BindingFlagsCreateInfo.bindingCount = static_cast<uint32_t>(t_BindingFlags.size());
+	t_BindingFlagsCreateInfo.pBindingFlags = t_BindingFlags.data();
+
+	VkDescriptorSetLayoutCreateInfo t_DescriptorSetLayoutCreateInfo = {};
+	t_DescriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	t_DescriptorSetLayoutCreateInfo.pNext = &t_BindingFlagsCreateInfo;
+	t_DescriptorSetLayoutCreateInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	t_DescriptorSetLayoutCreateInfo.bindingCount = static_cast<uint32_t>(t_Bindings.size());
+	t_DescriptorSetLayoutCreateInfo.pBindings = t_Bindings.data();
+
+	if (vkCreateDescriptorSetLayout(t_LogicalDevice, &t_DescriptorSetLayoutCreateInfo, nullptr, &m_DescriptorSetLayout) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Failed to create bindless texture descriptor set layout!");
+	}
+
+	// pool
+	std::array<VkDescriptorPoolSize, 2> t_PoolSizes = {};
+	t_PoolSizes[0].type = VK_DESCRIPTOR_TYPE_SAMPLER;
+	t_PoolSizes[0].descriptorCount = 1;
+	t_PoolSizes[1].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+	t_PoolSizes[1].descriptorCount = m_Capacity;
+
+	VkDescriptorPoolCreateInfo t_DescriptorPoolCreateInfo = {};
+	t_DescriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	t_DescriptorPoolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	t_DescriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(t_PoolSizes.size());
+	t_DescriptorPoolCreateInfo.pPoolSizes = t_PoolSizes.data();
+	t_DescriptorPoolCreateInfo.maxSets = 1;
+
+	if (vkCreateDescriptorPool(t_LogicalDevice, &t_DescriptorPoolCreateInfo, nullptr, &m_DescriptorPool) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not create bindless texture Descriptor Pool!");
+	}
+
+	VkDescriptorSetAllocateInfo t_AllocateInfo = {};
+	t_AllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	t_AllocateInfo.descriptorPool = m_DescriptorPool;
+	t_AllocateInfo.descriptorSetCount = 1;
+	t_AllocateInfo.pSetLayouts = &m_DescriptorSetLayout;
+
+	if (vkAllocateDescriptorSets(t_LogicalDevice, &t_AllocateInfo, &m_DescriptorSet) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not allocate bindless texture Descriptor Set!");
+	}
+
+	m_FreeSlots.clear();
+	m_PendingReleases.clear();
+	m_NextSlot = 0;
+}
+
+void BindlessTextureTable::Destroy(const VkDevice& a_LogicalDevice)
+{
+	// destroying the pool frees the set
+	vkDestroyDescriptorPool(a_LogicalDevice, m_DescriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(a_LogicalDevice, m_DescriptorSetLayout, nullptr);
+	vkDestroySampler(a_LogicalDevice, m_Sampler, nullptr);
+
+	m_DescriptorPool = VK_NULL_HANDLE;
+	m_DescriptorSetLayout = VK_NULL_HANDLE;
+	m_DescriptorSet = VK_NULL_HANDLE;
+	m_Sampler = VK_NULL_HANDLE;
+}
+
+uint32_t BindlessTextureTable::Register(const VkDevice& a_LogicalDevice, VkImageView a_ImageView)
+{
+	uint32_t t_Index;
+
+	if (!m_FreeSlots.empty())
+	{
+		t_Index = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+	}
+	else if (m_NextSlot < m_Capacity)
+	{
+		t_Index = m_NextSlot++;
+	}
+	else
+	{
+		throw std::runtime_error("Error! Bindless texture table is full!");
+	}
+
+	VkDescriptorImageInfo t_ImageInfo = {};
+	t_ImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	t_ImageInfo.imageView = a_ImageView;
+	t_ImageInfo.sampler = VK_NULL_HANDLE;
+
+	VkWriteDescriptorSet t_DescriptorWrite = {};
+	t_DescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	t_DescriptorWrite.dstSet = m_DescriptorSet;
+	t_DescriptorWrite.dstBinding = 1;
+	t_DescriptorWrite.dstArrayElement = t_Index;
+	t_DescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+	t_DescriptorWrite.descriptorCount = 1;
+	t_DescriptorWrite.pImageInfo = &t_ImageInfo;
+
+	vkUpdateDescriptorSets(a_LogicalDevice, 1, &t_DescriptorWrite, 0, nullptr);
+
+	return t_Index;
+}
+
+void BindlessTextureTable::Release(const uint32_t a_Index, const uint64_t a_RetireValue)
+{
+	if (a_Index >= m_NextSlot)
+	{
+		throw std::runtime_error("Error! Released bindless texture slot was never registered!");
+	}
+
+	m_PendingReleases.push_back({a_Index, a_RetireValue});
+}
+
+void BindlessTextureTable::Collect(const uint64_t a_CompletedValue)
+{
+	// slots are released with increasing retire values, so the oldest release completes first
+	while (!m_PendingReleases.empty() && m_PendingReleases.front().m_RetireValue <= a_CompletedValue)
+	{
+		m_FreeSlots.push_back(m_PendingReleases.front().m_Index);
+		m_PendingReleases.pop_front();
+	}
+}
+
+void BindlessTextureTable::Bind(VkCommandBuffer a_CommandBuffer, const VkPipelineBindPoint a_BindPoint,
+                                VkPipelineLayout a_PipelineLayout, const uint32_t a_Set) const
+{
+	vkCmdBindDescriptorSets(a_CommandBuffer, a_BindPoint, a_PipelineLayout, a_Set, 1, &m_DescriptorSet, 0, nullptr);
+}
+
+VkDescriptorSetLayout BindlessTextureTable::GetDescriptorSetLayout() const
+{
+	return m_DescriptorSetLayout;
+}
+
+VkDescriptorSet BindlessTextureTable::GetDescriptorSet() const
+{
+	return m_DescriptorSet;
+}
+
+uint32_t BindlessTextureTable::GetCapacity() const
+{
+	return m_Capacity;
+}
+
+uint32_t BindlessTextureTable::GetUsedSlotCount() const
+{
+	return m_NextSlot - static_cast<uint32_t>(m_FreeSlots.size());
+}
+
+/// <summary>
+/// 	Creates the sampler shared by all textures in the table. Mip levels are not clamped so
+/// 	textures with any number of mips can use it.
+/// </summary>
+/// <exception cref="std::runtime_error">	Raised when the sampler could not be created.</exception>
+/// <param name="a_Device">	The device.</param>
+
+void BindlessTextureTable::CreateSampler(const Device& a_Device)
+{
+	VkPhysicalDeviceProperties t_DeviceProperties = {};
+	vkGetPhysicalDeviceProperties(a_Device.GetPhysicalDevice(), &t_DeviceProperties);
+
+	VkSamplerCreateInfo t_SamplerCreateInfo = {};
+	t_SamplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	t_SamplerCreateInfo.magFilter = VK_FILTER_LINEAR;
+	t_SamplerCreateInfo.minFilter = VK_FILTER_LINEAR;
+	t_SamplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	t_SamplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	t_SamplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	t_SamplerCreateInfo.anisotropyEnable = VK_TRUE;
+	t_SamplerCreateInfo.maxAnisotropy = t_DeviceProperties.limits.maxSamplerAnisotropy;
+	t_SamplerCreateInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+	t_SamplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+	t_SamplerCreateInfo.compareEnable = VK_FALSE;
+	t_SamplerCreateInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+	t_SamplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+	t_SamplerCreateInfo.mipLodBias = 0.0f;
+	t_SamplerCreateInfo.minLod = 0.0f;
+	t_SamplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+	if (vkCreateSampler(a_Device.GetLogicalDevice(), &t_SamplerCreateInfo, nullptr, &m_Sampler) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Failed to create bindless texture Sampler!");
+	}
+}
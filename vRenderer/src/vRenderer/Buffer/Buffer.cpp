@@ -10,7 +10,8 @@ Buffer::Buffer()
 Buffer::~Buffer()
 = default;
 
-void Buffer::CreateBuffer(VkDeviceSize a_Size, VkBufferUsageFlags a_UsageFlag, VkMemoryPropertyFlags a_PropertyFlags, const Device& a_Device)
+void Buffer::CreateBuffer(VkDeviceSize a_Size, VkBufferUsageFlags a_UsageFlag, VkMemoryPropertyFlags a_PropertyFlags, const Device& a_Device,
+                          const bool a_SharedWithCompute)
 {
 	VkBufferCreateInfo t_CreateInfo = {};
 	t_CreateInfo.size = a_Size;
@@ -18,6 +19,16 @@ void Buffer::CreateBuffer(VkDeviceSize a_Size, VkBufferUsageFlags a_UsageFlag, V
 	t_CreateInfo.usage = a_UsageFlag;
 	t_CreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+	// concurrent sharing avoids ownership transfers for buffers written on one queue and read on the other
+	const uint32_t t_QueueFamilies[] = {a_Device.GetGraphicsQueueFamily(), a_Device.GetComputeQueueFamily()};
+
+	if (a_SharedWithCompute && a_Device.HasAsyncCompute())
+	{
+		t_CreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		t_CreateInfo.queueFamilyIndexCount = 2;
+		t_CreateInfo.pQueueFamilyIndices = t_QueueFamilies;
+	}
+
 	if (vkCreateBuffer(a_Device.GetLogicalDevice(), &t_CreateInfo, nullptr, &m_Buffer))
 	{
 		throw std::runtime_error("Error: Could not create Vertex VertexBuffer!");
@@ -49,10 +60,10 @@ const VkBuffer& Buffer::GetBuffer() const
 	return m_Buffer;
 }
 
-void Buffer::CopyInto(VkBuffer a_DstBuffer, VkDevice a_LogicalDevice, VkDeviceSize a_DeviceSize, VkQueue a_GraphicsQueue,
+void Buffer::CopyInto(VkBuffer a_DstBuffer, const Device& a_Device, VkDeviceSize a_DeviceSize, VkQueue a_GraphicsQueue,
 	              VkCommandPool a_CommandPool)
 {
-	VkCommandBuffer t_CmdBuffer = BeginSingleTimeCommand(a_CommandPool, a_LogicalDevice);
+	VkCommandBuffer t_CmdBuffer = BeginSingleTimeCommand(a_CommandPool, a_Device.GetLogicalDevice());
 
 	// copy data
 	VkBufferCopy t_CopyRegion = {};
@@ -63,14 +74,14 @@ void Buffer::CopyInto(VkBuffer a_DstBuffer, VkDevice a_LogicalDevice, VkDeviceSi
 	vkCmdCopyBuffer(t_CmdBuffer, m_Buffer, a_DstBuffer, 1, &t_CopyRegion);
 
 	// submit command buffer to complete copying
-	EndSingleTimeCommands(t_CmdBuffer, a_GraphicsQueue, a_LogicalDevice, a_CommandPool);
+	EndSingleTimeCommands(t_CmdBuffer, a_GraphicsQueue, a_Device, a_CommandPool);
 }
 
 void Buffer::CopyBufferToImage(const VkImage& a_Image, const uint32_t a_Width, const uint32_t a_Height,
-                               VkCommandPool& a_CommandPool, const VkDevice& a_LogicalDevice,
+                               VkCommandPool& a_CommandPool, const Device& a_Device,
                                const VkQueue& a_GraphicsQueue) const
 {
-	VkCommandBuffer t_CommandBuffer = BeginSingleTimeCommand(a_CommandPool,a_LogicalDevice);
+	VkCommandBuffer t_CommandBuffer = BeginSingleTimeCommand(a_CommandPool,a_Device.GetLogicalDevice());
 
 	VkBufferImageCopy t_CopyRegion;
 	t_CopyRegion.bufferOffset = 0;
@@ -94,7 +105,7 @@ void Buffer::CopyBufferToImage(const VkImage& a_Image, const uint32_t a_Width, c
 		&t_CopyRegion
 	);
 
-	EndSingleTimeCommands(t_CommandBuffer, a_GraphicsQueue, a_LogicalDevice, a_CommandPool);
+	EndSingleTimeCommands(t_CommandBuffer, a_GraphicsQueue, a_Device, a_CommandPool);
 }
 
 VkMemoryRequirements Buffer::GetMemoryRequirements(const VkDevice& a_LogicalDevice) const
@@ -106,6 +117,20 @@ VkMemoryRequirements Buffer::GetMemoryRequirements(const VkDevice& a_LogicalDevi
 }
 
 uint32_t Buffer::GetMemoryType(const Device& a_Device, uint32_t a_TypeFilter, VkMemoryPropertyFlags a_Properties)
+{
+	uint32_t t_TypeIndex = 0;
+
+	if (FindMemoryType(a_Device, a_TypeFilter, a_Properties, t_TypeIndex))
+	{
+		return t_TypeIndex;
+	}
+
+	// if none can be found, return runtime error
+	throw std::runtime_error("Error: Could not find suitable memory type!");
+}
+
+bool Buffer::FindMemoryType(const Device& a_Device, const uint32_t a_TypeFilter, const VkMemoryPropertyFlags a_Properties,
+                            uint32_t& a_TypeIndex)
 {
 	// get available types of memory
 	VkPhysicalDeviceMemoryProperties t_MemoryProperties;
@@ -117,12 +142,12 @@ uint32_t Buffer::GetMemoryType(const Device& a_Device, uint32_t a_TypeFilter, Vk
 		if (a_TypeFilter & (1 << i) 
 			&& (t_MemoryProperties.memoryTypes[i].propertyFlags & a_Properties) == a_Properties)
 		{
-			return i;
+			a_TypeIndex = i;
+			return true;
 		}
 	}
 
-	// if none can be found, return runtime error
-	throw std::runtime_error("Error: Could not find suitable memory type!");
+	return false;
 }
 
 void Buffer::AllocateMemory(const Device& a_Device, VkMemoryPropertyFlags a_Properties)
@@ -141,7 +166,7 @@ void Buffer::AllocateMemory(const Device& a_Device, VkMemoryPropertyFlags a_Prop
 	}
 }
 
-void Buffer::FillBuffer(VkDeviceSize a_BufferSize, const VkDevice& a_LogicalDevice, void* a_Data)
+void Buffer::FillBuffer(VkDeviceSize a_BufferSize, const VkDevice& a_LogicalDevice, const void* a_Data)
 {
 	vkMapMemory(a_LogicalDevice, m_Memory, 0, a_BufferSize, 0, &m_Data);
 	memcpy(m_Data, a_Data, static_cast<size_t>(a_BufferSize));
@@ -0,0 +1,182 @@
+#include "pch.h"
+#include "vRenderer/Buffer/ExternalBuffer.h"
+
+#include <stdexcept>
+
+#include "vRenderer/Device.h"
+
+ExternalBuffer::ExternalBuffer()
+= default;
+
+ExternalBuffer::~ExternalBuffer()
+= default;
+
+bool ExternalBuffer::SupportsFdExport(const Device& a_Device)
+{
+	if (!a_Device.IsExtensionEnabled(VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME))
+	{
+		return false;
+	}
+
+	VkPhysicalDeviceExternalBufferInfo t_BufferInfo = {};
+	t_BufferInfo.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_BUFFER_INFO;
+	t_BufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	t_BufferInfo.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+
+	VkExternalBufferProperties t_Properties = {};
+	t_Properties.sType = VK_STRUCTURE_TYPE_EXTERNAL_BUFFER_PROPERTIES;
+	vkGetPhysicalDeviceExternalBufferProperties(a_Device.GetPhysicalDevice(), &t_BufferInfo, &t_Properties);
+
+	return t_Properties.externalMemoryProperties.externalMemoryFeatures & VK_EXTERNAL_MEMORY_FEATURE_EXPORTABLE_BIT;
+}
+
+VkDeviceSize ExternalBuffer::GetHostPointerAlignment(const Device& a_Device)
+{
+	if (!a_Device.IsExtensionEnabled(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME))
+	{
+		return 0;
+	}
+
+	VkPhysicalDeviceExternalMemoryHostPropertiesEXT t_HostProperties = {};
+	t_HostProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT;
+
+	VkPhysicalDeviceProperties2 t_Properties = {};
+	t_Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	t_Properties.pNext = &t_HostProperties;
+	vkGetPhysicalDeviceProperties2(a_Device.GetPhysicalDevice(), &t_Properties);
+
+	return t_HostProperties.minImportedHostPointerAlignment;
+}
+
+void ExternalBuffer::CreateExportable(const Device& a_Device, const VkDeviceSize a_Size)
+{
+	CreateHandle(a_Device, a_Size, VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT);
+
+	const VkMemoryRequirements t_MemoryRequirements = GetMemoryRequirements(a_Device.GetLogicalDevice());
+
+	// a dedicated allocation is what importers of opaque handles expect on most drivers
+	VkMemoryDedicatedAllocateInfo t_DedicatedInfo = {};
+	t_DedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+	t_DedicatedInfo.buffer = m_Buffer;
+
+	VkExportMemoryAllocateInfo t_ExportInfo = {};
+	t_ExportInfo.sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO;
+	t_ExportInfo.pNext = &t_DedicatedInfo;
+	t_ExportInfo.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+
+	VkMemoryAllocateInfo t_AllocateInfo = {};
+	t_AllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	t_AllocateInfo.pNext = &t_ExportInfo;
+	t_AllocateInfo.allocationSize = t_MemoryRequirements.size;
+	t_AllocateInfo.memoryTypeIndex = GetMemoryType(a_Device, t_MemoryRequirements.memoryTypeBits,
+	                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	if (vkAllocateMemory(a_Device.GetLogicalDevice(), &t_AllocateInfo, nullptr, &m_Memory) != VK_SUCCESS)
+	{
+		vkDestroyBuffer(a_Device.GetLogicalDevice(), m_Buffer, nullptr);
+		throw std::runtime_error("Error! Could not allocate exportable buffer memory!");
+	}
+
+	vkBindBufferMemory(a_Device.GetLogicalDevice(), m_Buffer, m_Memory, 0);
+	m_AllocationSize = t_MemoryRequirements.size;
+}
+
+bool ExternalBuffer::CreateFromHostPointer(const Device& a_Device, void* a_Pointer, const VkDeviceSize a_Size)
+{
+	const auto t_GetHostPointerProperties = reinterpret_cast<PFN_vkGetMemoryHostPointerPropertiesEXT>(
+		vkGetDeviceProcAddr(a_Device.GetLogicalDevice(), "vkGetMemoryHostPointerPropertiesEXT"));
+
+	if (t_GetHostPointerProperties == nullptr)
+	{
+		return false;
+	}
+
+	VkMemoryHostPointerPropertiesEXT t_PointerProperties = {};
+	t_PointerProperties.sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT;
+
+	if (t_GetHostPointerProperties(a_Device.GetLogicalDevice(), VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+	                               a_Pointer, &t_PointerProperties) != VK_SUCCESS)
+	{
+		return false;
+	}
+
+	CreateHandle(a_Device, a_Size, VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT);
+
+	// the memory has to be both importable for the pointer and bindable to the buffer
+	const VkMemoryRequirements t_MemoryRequirements = GetMemoryRequirements(a_Device.GetLogicalDevice());
+	uint32_t t_TypeIndex = 0;
+
+	if (t_MemoryRequirements.size > a_Size ||
+		!FindMemoryType(a_Device, t_MemoryRequirements.memoryTypeBits & t_PointerProperties.memoryTypeBits,
+		                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, t_TypeIndex))
+	{
+		vkDestroyBuffer(a_Device.GetLogicalDevice(), m_Buffer, nullptr);
+		return false;
+	}
+
+	VkImportMemoryHostPointerInfoEXT t_ImportInfo = {};
+	t_ImportInfo.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT;
+	t_ImportInfo.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+	t_ImportInfo.pHostPointer = a_Pointer;
+
+	VkMemoryAllocateInfo t_AllocateInfo = {};
+	t_AllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	t_AllocateInfo.pNext = &t_ImportInfo;
+	t_AllocateInfo.allocationSize = a_Size;
+	t_AllocateInfo.memoryTypeIndex = t_TypeIndex;
+
+	if (vkAllocateMemory(a_Device.GetLogicalDevice(), &t_AllocateInfo, nullptr, &m_Memory) != VK_SUCCESS)
+	{
+		vkDestroyBuffer(a_Device.GetLogicalDevice(), m_Buffer, nullptr);
+		return false;
+	}
+
+	vkBindBufferMemory(a_Device.GetLogicalDevice(), m_Buffer, m_Memory, 0);
+	m_AllocationSize = a_Size;
+
+	return true;
+}
+
+int ExternalBuffer::ExportFd(const Device& a_Device) const
+{
+	const auto t_GetMemoryFd = reinterpret_cast<PFN_vkGetMemoryFdKHR>(
+		vkGetDeviceProcAddr(a_Device.GetLogicalDevice(), "vkGetMemoryFdKHR"));
+
+	VkMemoryGetFdInfoKHR t_GetFdInfo = {};
+	t_GetFdInfo.sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR;
+	t_GetFdInfo.memory = m_Memory;
+	t_GetFdInfo.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+
+	int t_Fd = -1;
+	if (t_GetMemoryFd == nullptr || t_GetMemoryFd(a_Device.GetLogicalDevice(), &t_GetFdInfo, &t_Fd) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not export the buffer memory!");
+	}
+
+	return t_Fd;
+}
+
+VkDeviceSize ExternalBuffer::GetAllocationSize() const
+{
+	return m_AllocationSize;
+}
+
+void ExternalBuffer::CreateHandle(const Device& a_Device, const VkDeviceSize a_Size,
+                                  const VkExternalMemoryHandleTypeFlags a_HandleTypes)
+{
+	VkExternalMemoryBufferCreateInfo t_ExternalInfo = {};
+	t_ExternalInfo.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO;
+	t_ExternalInfo.handleTypes = a_HandleTypes;
+
+	VkBufferCreateInfo t_CreateInfo = {};
+	t_CreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	t_CreateInfo.pNext = &t_ExternalInfo;
+	t_CreateInfo.size = a_Size;
+	t_CreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	t_CreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateBuffer(a_Device.GetLogicalDevice(), &t_CreateInfo, nullptr, &m_Buffer) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not create external buffer!");
+	}
+}
@@ -8,7 +8,7 @@ IndexBuffer::IndexBuffer()
 IndexBuffer::~IndexBuffer()
 = default;
 
-void IndexBuffer::CreateIndexBuffer(std::vector<uint32_t>& a_Indices, const Device& a_Device, VkQueue a_GraphicsQueue,
+void IndexBuffer::CreateIndexBuffer(const std::vector<uint32_t>& a_Indices, const Device& a_Device, VkQueue a_GraphicsQueue,
 	              VkCommandPool a_CommandPool)
 {
 	VkDeviceSize t_BufferSize = sizeof(a_Indices[0]) * a_Indices.size();
@@ -26,7 +26,7 @@ void IndexBuffer::CreateIndexBuffer(std::vector<uint32_t>& a_Indices, const Devi
 	             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, a_Device);
 
 	// copy data from staging buffer into index buffer
-	t_StagingBuffer.CopyInto(m_Buffer, a_Device.GetLogicalDevice(), t_BufferSize, a_GraphicsQueue, a_CommandPool);
+	t_StagingBuffer.CopyInto(m_Buffer, a_Device, t_BufferSize, a_GraphicsQueue, a_CommandPool);
 
 	// free buffer
 	t_StagingBuffer.DestroyBuffer(a_Device.GetLogicalDevice());
@@ -0,0 +1,42 @@
+#include "pch.h"
+#include "vRenderer/Buffer/InstanceBuffer.h"
+
+#include "vRenderer/Device.h"
+
+InstanceBuffer::InstanceBuffer()
+= default;
+
+InstanceBuffer::~InstanceBuffer()
+= default;
+
+void InstanceBuffer::CreateInstanceBuffer(const Device& a_Device, const uint32_t a_MaxInstances)
+{
+	const VkDeviceSize t_BufferSize = sizeof(InstanceData) * a_MaxInstances;
+	m_Capacity = a_MaxInstances;
+
+	CreateBuffer(t_BufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+	             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, a_Device);
+
+	// persistent mapping (get a pointer to write data to later)
+	vkMapMemory(a_Device.GetLogicalDevice(), m_Memory, 0, t_BufferSize, 0, &m_AccessPointer);
+}
+
+void InstanceBuffer::FillBuffer(const std::vector<InstanceData>& a_Instances)
+{
+	if (a_Instances.size() > m_Capacity)
+	{
+		throw std::runtime_error("Error! Too many instances for the Instance Buffer!");
+	}
+
+	memcpy(m_AccessPointer, a_Instances.data(), sizeof(InstanceData) * a_Instances.size());
+}
+
+uint32_t InstanceBuffer::GetCapacity() const
+{
+	return m_Capacity;
+}
+
+InstanceData* InstanceBuffer::GetMappedInstances() const
+{
+	return static_cast<InstanceData*>(m_AccessPointer);
+}
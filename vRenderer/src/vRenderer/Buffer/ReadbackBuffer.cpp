@@ -0,0 +1,67 @@
+#include "pch.h"
+#include "vRenderer/Buffer/ReadbackBuffer.h"
+
+#include <cstring>
+
+#include "vRenderer/Device.h"
+#include "vRenderer/helpers/VulkanHelpers.h"
+
+ReadbackBuffer::ReadbackBuffer()
+= default;
+
+ReadbackBuffer::~ReadbackBuffer()
+= default;
+
+void ReadbackBuffer::CreateReadbackBuffer(const Device& a_Device, const VkDeviceSize a_Size)
+{
+	m_Size = a_Size;
+
+	CreateBuffer(a_Size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, a_Device);
+
+	// persistent mapping (get a pointer to read data from later)
+	vkMapMemory(a_Device.GetLogicalDevice(), m_Memory, 0, a_Size, 0, &m_AccessPointer);
+}
+
+void ReadbackBuffer::RecordImageCopy(VkCommandBuffer a_CommandBuffer, VkImage a_Image, const VkExtent2D a_Extent,
+                                     const uint32_t a_TexelSize) const
+{
+	if (static_cast<VkDeviceSize>(a_Extent.width) * a_Extent.height * a_TexelSize > m_Size)
+	{
+		throw std::runtime_error("Error! Image does not fit into the Readback Buffer!");
+	}
+
+	// a row length and height of 0 pack the rows tightly
+	VkBufferImageCopy t_Region = {};
+	t_Region.bufferOffset = 0;
+	t_Region.bufferRowLength = 0;
+	t_Region.bufferImageHeight = 0;
+	t_Region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+	t_Region.imageOffset = {0, 0, 0};
+	t_Region.imageExtent = {a_Extent.width, a_Extent.height, 1};
+
+	vkCmdCopyImageToBuffer(a_CommandBuffer, a_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_Buffer, 1, &t_Region);
+
+	InsertMemoryBarrier(a_CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+	                    VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+}
+
+void ReadbackBuffer::Read(void* a_Data, const VkDeviceSize a_Size, const VkDeviceSize a_Offset) const
+{
+	if (a_Offset + a_Size > m_Size)
+	{
+		throw std::runtime_error("Error! Reading past the end of the Readback Buffer!");
+	}
+
+	memcpy(a_Data, static_cast<const char*>(m_AccessPointer) + a_Offset, static_cast<size_t>(a_Size));
+}
+
+const uint8_t* ReadbackBuffer::GetData() const
+{
+	return static_cast<const uint8_t*>(m_AccessPointer);
+}
+
+VkDeviceSize ReadbackBuffer::GetSize() const
+{
+	return m_Size;
+}
@@ -0,0 +1,51 @@
+#include "pch.h"
+#include "vRenderer/Buffer/StorageBuffer.h"
+
+#include <cstring>
+
+#include "vRenderer/Device.h"
+
+StorageBuffer::StorageBuffer()
+= default;
+
+StorageBuffer::~StorageBuffer()
+= default;
+
+void StorageBuffer::CreateStorageBuffer(const Device& a_Device, const VkDeviceSize a_Size, const bool a_HostVisible,
+                                        const VkBufferUsageFlags a_AdditionalUsage, const bool a_SharedWithCompute)
+{
+	m_Size = a_Size;
+	m_AccessPointer = nullptr;
+
+	const VkMemoryPropertyFlags t_Properties = a_HostVisible
+		                                           ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		                                           : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+	CreateBuffer(a_Size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | a_AdditionalUsage, t_Properties, a_Device, a_SharedWithCompute);
+
+	if (a_HostVisible)
+	{
+		// persistent mapping (get a pointer to write data to later)
+		vkMapMemory(a_Device.GetLogicalDevice(), m_Memory, 0, a_Size, 0, &m_AccessPointer);
+	}
+}
+
+void StorageBuffer::FillBuffer(const void* a_Data, const VkDeviceSize a_Size, const VkDeviceSize a_Offset)
+{
+	if (m_AccessPointer == nullptr)
+	{
+		throw std::runtime_error("Error! Storage Buffer is not host visible!");
+	}
+
+	if (a_Offset + a_Size > m_Size)
+	{
+		throw std::runtime_error("Error! Too much data for the Storage Buffer!");
+	}
+
+	memcpy(static_cast<char*>(m_AccessPointer) + a_Offset, a_Data, static_cast<size_t>(a_Size));
+}
+
+VkDeviceSize StorageBuffer::GetSize() const
+{
+	return m_Size;
+}
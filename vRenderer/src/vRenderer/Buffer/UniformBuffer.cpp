@@ -35,15 +35,8 @@ VkDescriptorSetLayout UniformBuffer::CreateDescriptorSetLayout(const VkDevice a_
 	t_UniformBufferObjectBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 	t_UniformBufferObjectBinding.pImmutableSamplers = nullptr;
 
-	// Sampler Binding
-	VkDescriptorSetLayoutBinding t_SamplerLayoutBinding;
-	t_SamplerLayoutBinding.binding = 1;
-	t_SamplerLayoutBinding.descriptorCount = 1;
-	t_SamplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	t_SamplerLayoutBinding.pImmutableSamplers = nullptr;
-	t_SamplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-	std::array<VkDescriptorSetLayoutBinding, 2> t_Bindings = {t_UniformBufferObjectBinding, t_SamplerLayoutBinding};
+	// textures are sampled through the bindless texture table in set 1
+	std::array<VkDescriptorSetLayoutBinding, 1> t_Bindings = {t_UniformBufferObjectBinding};
 
 	// create info
 	VkDescriptorSetLayoutCreateInfo t_DescriptorSetLayoutCreateInfo = {};
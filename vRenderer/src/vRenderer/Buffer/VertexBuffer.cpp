@@ -9,7 +9,7 @@ VertexBuffer::VertexBuffer()
 VertexBuffer::~VertexBuffer()
 = default;
 
-void VertexBuffer::CreateVertexBuffer(std::vector<Vertex>& a_Vertices, const Device& a_Device, VkQueue a_GraphicsQueue,
+void VertexBuffer::CreateVertexBuffer(const std::vector<Vertex>& a_Vertices, const Device& a_Device, VkQueue a_GraphicsQueue,
 	              VkCommandPool a_CommandPool)
 {
 	VkDeviceSize t_BufferSize = sizeof(a_Vertices[0]) * a_Vertices.size();
@@ -26,7 +26,7 @@ void VertexBuffer::CreateVertexBuffer(std::vector<Vertex>& a_Vertices, const Dev
 	CreateBuffer(t_BufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, a_Device);
 
 	// copy data from staging buffer into vertex buffer
-	t_StagingBuffer.CopyInto(m_Buffer, a_Device.GetLogicalDevice(), t_BufferSize, a_GraphicsQueue, a_CommandPool);
+	t_StagingBuffer.CopyInto(m_Buffer, a_Device, t_BufferSize, a_GraphicsQueue, a_CommandPool);
 
 	// free buffer
 	t_StagingBuffer.DestroyBuffer(a_Device.GetLogicalDevice());
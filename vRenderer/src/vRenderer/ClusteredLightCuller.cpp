@@ -0,0 +1,140 @@
+#include "pch.h"
+#include "vRenderer/ClusteredLightCuller.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <glm/trigonometric.hpp>
+
+#include "vRenderer/DescriptorAllocator.h"
+#include "vRenderer/Device.h"
+#include "vRenderer/camera/Camera.h"
+#include "vRenderer/helpers/VulkanHelpers.h"
+
+ClusteredLightCuller::ClusteredLightCuller()
+= default;
+
+ClusteredLightCuller::~ClusteredLightCuller()
+= default;
+
+void ClusteredLightCuller::Create(const Device& a_Device, DescriptorAllocator& a_DescriptorAllocator,
+                                  const uint32_t a_MaxLights, const uint32_t a_FramesInFlight)
+{
+	const VkDevice t_LogicalDevice = a_Device.GetLogicalDevice();
+	m_MaxLights = a_MaxLights;
+
+	// lights, light counts and light indices, written in compute and read in the fragment shader
+	std::vector<VkDescriptorSetLayoutBinding> t_Bindings(3);
+	for (uint32_t i = 0; i < t_Bindings.size(); i++)
+	{
+		t_Bindings[i].binding = i;
+		t_Bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		t_Bindings[i].descriptorCount = 1;
+		t_Bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+	}
+
+	m_CullPipeline.Create(t_LogicalDevice, "../vRenderer/assets/shaders/compiled/light_cull.spv", t_Bindings);
+
+	m_LightBuffers.resize(a_FramesInFlight);
+	m_ClusterLightCountBuffers.resize(a_FramesInFlight);
+	m_ClusterLightIndexBuffers.resize(a_FramesInFlight);
+
+	// the culling pass may run on the async compute queue while the lists are read on the graphics queue
+	for (uint32_t i = 0; i < a_FramesInFlight; i++)
+	{
+		m_LightBuffers[i].CreateStorageBuffer(a_Device, sizeof(ClusterParameters) + sizeof(PointLight) * a_MaxLights,
+		                                      true, 0, true);
+		m_ClusterLightCountBuffers[i].CreateStorageBuffer(a_Device, sizeof(uint32_t) * s_ClusterCount, false, 0, true);
+		m_ClusterLightIndexBuffers[i].CreateStorageBuffer(
+			a_Device, sizeof(uint32_t) * s_ClusterCount * s_MaxLightsPerCluster, false, 0, true);
+	}
+
+	CreateDescriptorSets(t_LogicalDevice, a_DescriptorAllocator);
+}
+
+void ClusteredLightCuller::Destroy(const VkDevice& a_LogicalDevice)
+{
+	// the descriptor sets are freed with the allocator's pools
+	m_DescriptorSets.clear();
+
+	for (size_t i = 0; i < m_LightBuffers.size(); i++)
+	{
+		m_LightBuffers[i].DestroyBuffer(a_LogicalDevice);
+		m_ClusterLightCountBuffers[i].DestroyBuffer(a_LogicalDevice);
+		m_ClusterLightIndexBuffers[i].DestroyBuffer(a_LogicalDevice);
+	}
+
+	m_LightBuffers.clear();
+	m_ClusterLightCountBuffers.clear();
+	m_ClusterLightIndexBuffers.clear();
+
+	m_CullPipeline.Destroy(a_LogicalDevice);
+}
+
+void ClusteredLightCuller::UpdateLights(const uint32_t a_Frame, const Camera& a_Camera, const VkExtent2D a_RenderExtent,
+                                        const std::vector<PointLight>& a_Lights, const glm::vec3& a_Ambient)
+{
+	if (a_Lights.size() > m_MaxLights)
+	{
+		throw std::runtime_error("Error! Too many lights for clustered light culling!");
+	}
+
+	// the clusters are built from the unjittered frustum, the jitter is far below a tile
+	const float t_TanHalfFOV = std::tan(glm::radians(a_Camera.GetFOV()) * 0.5f);
+	const glm::vec2 t_TanHalfExtent = {t_TanHalfFOV * a_Camera.GetAspectRatio(), t_TanHalfFOV};
+
+	// an off-center view region scales and shifts the slopes, its y points down like the clusters'
+	const glm::vec2 t_RegionMin = a_Camera.GetViewRegionMin();
+	const glm::vec2 t_RegionMax = a_Camera.GetViewRegionMax();
+	const glm::vec2 t_RegionCenter = t_RegionMin + t_RegionMax - 1.0f;
+
+	ClusterParameters t_Parameters = {};
+	t_Parameters.m_View = a_Camera.GetViewMat();
+	t_Parameters.m_Projection = {
+		t_TanHalfExtent * (t_RegionMax - t_RegionMin), a_Camera.GetNearPlane(), a_Camera.GetFarPlane()
+	};
+	t_Parameters.m_ProjectionOffset = {t_RegionCenter.x * t_TanHalfExtent.x, -t_RegionCenter.y * t_TanHalfExtent.y};
+	t_Parameters.m_CameraPosition = glm::vec4(a_Camera.GetPosition(), 1.0f);
+	t_Parameters.m_Ambient = glm::vec4(a_Ambient, 0.0f);
+	t_Parameters.m_InverseRenderExtent = {
+		1.0f / static_cast<float>(a_RenderExtent.width), 1.0f / static_cast<float>(a_RenderExtent.height)
+	};
+	t_Parameters.m_LightCount = static_cast<uint32_t>(a_Lights.size());
+
+	m_LightBuffers[a_Frame].FillBuffer(&t_Parameters, sizeof(t_Parameters));
+	m_LightBuffers[a_Frame].FillBuffer(a_Lights.data(), sizeof(PointLight) * a_Lights.size(), sizeof(t_Parameters));
+}
+
+void ClusteredLightCuller::RecordLightCulling(VkCommandBuffer a_CommandBuffer, const uint32_t a_Frame) const
+{
+	// the frame's previous submission, the last one reading the lists, has finished before recording
+	m_CullPipeline.Bind(a_CommandBuffer, m_DescriptorSets[a_Frame]);
+
+	// the shader culls one cluster per invocation in groups of 64
+	vkCmdDispatch(a_CommandBuffer, (s_ClusterCount + 63) / 64, 1, 1);
+}
+
+VkDescriptorSetLayout ClusteredLightCuller::GetDescriptorSetLayout() const
+{
+	return m_CullPipeline.GetDescriptorSetLayout();
+}
+
+VkDescriptorSet ClusteredLightCuller::GetDescriptorSet(const uint32_t a_Frame) const
+{
+	return m_DescriptorSets[a_Frame];
+}
+
+void ClusteredLightCuller::CreateDescriptorSets(const VkDevice& a_LogicalDevice,
+                                                DescriptorAllocator& a_DescriptorAllocator)
+{
+	m_DescriptorSets.resize(m_LightBuffers.size());
+
+	// the buffers live as long as the culler, so the sets never change
+	for (size_t i = 0; i < m_DescriptorSets.size(); i++)
+	{
+		m_DescriptorSets[i] = a_DescriptorAllocator.GetCached(a_LogicalDevice, m_CullPipeline.GetDescriptorSetLayout(), {
+			DescriptorBinding::Buffer(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_LightBuffers[i].GetBuffer()),
+			DescriptorBinding::Buffer(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_ClusterLightCountBuffers[i].GetBuffer()),
+			DescriptorBinding::Buffer(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_ClusterLightIndexBuffers[i].GetBuffer())
+		});
+	}
+}
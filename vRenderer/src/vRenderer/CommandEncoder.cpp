@@ -0,0 +1,220 @@
+#include "pch.h"
+#include "vRenderer/CommandEncoder.h"
+
+#include <cstring>
+
+#include "vRenderer/DrawQueue.h"
+
+uint32_t BindStatistics::GetTotalBinds() const
+{
+	return m_PipelineBinds + m_DescriptorSetBinds + m_VertexBufferBinds + m_IndexBufferBinds + m_DynamicStateSets;
+}
+
+CommandEncoder::CommandEncoder()
+= default;
+
+CommandEncoder::~CommandEncoder()
+= default;
+
+void CommandEncoder::Begin(VkCommandBuffer a_CommandBuffer)
+{
+	m_CommandBuffer = a_CommandBuffer;
+	m_Statistics = {};
+	Invalidate();
+}
+
+void CommandEncoder::Invalidate()
+{
+	m_Pipeline = VK_NULL_HANDLE;
+	m_PipelineLayout = VK_NULL_HANDLE;
+	m_DescriptorSets.fill(VK_NULL_HANDLE);
+	m_VertexBuffers.fill(VK_NULL_HANDLE);
+	m_VertexBufferOffsets.fill(0);
+	m_IndexBuffer = VK_NULL_HANDLE;
+	m_IndexBufferOffset = 0;
+	m_ViewportSet = false;
+	m_ScissorSet = false;
+}
+
+void CommandEncoder::BindPipeline(VkPipeline a_Pipeline)
+{
+	if (a_Pipeline == m_Pipeline)
+	{
+		m_Statistics.m_SkippedCalls++;
+		return;
+	}
+
+	m_Pipeline = a_Pipeline;
+	m_Statistics.m_PipelineBinds++;
+
+	if (m_CommandBuffer != VK_NULL_HANDLE)
+	{
+		vkCmdBindPipeline(m_CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, a_Pipeline);
+	}
+}
+
+void CommandEncoder::BindDescriptorSets(VkPipelineLayout a_PipelineLayout, const uint32_t a_FirstSet,
+                                        const uint32_t a_SetCount, const VkDescriptorSet* a_Sets)
+{
+	// sets bound with a different layout may be disturbed, treat all of them as unbound
+	if (a_PipelineLayout != m_PipelineLayout)
+	{
+		m_DescriptorSets.fill(VK_NULL_HANDLE);
+		m_PipelineLayout = a_PipelineLayout;
+	}
+
+	// only rebind from the first set that changed
+	uint32_t t_First = 0;
+	while (t_First < a_SetCount && m_DescriptorSets[a_FirstSet + t_First] == a_Sets[t_First])
+	{
+		t_First++;
+	}
+
+	if (t_First == a_SetCount)
+	{
+		m_Statistics.m_SkippedCalls++;
+		return;
+	}
+
+	for (uint32_t i = t_First; i < a_SetCount; i++)
+	{
+		m_DescriptorSets[a_FirstSet + i] = a_Sets[i];
+	}
+
+	m_Statistics.m_DescriptorSetBinds++;
+
+	if (m_CommandBuffer != VK_NULL_HANDLE)
+	{
+		vkCmdBindDescriptorSets(m_CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, a_PipelineLayout,
+		                        a_FirstSet + t_First, a_SetCount - t_First, a_Sets + t_First, 0, nullptr);
+	}
+}
+
+void CommandEncoder::BindVertexBuffers(const uint32_t a_FirstBinding, const uint32_t a_BindingCount,
+                                       const VkBuffer* a_Buffers, const VkDeviceSize* a_Offsets)
+{
+	uint32_t t_First = 0;
+	while (t_First < a_BindingCount &&
+		m_VertexBuffers[a_FirstBinding + t_First] == a_Buffers[t_First] &&
+		m_VertexBufferOffsets[a_FirstBinding + t_First] == a_Offsets[t_First])
+	{
+		t_First++;
+	}
+
+	if (t_First == a_BindingCount)
+	{
+		m_Statistics.m_SkippedCalls++;
+		return;
+	}
+
+	for (uint32_t i = t_First; i < a_BindingCount; i++)
+	{
+		m_VertexBuffers[a_FirstBinding + i] = a_Buffers[i];
+		m_VertexBufferOffsets[a_FirstBinding + i] = a_Offsets[i];
+	}
+
+	m_Statistics.m_VertexBufferBinds++;
+
+	if (m_CommandBuffer != VK_NULL_HANDLE)
+	{
+		vkCmdBindVertexBuffers(m_CommandBuffer, a_FirstBinding + t_First, a_BindingCount - t_First,
+		                       a_Buffers + t_First, a_Offsets + t_First);
+	}
+}
+
+void CommandEncoder::BindIndexBuffer(VkBuffer a_Buffer, const VkDeviceSize a_Offset, const VkIndexType a_IndexType)
+{
+	if (a_Buffer == m_IndexBuffer && a_Offset == m_IndexBufferOffset && a_IndexType == m_IndexType)
+	{
+		m_Statistics.m_SkippedCalls++;
+		return;
+	}
+
+	m_IndexBuffer = a_Buffer;
+	m_IndexBufferOffset = a_Offset;
+	m_IndexType = a_IndexType;
+	m_Statistics.m_IndexBufferBinds++;
+
+	if (m_CommandBuffer != VK_NULL_HANDLE)
+	{
+		vkCmdBindIndexBuffer(m_CommandBuffer, a_Buffer, a_Offset, a_IndexType);
+	}
+}
+
+void CommandEncoder::SetViewport(const VkViewport& a_Viewport)
+{
+	if (m_ViewportSet && std::memcmp(&a_Viewport, &m_Viewport, sizeof(VkViewport)) == 0)
+	{
+		m_Statistics.m_SkippedCalls++;
+		return;
+	}
+
+	m_Viewport = a_Viewport;
+	m_ViewportSet = true;
+	m_Statistics.m_DynamicStateSets++;
+
+	if (m_CommandBuffer != VK_NULL_HANDLE)
+	{
+		vkCmdSetViewport(m_CommandBuffer, 0, 1, &a_Viewport);
+	}
+}
+
+void CommandEncoder::SetScissor(const VkRect2D& a_Scissor)
+{
+	if (m_ScissorSet && std::memcmp(&a_Scissor, &m_Scissor, sizeof(VkRect2D)) == 0)
+	{
+		m_Statistics.m_SkippedCalls++;
+		return;
+	}
+
+	m_Scissor = a_Scissor;
+	m_ScissorSet = true;
+	m_Statistics.m_DynamicStateSets++;
+
+	if (m_CommandBuffer != VK_NULL_HANDLE)
+	{
+		vkCmdSetScissor(m_CommandBuffer, 0, 1, &a_Scissor);
+	}
+}
+
+void CommandEncoder::Draw(const DrawItem& a_DrawItem)
+{
+	BindPipeline(a_DrawItem.m_Pipeline);
+
+	if (a_DrawItem.m_DescriptorSetCount > 0)
+	{
+		BindDescriptorSets(a_DrawItem.m_PipelineLayout, 0, a_DrawItem.m_DescriptorSetCount,
+		                   a_DrawItem.m_DescriptorSets.data());
+	}
+
+	if (a_DrawItem.m_VertexBufferCount > 0)
+	{
+		BindVertexBuffers(0, a_DrawItem.m_VertexBufferCount, a_DrawItem.m_VertexBuffers.data(),
+		                  a_DrawItem.m_VertexBufferOffsets.data());
+	}
+
+	BindIndexBuffer(a_DrawItem.m_IndexBuffer, 0, a_DrawItem.m_IndexType);
+
+	m_Statistics.m_Draws++;
+
+	if (m_CommandBuffer == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	if (a_DrawItem.m_IndirectBuffer != VK_NULL_HANDLE)
+	{
+		vkCmdDrawIndexedIndirect(m_CommandBuffer, a_DrawItem.m_IndirectBuffer, a_DrawItem.m_IndirectOffset, 1,
+		                         sizeof(VkDrawIndexedIndirectCommand));
+	}
+	else
+	{
+		vkCmdDrawIndexed(m_CommandBuffer, a_DrawItem.m_IndexCount, a_DrawItem.m_InstanceCount, a_DrawItem.m_FirstIndex,
+		                 a_DrawItem.m_VertexOffset, a_DrawItem.m_FirstInstance);
+	}
+}
+
+const BindStatistics& CommandEncoder::GetStatistics() const
+{
+	return m_Statistics;
+}
@@ -0,0 +1,124 @@
+#include "pch.h"
+#include "vRenderer/ComputePipeline.h"
+
+#include <stdexcept>
+
+#include "vRenderer/helpers/helpers.h"
+#include "vRenderer/helpers/VulkanHelpers.h"
+
+ComputePipeline::ComputePipeline()
+= default;
+
+ComputePipeline::~ComputePipeline()
+= default;
+
+void ComputePipeline::Create(const VkDevice& a_LogicalDevice, const std::string& a_ShaderPath,
+                             const std::vector<VkDescriptorSetLayoutBinding>& a_Bindings, const uint32_t a_PushConstantSize,
+                             const std::vector<VkDescriptorSetLayout>& a_AdditionalLayouts)
+{
+	// descriptor set layout for set 0
+	VkDescriptorSetLayoutCreateInfo t_DescriptorSetLayoutCreateInfo = {};
+	t_DescriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	t_DescriptorSetLayoutCreateInfo.bindingCount = static_cast<uint32_t>(a_Bindings.size());
+	t_DescriptorSetLayoutCreateInfo.pBindings = a_Bindings.data();
+
+	if (vkCreateDescriptorSetLayout(a_LogicalDevice, &t_DescriptorSetLayoutCreateInfo, nullptr, &m_DescriptorSetLayout) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Failed to create compute descriptor set layout!");
+	}
+
+	// pipeline layout, set 0 is owned by this pipeline, any additional sets are provided by the caller
+	std::vector<VkDescriptorSetLayout> t_SetLayouts = {m_DescriptorSetLayout};
+	t_SetLayouts.insert(t_SetLayouts.end(), a_AdditionalLayouts.begin(), a_AdditionalLayouts.end());
+
+	VkPushConstantRange t_PushConstantRange = {};
+	t_PushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	t_PushConstantRange.offset = 0;
+	t_PushConstantRange.size = a_PushConstantSize;
+
+	VkPipelineLayoutCreateInfo t_PipelineLayoutCreateInfo = GenPipelineCreateInfo(
+		static_cast<int>(t_SetLayouts.size()), t_SetLayouts.data());
+
+	if (a_PushConstantSize > 0)
+	{
+		t_PipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+		t_PipelineLayoutCreateInfo.pPushConstantRanges = &t_PushConstantRange;
+	}
+
+	if (vkCreatePipelineLayout(a_LogicalDevice, &t_PipelineLayoutCreateInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not create compute Pipeline Layout!");
+	}
+
+	// shader stage
+	const VkShaderModule t_ComputeShader = CreateShaderModule(ReadFile(a_ShaderPath), a_LogicalDevice);
+
+	VkPipelineShaderStageCreateInfo t_ShaderStageInfo = {};
+	t_ShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	t_ShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	t_ShaderStageInfo.module = t_ComputeShader;
+	t_ShaderStageInfo.pName = "main";
+
+	VkComputePipelineCreateInfo t_PipelineCreateInfo = {};
+	t_PipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	t_PipelineCreateInfo.stage = t_ShaderStageInfo;
+	t_PipelineCreateInfo.layout = m_PipelineLayout;
+	t_PipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+	t_PipelineCreateInfo.basePipelineIndex = -1;
+
+	if (vkCreateComputePipelines(a_LogicalDevice, VK_NULL_HANDLE, 1, &t_PipelineCreateInfo, nullptr, &m_Pipeline) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Unable to create Compute Pipeline!");
+	}
+
+	// the shader module is no longer needed once the pipeline exists
+	vkDestroyShaderModule(a_LogicalDevice, t_ComputeShader, nullptr);
+}
+
+void ComputePipeline::Destroy(const VkDevice& a_LogicalDevice)
+{
+	vkDestroyPipeline(a_LogicalDevice, m_Pipeline, nullptr);
+	vkDestroyPipelineLayout(a_LogicalDevice, m_PipelineLayout, nullptr);
+	vkDestroyDescriptorSetLayout(a_LogicalDevice, m_DescriptorSetLayout, nullptr);
+
+	m_Pipeline = VK_NULL_HANDLE;
+	m_PipelineLayout = VK_NULL_HANDLE;
+	m_DescriptorSetLayout = VK_NULL_HANDLE;
+}
+
+void ComputePipeline::Bind(VkCommandBuffer a_CommandBuffer, VkDescriptorSet a_DescriptorSet) const
+{
+	vkCmdBindPipeline(a_CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+	vkCmdBindDescriptorSets(a_CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &a_DescriptorSet, 0,
+	                        nullptr);
+}
+
+void ComputePipeline::PushConstants(VkCommandBuffer a_CommandBuffer, const void* a_Data, const uint32_t a_Size) const
+{
+	vkCmdPushConstants(a_CommandBuffer, m_PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, a_Size, a_Data);
+}
+
+void ComputePipeline::Dispatch2D(VkCommandBuffer a_CommandBuffer, const uint32_t a_Width, const uint32_t a_Height,
+                                 const uint32_t a_GroupSize)
+{
+	// round up so partially covered groups at the border are dispatched as well
+	const uint32_t t_GroupsX = (a_Width + a_GroupSize - 1) / a_GroupSize;
+	const uint32_t t_GroupsY = (a_Height + a_GroupSize - 1) / a_GroupSize;
+
+	vkCmdDispatch(a_CommandBuffer, t_GroupsX, t_GroupsY, 1);
+}
+
+VkPipeline ComputePipeline::GetPipeline() const
+{
+	return m_Pipeline;
+}
+
+VkPipelineLayout ComputePipeline::GetPipelineLayout() const
+{
+	return m_PipelineLayout;
+}
+
+VkDescriptorSetLayout ComputePipeline::GetDescriptorSetLayout() const
+{
+	return m_DescriptorSetLayout;
+}
@@ -0,0 +1,37 @@
+#include "pch.h"
+#include "vRenderer/DeferredDestructionQueue.h"
+
+DeferredDestructionQueue::DeferredDestructionQueue()
+= default;
+
+DeferredDestructionQueue::~DeferredDestructionQueue()
+= default;
+
+void DeferredDestructionQueue::Push(const uint64_t a_RetireValue, std::function<void()> a_Destroy)
+{
+	m_Pending.push_back({a_RetireValue, std::move(a_Destroy)});
+}
+
+void DeferredDestructionQueue::Collect(const uint64_t a_CompletedValue)
+{
+	while (!m_Pending.empty() && m_Pending.front().m_RetireValue <= a_CompletedValue)
+	{
+		m_Pending.front().m_Destroy();
+		m_Pending.pop_front();
+	}
+}
+
+void DeferredDestructionQueue::Flush()
+{
+	for (PendingDestruction& t_Pending : m_Pending)
+	{
+		t_Pending.m_Destroy();
+	}
+
+	m_Pending.clear();
+}
+
+size_t DeferredDestructionQueue::GetPendingCount() const
+{
+	return m_Pending.size();
+}
@@ -0,0 +1,233 @@
+#include "pch.h"
+#include "vRenderer/DeferredLighting.h"
+
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+#include "vRenderer/DescriptorAllocator.h"
+#include "vRenderer/Device.h"
+#include "vRenderer/helpers/helpers.h"
+#include "vRenderer/helpers/VulkanHelpers.h"
+
+DeferredLighting::DeferredLighting()
+= default;
+
+DeferredLighting::~DeferredLighting()
+= default;
+
+void DeferredLighting::Create(const Device& a_Device)
+{
+	const VkDevice t_LogicalDevice = a_Device.GetLogicalDevice();
+
+	// albedo, normal and depth, read by the lighting subpass at the pixel it shades
+	std::array<VkDescriptorSetLayoutBinding, 3> t_Bindings = {};
+	for (uint32_t i = 0; i < t_Bindings.size(); i++)
+	{
+		t_Bindings[i].binding = i;
+		t_Bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		t_Bindings[i].descriptorCount = 1;
+		t_Bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo t_LayoutCreateInfo = {};
+	t_LayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	t_LayoutCreateInfo.bindingCount = static_cast<uint32_t>(t_Bindings.size());
+	t_LayoutCreateInfo.pBindings = t_Bindings.data();
+
+	if (vkCreateDescriptorSetLayout(t_LogicalDevice, &t_LayoutCreateInfo, nullptr, &m_DescriptorSetLayout) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not create G-buffer Descriptor Set Layout!");
+	}
+}
+
+void DeferredLighting::Destroy(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator)
+{
+	DestroyTargets(a_LogicalDevice, a_DescriptorAllocator);
+	DestroyPipeline(a_LogicalDevice);
+
+	vkDestroyDescriptorSetLayout(a_LogicalDevice, m_DescriptorSetLayout, nullptr);
+	m_DescriptorSetLayout = VK_NULL_HANDLE;
+}
+
+void DeferredLighting::CreatePipeline(const Device& a_Device, VkRenderPass a_RenderPass,
+                                      VkDescriptorSetLayout a_LightSetLayout)
+{
+	const VkDevice t_LogicalDevice = a_Device.GetLogicalDevice();
+
+	// set 0 holds the G-buffer, set 1 the clustered light lists
+	const std::array<VkDescriptorSetLayout, 2> t_SetLayouts = {m_DescriptorSetLayout, a_LightSetLayout};
+
+	VkPushConstantRange t_PushConstantRange = {};
+	t_PushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	t_PushConstantRange.offset = 0;
+	t_PushConstantRange.size = sizeof(LightingParameters);
+
+	VkPipelineLayoutCreateInfo t_PipelineLayoutCreateInfo = GenPipelineCreateInfo(
+		static_cast<int>(t_SetLayouts.size()), t_SetLayouts.data());
+	t_PipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+	t_PipelineLayoutCreateInfo.pPushConstantRanges = &t_PushConstantRange;
+
+	if (vkCreatePipelineLayout(t_LogicalDevice, &t_PipelineLayoutCreateInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not create deferred lighting Pipeline Layout!");
+	}
+
+	const VkShaderModule t_VertexShader = CreateShaderModule(
+		ReadFile("../vRenderer/assets/shaders/compiled/deferred_lighting_vert.spv"), t_LogicalDevice);
+	const VkShaderModule t_FragmentShader = CreateShaderModule(
+		ReadFile("../vRenderer/assets/shaders/compiled/deferred_lighting_frag.spv"), t_LogicalDevice);
+
+	std::array<VkPipelineShaderStageCreateInfo, 2> t_ShaderStages = {};
+	t_ShaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	t_ShaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+	t_ShaderStages[0].module = t_VertexShader;
+	t_ShaderStages[0].pName = "main";
+	t_ShaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	t_ShaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	t_ShaderStages[1].module = t_FragmentShader;
+	t_ShaderStages[1].pName = "main";
+
+	const std::vector<VkDynamicState> t_DynStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+	VkPipelineDynamicStateCreateInfo t_DynamicStateCreateInfo = GenDynamicStateCreateInfo(t_DynStates);
+
+	// the fullscreen triangle is generated from the vertex index
+	const std::vector<VkVertexInputBindingDescription> t_BindingDesc;
+	const std::vector<VkVertexInputAttributeDescription> t_AttributeDesc;
+	VkPipelineVertexInputStateCreateInfo t_VertexInputStateCreateInfo = GenVertexInputStateCreateInfo(t_BindingDesc, t_AttributeDesc);
+	VkPipelineInputAssemblyStateCreateInfo t_InputAssemblyStateCreateInfo = GenInputAssemblyStateCreateInfo();
+
+	// viewport and scissor are dynamic, only their count matters here
+	const VkViewport t_Viewport = {};
+	const VkRect2D t_ScissorRect = {};
+	VkPipelineViewportStateCreateInfo t_ViewportState = GenViewportStateCreateInfo(1, t_Viewport, 1, t_ScissorRect);
+
+	VkPipelineRasterizationStateCreateInfo t_RasterizationStateCreateInfo = GenRasterizationStateCreateInfo();
+	t_RasterizationStateCreateInfo.cullMode = VK_CULL_MODE_NONE;
+
+	// the deferred path always renders with one sample per pixel
+	VkPipelineMultisampleStateCreateInfo t_MultisampleState = GenMultisamplingStateCreateInfo(VK_SAMPLE_COUNT_1_BIT, 0.0f);
+
+	const VkPipelineColorBlendAttachmentState t_ColorBlendAttachmentState = GenColorBlendAttachStateCreateInfo();
+	VkPipelineColorBlendStateCreateInfo t_ColorBlendStateCreateInfo = GenColorBlendStateCreateInfo(&t_ColorBlendAttachmentState);
+
+	// depth is read as an input attachment, the subpass uses no depth attachment
+	VkPipelineDepthStencilStateCreateInfo t_DepthStencilCreateInfo = {};
+	t_DepthStencilCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	t_DepthStencilCreateInfo.depthTestEnable = VK_FALSE;
+	t_DepthStencilCreateInfo.depthWriteEnable = VK_FALSE;
+	t_DepthStencilCreateInfo.maxDepthBounds = 1.0f;
+
+	VkGraphicsPipelineCreateInfo t_PipelineCreateInfo = {};
+	t_PipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	t_PipelineCreateInfo.stageCount = static_cast<uint32_t>(t_ShaderStages.size());
+	t_PipelineCreateInfo.pStages = t_ShaderStages.data();
+	t_PipelineCreateInfo.pVertexInputState = &t_VertexInputStateCreateInfo;
+	t_PipelineCreateInfo.pInputAssemblyState = &t_InputAssemblyStateCreateInfo;
+	t_PipelineCreateInfo.pViewportState = &t_ViewportState;
+	t_PipelineCreateInfo.pRasterizationState = &t_RasterizationStateCreateInfo;
+	t_PipelineCreateInfo.pMultisampleState = &t_MultisampleState;
+	t_PipelineCreateInfo.pDepthStencilState = &t_DepthStencilCreateInfo;
+	t_PipelineCreateInfo.pColorBlendState = &t_ColorBlendStateCreateInfo;
+	t_PipelineCreateInfo.pDynamicState = &t_DynamicStateCreateInfo;
+	t_PipelineCreateInfo.layout = m_PipelineLayout;
+	t_PipelineCreateInfo.renderPass = a_RenderPass;
+	t_PipelineCreateInfo.subpass = 1;
+	t_PipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+	t_PipelineCreateInfo.basePipelineIndex = -1;
+
+	if (vkCreateGraphicsPipelines(t_LogicalDevice, VK_NULL_HANDLE, 1, &t_PipelineCreateInfo, nullptr, &m_Pipeline) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Unable to create deferred lighting Pipeline!");
+	}
+
+	vkDestroyShaderModule(t_LogicalDevice, t_VertexShader, nullptr);
+	vkDestroyShaderModule(t_LogicalDevice, t_FragmentShader, nullptr);
+}
+
+void DeferredLighting::DestroyPipeline(const VkDevice& a_LogicalDevice)
+{
+	vkDestroyPipeline(a_LogicalDevice, m_Pipeline, nullptr);
+	vkDestroyPipelineLayout(a_LogicalDevice, m_PipelineLayout, nullptr);
+
+	m_Pipeline = VK_NULL_HANDLE;
+	m_PipelineLayout = VK_NULL_HANDLE;
+}
+
+void DeferredLighting::CreateTargets(const Device& a_Device, DescriptorAllocator& a_DescriptorAllocator,
+                                     const VkExtent2D a_Extent, const Image& a_DepthImage)
+{
+	// the G-buffer is cleared at the start of the render pass and discarded at its end, so it never
+	// has to leave tile memory on GPUs that support lazily allocated memory
+	const VkImageUsageFlags t_Usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT |
+		VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+	const VkMemoryPropertyFlags t_MemoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+		VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+
+	m_Albedo.CreateImage(a_Device, a_Extent.width, a_Extent.height, 1, VK_SAMPLE_COUNT_1_BIT, s_AlbedoFormat,
+	                     VK_IMAGE_TILING_OPTIMAL, t_Usage, t_MemoryProperties, VK_IMAGE_ASPECT_COLOR_BIT);
+	m_Normal.CreateImage(a_Device, a_Extent.width, a_Extent.height, 1, VK_SAMPLE_COUNT_1_BIT, s_NormalFormat,
+	                     VK_IMAGE_TILING_OPTIMAL, t_Usage, t_MemoryProperties, VK_IMAGE_ASPECT_COLOR_BIT);
+
+	// a single set is enough, the G-buffer only lives within one render pass and is not shared
+	// between frames in flight. Layouts have to match the input attachment references of the
+	// lighting subpass
+	m_DescriptorSet = a_DescriptorAllocator.GetCached(a_Device.GetLogicalDevice(), m_DescriptorSetLayout, {
+		DescriptorBinding::Image(0, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, m_Albedo.GetImageView(), VK_NULL_HANDLE,
+		                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+		DescriptorBinding::Image(1, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, m_Normal.GetImageView(), VK_NULL_HANDLE,
+		                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+		DescriptorBinding::Image(2, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, a_DepthImage.GetImageView(), VK_NULL_HANDLE,
+		                         VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL)
+	});
+}
+
+void DeferredLighting::DestroyTargets(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator)
+{
+	a_DescriptorAllocator.InvalidateImageViews(a_LogicalDevice, {m_Albedo.GetImageView(), m_Normal.GetImageView()});
+	m_DescriptorSet = VK_NULL_HANDLE;
+
+	m_Albedo.DestroyImage(a_LogicalDevice);
+	m_Normal.DestroyImage(a_LogicalDevice);
+}
+
+void DeferredLighting::RecordLighting(VkCommandBuffer a_CommandBuffer, VkDescriptorSet a_LightSet,
+                                      const glm::mat4& a_InverseViewProjection, const VkExtent2D a_RenderExtent) const
+{
+	vkCmdNextSubpass(a_CommandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+
+	VkViewport t_Viewport = {};
+	t_Viewport.width = static_cast<float>(a_RenderExtent.width);
+	t_Viewport.height = static_cast<float>(a_RenderExtent.height);
+	t_Viewport.maxDepth = 1.0f;
+
+	VkRect2D t_Scissor = {};
+	t_Scissor.extent = a_RenderExtent;
+
+	vkCmdSetViewport(a_CommandBuffer, 0, 1, &t_Viewport);
+	vkCmdSetScissor(a_CommandBuffer, 0, 1, &t_Scissor);
+
+	const std::array<VkDescriptorSet, 2> t_DescriptorSets = {m_DescriptorSet, a_LightSet};
+
+	vkCmdBindPipeline(a_CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline);
+	vkCmdBindDescriptorSets(a_CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0,
+	                        static_cast<uint32_t>(t_DescriptorSets.size()), t_DescriptorSets.data(), 0, nullptr);
+
+	LightingParameters t_Parameters = {};
+	t_Parameters.m_InverseViewProjection = a_InverseViewProjection;
+
+	vkCmdPushConstants(a_CommandBuffer, m_PipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(t_Parameters),
+	                   &t_Parameters);
+
+	vkCmdDraw(a_CommandBuffer, 3, 1, 0, 0);
+}
+
+const Image& DeferredLighting::GetAlbedo() const
+{
+	return m_Albedo;
+}
+
+const Image& DeferredLighting::GetNormal() const
+{
+	return m_Normal;
+}
@@ -0,0 +1,351 @@
+#include "pch.h"
+#include "vRenderer/DescriptorAllocator.h"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <stdexcept>
+
+namespace
+{
+	// descriptors of each type reserved per set in a pool
+	struct PoolSizeRatio
+	{
+		VkDescriptorType m_Type;
+		float m_Ratio;
+	};
+
+	constexpr std::array<PoolSizeRatio, 7> s_PoolSizeRatios = {{
+		{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f},
+		{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.0f},
+		{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
+		{VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2.0f},
+		{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2.0f},
+		{VK_DESCRIPTOR_TYPE_SAMPLER, 1.0f},
+		{VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1.0f}
+	}};
+
+	template <typename T>
+	void HashCombine(size_t& a_Seed, const T& a_Value)
+	{
+		a_Seed ^= std::hash<T>()(a_Value) + 0x9e3779b9 + (a_Seed << 6) + (a_Seed >> 2);
+	}
+}
+
+DescriptorBinding DescriptorBinding::Buffer(const uint32_t a_Binding, const VkDescriptorType a_Type, VkBuffer a_Buffer,
+                                            const VkDeviceSize a_Offset, const VkDeviceSize a_Range)
+{
+	DescriptorBinding t_Binding = {};
+	t_Binding.m_Binding = a_Binding;
+	t_Binding.m_Type = a_Type;
+	t_Binding.m_BufferInfo.buffer = a_Buffer;
+	t_Binding.m_BufferInfo.offset = a_Offset;
+	t_Binding.m_BufferInfo.range = a_Range;
+
+	return t_Binding;
+}
+
+DescriptorBinding DescriptorBinding::Image(const uint32_t a_Binding, const VkDescriptorType a_Type,
+                                           VkImageView a_ImageView, VkSampler a_Sampler, const VkImageLayout a_Layout)
+{
+	DescriptorBinding t_Binding = {};
+	t_Binding.m_Binding = a_Binding;
+	t_Binding.m_Type = a_Type;
+	t_Binding.m_ImageInfo.imageView = a_ImageView;
+	t_Binding.m_ImageInfo.sampler = a_Sampler;
+	t_Binding.m_ImageInfo.imageLayout = a_Layout;
+
+	return t_Binding;
+}
+
+bool DescriptorBinding::IsImage() const
+{
+	return m_Type == VK_DESCRIPTOR_TYPE_SAMPLER || m_Type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
+		m_Type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE || m_Type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
+		m_Type == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+}
+
+bool DescriptorBinding::operator==(const DescriptorBinding& a_Other) const
+{
+	return	m_Binding == a_Other.m_Binding &&
+			m_Type == a_Other.m_Type &&
+			m_BufferInfo.buffer == a_Other.m_BufferInfo.buffer &&
+			m_BufferInfo.offset == a_Other.m_BufferInfo.offset &&
+			m_BufferInfo.range == a_Other.m_BufferInfo.range &&
+			m_ImageInfo.imageView == a_Other.m_ImageInfo.imageView &&
+			m_ImageInfo.sampler == a_Other.m_ImageInfo.sampler &&
+			m_ImageInfo.imageLayout == a_Other.m_ImageInfo.imageLayout;
+}
+
+bool DescriptorAllocator::CacheKey::operator==(const CacheKey& a_Other) const
+{
+	return m_Layout == a_Other.m_Layout && m_Bindings == a_Other.m_Bindings;
+}
+
+size_t DescriptorAllocator::CacheKeyHash::operator()(const CacheKey& a_Key) const
+{
+	size_t t_Seed = 0;
+	HashCombine(t_Seed, a_Key.m_Layout);
+
+	for (const DescriptorBinding& t_Binding : a_Key.m_Bindings)
+	{
+		HashCombine(t_Seed, t_Binding.m_Binding);
+		HashCombine(t_Seed, static_cast<uint32_t>(t_Binding.m_Type));
+		HashCombine(t_Seed, t_Binding.m_BufferInfo.buffer);
+		HashCombine(t_Seed, t_Binding.m_BufferInfo.offset);
+		HashCombine(t_Seed, t_Binding.m_BufferInfo.range);
+		HashCombine(t_Seed, t_Binding.m_ImageInfo.imageView);
+		HashCombine(t_Seed, t_Binding.m_ImageInfo.sampler);
+		HashCombine(t_Seed, static_cast<uint32_t>(t_Binding.m_ImageInfo.imageLayout));
+	}
+
+	return t_Seed;
+}
+
+DescriptorAllocator::DescriptorAllocator()
+= default;
+
+DescriptorAllocator::~DescriptorAllocator()
+= default;
+
+void DescriptorAllocator::Create(const uint32_t a_FramesInFlight, const uint32_t a_InitialSets)
+{
+	m_FramePools.resize(a_FramesInFlight);
+	m_InitialSets = a_InitialSets;
+
+	// cached sets are freed one by one when the views they point to are destroyed
+	m_CachePools.m_Flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+	m_CurrentFrame = 0;
+}
+
+void DescriptorAllocator::Destroy(const VkDevice& a_LogicalDevice)
+{
+	for (PoolList& t_Pools : m_FramePools)
+	{
+		DestroyPools(a_LogicalDevice, t_Pools);
+	}
+
+	DestroyPools(a_LogicalDevice, m_CachePools);
+
+	m_FramePools.clear();
+	m_Cache.clear();
+	m_PoolCount = 0;
+}
+
+void DescriptorAllocator::BeginFrame(const VkDevice& a_LogicalDevice, const uint32_t a_Frame)
+{
+	m_CurrentFrame = a_Frame;
+	ResetPools(a_LogicalDevice, m_FramePools[m_CurrentFrame]);
+}
+
+VkDescriptorSet DescriptorAllocator::AllocateTransient(const VkDevice& a_LogicalDevice, VkDescriptorSetLayout a_Layout,
+                                                       const std::initializer_list<DescriptorBinding> a_Bindings)
+{
+	VkDescriptorSet t_Set = Allocate(a_LogicalDevice, m_FramePools[m_CurrentFrame], a_Layout);
+
+	if (a_Bindings.size() != 0)
+	{
+		Write(a_LogicalDevice, t_Set, a_Bindings.begin(), a_Bindings.size());
+	}
+
+	return t_Set;
+}
+
+VkDescriptorSet DescriptorAllocator::GetCached(const VkDevice& a_LogicalDevice, VkDescriptorSetLayout a_Layout,
+                                               const std::vector<DescriptorBinding>& a_Bindings)
+{
+	CacheKey t_Key = {a_Layout, a_Bindings};
+
+	const auto t_Cached = m_Cache.find(t_Key);
+
+	if (t_Cached != m_Cache.end())
+	{
+		return t_Cached->second.m_Set;
+	}
+
+	VkDescriptorPool t_Pool = VK_NULL_HANDLE;
+	VkDescriptorSet t_Set = Allocate(a_LogicalDevice, m_CachePools, a_Layout, &t_Pool);
+	Write(a_LogicalDevice, t_Set, a_Bindings.data(), a_Bindings.size());
+
+	m_Cache.emplace(std::move(t_Key), CachedSet{t_Set, t_Pool});
+	return t_Set;
+}
+
+void DescriptorAllocator::ResetCache(const VkDevice& a_LogicalDevice)
+{
+	ResetPools(a_LogicalDevice, m_CachePools);
+	m_Cache.clear();
+}
+
+void DescriptorAllocator::InvalidateImageViews(const VkDevice& a_LogicalDevice,
+                                               const std::vector<VkImageView>& a_ImageViews)
+{
+	for (auto t_Entry = m_Cache.begin(); t_Entry != m_Cache.end();)
+	{
+		const std::vector<DescriptorBinding>& t_Bindings = t_Entry->first.m_Bindings;
+
+		const bool t_PointsToView = std::any_of(t_Bindings.begin(), t_Bindings.end(), [&](const DescriptorBinding& a_Binding)
+		{
+			const VkImageView t_View = a_Binding.IsImage() ? a_Binding.m_ImageInfo.imageView : VK_NULL_HANDLE;
+			return t_View != VK_NULL_HANDLE &&
+				std::find(a_ImageViews.begin(), a_ImageViews.end(), t_View) != a_ImageViews.end();
+		});
+
+		if (!t_PointsToView)
+		{
+			++t_Entry;
+			continue;
+		}
+
+		vkFreeDescriptorSets(a_LogicalDevice, t_Entry->second.m_Pool, 1, &t_Entry->second.m_Set);
+		t_Entry = m_Cache.erase(t_Entry);
+	}
+}
+
+void DescriptorAllocator::Write(const VkDevice& a_LogicalDevice, VkDescriptorSet a_Set,
+                                const DescriptorBinding* a_Bindings, const size_t a_Count)
+{
+	// written in batches from the stack, transient sets are written every frame
+	std::array<VkWriteDescriptorSet, 8> t_DescriptorWrites = {};
+
+	for (size_t t_First = 0; t_First < a_Count; t_First += t_DescriptorWrites.size())
+	{
+		const size_t t_BatchSize = std::min(a_Count - t_First, t_DescriptorWrites.size());
+
+		for (size_t i = 0; i < t_BatchSize; i++)
+		{
+			const DescriptorBinding& t_Binding = a_Bindings[t_First + i];
+
+			t_DescriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			t_DescriptorWrites[i].dstSet = a_Set;
+			t_DescriptorWrites[i].dstBinding = t_Binding.m_Binding;
+			t_DescriptorWrites[i].dstArrayElement = 0;
+			t_DescriptorWrites[i].descriptorType = t_Binding.m_Type;
+			t_DescriptorWrites[i].descriptorCount = 1;
+			t_DescriptorWrites[i].pBufferInfo = t_Binding.IsImage() ? nullptr : &t_Binding.m_BufferInfo;
+			t_DescriptorWrites[i].pImageInfo = t_Binding.IsImage() ? &t_Binding.m_ImageInfo : nullptr;
+		}
+
+		vkUpdateDescriptorSets(a_LogicalDevice, static_cast<uint32_t>(t_BatchSize), t_DescriptorWrites.data(), 0,
+		                       nullptr);
+	}
+}
+
+size_t DescriptorAllocator::GetPoolCount() const
+{
+	return m_PoolCount;
+}
+
+/// <summary>
+/// 	Allocates a set from the last pool of a list. If the pool is exhausted a free pool of the
+/// 	list is used, or a new one is created, and the allocation is retried once.
+/// </summary>
+/// <exception cref="std::runtime_error">	Raised when the set could not be allocated from a fresh pool either.</exception>
+
+VkDescriptorSet DescriptorAllocator::Allocate(const VkDevice& a_LogicalDevice, PoolList& a_Pools,
+                                              VkDescriptorSetLayout a_Layout, VkDescriptorPool* a_Pool)
+{
+	if (a_Pools.m_UsedPools.empty())
+	{
+		a_Pools.m_UsedPools.push_back(CreatePool(a_LogicalDevice, a_Pools));
+	}
+
+	VkDescriptorSetAllocateInfo t_AllocateInfo = {};
+	t_AllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	t_AllocateInfo.descriptorPool = a_Pools.m_UsedPools.back();
+	t_AllocateInfo.descriptorSetCount = 1;
+	t_AllocateInfo.pSetLayouts = &a_Layout;
+
+	VkDescriptorSet t_Set;
+	VkResult t_Result = vkAllocateDescriptorSets(a_LogicalDevice, &t_AllocateInfo, &t_Set);
+
+	if (t_Result == VK_ERROR_OUT_OF_POOL_MEMORY || t_Result == VK_ERROR_FRAGMENTED_POOL)
+	{
+		a_Pools.m_UsedPools.push_back(CreatePool(a_LogicalDevice, a_Pools));
+
+		t_AllocateInfo.descriptorPool = a_Pools.m_UsedPools.back();
+		t_Result = vkAllocateDescriptorSets(a_LogicalDevice, &t_AllocateInfo, &t_Set);
+	}
+
+	if (t_Result != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not allocate Descriptor Set!");
+	}
+
+	if (a_Pool != nullptr)
+	{
+		*a_Pool = t_AllocateInfo.descriptorPool;
+	}
+
+	return t_Set;
+}
+
+/// <summary>
+/// 	Gets an empty pool for a list, reusing a pool that was reset before. New pools hold twice as
+/// 	many sets as the previous one, up to m_MaxPoolSets.
+/// </summary>
+/// <exception cref="std::runtime_error">	Raised when the pool could not be created.</exception>
+
+VkDescriptorPool DescriptorAllocator::CreatePool(const VkDevice& a_LogicalDevice, PoolList& a_Pools)
+{
+	if (!a_Pools.m_FreePools.empty())
+	{
+		const VkDescriptorPool t_Pool = a_Pools.m_FreePools.back();
+		a_Pools.m_FreePools.pop_back();
+		return t_Pool;
+	}
+
+	const uint32_t t_SetCount = a_Pools.m_NextPoolSets == 0 ? m_InitialSets : a_Pools.m_NextPoolSets;
+	a_Pools.m_NextPoolSets = std::min(t_SetCount * 2, m_MaxPoolSets);
+
+	std::array<VkDescriptorPoolSize, s_PoolSizeRatios.size()> t_PoolSizes = {};
+
+	for (size_t i = 0; i < s_PoolSizeRatios.size(); i++)
+	{
+		t_PoolSizes[i].type = s_PoolSizeRatios[i].m_Type;
+		t_PoolSizes[i].descriptorCount = static_cast<uint32_t>(s_PoolSizeRatios[i].m_Ratio * static_cast<float>(t_SetCount));
+	}
+
+	VkDescriptorPoolCreateInfo t_DescriptorPoolCreateInfo = {};
+	t_DescriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	t_DescriptorPoolCreateInfo.flags = a_Pools.m_Flags;
+	t_DescriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(t_PoolSizes.size());
+	t_DescriptorPoolCreateInfo.pPoolSizes = t_PoolSizes.data();
+	t_DescriptorPoolCreateInfo.maxSets = t_SetCount;
+
+	VkDescriptorPool t_Pool;
+
+	if (vkCreateDescriptorPool(a_LogicalDevice, &t_DescriptorPoolCreateInfo, nullptr, &t_Pool) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not create Descriptor Pool!");
+	}
+
+	m_PoolCount++;
+	return t_Pool;
+}
+
+void DescriptorAllocator::ResetPools(const VkDevice& a_LogicalDevice, PoolList& a_Pools)
+{
+	for (VkDescriptorPool t_Pool : a_Pools.m_UsedPools)
+	{
+		vkResetDescriptorPool(a_LogicalDevice, t_Pool, 0);
+		a_Pools.m_FreePools.push_back(t_Pool);
+	}
+
+	a_Pools.m_UsedPools.clear();
+}
+
+void DescriptorAllocator::DestroyPools(const VkDevice& a_LogicalDevice, PoolList& a_Pools)
+{
+	for (VkDescriptorPool t_Pool : a_Pools.m_UsedPools)
+	{
+		vkDestroyDescriptorPool(a_LogicalDevice, t_Pool, nullptr);
+	}
+
+	for (VkDescriptorPool t_Pool : a_Pools.m_FreePools)
+	{
+		vkDestroyDescriptorPool(a_LogicalDevice, t_Pool, nullptr);
+	}
+
+	a_Pools = {};
+}
@@ -2,12 +2,23 @@
 #include "vRenderer/Device.h"
 #include "../include/vRenderer/helper_structs/RenderingHelpers.h"
 
+#include <algorithm>
 #include <iostream>
 #include <set>
 
 #include "vRenderer/helpers/VulkanHelpers.h"
 #include <vRenderer/SwapChain.h>
 
+namespace
+{
+	// enabled when supported, the features using them fall back to other paths otherwise
+	const std::vector<const char*> s_OptionalDeviceExtensions = {
+		VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME,
+		VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME,
+		VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME
+	};
+}
+
 Device::Device()
 {
 	
@@ -23,6 +34,93 @@ VkSampleCountFlagBits Device::GetMSAASampleCount() const
 	return m_MSAASampleCount;
 }
 
+VkSampleCountFlagBits Device::GetMaxMSAASampleCount() const
+{
+	return m_MaxMSAASampleCount;
+}
+
+VkSampleCountFlagBits Device::SetMSAASampleCount(const VkSampleCountFlagBits a_RequestedSampleCount)
+{
+	VkSampleCountFlagBits t_SampleCount = a_RequestedSampleCount;
+
+	// step down until a sample count is found that is both supported and not above the maximum
+	while (t_SampleCount > VK_SAMPLE_COUNT_1_BIT &&
+		(t_SampleCount > m_MaxMSAASampleCount || !(m_SupportedMSAASampleCounts & t_SampleCount)))
+	{
+		t_SampleCount = static_cast<VkSampleCountFlagBits>(t_SampleCount >> 1);
+	}
+
+	if (t_SampleCount < VK_SAMPLE_COUNT_1_BIT)
+	{
+		t_SampleCount = VK_SAMPLE_COUNT_1_BIT;
+	}
+
+#ifdef _DEBUG
+	if (t_SampleCount != a_RequestedSampleCount)
+	{
+		std::cout << "Requested " << a_RequestedSampleCount << " MSAA Samples, using " << t_SampleCount << " instead." << std::endl;
+	}
+#endif
+
+	m_MSAASampleCount = t_SampleCount;
+	return m_MSAASampleCount;
+}
+
+bool Device::SupportsSampleRateShading() const
+{
+	return m_SampleRateShadingSupported;
+}
+
+bool Device::SupportsTimestamps() const
+{
+	return m_TimestampsSupported;
+}
+
+float Device::GetTimestampPeriod() const
+{
+	return m_TimestampPeriod;
+}
+
+uint32_t Device::GetMaxSampledImages() const
+{
+	return m_MaxSampledImages;
+}
+
+TimelineSemaphore& Device::GetGraphicsTimeline() const
+{
+	return m_GraphicsTimeline;
+}
+
+bool Device::HasAsyncCompute() const
+{
+	return m_AsyncComputeFamily.has_value();
+}
+
+VkQueue Device::GetComputeQueue() const
+{
+	return m_ComputeQueue;
+}
+
+uint32_t Device::GetGraphicsQueueFamily() const
+{
+	return m_GraphicsFamily;
+}
+
+uint32_t Device::GetComputeQueueFamily() const
+{
+	return m_AsyncComputeFamily.value_or(m_GraphicsFamily);
+}
+
+TimelineSemaphore& Device::GetComputeTimeline() const
+{
+	return m_ComputeTimeline;
+}
+
+bool Device::IsExtensionEnabled(const char* a_Extension) const
+{
+	return std::find(m_EnabledExtensions.begin(), m_EnabledExtensions.end(), a_Extension) != m_EnabledExtensions.end();
+}
+
 /// <summary>
 /// 	This function queries all existing physical devices (graphics cards) and chooses the
 /// 	first one that suits the provided requirements.
@@ -65,12 +163,42 @@ VkPhysicalDevice Device::ChoosePhysicalDevice(VkInstance& a_Instance, VkSurfaceK
 	VkPhysicalDeviceProperties t_DeviceProperties;
 	vkGetPhysicalDeviceProperties(t_PhysicalDevice,&t_DeviceProperties);
 
+	VkPhysicalDeviceFeatures t_DeviceFeatures = {};
+	vkGetPhysicalDeviceFeatures(t_PhysicalDevice, &t_DeviceFeatures);
+
 	m_PhysicalDevice = t_PhysicalDevice;
-	m_MSAASampleCount = CheckMSAASampleCount(t_PhysicalDevice);
+	m_MaxMSAASampleCount = CheckMSAASampleCount(t_PhysicalDevice);
+	m_MSAASampleCount = m_MaxMSAASampleCount;
+	m_SampleRateShadingSupported = t_DeviceFeatures.sampleRateShading == VK_TRUE;
+
+	// timestamps are usable if the graphics queue family reports valid timestamp bits
+	uint32_t t_NumQueueFamilies = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(t_PhysicalDevice, &t_NumQueueFamilies, nullptr);
+	std::vector<VkQueueFamilyProperties> t_QueueFamilyProperties(t_NumQueueFamilies);
+	vkGetPhysicalDeviceQueueFamilyProperties(t_PhysicalDevice, &t_NumQueueFamilies, t_QueueFamilyProperties.data());
+
+	const uint32_t t_GraphicsFamily = CheckSupportedQueueFamilies(t_PhysicalDevice, a_Surface).m_GraphicsFamily.value();
+	m_TimestampsSupported = t_QueueFamilyProperties[t_GraphicsFamily].timestampValidBits > 0;
+	m_GraphicsFamily = t_GraphicsFamily;
+	m_AsyncComputeFamily = FindAsyncComputeQueueFamily(t_PhysicalDevice);
+	m_TimestampPeriod = t_DeviceProperties.limits.timestampPeriod;
+
+	// the bindless table is an update-after-bind set, which has its own limits
+	VkPhysicalDeviceDescriptorIndexingProperties t_IndexingProperties = {};
+	t_IndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+	VkPhysicalDeviceProperties2 t_DeviceProperties2 = {};
+	t_DeviceProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	t_DeviceProperties2.pNext = &t_IndexingProperties;
+	vkGetPhysicalDeviceProperties2(t_PhysicalDevice, &t_DeviceProperties2);
+
+	m_MaxSampledImages = std::min(t_IndexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+	                              t_IndexingProperties.maxDescriptorSetUpdateAfterBindSampledImages);
 
 #ifdef _DEBUG
 	std::cout << "Chose " << t_DeviceProperties.deviceName << " as physical device." << std::endl;
-	std::cout << "Physical Device supports up to " << m_MSAASampleCount << " MSAA Samples" << std::endl;
+	std::cout << "Physical Device supports up to " << m_MaxMSAASampleCount << " MSAA Samples" << std::endl;
+	std::cout << "Physical Device " << (m_AsyncComputeFamily.has_value() ? "has" : "has no") << " dedicated compute queue" << std::endl;
 #endif
 
 	return t_PhysicalDevice;
@@ -78,7 +206,7 @@ VkPhysicalDevice Device::ChoosePhysicalDevice(VkInstance& a_Instance, VkSurfaceK
 
 /// <summary>	Checks device suitability. </summary>
 /// <param name="a_Device">					  	The device.</param>
-/// <param name="a_Surface">				  	The Window Surface.</param>
+/// <param name="a_Surface">				  	The Window Surface, VK_NULL_HANDLE when rendering headless.</param>
 /// <param name="a_RequestedDeviceExtensions">	The Device Extensions Required.</param>
 /// <param name="a_SwapChain">				  	[in,out] The Renderer's SwapChain.</param>
 /// <returns>
@@ -99,17 +227,55 @@ bool Device::CheckDeviceSuitability(const VkPhysicalDevice a_Device, const VkSur
 
 	return	t_SupportedQueueFamilies.IsComplete() && 
 			CheckDeviceExtensionSupport(a_Device, a_RequestedDeviceExtensions) && 
-			CheckSwapChainCompatibility(a_Device, a_Surface) &&
+			(a_Surface == VK_NULL_HANDLE || CheckSwapChainCompatibility(a_Device, a_Surface)) &&
+			CheckVulkan12FeatureSupport(a_Device) &&
 			t_PhysicalDeviceFeatures.samplerAnisotropy;
 }
 
+/// <summary>
+/// 	Checks whether the physical device supports Vulkan 1.2, the descriptor indexing features
+/// 	required by the bindless texture table and timeline semaphores.
+/// </summary>
+/// <param name="a_Device">	The physical device.</param>
+/// <returns>	True if all required features are supported, false if not. </returns>
+
+bool Device::CheckVulkan12FeatureSupport(const VkPhysicalDevice& a_Device)
+{
+	VkPhysicalDeviceProperties t_DeviceProperties;
+	vkGetPhysicalDeviceProperties(a_Device, &t_DeviceProperties);
+
+	// the feature structs below are only valid to query on Vulkan 1.2 devices
+	if (t_DeviceProperties.apiVersion < VK_API_VERSION_1_2)
+	{
+		return false;
+	}
+
+	VkPhysicalDeviceVulkan12Features t_Vulkan12Features = {};
+	t_Vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+
+	VkPhysicalDeviceFeatures2 t_DeviceFeatures = {};
+	t_DeviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	t_DeviceFeatures.pNext = &t_Vulkan12Features;
+
+	vkGetPhysicalDeviceFeatures2(a_Device, &t_DeviceFeatures);
+
+	return	t_Vulkan12Features.shaderSampledImageArrayNonUniformIndexing &&
+			t_Vulkan12Features.descriptorBindingSampledImageUpdateAfterBind &&
+			t_Vulkan12Features.descriptorBindingUpdateUnusedWhilePending &&
+			t_Vulkan12Features.descriptorBindingPartiallyBound &&
+			t_Vulkan12Features.runtimeDescriptorArray &&
+			t_Vulkan12Features.timelineSemaphore;
+}
+
 bool Device::CheckSwapChainCompatibility(const VkPhysicalDevice& a_Device, const VkSurfaceKHR& a_WindowSurface)
 {
 	const auto [t_SurfaceCapabilities, t_SupportedSurfaceFormats, t_SupportedPresentModes] = SwapChain::GetSwapChainInformation(
 		a_Device, a_WindowSurface);
 
+	// the TAA resolve, the upscaler and the final blit copy into the swap chain images
 	return	!t_SupportedPresentModes.empty() &&
-			!t_SupportedSurfaceFormats.empty();
+			!t_SupportedSurfaceFormats.empty() &&
+			(t_SurfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT);
 }
 
 /// <summary>
@@ -149,6 +315,9 @@ VkSampleCountFlagBits Device::CheckMSAASampleCount(VkPhysicalDevice& a_PhysicalD
 	VkSampleCountFlags t_SampleCount = t_PhysicalDeviceProperties.limits.framebufferColorSampleCounts &
 		t_PhysicalDeviceProperties.limits.framebufferDepthSampleCounts;
 
+	// remember all supported counts so requested counts can be clamped later on
+	m_SupportedMSAASampleCounts = t_SampleCount;
+
 	if (t_SampleCount & VK_SAMPLE_COUNT_64_BIT) {return VK_SAMPLE_COUNT_64_BIT;}
 	if (t_SampleCount & VK_SAMPLE_COUNT_32_BIT) {return VK_SAMPLE_COUNT_32_BIT;}
 	if (t_SampleCount & VK_SAMPLE_COUNT_16_BIT) {return VK_SAMPLE_COUNT_16_BIT;}
@@ -183,6 +352,12 @@ void Device::CreateLogicalDevice(VkSurfaceKHR a_Surface, VkQueue& a_GraphicsQueu
 	std::vector<VkDeviceQueueCreateInfo> t_QueueCreateInfos;
 	std::set<uint32_t> t_UniqueQueueFamilies = {t_QueueFamilies.m_GraphicsFamily.value(), t_QueueFamilies.m_PresentFamily.value()};
 
+	// compute work is submitted to a separate queue if the device has a dedicated compute family
+	if (m_AsyncComputeFamily.has_value())
+	{
+		t_UniqueQueueFamilies.insert(m_AsyncComputeFamily.value());
+	}
+
 	float t_QueuePriorities = 1.0f;
 	for (uint32_t t_QueueFamily : t_UniqueQueueFamilies)
 	{
@@ -210,18 +385,47 @@ void Device::CreateLogicalDevice(VkSurfaceKHR a_Surface, VkQueue& a_GraphicsQueu
 	// TODO specify the actual features later when they become relevant
 	VkPhysicalDeviceFeatures t_PhysicalDeviceFeatures = {};
 	t_PhysicalDeviceFeatures.samplerAnisotropy = VK_TRUE;
-	t_PhysicalDeviceFeatures.sampleRateShading = VK_TRUE;
+	// only request sample rate shading if the device actually supports it
+	t_PhysicalDeviceFeatures.sampleRateShading = m_SampleRateShadingSupported ? VK_TRUE : VK_FALSE;
+
+	// descriptor indexing for the bindless texture table and timeline semaphores for synchronization,
+	// support is checked when choosing the device
+	VkPhysicalDeviceVulkan12Features t_Vulkan12Features = {};
+	t_Vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+	t_Vulkan12Features.descriptorIndexing = VK_TRUE;
+	t_Vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+	t_Vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+	t_Vulkan12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+	t_Vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+	t_Vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+	t_Vulkan12Features.timelineSemaphore = VK_TRUE;
 
 	// create the logical device
 	VkDeviceCreateInfo t_LogicalDeviceCreateInfo = {};
 	t_LogicalDeviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	t_LogicalDeviceCreateInfo.pNext = &t_Vulkan12Features;
 	t_LogicalDeviceCreateInfo.pQueueCreateInfos = t_QueueCreateInfos.data();
 	t_LogicalDeviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(t_QueueCreateInfos.size());
 
 	t_LogicalDeviceCreateInfo.pEnabledFeatures = &t_PhysicalDeviceFeatures;
 
-	t_LogicalDeviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(a_RequestedDeviceExtensions.size());
-	t_LogicalDeviceCreateInfo.ppEnabledExtensionNames = a_RequestedDeviceExtensions.data();
+	// add the optional extensions the physical device supports to the requested ones
+	std::vector<const char*> t_EnabledExtensions = a_RequestedDeviceExtensions;
+	for (const char* t_Extension : s_OptionalDeviceExtensions)
+	{
+		const bool t_Requested = std::any_of(t_EnabledExtensions.begin(), t_EnabledExtensions.end(),
+		                                     [t_Extension](const char* a_Name) { return strcmp(a_Name, t_Extension) == 0; });
+
+		if (!t_Requested && CheckDeviceExtensionSupport(m_PhysicalDevice, {t_Extension}))
+		{
+			t_EnabledExtensions.push_back(t_Extension);
+		}
+	}
+
+	m_EnabledExtensions.assign(t_EnabledExtensions.begin(), t_EnabledExtensions.end());
+
+	t_LogicalDeviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(t_EnabledExtensions.size());
+	t_LogicalDeviceCreateInfo.ppEnabledExtensionNames = t_EnabledExtensions.data();
 
 #ifdef _DEBUG
 	t_LogicalDeviceCreateInfo.enabledLayerCount = static_cast<uint32_t>(a_EnabledValidationLayers.size());
@@ -240,6 +444,14 @@ void Device::CreateLogicalDevice(VkSurfaceKHR a_Surface, VkQueue& a_GraphicsQueu
 
 	// create present queue, store the queue handle for later use
 	vkGetDeviceQueue(m_LogicalDevice, t_QueueFamilies.m_PresentFamily.value(), 0, &a_PresentQueue);
+
+	if (m_AsyncComputeFamily.has_value())
+	{
+		vkGetDeviceQueue(m_LogicalDevice, m_AsyncComputeFamily.value(), 0, &m_ComputeQueue);
+	}
+
+	m_GraphicsTimeline.Create(m_LogicalDevice);
+	m_ComputeTimeline.Create(m_LogicalDevice);
 }
 
 // Note: might cause issues because it returns a copy, not a reference
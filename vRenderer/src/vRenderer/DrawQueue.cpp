@@ -0,0 +1,193 @@
+#include "pch.h"
+#include "vRenderer/DrawQueue.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "vRenderer/JobSystem.h"
+
+DrawQueue::DrawQueue()
+= default;
+
+DrawQueue::~DrawQueue()
+= default;
+
+/// <summary>	Quantizes a normalized depth to an unsigned integer with the given number of bits. </summary>
+/// <param name="a_Depth">	The depth in [0, 1], values outside are clamped.</param>
+/// <param name="a_Bits"> 	Number of bits of the result.</param>
+/// <returns>	The quantized depth. </returns>
+
+static uint64_t QuantizeDepth(const float a_Depth, const uint32_t a_Bits)
+{
+	const uint64_t t_Max = (1ull << a_Bits) - 1;
+	return static_cast<uint64_t>(std::clamp(a_Depth, 0.0f, 1.0f) * static_cast<float>(t_Max));
+}
+
+uint64_t DrawQueue::MakeOpaqueKey(const uint32_t a_Pass, const uint32_t a_Pipeline, const uint32_t a_Material,
+                                  const uint32_t a_Mesh, const float a_Depth)
+{
+	return	(static_cast<uint64_t>(a_Pass & 0xF) << 60) |
+			(static_cast<uint64_t>(a_Pipeline & 0x7FF) << 48) |
+			(static_cast<uint64_t>(a_Material & 0xFFFF) << 32) |
+			(static_cast<uint64_t>(a_Mesh & 0xFFFF) << 16) |
+			QuantizeDepth(a_Depth, 16);
+}
+
+uint64_t DrawQueue::MakeTranslucentKey(const uint32_t a_Pass, const uint32_t a_Pipeline, const uint32_t a_Material,
+                                       const uint32_t a_Mesh, const float a_Depth)
+{
+	// inverting the depth sorts the farthest draws first
+	const uint64_t t_InvertedDepth = QuantizeDepth(1.0f - a_Depth, 24);
+
+	return	(static_cast<uint64_t>(a_Pass & 0xF) << 60) |
+			(1ull << 59) |
+			(t_InvertedDepth << 35) |
+			(static_cast<uint64_t>(a_Pipeline & 0x7FF) << 24) |
+			(static_cast<uint64_t>(a_Material & 0xFFF) << 12) |
+			static_cast<uint64_t>(a_Mesh & 0xFFF);
+}
+
+void DrawQueue::Clear(LinearArena* a_Arena)
+{
+	// storage from an earlier frame's arena may already have been rewound, so it is dropped instead of reused
+	if (a_Arena != nullptr || m_Items.get_allocator().GetArena() != nullptr)
+	{
+		m_Items = FrameVector<DrawItem>(ArenaAllocator<DrawItem>(a_Arena));
+		m_Order = FrameVector<uint32_t>(ArenaAllocator<uint32_t>(a_Arena));
+		m_Keys = FrameVector<uint64_t>(ArenaAllocator<uint64_t>(a_Arena));
+		return;
+	}
+
+	m_Items.clear();
+	m_Order.clear();
+}
+
+void DrawQueue::Add(const DrawItem& a_DrawItem)
+{
+	m_Order.push_back(static_cast<uint32_t>(m_Items.size()));
+	m_Items.push_back(a_DrawItem);
+}
+
+void DrawQueue::Sort(JobSystem& a_JobSystem)
+{
+	m_Keys.resize(m_Items.size());
+	m_Order.resize(m_Items.size());
+
+	for (size_t i = 0; i < m_Items.size(); i++)
+	{
+		m_Keys[i] = m_Items[i].m_SortKey;
+		m_Order[i] = static_cast<uint32_t>(i);
+	}
+
+	RadixSort(m_Keys, m_Order, a_JobSystem);
+}
+
+void DrawQueue::Record(CommandEncoder& a_Encoder) const
+{
+	for (const uint32_t t_Index : m_Order)
+	{
+		a_Encoder.Draw(m_Items[t_Index]);
+	}
+}
+
+BindStatistics DrawQueue::CountBinds() const
+{
+	CommandEncoder t_Encoder;
+	t_Encoder.Begin(VK_NULL_HANDLE);
+	Record(t_Encoder);
+
+	return t_Encoder.GetStatistics();
+}
+
+size_t DrawQueue::GetSize() const
+{
+	return m_Items.size();
+}
+
+void DrawQueue::RadixSort(FrameVector<uint64_t>& a_Keys, FrameVector<uint32_t>& a_Values, JobSystem& a_JobSystem)
+{
+	const size_t t_NumKeys = a_Keys.size();
+
+	if (t_NumKeys < 2)
+	{
+		return;
+	}
+
+	// below this many keys per chunk queuing a job costs more than it saves
+	constexpr size_t t_MinKeysPerChunk = 4096;
+	const size_t t_NumChunks = std::clamp<size_t>(t_NumKeys / t_MinKeysPerChunk, 1, a_JobSystem.GetThreadCount());
+	const size_t t_ChunkSize = (t_NumKeys + t_NumChunks - 1) / t_NumChunks;
+
+	// the scratch comes from the same arena as the input, so the vectors can be swapped
+	FrameVector<uint64_t> t_KeysOut(t_NumKeys, a_Keys.get_allocator());
+	FrameVector<uint32_t> t_ValuesOut(t_NumKeys, a_Values.get_allocator());
+
+	// one histogram per chunk, turned into the chunk's scatter offsets
+	FrameVector<std::array<size_t, 256>> t_Histograms(t_NumChunks, a_Keys.get_allocator());
+
+	for (uint32_t t_Shift = 0; t_Shift < 64; t_Shift += 8)
+	{
+		a_JobSystem.ParallelFor(t_NumChunks, 1, [&](const size_t a_Begin, const size_t a_End)
+		{
+			for (size_t t_Chunk = a_Begin; t_Chunk < a_End; t_Chunk++)
+			{
+				std::array<size_t, 256>& t_Histogram = t_Histograms[t_Chunk];
+				t_Histogram.fill(0);
+
+				const size_t t_End = std::min(t_NumKeys, (t_Chunk + 1) * t_ChunkSize);
+				for (size_t i = t_Chunk * t_ChunkSize; i < t_End; i++)
+				{
+					t_Histogram[(a_Keys[i] >> t_Shift) & 0xFF]++;
+				}
+			}
+		}, "RadixSort histogram");
+
+		// skip the pass if all keys share this digit, it would not change the order
+		bool t_Skip = false;
+		for (size_t t_Digit = 0; t_Digit < 256 && !t_Skip; t_Digit++)
+		{
+			size_t t_Count = 0;
+			for (const std::array<size_t, 256>& t_Histogram : t_Histograms)
+			{
+				t_Count += t_Histogram[t_Digit];
+			}
+			t_Skip = t_Count == t_NumKeys;
+		}
+
+		if (t_Skip)
+		{
+			continue;
+		}
+
+		// exclusive prefix sum over digits first and chunks second keeps the sort stable
+		size_t t_Offset = 0;
+		for (size_t t_Digit = 0; t_Digit < 256; t_Digit++)
+		{
+			for (std::array<size_t, 256>& t_Histogram : t_Histograms)
+			{
+				const size_t t_Count = t_Histogram[t_Digit];
+				t_Histogram[t_Digit] = t_Offset;
+				t_Offset += t_Count;
+			}
+		}
+
+		a_JobSystem.ParallelFor(t_NumChunks, 1, [&](const size_t a_Begin, const size_t a_End)
+		{
+			for (size_t t_Chunk = a_Begin; t_Chunk < a_End; t_Chunk++)
+			{
+				std::array<size_t, 256>& t_Offsets = t_Histograms[t_Chunk];
+
+				const size_t t_End = std::min(t_NumKeys, (t_Chunk + 1) * t_ChunkSize);
+				for (size_t i = t_Chunk * t_ChunkSize; i < t_End; i++)
+				{
+					const size_t t_Destination = t_Offsets[(a_Keys[i] >> t_Shift) & 0xFF]++;
+					t_KeysOut[t_Destination] = a_Keys[i];
+					t_ValuesOut[t_Destination] = a_Values[i];
+				}
+			}
+		}, "RadixSort scatter");
+
+		a_Keys.swap(t_KeysOut);
+		a_Values.swap(t_ValuesOut);
+	}
+}
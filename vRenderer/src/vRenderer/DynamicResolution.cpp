@@ -0,0 +1,101 @@
+#include "pch.h"
+#include "vRenderer/DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+DynamicResolution::DynamicResolution()
+= default;
+
+DynamicResolution::~DynamicResolution()
+= default;
+
+void DynamicResolution::Configure(const float a_TargetFrameTime, const float a_MinScale, const float a_MaxScale)
+{
+	m_TargetFrameTime = std::max(a_TargetFrameTime, 0.1f);
+	m_MaxScale = std::clamp(a_MaxScale, 0.1f, 1.0f);
+	m_MinScale = std::clamp(a_MinScale, 0.1f, m_MaxScale);
+
+	Reset();
+}
+
+bool DynamicResolution::Update(const float a_GpuFrameTime)
+{
+	if (a_GpuFrameTime <= 0.0f)
+	{
+		return false;
+	}
+
+	// exponential moving average, seeded with the first measurement
+	if (m_SmoothedFrameTime <= 0.0f)
+	{
+		m_SmoothedFrameTime = a_GpuFrameTime;
+	}
+	else
+	{
+		m_SmoothedFrameTime += (a_GpuFrameTime - m_SmoothedFrameTime) * m_Smoothing;
+	}
+
+	m_FramesSinceChange++;
+
+	if (m_FramesSinceChange < m_CooldownFrames)
+	{
+		return false;
+	}
+
+	// inside the band between target * (1 - hysteresis) and the target the scale is kept
+	const bool t_OverBudget = m_SmoothedFrameTime > m_TargetFrameTime;
+	const bool t_UnderBudget = m_SmoothedFrameTime < m_TargetFrameTime * (1.0f - m_Hysteresis);
+
+	if (!t_OverBudget && !t_UnderBudget)
+	{
+		return false;
+	}
+
+	// aim for the middle of the band
+	const float t_DesiredFrameTime = m_TargetFrameTime * (1.0f - m_Hysteresis * 0.5f);
+
+	// GPU cost is roughly proportional to the pixel count, i.e. to the squared scale
+	float t_NewScale = m_Scale * std::sqrt(t_DesiredFrameTime / m_SmoothedFrameTime);
+	t_NewScale = std::clamp(t_NewScale, m_Scale - m_MaxScaleChange, m_Scale + m_MaxScaleChange);
+	t_NewScale = std::round(t_NewScale / m_ScaleStep) * m_ScaleStep;
+	t_NewScale = std::clamp(t_NewScale, m_MinScale, m_MaxScale);
+
+	if (std::abs(t_NewScale - m_Scale) < 0.001f)
+	{
+		return false;
+	}
+
+	// predict the frame time at the new scale so the average does not lag behind the change
+	m_SmoothedFrameTime *= (t_NewScale * t_NewScale) / (m_Scale * m_Scale);
+	m_Scale = t_NewScale;
+	m_FramesSinceChange = 0;
+
+	return true;
+}
+
+void DynamicResolution::Reset()
+{
+	m_Scale = m_MaxScale;
+	m_SmoothedFrameTime = 0.0f;
+	m_FramesSinceChange = 0;
+}
+
+float DynamicResolution::GetScale() const
+{
+	return m_Scale;
+}
+
+float DynamicResolution::GetSmoothedFrameTime() const
+{
+	return m_SmoothedFrameTime;
+}
+
+VkExtent2D DynamicResolution::GetRenderExtent(const VkExtent2D a_FullExtent) const
+{
+	VkExtent2D t_Extent;
+	t_Extent.width = std::max(1u, static_cast<uint32_t>(static_cast<float>(a_FullExtent.width) * m_Scale));
+	t_Extent.height = std::max(1u, static_cast<uint32_t>(static_cast<float>(a_FullExtent.height) * m_Scale));
+
+	return t_Extent;
+}
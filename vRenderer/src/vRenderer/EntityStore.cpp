@@ -0,0 +1,270 @@
+#include "pch.h"
+#include "vRenderer/EntityStore.h"
+
+#include <mutex>
+
+namespace
+{
+	// sizes of the registered component types, indexed by their ids
+	std::mutex g_ComponentMutex;
+	std::vector<uint32_t> g_ComponentSizes;
+
+	uint32_t AlignOffset(const uint32_t a_Offset, const uint32_t a_Alignment)
+	{
+		return (a_Offset + a_Alignment - 1) / a_Alignment * a_Alignment;
+	}
+}
+
+EntityStore::EntityStore()
+= default;
+
+EntityStore::~EntityStore()
+= default;
+
+void EntityStore::Destroy(const Entity a_Entity)
+{
+	const EntityRecord t_Record = GetRecord(a_Entity);
+	RemoveRow(t_Record.m_Archetype, t_Record.m_Chunk, t_Record.m_Row);
+
+	EntityRecord& t_FreedRecord = m_Records[a_Entity.m_Index];
+	t_FreedRecord.m_Archetype = s_NoArchetype;
+	t_FreedRecord.m_Generation++;
+
+	m_FreeIndices.push_back(a_Entity.m_Index);
+	m_EntityCount--;
+}
+
+void EntityStore::Clear()
+{
+	for (const std::unique_ptr<Archetype>& t_Archetype : m_Archetypes)
+	{
+		t_Archetype->m_Chunks.clear();
+	}
+
+	// the records are kept so old handles stay stale instead of matching new entities
+	for (uint32_t i = 0; i < m_Records.size(); i++)
+	{
+		EntityRecord& t_Record = m_Records[i];
+
+		if (t_Record.m_Archetype != s_NoArchetype)
+		{
+			t_Record.m_Archetype = s_NoArchetype;
+			t_Record.m_Generation++;
+			m_FreeIndices.push_back(i);
+		}
+	}
+
+	m_EntityCount = 0;
+}
+
+bool EntityStore::IsAlive(const Entity a_Entity) const
+{
+	return a_Entity.m_Index < m_Records.size() && m_Records[a_Entity.m_Index].m_Archetype != s_NoArchetype &&
+		m_Records[a_Entity.m_Index].m_Generation == a_Entity.m_Generation;
+}
+
+uint32_t EntityStore::GetEntityCount() const
+{
+	return m_EntityCount;
+}
+
+uint32_t EntityStore::RegisterComponent(const uint32_t a_Size)
+{
+	std::lock_guard<std::mutex> t_Lock(g_ComponentMutex);
+
+	if (g_ComponentSizes.size() == s_MaxComponentTypes)
+	{
+		throw std::runtime_error("Error! Too many component types for the Entity Store!");
+	}
+
+	g_ComponentSizes.push_back(a_Size);
+	return static_cast<uint32_t>(g_ComponentSizes.size() - 1);
+}
+
+uint32_t EntityStore::CountComponents(ComponentMask a_Mask)
+{
+	uint32_t t_Count = 0;
+
+	for (; a_Mask != 0; a_Mask &= a_Mask - 1)
+	{
+		t_Count++;
+	}
+
+	return t_Count;
+}
+
+const EntityStore::EntityRecord& EntityStore::GetRecord(const Entity a_Entity) const
+{
+	if (!IsAlive(a_Entity))
+	{
+		throw std::runtime_error("Error! The entity does not exist!");
+	}
+
+	return m_Records[a_Entity.m_Index];
+}
+
+uint32_t EntityStore::GetArchetypeIndex(const ComponentMask a_Mask)
+{
+	const auto t_Found = m_ArchetypeIndices.find(a_Mask);
+	if (t_Found != m_ArchetypeIndices.end())
+	{
+		return t_Found->second;
+	}
+
+	std::unique_ptr<Archetype> t_Archetype = std::make_unique<Archetype>();
+	t_Archetype->m_Mask = a_Mask;
+	t_Archetype->m_Offsets.fill(s_NoOffset);
+
+	std::vector<uint32_t> t_Sizes;
+	{
+		std::lock_guard<std::mutex> t_Lock(g_ComponentMutex);
+		t_Sizes = g_ComponentSizes;
+	}
+
+	uint32_t t_EntitySize = sizeof(Entity);
+	for (uint32_t t_Id = 0; t_Id < t_Sizes.size(); t_Id++)
+	{
+		if (a_Mask >> t_Id & 1)
+		{
+			t_EntitySize += t_Sizes[t_Id];
+		}
+	}
+
+	// start from the capacity without padding and shrink it until the aligned arrays fit
+	for (uint32_t t_Capacity = s_ChunkSize / t_EntitySize; t_Capacity > 0; t_Capacity--)
+	{
+		uint32_t t_Offset = t_Capacity * static_cast<uint32_t>(sizeof(Entity));
+
+		for (uint32_t t_Id = 0; t_Id < t_Sizes.size(); t_Id++)
+		{
+			if (a_Mask >> t_Id & 1)
+			{
+				t_Offset = AlignOffset(t_Offset, s_ArrayAlignment);
+				t_Archetype->m_Offsets[t_Id] = t_Offset;
+				t_Archetype->m_Components.push_back(t_Id);
+				t_Archetype->m_Sizes.push_back(t_Sizes[t_Id]);
+				t_Offset += t_Capacity * t_Sizes[t_Id];
+			}
+		}
+
+		if (t_Offset <= s_ChunkSize)
+		{
+			t_Archetype->m_Capacity = t_Capacity;
+			break;
+		}
+
+		t_Archetype->m_Components.clear();
+		t_Archetype->m_Sizes.clear();
+	}
+
+	if (t_Archetype->m_Capacity == 0)
+	{
+		throw std::runtime_error("Error! The components of an entity do not fit into a chunk!");
+	}
+
+	const uint32_t t_Index = static_cast<uint32_t>(m_Archetypes.size());
+	m_Archetypes.push_back(std::move(t_Archetype));
+	m_ArchetypeIndices.emplace(a_Mask, t_Index);
+
+	return t_Index;
+}
+
+Entity EntityStore::AllocateEntity()
+{
+	Entity t_Entity;
+
+	if (!m_FreeIndices.empty())
+	{
+		t_Entity.m_Index = m_FreeIndices.back();
+		m_FreeIndices.pop_back();
+	}
+	else
+	{
+		t_Entity.m_Index = static_cast<uint32_t>(m_Records.size());
+		m_Records.emplace_back();
+	}
+
+	t_Entity.m_Generation = m_Records[t_Entity.m_Index].m_Generation;
+	m_EntityCount++;
+
+	return t_Entity;
+}
+
+void EntityStore::AddRow(const uint32_t a_Archetype, const Entity a_Entity)
+{
+	Archetype& t_Archetype = *m_Archetypes[a_Archetype];
+
+	if (t_Archetype.m_Chunks.empty() || t_Archetype.m_Chunks.back().m_Count == t_Archetype.m_Capacity)
+	{
+		Chunk t_Chunk;
+		t_Chunk.m_Data = std::make_unique<uint8_t[]>(s_ChunkSize);
+		t_Archetype.m_Chunks.push_back(std::move(t_Chunk));
+	}
+
+	Chunk& t_Chunk = t_Archetype.m_Chunks.back();
+	const uint32_t t_Row = t_Chunk.m_Count++;
+	std::memcpy(t_Chunk.m_Data.get() + t_Row * sizeof(Entity), &a_Entity, sizeof(Entity));
+
+	EntityRecord& t_Record = m_Records[a_Entity.m_Index];
+	t_Record.m_Archetype = a_Archetype;
+	t_Record.m_Chunk = static_cast<uint32_t>(t_Archetype.m_Chunks.size() - 1);
+	t_Record.m_Row = t_Row;
+}
+
+void EntityStore::RemoveRow(const uint32_t a_Archetype, const uint32_t a_Chunk, const uint32_t a_Row)
+{
+	Archetype& t_Archetype = *m_Archetypes[a_Archetype];
+	const uint32_t t_LastChunk = static_cast<uint32_t>(t_Archetype.m_Chunks.size() - 1);
+	Chunk& t_Last = t_Archetype.m_Chunks[t_LastChunk];
+	const uint32_t t_LastRow = t_Last.m_Count - 1;
+
+	if (a_Chunk != t_LastChunk || a_Row != t_LastRow)
+	{
+		uint8_t* t_Target = t_Archetype.m_Chunks[a_Chunk].m_Data.get();
+		const uint8_t* t_Source = t_Last.m_Data.get();
+
+		const Entity t_Moved = GetEntities(t_Last)[t_LastRow];
+		std::memcpy(t_Target + a_Row * sizeof(Entity), &t_Moved, sizeof(Entity));
+
+		for (size_t i = 0; i < t_Archetype.m_Components.size(); i++)
+		{
+			const uint32_t t_Size = t_Archetype.m_Sizes[i];
+			const uint32_t t_Offset = t_Archetype.m_Offsets[t_Archetype.m_Components[i]];
+			std::memcpy(t_Target + t_Offset + a_Row * t_Size, t_Source + t_Offset + t_LastRow * t_Size, t_Size);
+		}
+
+		m_Records[t_Moved.m_Index].m_Chunk = a_Chunk;
+		m_Records[t_Moved.m_Index].m_Row = a_Row;
+	}
+
+	if (--t_Last.m_Count == 0)
+	{
+		t_Archetype.m_Chunks.pop_back();
+	}
+}
+
+void EntityStore::MoveEntity(const Entity a_Entity, const ComponentMask a_Mask)
+{
+	const EntityRecord t_Old = GetRecord(a_Entity);
+	const uint32_t t_NewArchetype = GetArchetypeIndex(a_Mask);
+	AddRow(t_NewArchetype, a_Entity);
+
+	const EntityRecord& t_New = m_Records[a_Entity.m_Index];
+	const Archetype& t_Source = *m_Archetypes[t_Old.m_Archetype];
+	const Archetype& t_Target = *m_Archetypes[t_NewArchetype];
+	const uint8_t* t_SourceData = t_Source.m_Chunks[t_Old.m_Chunk].m_Data.get();
+	uint8_t* t_TargetData = t_Target.m_Chunks[t_New.m_Chunk].m_Data.get();
+
+	for (size_t i = 0; i < t_Source.m_Components.size(); i++)
+	{
+		const uint32_t t_Id = t_Source.m_Components[i];
+		if (a_Mask >> t_Id & 1)
+		{
+			const uint32_t t_Size = t_Source.m_Sizes[i];
+			std::memcpy(t_TargetData + t_Target.m_Offsets[t_Id] + t_New.m_Row * t_Size,
+			            t_SourceData + t_Source.m_Offsets[t_Id] + t_Old.m_Row * t_Size, t_Size);
+		}
+	}
+
+	RemoveRow(t_Old.m_Archetype, t_Old.m_Chunk, t_Old.m_Row);
+}
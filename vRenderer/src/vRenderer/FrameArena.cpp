@@ -0,0 +1,114 @@
+#include "pch.h"
+#include "vRenderer/FrameArena.h"
+
+#include <algorithm>
+
+namespace
+{
+	size_t AlignUp(const size_t a_Value, const size_t a_Alignment)
+	{
+		return (a_Value + a_Alignment - 1) & ~(a_Alignment - 1);
+	}
+}
+
+LinearArena::LinearArena()
+= default;
+
+LinearArena::~LinearArena()
+= default;
+
+void LinearArena::Create(const size_t a_Capacity)
+{
+	m_Block = std::make_unique<uint8_t[]>(a_Capacity);
+	m_Capacity = a_Capacity;
+	m_Offset = 0;
+}
+
+void LinearArena::Destroy()
+{
+	m_Block.reset();
+	m_OverflowBlocks.clear();
+	m_Capacity = 0;
+	m_Offset = 0;
+	m_OverflowSize = 0;
+}
+
+void* LinearArena::Allocate(const size_t a_Size, const size_t a_Alignment)
+{
+	// align the address rather than the offset, the block itself is only aligned for max_align_t
+	const uintptr_t t_Base = reinterpret_cast<uintptr_t>(m_Block.get());
+	const size_t t_Offset = AlignUp(t_Base + m_Offset, a_Alignment) - t_Base;
+
+	if (m_Block && t_Offset + a_Size <= m_Capacity)
+	{
+		m_Offset = t_Offset + a_Size;
+		return m_Block.get() + t_Offset;
+	}
+
+	// keep serving the frame from a separate block, the main one is grown on Reset
+	const size_t t_BlockSize = a_Size + a_Alignment;
+	m_OverflowBlocks.push_back(std::make_unique<uint8_t[]>(t_BlockSize));
+	m_OverflowSize += t_BlockSize;
+
+	const uintptr_t t_OverflowBase = reinterpret_cast<uintptr_t>(m_OverflowBlocks.back().get());
+	return reinterpret_cast<void*>(AlignUp(t_OverflowBase, a_Alignment));
+}
+
+void LinearArena::Reset()
+{
+	if (!m_OverflowBlocks.empty())
+	{
+		// grow geometrically so a slowly growing workload does not reallocate every time
+		Create(std::max(m_Capacity * 2, m_Offset + m_OverflowSize));
+		m_OverflowBlocks.clear();
+		m_OverflowSize = 0;
+	}
+
+	m_Offset = 0;
+}
+
+size_t LinearArena::GetUsedSize() const
+{
+	return m_Offset + m_OverflowSize;
+}
+
+size_t LinearArena::GetCapacity() const
+{
+	return m_Capacity;
+}
+
+FrameArena::FrameArena()
+= default;
+
+FrameArena::~FrameArena()
+= default;
+
+void FrameArena::Create(const uint32_t a_FramesInFlight, const size_t a_InitialCapacity)
+{
+	m_Arenas.resize(a_FramesInFlight);
+
+	for (LinearArena& t_Arena : m_Arenas)
+	{
+		t_Arena.Create(a_InitialCapacity);
+	}
+
+	m_CurrentFrame = 0;
+}
+
+void FrameArena::Destroy()
+{
+	m_Arenas.clear();
+}
+
+LinearArena& FrameArena::BeginFrame(const uint32_t a_Frame)
+{
+	m_CurrentFrame = a_Frame;
+	m_Arenas[a_Frame].Reset();
+
+	return m_Arenas[a_Frame];
+}
+
+LinearArena& FrameArena::GetCurrent()
+{
+	return m_Arenas[m_CurrentFrame];
+}
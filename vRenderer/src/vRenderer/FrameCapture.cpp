@@ -0,0 +1,358 @@
+#include "pch.h"
+#include "vRenderer/FrameCapture.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "vRenderer/Device.h"
+#include "vRenderer/helpers/VulkanHelpers.h"
+
+FrameCapture::FrameCapture()
+= default;
+
+FrameCapture::~FrameCapture()
+= default;
+
+void FrameCapture::Start(const Device& a_Device, const VkExtent2D a_Extent, const VkFormat a_ImageFormat,
+                         const std::string& a_FilePath, const CaptureFormat a_Format, const uint32_t a_FrameRate,
+                         const uint32_t a_RingSize)
+{
+	if (m_Capturing)
+	{
+		throw std::runtime_error("Error! A capture is already running!");
+	}
+
+	switch (a_ImageFormat)
+	{
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB:
+		m_SwapRedBlue = false;
+		break;
+	case VK_FORMAT_B8G8R8A8_UNORM:
+	case VK_FORMAT_B8G8R8A8_SRGB:
+		m_SwapRedBlue = true;
+		break;
+	default:
+		throw std::runtime_error("Error! The image format is not supported for capturing!");
+	}
+
+	m_File.open(a_FilePath, std::ios::binary | std::ios::trunc);
+
+	if (!m_File.is_open())
+	{
+		throw std::runtime_error("Error! Could not open the capture file for writing!");
+	}
+
+	m_Extent = a_Extent;
+	m_Format = a_Format;
+	m_FilePath = a_FilePath;
+	m_Segment = 0;
+	m_FrameRate = a_FrameRate;
+
+	m_Slots.assign(std::max(a_RingSize, 1u), {});
+	for (Slot& t_Slot : m_Slots)
+	{
+		t_Slot.m_Buffer.CreateReadbackBuffer(a_Device, static_cast<VkDeviceSize>(a_Extent.width) * a_Extent.height * 4);
+	}
+
+	m_InFlight.clear();
+	m_EncodeQueue.clear();
+	m_RecordedSlot = -1;
+	m_CapturedFrames = 0;
+	m_DroppedFrames = 0;
+
+	if (m_Format == CaptureFormat::Y4M)
+	{
+		// the chroma planes are subsampled by 2 in both directions
+		const size_t t_ChromaSize = static_cast<size_t>((a_Extent.width + 1) / 2) * ((a_Extent.height + 1) / 2);
+		m_Scratch.resize(static_cast<size_t>(a_Extent.width) * a_Extent.height + 2 * t_ChromaSize);
+
+		m_File << "YUV4MPEG2 W" << a_Extent.width << " H" << a_Extent.height << " F" << a_FrameRate
+			<< ":1 Ip A1:1 C420jpeg\n";
+	}
+	else
+	{
+		m_Scratch.resize(m_SwapRedBlue ? static_cast<size_t>(a_Extent.width) * a_Extent.height * 4 : 0);
+	}
+
+	m_Stopping = false;
+	m_Capturing = true;
+	m_Encoder = std::thread(&FrameCapture::EncodeLoop, this);
+}
+
+void FrameCapture::Stop(const Device& a_Device)
+{
+	if (!m_Capturing)
+	{
+		return;
+	}
+
+	// every submitted copy has to finish before its slot can be written
+	vkDeviceWaitIdle(a_Device.GetLogicalDevice());
+
+	if (m_RecordedSlot >= 0)
+	{
+		m_Slots[m_RecordedSlot].m_State = SlotState::Free;
+		m_RecordedSlot = -1;
+	}
+
+	Poll(UINT64_MAX);
+
+	{
+		std::lock_guard<std::mutex> t_Lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_SlotQueued.notify_all();
+	m_Encoder.join();
+
+	for (Slot& t_Slot : m_Slots)
+	{
+		t_Slot.m_Buffer.DestroyBuffer(a_Device.GetLogicalDevice());
+	}
+
+	m_Slots.clear();
+	m_InFlight.clear();
+	m_Scratch = {};
+	m_File.close();
+	m_Capturing = false;
+}
+
+void FrameCapture::Restart(const Device& a_Device, const VkExtent2D a_Extent, const VkFormat a_ImageFormat)
+{
+	if (!m_Capturing || (a_Extent.width == m_Extent.width && a_Extent.height == m_Extent.height))
+	{
+		return;
+	}
+
+	const std::string t_FilePath = m_FilePath;
+	const uint32_t t_Segment = m_Segment + 1;
+	const uint32_t t_RingSize = static_cast<uint32_t>(m_Slots.size());
+
+	Stop(a_Device);
+
+	const uint64_t t_CapturedFrames = m_CapturedFrames;
+	const uint64_t t_DroppedFrames = m_DroppedFrames;
+
+	// the suffix goes before the extension, unless the dot belongs to a directory
+	std::string t_SegmentPath = t_FilePath;
+	const size_t t_Dot = t_FilePath.find_last_of('.');
+	const size_t t_Separator = t_FilePath.find_last_of("/\\");
+	const size_t t_Insert = t_Dot != std::string::npos && (t_Separator == std::string::npos || t_Dot > t_Separator)
+		                        ? t_Dot
+		                        : t_FilePath.size();
+	t_SegmentPath.insert(t_Insert, "_" + std::to_string(t_Segment));
+
+	Start(a_Device, a_Extent, a_ImageFormat, t_SegmentPath, m_Format, m_FrameRate, t_RingSize);
+
+	m_FilePath = t_FilePath;
+	m_Segment = t_Segment;
+	m_CapturedFrames = t_CapturedFrames;
+	m_DroppedFrames = t_DroppedFrames;
+}
+
+bool FrameCapture::IsCapturing() const
+{
+	return m_Capturing;
+}
+
+void FrameCapture::Poll(const uint64_t a_CompletedValue)
+{
+	if (!m_Capturing)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> t_Lock(m_Mutex);
+
+		while (!m_InFlight.empty() && m_Slots[m_InFlight.front()].m_SubmitValue <= a_CompletedValue)
+		{
+			m_Slots[m_InFlight.front()].m_State = SlotState::Encoding;
+			m_EncodeQueue.push_back(m_InFlight.front());
+			m_InFlight.pop_front();
+		}
+	}
+
+	m_SlotQueued.notify_one();
+}
+
+void FrameCapture::RecordCapture(VkCommandBuffer a_CommandBuffer, VkImage a_Image, const VkExtent2D a_Extent,
+                                 const VkImageLayout a_Layout)
+{
+	// a frame between a resize and the restart is not a frame the encoder could not keep up with
+	if (!m_Capturing || a_Extent.width != m_Extent.width || a_Extent.height != m_Extent.height)
+	{
+		return;
+	}
+
+	uint32_t t_SlotIndex = 0;
+
+	{
+		std::lock_guard<std::mutex> t_Lock(m_Mutex);
+
+		const auto t_Free = std::find_if(m_Slots.begin(), m_Slots.end(), [](const Slot& a_Slot)
+		{
+			return a_Slot.m_State == SlotState::Free;
+		});
+
+		// dropping a frame is preferred over waiting for the encoder
+		if (t_Free == m_Slots.end())
+		{
+			m_DroppedFrames++;
+			return;
+		}
+
+		t_Free->m_State = SlotState::Recorded;
+		t_SlotIndex = static_cast<uint32_t>(t_Free - m_Slots.begin());
+	}
+
+	// the image was last written by the render pass, a copy or a layout transition
+	InsertImageBarrier(a_CommandBuffer, a_Image, VK_IMAGE_ASPECT_COLOR_BIT,
+	                   a_Layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+	                   VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_WRITE_BIT,
+	                   VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+
+	m_Slots[t_SlotIndex].m_Buffer.RecordImageCopy(a_CommandBuffer, a_Image, a_Extent, 4);
+
+	InsertImageBarrier(a_CommandBuffer, a_Image, VK_IMAGE_ASPECT_COLOR_BIT,
+	                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, a_Layout,
+	                   VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+	                   VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0);
+
+	m_RecordedSlot = static_cast<int32_t>(t_SlotIndex);
+}
+
+void FrameCapture::SetSubmitValue(const uint64_t a_SubmitValue)
+{
+	if (m_RecordedSlot < 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> t_Lock(m_Mutex);
+
+	m_Slots[m_RecordedSlot].m_SubmitValue = a_SubmitValue;
+	m_Slots[m_RecordedSlot].m_State = SlotState::InFlight;
+	m_InFlight.push_back(static_cast<uint32_t>(m_RecordedSlot));
+	m_RecordedSlot = -1;
+}
+
+uint64_t FrameCapture::GetCapturedFrames() const
+{
+	std::lock_guard<std::mutex> t_Lock(m_Mutex);
+	return m_CapturedFrames;
+}
+
+uint64_t FrameCapture::GetDroppedFrames() const
+{
+	std::lock_guard<std::mutex> t_Lock(m_Mutex);
+	return m_DroppedFrames;
+}
+
+void FrameCapture::EncodeLoop()
+{
+	while (true)
+	{
+		uint32_t t_SlotIndex;
+
+		{
+			std::unique_lock<std::mutex> t_Lock(m_Mutex);
+			m_SlotQueued.wait(t_Lock, [this] { return !m_EncodeQueue.empty() || m_Stopping; });
+
+			if (m_EncodeQueue.empty())
+			{
+				return;
+			}
+
+			t_SlotIndex = m_EncodeQueue.front();
+			m_EncodeQueue.pop_front();
+		}
+
+		// the slot is not reused before it is freed below, so its memory is read in place
+		WriteFrame(m_Slots[t_SlotIndex].m_Buffer.GetData());
+
+		std::lock_guard<std::mutex> t_Lock(m_Mutex);
+		m_Slots[t_SlotIndex].m_State = SlotState::Free;
+		m_CapturedFrames++;
+	}
+}
+
+void FrameCapture::WriteFrame(const uint8_t* a_Pixels)
+{
+	const uint32_t t_Width = m_Extent.width;
+	const uint32_t t_Height = m_Extent.height;
+	const uint32_t t_Red = m_SwapRedBlue ? 2 : 0;
+	const uint32_t t_Blue = m_SwapRedBlue ? 0 : 2;
+
+	if (m_Format == CaptureFormat::Raw)
+	{
+		if (!m_SwapRedBlue)
+		{
+			m_File.write(reinterpret_cast<const char*>(a_Pixels), static_cast<std::streamsize>(t_Width) * t_Height * 4);
+			return;
+		}
+
+		for (size_t i = 0; i < static_cast<size_t>(t_Width) * t_Height; i++)
+		{
+			m_Scratch[i * 4 + 0] = a_Pixels[i * 4 + 2];
+			m_Scratch[i * 4 + 1] = a_Pixels[i * 4 + 1];
+			m_Scratch[i * 4 + 2] = a_Pixels[i * 4 + 0];
+			m_Scratch[i * 4 + 3] = a_Pixels[i * 4 + 3];
+		}
+
+		m_File.write(reinterpret_cast<const char*>(m_Scratch.data()), static_cast<std::streamsize>(m_Scratch.size()));
+		return;
+	}
+
+	// BT.601 studio range, chroma from the average of each 2x2 block
+	const uint32_t t_ChromaWidth = (t_Width + 1) / 2;
+	const uint32_t t_ChromaHeight = (t_Height + 1) / 2;
+	uint8_t* t_LumaPlane = m_Scratch.data();
+	uint8_t* t_BluePlane = t_LumaPlane + static_cast<size_t>(t_Width) * t_Height;
+	uint8_t* t_RedPlane = t_BluePlane + static_cast<size_t>(t_ChromaWidth) * t_ChromaHeight;
+
+	for (uint32_t t_Y = 0; t_Y < t_Height; t_Y++)
+	{
+		for (uint32_t t_X = 0; t_X < t_Width; t_X++)
+		{
+			const uint8_t* t_Pixel = a_Pixels + (static_cast<size_t>(t_Y) * t_Width + t_X) * 4;
+			const int t_R = t_Pixel[t_Red];
+			const int t_G = t_Pixel[1];
+			const int t_B = t_Pixel[t_Blue];
+
+			t_LumaPlane[static_cast<size_t>(t_Y) * t_Width + t_X] =
+				static_cast<uint8_t>(((66 * t_R + 129 * t_G + 25 * t_B + 128) >> 8) + 16);
+		}
+	}
+
+	for (uint32_t t_Y = 0; t_Y < t_ChromaHeight; t_Y++)
+	{
+		for (uint32_t t_X = 0; t_X < t_ChromaWidth; t_X++)
+		{
+			// odd extents repeat the last row or column
+			int t_R = 0;
+			int t_G = 0;
+			int t_B = 0;
+			for (uint32_t t_Sample = 0; t_Sample < 4; t_Sample++)
+			{
+				const uint32_t t_SampleX = std::min(t_X * 2 + (t_Sample & 1), t_Width - 1);
+				const uint32_t t_SampleY = std::min(t_Y * 2 + (t_Sample >> 1), t_Height - 1);
+				const uint8_t* t_Pixel = a_Pixels + (static_cast<size_t>(t_SampleY) * t_Width + t_SampleX) * 4;
+				t_R += t_Pixel[t_Red];
+				t_G += t_Pixel[1];
+				t_B += t_Pixel[t_Blue];
+			}
+
+			t_R /= 4;
+			t_G /= 4;
+			t_B /= 4;
+
+			const size_t t_Index = static_cast<size_t>(t_Y) * t_ChromaWidth + t_X;
+			t_BluePlane[t_Index] = static_cast<uint8_t>(((-38 * t_R - 74 * t_G + 112 * t_B + 128) >> 8) + 128);
+			t_RedPlane[t_Index] = static_cast<uint8_t>(((112 * t_R - 94 * t_G - 18 * t_B + 128) >> 8) + 128);
+		}
+	}
+
+	m_File << "FRAME\n";
+	m_File.write(reinterpret_cast<const char*>(m_Scratch.data()), static_cast<std::streamsize>(m_Scratch.size()));
+}
@@ -0,0 +1,465 @@
+#include "pch.h"
+#include "vRenderer/FrameExporter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <climits>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "vRenderer/Device.h"
+#include "vRenderer/helpers/VulkanHelpers.h"
+
+namespace
+{
+	VkDeviceSize AlignUp(const VkDeviceSize a_Value, const VkDeviceSize a_Alignment)
+	{
+		return (a_Value + a_Alignment - 1) / a_Alignment * a_Alignment;
+	}
+
+	// creates and maps a POSIX shared memory object, replacing one of the same name
+	void* MapSharedMemory(const std::string& a_Name, const size_t a_Size, int& a_Fd)
+	{
+#if defined(__linux__)
+		// truncating an existing object would shrink it under consumers still mapping it, unlinking
+		// leaves their memory intact until they let go of it
+		shm_unlink(a_Name.c_str());
+		a_Fd = shm_open(a_Name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+
+		if (a_Fd < 0)
+		{
+			throw std::runtime_error("Error! Could not create the shared memory object for frame export!");
+		}
+
+		void* t_Memory = MAP_FAILED;
+		if (ftruncate(a_Fd, static_cast<off_t>(a_Size)) == 0)
+		{
+			t_Memory = mmap(nullptr, a_Size, PROT_READ | PROT_WRITE, MAP_SHARED, a_Fd, 0);
+		}
+
+		if (t_Memory == MAP_FAILED)
+		{
+			close(a_Fd);
+			shm_unlink(a_Name.c_str());
+			a_Fd = -1;
+			throw std::runtime_error("Error! Could not map the shared memory object for frame export!");
+		}
+
+		return t_Memory;
+#else
+		throw std::runtime_error("Error! Frame export through shared memory is only supported on Linux!");
+#endif
+	}
+
+	void UnmapSharedMemory(const std::string& a_Name, void* a_Memory, const size_t a_Size, const int a_Fd)
+	{
+#if defined(__linux__)
+		munmap(a_Memory, a_Size);
+		close(a_Fd);
+		shm_unlink(a_Name.c_str());
+#endif
+	}
+
+	// the futex is shared between processes, so the private futex operations can not be used
+	void WakeWaiters(std::atomic<uint32_t>& a_Word)
+	{
+#if defined(__linux__)
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(&a_Word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+	}
+
+	void WaitWhileEqual(const std::atomic<uint32_t>& a_Word, const uint32_t a_Value, const uint32_t a_TimeoutMs)
+	{
+#if defined(__linux__)
+		timespec t_Timeout = {};
+		t_Timeout.tv_sec = a_TimeoutMs / 1000;
+		t_Timeout.tv_nsec = static_cast<long>(a_TimeoutMs % 1000) * 1000000;
+
+		syscall(SYS_futex, reinterpret_cast<const uint32_t*>(&a_Word), FUTEX_WAIT, a_Value, &t_Timeout, nullptr, 0);
+#endif
+	}
+
+	bool SupportsTimelineFdExport(const Device& a_Device)
+	{
+		if (!a_Device.IsExtensionEnabled(VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME))
+		{
+			return false;
+		}
+
+		VkSemaphoreTypeCreateInfo t_TypeInfo = {};
+		t_TypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		t_TypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+
+		VkPhysicalDeviceExternalSemaphoreInfo t_SemaphoreInfo = {};
+		t_SemaphoreInfo.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_SEMAPHORE_INFO;
+		t_SemaphoreInfo.pNext = &t_TypeInfo;
+		t_SemaphoreInfo.handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT;
+
+		VkExternalSemaphoreProperties t_Properties = {};
+		t_Properties.sType = VK_STRUCTURE_TYPE_EXTERNAL_SEMAPHORE_PROPERTIES;
+		vkGetPhysicalDeviceExternalSemaphoreProperties(a_Device.GetPhysicalDevice(), &t_SemaphoreInfo, &t_Properties);
+
+		return t_Properties.externalSemaphoreFeatures & VK_EXTERNAL_SEMAPHORE_FEATURE_EXPORTABLE_BIT;
+	}
+}
+
+FrameExporter::FrameExporter()
+= default;
+
+FrameExporter::~FrameExporter()
+= default;
+
+void FrameExporter::Create(const Device& a_Device, const VkExtent2D a_Extent, const VkFormat a_Format,
+                           const std::string& a_Name, const uint32_t a_SlotCount, const FrameExportMode a_PreferredMode)
+{
+	if (m_Exporting)
+	{
+		throw std::runtime_error("Error! Frames are already being exported!");
+	}
+
+	if (a_SlotCount == 0 || a_SlotCount > SharedFrameRing::s_MaxSlots)
+	{
+		throw std::runtime_error("Error! Unsupported number of frame export slots!");
+	}
+
+	if (a_Format != VK_FORMAT_R8G8B8A8_UNORM && a_Format != VK_FORMAT_R8G8B8A8_SRGB &&
+		a_Format != VK_FORMAT_B8G8R8A8_UNORM && a_Format != VK_FORMAT_B8G8R8A8_SRGB)
+	{
+		throw std::runtime_error("Error! The image format is not supported for frame export!");
+	}
+
+	const bool t_CanExport = a_PreferredMode == FrameExportMode::ExternalMemory &&
+		ExternalBuffer::SupportsFdExport(a_Device) && SupportsTimelineFdExport(a_Device);
+	m_Mode = t_CanExport ? FrameExportMode::ExternalMemory : FrameExportMode::SharedMemory;
+
+	// imported host memory has to be aligned in address and size, pages are enough otherwise
+	const VkDeviceSize t_HostAlignment = m_Mode == FrameExportMode::SharedMemory
+		                                     ? ExternalBuffer::GetHostPointerAlignment(a_Device)
+		                                     : 0;
+	const VkDeviceSize t_Alignment = std::max<VkDeviceSize>(t_HostAlignment, 4096);
+	const VkDeviceSize t_FrameSize = static_cast<VkDeviceSize>(a_Extent.width) * a_Extent.height * 4;
+	const VkDeviceSize t_DataOffset = AlignUp(sizeof(SharedFrameRing), t_Alignment);
+
+	m_Extent = a_Extent;
+	m_SlotSize = AlignUp(t_FrameSize, t_Alignment);
+	m_Name = a_Name;
+	m_Format = a_Format;
+	m_PreferredMode = a_PreferredMode;
+	m_RingSize = static_cast<size_t>(t_DataOffset);
+	if (m_Mode == FrameExportMode::SharedMemory)
+	{
+		m_RingSize += static_cast<size_t>(m_SlotSize * a_SlotCount);
+	}
+
+	void* t_Memory = MapSharedMemory(m_Name, m_RingSize, m_RingFd);
+	m_Ring = new(t_Memory) SharedFrameRing();
+
+	try
+	{
+		if (m_Mode == FrameExportMode::ExternalMemory)
+		{
+			m_SlotBuffer.CreateExportable(a_Device, m_SlotSize * a_SlotCount);
+			m_HasSlotBuffer = true;
+
+			CreateExportedSemaphore(a_Device);
+		}
+		else
+		{
+			uint8_t* t_Slots = static_cast<uint8_t*>(t_Memory) + t_DataOffset;
+			m_HasSlotBuffer = t_HostAlignment != 0 &&
+				m_SlotBuffer.CreateFromHostPointer(a_Device, t_Slots, m_SlotSize * a_SlotCount);
+
+			if (!m_HasSlotBuffer)
+			{
+				m_StagingBuffers.resize(a_SlotCount);
+				for (ReadbackBuffer& t_Buffer : m_StagingBuffers)
+				{
+					t_Buffer.CreateReadbackBuffer(a_Device, t_FrameSize);
+				}
+			}
+		}
+	}
+	catch (...)
+	{
+		Destroy(a_Device);
+		throw;
+	}
+
+	VkPhysicalDeviceIDProperties t_IDProperties = {};
+	t_IDProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+
+	VkPhysicalDeviceProperties2 t_Properties = {};
+	t_Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	t_Properties.pNext = &t_IDProperties;
+	vkGetPhysicalDeviceProperties2(a_Device.GetPhysicalDevice(), &t_Properties);
+
+	m_Ring->m_Version = SharedFrameRing::s_Version;
+	m_Ring->m_Width = a_Extent.width;
+	m_Ring->m_Height = a_Extent.height;
+	m_Ring->m_Format = static_cast<uint32_t>(a_Format);
+	m_Ring->m_SlotCount = a_SlotCount;
+	m_Ring->m_Mode = static_cast<uint32_t>(m_Mode);
+	m_Ring->m_SlotSize = m_SlotSize;
+	m_Ring->m_DataOffset = m_Mode == FrameExportMode::SharedMemory ? t_DataOffset : 0;
+	m_Ring->m_MemorySize = m_Mode == FrameExportMode::ExternalMemory ? m_SlotBuffer.GetAllocationSize() : 0;
+	memcpy(m_Ring->m_DeviceUuid, t_IDProperties.deviceUUID, VK_UUID_SIZE);
+
+	// consumers check the magic number before anything else, it is written last
+	std::atomic_thread_fence(std::memory_order_release);
+	m_Ring->m_Magic = SharedFrameRing::s_Magic;
+
+	m_NextFrame = 1;
+	m_RecordedFrame = 0;
+	m_Exporting = true;
+}
+
+void FrameExporter::Destroy(const Device& a_Device)
+{
+	if (m_Ring == nullptr)
+	{
+		return;
+	}
+
+	// imported host memory has to be released before the mapping is gone
+	if (m_HasSlotBuffer)
+	{
+		m_SlotBuffer.DestroyBuffer(a_Device.GetLogicalDevice());
+		m_HasSlotBuffer = false;
+	}
+
+	for (ReadbackBuffer& t_Buffer : m_StagingBuffers)
+	{
+		t_Buffer.DestroyBuffer(a_Device.GetLogicalDevice());
+	}
+
+	m_StagingBuffers.clear();
+
+	vkDestroySemaphore(a_Device.GetLogicalDevice(), m_ExportedSemaphore, nullptr);
+	m_ExportedSemaphore = VK_NULL_HANDLE;
+
+	// consumers waiting for the next frame would otherwise wait for their timeout
+	m_Ring->m_Ended.store(1, std::memory_order_release);
+	m_Ring->m_Sequence.fetch_add(1, std::memory_order_release);
+	WakeWaiters(m_Ring->m_Sequence);
+
+	UnmapSharedMemory(m_Name, m_Ring, m_RingSize, m_RingFd);
+	m_Ring = nullptr;
+	m_RingFd = -1;
+
+	m_PendingFrames.clear();
+	m_RecordedFrame = 0;
+	m_Exporting = false;
+}
+
+void FrameExporter::Resize(const Device& a_Device, const VkExtent2D a_Extent)
+{
+	if (!m_Exporting || (a_Extent.width == m_Extent.width && a_Extent.height == m_Extent.height))
+	{
+		return;
+	}
+
+	const std::string t_Name = m_Name;
+	const uint32_t t_SlotCount = m_Ring->m_SlotCount;
+
+	Destroy(a_Device);
+	Create(a_Device, a_Extent, m_Format, t_Name, t_SlotCount, m_PreferredMode);
+}
+
+bool FrameExporter::IsExporting() const
+{
+	return m_Exporting;
+}
+
+FrameExportMode FrameExporter::GetMode() const
+{
+	return m_Mode;
+}
+
+void FrameExporter::Poll(const uint64_t a_CompletedValue)
+{
+	while (!m_PendingFrames.empty() && m_PendingFrames.front().m_SubmitValue <= a_CompletedValue)
+	{
+		const uint64_t t_Frame = m_PendingFrames.front().m_Frame;
+		m_PendingFrames.pop_front();
+
+		// without host imports this is the one copy on the CPU
+		if (!m_StagingBuffers.empty())
+		{
+			const uint32_t t_Slot = static_cast<uint32_t>((t_Frame - 1) % m_Ring->m_SlotCount);
+			uint8_t* t_Destination = reinterpret_cast<uint8_t*>(m_Ring) + m_Ring->m_DataOffset + t_Slot * m_SlotSize;
+			memcpy(t_Destination, m_StagingBuffers[t_Slot].GetData(), static_cast<size_t>(m_StagingBuffers[t_Slot].GetSize()));
+		}
+
+		Publish(t_Frame);
+	}
+}
+
+void FrameExporter::RecordExport(VkCommandBuffer a_CommandBuffer, VkImage a_Image, const VkExtent2D a_Extent,
+                                 const VkImageLayout a_Layout)
+{
+	if (!m_Exporting || a_Extent.width != m_Extent.width || a_Extent.height != m_Extent.height)
+	{
+		return;
+	}
+
+	const uint64_t t_Frame = m_NextFrame++;
+	const uint32_t t_Slot = static_cast<uint32_t>((t_Frame - 1) % m_Ring->m_SlotCount);
+
+	// the slot's previous frame finished frames ago, consumers still reading it notice the overwrite
+	m_Ring->m_SlotFrames[t_Slot].store(0, std::memory_order_release);
+
+	InsertImageBarrier(a_CommandBuffer, a_Image, VK_IMAGE_ASPECT_COLOR_BIT,
+	                   a_Layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+	                   VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_WRITE_BIT,
+	                   VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+
+	if (m_HasSlotBuffer)
+	{
+		VkBufferImageCopy t_Region = {};
+		t_Region.bufferOffset = t_Slot * m_SlotSize;
+		t_Region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+		t_Region.imageExtent = {a_Extent.width, a_Extent.height, 1};
+
+		vkCmdCopyImageToBuffer(a_CommandBuffer, a_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_SlotBuffer.GetBuffer(),
+		                       1, &t_Region);
+
+		// imported host memory is read by the consumers once the submission has finished
+		InsertMemoryBarrier(a_CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+		                    VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+	}
+	else
+	{
+		m_StagingBuffers[t_Slot].RecordImageCopy(a_CommandBuffer, a_Image, a_Extent, 4);
+	}
+
+	InsertImageBarrier(a_CommandBuffer, a_Image, VK_IMAGE_ASPECT_COLOR_BIT,
+	                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, a_Layout,
+	                   VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+	                   VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0);
+
+	m_RecordedFrame = t_Frame;
+}
+
+void FrameExporter::AddSignal(FrameVector<VkSemaphore>& a_Semaphores, FrameVector<uint64_t>& a_Values) const
+{
+	if (m_Mode != FrameExportMode::ExternalMemory || m_RecordedFrame == 0)
+	{
+		return;
+	}
+
+	a_Semaphores.push_back(m_ExportedSemaphore);
+	a_Values.push_back(m_RecordedFrame);
+}
+
+void FrameExporter::SetSubmitValue(const uint64_t a_SubmitValue)
+{
+	if (m_RecordedFrame == 0)
+	{
+		return;
+	}
+
+	// consumers of exported memory wait on the semaphore on the GPU, the frame is usable as soon
+	// as it is submitted
+	if (m_Mode == FrameExportMode::ExternalMemory)
+	{
+		Publish(m_RecordedFrame);
+	}
+	else
+	{
+		m_PendingFrames.push_back({m_RecordedFrame, a_SubmitValue});
+	}
+
+	m_RecordedFrame = 0;
+}
+
+int FrameExporter::ExportMemoryFd(const Device& a_Device) const
+{
+	if (!m_Exporting || m_Mode != FrameExportMode::ExternalMemory)
+	{
+		throw std::runtime_error("Error! Frames are not exported through external memory!");
+	}
+
+	return m_SlotBuffer.ExportFd(a_Device);
+}
+
+int FrameExporter::ExportSemaphoreFd(const Device& a_Device) const
+{
+	if (!m_Exporting || m_Mode != FrameExportMode::ExternalMemory)
+	{
+		throw std::runtime_error("Error! Frames are not exported through external memory!");
+	}
+
+	const auto t_GetSemaphoreFd = reinterpret_cast<PFN_vkGetSemaphoreFdKHR>(
+		vkGetDeviceProcAddr(a_Device.GetLogicalDevice(), "vkGetSemaphoreFdKHR"));
+
+	VkSemaphoreGetFdInfoKHR t_GetFdInfo = {};
+	t_GetFdInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_GET_FD_INFO_KHR;
+	t_GetFdInfo.semaphore = m_ExportedSemaphore;
+	t_GetFdInfo.handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT;
+
+	int t_Fd = -1;
+	if (t_GetSemaphoreFd == nullptr || t_GetSemaphoreFd(a_Device.GetLogicalDevice(), &t_GetFdInfo, &t_Fd) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not export the frame export semaphore!");
+	}
+
+	return t_Fd;
+}
+
+uint32_t FrameExporter::WaitForFrame(const SharedFrameRing& a_Ring, const uint32_t a_LastSequence,
+                                     const uint32_t a_TimeoutMs)
+{
+	const uint32_t t_Sequence = a_Ring.m_Sequence.load(std::memory_order_acquire);
+
+	if (t_Sequence != a_LastSequence)
+	{
+		return t_Sequence;
+	}
+
+	// returns right away if the sequence changed in between
+	WaitWhileEqual(a_Ring.m_Sequence, a_LastSequence, a_TimeoutMs);
+
+	return a_Ring.m_Sequence.load(std::memory_order_acquire);
+}
+
+void FrameExporter::CreateExportedSemaphore(const Device& a_Device)
+{
+	VkExportSemaphoreCreateInfo t_ExportInfo = {};
+	t_ExportInfo.sType = VK_STRUCTURE_TYPE_EXPORT_SEMAPHORE_CREATE_INFO;
+	t_ExportInfo.handleTypes = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT;
+
+	VkSemaphoreTypeCreateInfo t_TypeInfo = {};
+	t_TypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	t_TypeInfo.pNext = &t_ExportInfo;
+	t_TypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	t_TypeInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo t_CreateInfo = {};
+	t_CreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	t_CreateInfo.pNext = &t_TypeInfo;
+
+	if (vkCreateSemaphore(a_Device.GetLogicalDevice(), &t_CreateInfo, nullptr, &m_ExportedSemaphore) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not create the frame export semaphore!");
+	}
+}
+
+void FrameExporter::Publish(const uint64_t a_Frame)
+{
+	const uint32_t t_Slot = static_cast<uint32_t>((a_Frame - 1) % m_Ring->m_SlotCount);
+
+	m_Ring->m_SlotFrames[t_Slot].store(a_Frame, std::memory_order_release);
+	m_Ring->m_LatestFrame.store(a_Frame, std::memory_order_release);
+	m_Ring->m_Sequence.fetch_add(1, std::memory_order_release);
+
+	WakeWaiters(m_Ring->m_Sequence);
+}
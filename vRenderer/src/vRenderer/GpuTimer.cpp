@@ -0,0 +1,84 @@
+#include "pch.h"
+#include "vRenderer/GpuTimer.h"
+
+#include <stdexcept>
+
+#include "vRenderer/Device.h"
+
+GpuTimer::GpuTimer()
+= default;
+
+GpuTimer::~GpuTimer()
+= default;
+
+void GpuTimer::Create(const Device& a_Device, const uint32_t a_FrameCount)
+{
+	m_Supported = a_Device.SupportsTimestamps();
+	m_TimestampPeriod = a_Device.GetTimestampPeriod();
+	m_Recorded.assign(a_FrameCount, false);
+
+	if (!m_Supported)
+	{
+		return;
+	}
+
+	// a start and an end timestamp per frame
+	VkQueryPoolCreateInfo t_QueryPoolCreateInfo = {};
+	t_QueryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	t_QueryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	t_QueryPoolCreateInfo.queryCount = a_FrameCount * 2;
+
+	if (vkCreateQueryPool(a_Device.GetLogicalDevice(), &t_QueryPoolCreateInfo, nullptr, &m_QueryPool) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not create timestamp Query Pool!");
+	}
+}
+
+void GpuTimer::Destroy(const VkDevice& a_LogicalDevice)
+{
+	vkDestroyQueryPool(a_LogicalDevice, m_QueryPool, nullptr);
+	m_QueryPool = VK_NULL_HANDLE;
+}
+
+void GpuTimer::Begin(VkCommandBuffer a_CommandBuffer, const uint32_t a_Frame)
+{
+	if (!m_Supported)
+	{
+		return;
+	}
+
+	vkCmdResetQueryPool(a_CommandBuffer, m_QueryPool, a_Frame * 2, 2);
+	vkCmdWriteTimestamp(a_CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_QueryPool, a_Frame * 2);
+}
+
+void GpuTimer::End(VkCommandBuffer a_CommandBuffer, const uint32_t a_Frame)
+{
+	if (!m_Supported)
+	{
+		return;
+	}
+
+	vkCmdWriteTimestamp(a_CommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_QueryPool, a_Frame * 2 + 1);
+	m_Recorded[a_Frame] = true;
+}
+
+bool GpuTimer::GetElapsedMilliseconds(const VkDevice& a_LogicalDevice, const uint32_t a_Frame, float& a_Milliseconds) const
+{
+	if (!m_Supported || !m_Recorded[a_Frame])
+	{
+		return false;
+	}
+
+	uint64_t t_Timestamps[2] = {};
+
+	// VK_NOT_READY is returned if the frame has not finished executing yet
+	if (vkGetQueryPoolResults(a_LogicalDevice, m_QueryPool, a_Frame * 2, 2, sizeof(t_Timestamps), t_Timestamps,
+	                          sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+	{
+		return false;
+	}
+
+	// timestamp ticks to nanoseconds to milliseconds
+	a_Milliseconds = static_cast<float>(t_Timestamps[1] - t_Timestamps[0]) * m_TimestampPeriod / 1000000.0f;
+	return true;
+}
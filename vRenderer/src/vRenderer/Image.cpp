@@ -59,6 +59,11 @@ void Image::DestroyImage(const VkDevice a_LogicalDevice)
 	vkDestroyImageView(a_LogicalDevice, m_ImageView, nullptr);
 	vkDestroyImage(a_LogicalDevice, m_Image, nullptr);
 	vkFreeMemory(a_LogicalDevice, m_ImageMemory, nullptr);
+
+	// reset handles so destroying an image twice (or one that was never created) is harmless
+	m_ImageView = VK_NULL_HANDLE;
+	m_Image = VK_NULL_HANDLE;
+	m_ImageMemory = VK_NULL_HANDLE;
 }
 
 VkImageView Image::CreateImageView(const VkFormat a_Format, const VkDevice a_LogicalDevice, VkImageAspectFlags a_AspectFlag, uint32_t a_MipLevel) const
@@ -96,9 +101,9 @@ const VkImageView Image::GetImageView() const
 }
 
 void Image::TransitionImageLayout(VkImageLayout a_OldLayout, VkImageLayout a_NewLayout, VkCommandPool& a_CommandPool,
-                                  const VkQueue& a_GraphicsQueue, const VkDevice& a_LogicalDevice, uint32_t a_MipLevel)
+                                  const VkQueue& a_GraphicsQueue, const Device& a_Device, uint32_t a_MipLevel)
 {
-	VkCommandBuffer t_CmdBuffer = BeginSingleTimeCommand(a_CommandPool, a_LogicalDevice);
+	VkCommandBuffer t_CmdBuffer = BeginSingleTimeCommand(a_CommandPool, a_Device.GetLogicalDevice());
 
 	VkPipelineStageFlags t_SourceStage;
 	VkPipelineStageFlags t_DestinationStage;
@@ -112,7 +117,7 @@ void Image::TransitionImageLayout(VkImageLayout a_OldLayout, VkImageLayout a_New
 		0, nullptr, 
 		1, &t_MemoryBarrier);
 
-	EndSingleTimeCommands(t_CmdBuffer, a_GraphicsQueue, a_LogicalDevice, a_CommandPool);
+	EndSingleTimeCommands(t_CmdBuffer, a_GraphicsQueue, a_Device, a_CommandPool);
 }
 
 uint32_t Image::GetMipLevels()
@@ -125,7 +130,7 @@ uint32_t Image::GetMipLevels()
 /// <param name="a_Device">		  	The device.</param>
 /// <param name="a_PropertyFlags">	The property flags.</param>
 
-void Image::AllocateImageMemory(Device a_Device, VkMemoryPropertyFlags a_PropertyFlags)
+void Image::AllocateImageMemory(const Device& a_Device, VkMemoryPropertyFlags a_PropertyFlags)
 {
 	// query memory requirements
 	VkMemoryRequirements t_MemoryRequirements;
@@ -135,6 +140,15 @@ void Image::AllocateImageMemory(Device a_Device, VkMemoryPropertyFlags a_Propert
 	VkMemoryAllocateInfo t_AllocateInfo = {};
 	t_AllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
 	t_AllocateInfo.allocationSize = t_MemoryRequirements.size;
+	// lazily allocated memory is only offered by tile based GPUs, elsewhere transient attachments
+	// fall back to regular device local memory
+	if ((a_PropertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) != 0 &&
+		!Buffer::FindMemoryType(a_Device, t_MemoryRequirements.memoryTypeBits, a_PropertyFlags,
+		                        t_AllocateInfo.memoryTypeIndex))
+	{
+		a_PropertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	}
+
 	t_AllocateInfo.memoryTypeIndex = Buffer::GetMemoryType(a_Device, t_MemoryRequirements.memoryTypeBits, a_PropertyFlags);
 
 	if (vkAllocateMemory(a_Device.GetLogicalDevice(), &t_AllocateInfo, nullptr, &m_ImageMemory))
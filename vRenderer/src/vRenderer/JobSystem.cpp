@@ -0,0 +1,363 @@
+#include "pch.h"
+#include "vRenderer/JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+	// identifies the system and queue of worker threads, other threads use the shared queue
+	thread_local const JobSystem* s_CurrentSystem = nullptr;
+	thread_local uint32_t s_CurrentWorker = 0;
+
+	void PinThread(std::thread& a_Thread, const uint32_t a_Core)
+	{
+#if defined(_WIN32)
+		SetThreadAffinityMask(a_Thread.native_handle(), static_cast<DWORD_PTR>(1) << a_Core);
+#elif defined(__linux__)
+		cpu_set_t t_CpuSet;
+		CPU_ZERO(&t_CpuSet);
+		CPU_SET(a_Core, &t_CpuSet);
+		pthread_setaffinity_np(a_Thread.native_handle(), sizeof(t_CpuSet), &t_CpuSet);
+#endif
+	}
+}
+
+JobCounter::JobCounter()
+= default;
+
+JobCounter::~JobCounter()
+= default;
+
+bool JobCounter::IsDone() const
+{
+	return m_Pending.load(std::memory_order_acquire) == 0;
+}
+
+JobSystem::JobSystem()
+= default;
+
+JobSystem::~JobSystem()
+{
+	Stop();
+}
+
+void JobSystem::Start(const JobSystemSettings& a_Settings)
+{
+	Stop();
+
+	const uint32_t t_CoreCount = std::max(1u, std::thread::hardware_concurrency());
+	const uint32_t t_WorkerCount = a_Settings.m_WorkerCount > 0 ? a_Settings.m_WorkerCount : t_CoreCount - 1;
+
+	m_Queues.clear();
+	for (uint32_t i = 0; i <= t_WorkerCount; i++)
+	{
+		m_Queues.push_back(std::make_unique<WorkQueue>());
+	}
+
+	m_Stopping = false;
+	m_Workers.reserve(t_WorkerCount);
+
+	for (uint32_t i = 0; i < t_WorkerCount; i++)
+	{
+		m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+
+		// pinning more workers than cores would stack them on the same ones
+		if (a_Settings.m_PinWorkers && t_WorkerCount < t_CoreCount)
+		{
+			PinThread(m_Workers.back(), i + 1);
+		}
+	}
+}
+
+void JobSystem::Stop()
+{
+	if (m_Queues.empty())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> t_Lock(m_SleepMutex);
+		m_Stopping = true;
+	}
+	m_WakeUp.notify_all();
+
+	for (std::thread& t_Worker : m_Workers)
+	{
+		t_Worker.join();
+	}
+
+	m_Workers.clear();
+
+	// without workers the shared queue is only emptied by waiting threads
+	Job t_Job;
+	while (TryPop(static_cast<uint32_t>(m_Queues.size() - 1), t_Job))
+	{
+		Execute(t_Job);
+	}
+
+	m_Queues.clear();
+}
+
+bool JobSystem::IsRunning() const
+{
+	return !m_Queues.empty();
+}
+
+uint32_t JobSystem::GetWorkerCount() const
+{
+	return static_cast<uint32_t>(m_Workers.size());
+}
+
+uint32_t JobSystem::GetThreadCount() const
+{
+	return GetWorkerCount() + 1;
+}
+
+void JobSystem::SetProfilingHooks(const JobProfilingHooks& a_Hooks)
+{
+	m_Hooks = a_Hooks;
+}
+
+void JobSystem::Run(std::function<void()> a_Function, JobCounter* a_Counter, const char* a_Name)
+{
+	if (a_Counter != nullptr)
+	{
+		a_Counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	Job t_Job = {std::move(a_Function), a_Counter, a_Name};
+
+	if (!IsRunning())
+	{
+		Execute(t_Job);
+		return;
+	}
+
+	Push(std::move(t_Job));
+}
+
+void JobSystem::RunAfter(JobCounter& a_Dependency, std::function<void()> a_Function, JobCounter* a_Counter,
+                         const char* a_Name)
+{
+	if (a_Counter != nullptr)
+	{
+		a_Counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	Job t_Job = {std::move(a_Function), a_Counter, a_Name};
+
+	{
+		// the counter only reaches zero under its lock, so the job is either parked or runnable
+		std::lock_guard<std::mutex> t_Lock(a_Dependency.m_Mutex);
+
+		if (!a_Dependency.IsDone())
+		{
+			a_Dependency.m_Continuations.push_back(std::move(t_Job));
+			return;
+		}
+	}
+
+	if (!IsRunning())
+	{
+		Execute(t_Job);
+		return;
+	}
+
+	Push(std::move(t_Job));
+}
+
+void JobSystem::Wait(JobCounter& a_Counter)
+{
+	const uint32_t t_Queue = GetCurrentThreadIndex();
+
+	while (!a_Counter.IsDone())
+	{
+		Job t_Job;
+		if (IsRunning() && TryPop(t_Queue, t_Job))
+		{
+			Execute(t_Job);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	// the thread finishing the last job may still hold the lock, the counter can be destroyed after it
+	std::lock_guard<std::mutex> t_Lock(a_Counter.m_Mutex);
+}
+
+void JobSystem::ParallelFor(const size_t a_Count, const size_t a_MinBatchSize,
+                            const std::function<void(size_t, size_t)>& a_Function, const char* a_Name)
+{
+	// a few batches per thread leave room for stealing when they take different amounts of time
+	const size_t t_BatchSize = std::max<size_t>({
+		a_MinBatchSize, 1, (a_Count + GetThreadCount() * 4 - 1) / (GetThreadCount() * 4)
+	});
+
+	if (a_Count <= t_BatchSize || GetWorkerCount() == 0)
+	{
+		if (a_Count > 0)
+		{
+			a_Function(0, a_Count);
+		}
+		return;
+	}
+
+	JobCounter t_Counter;
+	for (size_t t_Begin = 0; t_Begin < a_Count; t_Begin += t_BatchSize)
+	{
+		const size_t t_End = std::min(a_Count, t_Begin + t_BatchSize);
+		Run([&a_Function, t_Begin, t_End] { a_Function(t_Begin, t_End); }, &t_Counter, a_Name);
+	}
+
+	Wait(t_Counter);
+}
+
+uint32_t JobSystem::GetCurrentThreadIndex() const
+{
+	return s_CurrentSystem == this ? s_CurrentWorker : GetWorkerCount();
+}
+
+void JobSystem::WorkerLoop(const uint32_t a_Worker)
+{
+	s_CurrentSystem = this;
+	s_CurrentWorker = a_Worker;
+
+	while (true)
+	{
+		Job t_Job;
+		if (TryPop(a_Worker, t_Job))
+		{
+			Execute(t_Job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> t_Lock(m_SleepMutex);
+		m_WakeUp.wait(t_Lock, [this] { return m_QueuedJobs.load() > 0 || m_Stopping; });
+
+		if (m_Stopping && m_QueuedJobs.load() == 0)
+		{
+			return;
+		}
+	}
+}
+
+void JobSystem::Push(Job&& a_Job)
+{
+	WorkQueue& t_Queue = *m_Queues[GetCurrentThreadIndex()];
+
+	{
+		std::lock_guard<std::mutex> t_Lock(t_Queue.m_Mutex);
+		t_Queue.m_Jobs.push_back(std::move(a_Job));
+	}
+
+	m_QueuedJobs.fetch_add(1);
+
+	// taking the lock orders the push before a worker's check, so the wake up cannot be missed
+	{
+		std::lock_guard<std::mutex> t_Lock(m_SleepMutex);
+	}
+	m_WakeUp.notify_one();
+}
+
+bool JobSystem::TryPop(const uint32_t a_Queue, Job& a_Job)
+{
+	{
+		WorkQueue& t_Queue = *m_Queues[a_Queue];
+		std::lock_guard<std::mutex> t_Lock(t_Queue.m_Mutex);
+
+		if (!t_Queue.m_Jobs.empty())
+		{
+			a_Job = std::move(t_Queue.m_Jobs.back());
+			t_Queue.m_Jobs.pop_back();
+			m_QueuedJobs.fetch_sub(1);
+			return true;
+		}
+	}
+
+	for (size_t i = 1; i < m_Queues.size(); i++)
+	{
+		WorkQueue& t_Queue = *m_Queues[(a_Queue + i) % m_Queues.size()];
+		std::lock_guard<std::mutex> t_Lock(t_Queue.m_Mutex);
+
+		if (!t_Queue.m_Jobs.empty())
+		{
+			a_Job = std::move(t_Queue.m_Jobs.front());
+			t_Queue.m_Jobs.pop_front();
+			m_QueuedJobs.fetch_sub(1);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::Execute(Job& a_Job)
+{
+	if (!m_Hooks.m_OnBegin && !m_Hooks.m_OnEnd)
+	{
+		a_Job.m_Function();
+	}
+	else
+	{
+		const uint32_t t_Thread = GetCurrentThreadIndex();
+
+		if (m_Hooks.m_OnBegin)
+		{
+			m_Hooks.m_OnBegin(a_Job.m_Name, t_Thread);
+		}
+
+		const auto t_Start = std::chrono::steady_clock::now();
+		a_Job.m_Function();
+		const auto t_Duration = std::chrono::steady_clock::now() - t_Start;
+
+		if (m_Hooks.m_OnEnd)
+		{
+			m_Hooks.m_OnEnd(a_Job.m_Name, t_Thread,
+			                static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t_Duration).count()));
+		}
+	}
+
+	if (a_Job.m_Counter != nullptr)
+	{
+		Complete(*a_Job.m_Counter);
+	}
+}
+
+void JobSystem::Complete(JobCounter& a_Counter)
+{
+	std::vector<Job> t_Ready;
+
+	{
+		std::lock_guard<std::mutex> t_Lock(a_Counter.m_Mutex);
+
+		if (a_Counter.m_Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			t_Ready.swap(a_Counter.m_Continuations);
+		}
+	}
+
+	for (Job& t_Job : t_Ready)
+	{
+		if (IsRunning())
+		{
+			Push(std::move(t_Job));
+		}
+		else
+		{
+			Execute(t_Job);
+		}
+	}
+}
@@ -1,11 +1,16 @@
 #include "pch.h"
 #include "vRenderer/Model.h"
 
+#include <algorithm>
+#include <cmath>
+#include <exception>
 #include <unordered_map>
 #include <glm/ext/matrix_transform.hpp>
 #include <tiny_obj/tiny_obj_loader.h>
 
-Model::Model() : m_Position(glm::vec3(0.f)), m_Scale(1.0f), m_Rotation(glm::mat4(1.f))
+#include "vRenderer/JobSystem.h"
+
+Model::Model() : m_Position(glm::vec3(0.f)), m_Scale(1.0f), m_Rotation(glm::quat(1.f, 0.f, 0.f, 0.f))
 {
 	
 }
@@ -14,20 +19,70 @@ Model::~Model()
 = default;
 
 void Model::Load(const char* a_ModelPath, const char* a_TexturePath, const Device& a_Device,
-                 VkCommandPool& a_CommandPool, const VkQueue& a_GraphicsQueue)
+                 VkCommandPool& a_CommandPool, const VkQueue& a_GraphicsQueue, JobSystem* a_JobSystem)
 {
-	// load texture
-	m_Texture.CreateTextureFromImage(a_TexturePath, a_Device, a_CommandPool, a_GraphicsQueue);
-	m_Texture.CreateTextureSampler(a_Device);
+	// decode the texture while the mesh is parsed, errors are rethrown on this thread
+	DecodedImage t_Image;
+	std::exception_ptr t_DecodeError;
+	JobCounter t_Decoded;
+
+	const auto t_Decode = [&]
+	{
+		try
+		{
+			t_Image = Texture::DecodeImage(a_TexturePath);
+		}
+		catch (...)
+		{
+			t_DecodeError = std::current_exception();
+		}
+	};
+
+	if (a_JobSystem != nullptr)
+	{
+		a_JobSystem->Run(t_Decode, &t_Decoded, "Texture decode");
+	}
+	else
+	{
+		t_Decode();
+	}
 
 	// load mesh
-	LoadMesh(a_ModelPath);
+	try
+	{
+		LoadMesh(a_ModelPath);
+		ComputeBounds();
+	}
+	catch (...)
+	{
+		// the job references the locals of this function
+		if (a_JobSystem != nullptr)
+		{
+			a_JobSystem->Wait(t_Decoded);
+		}
+		throw;
+	}
+
+	if (a_JobSystem != nullptr)
+	{
+		a_JobSystem->Wait(t_Decoded);
+	}
+
+	if (t_DecodeError)
+	{
+		std::rethrow_exception(t_DecodeError);
+	}
+
+	// upload texture
+	m_Texture.CreateTextureFromDecodedImage(t_Image, a_Device, a_CommandPool, a_GraphicsQueue);
+	m_Texture.CreateTextureSampler(a_Device);
 }
 
 void Model::CreateFromMesh(Mesh& a_Mesh, const char* a_TexturePath, const Device& a_Device,
                  VkCommandPool& a_CommandPool, const VkQueue& a_GraphicsQueue)
 {
 	m_Mesh = a_Mesh;
+	ComputeBounds();
 
 	// load texture
 	m_Texture.CreateTextureFromImage(a_TexturePath, a_Device, a_CommandPool, a_GraphicsQueue);
@@ -49,12 +104,33 @@ Mesh& Model::GetMesh()
 	return m_Mesh;
 }
 
+void Model::SetTextureIndex(const uint32_t a_TextureIndex)
+{
+	m_TextureIndex = a_TextureIndex;
+}
+
+uint32_t Model::GetTextureIndex() const
+{
+	return m_TextureIndex;
+}
+
 void Model::Rotate(float a_Angle, glm::vec3 a_Axis)
 {
-	m_Rotation = glm::rotate(glm::mat4(1.0f), glm::radians(a_Angle), a_Axis);
+	// renormalize so repeated rotations do not accumulate scale
+	m_Rotation = glm::normalize(glm::angleAxis(glm::radians(a_Angle), glm::normalize(a_Axis)) * m_Rotation);
+}
+
+void Model::SetRotation(float a_Angle, glm::vec3 a_Axis)
+{
+	m_Rotation = glm::angleAxis(glm::radians(a_Angle), glm::normalize(a_Axis));
 }
 
 glm::mat4 Model::GetRotation()
+{
+	return glm::mat4_cast(m_Rotation);
+}
+
+const glm::quat& Model::GetOrientation() const
 {
 	return m_Rotation;
 }
@@ -81,7 +157,39 @@ glm::mat4 Model::GetTranslation()
 
 glm::mat4 Model::GetModelMatrix()
 {
-	return GetTranslation() * GetRotation() * GetScale();
+	// translation * rotation * scale without building and multiplying the three matrices
+	glm::mat4 t_Model = glm::mat4_cast(m_Rotation);
+	t_Model[0] *= m_Scale;
+	t_Model[1] *= m_Scale;
+	t_Model[2] *= m_Scale;
+	t_Model[3] = glm::vec4(m_Position, 1.0f);
+
+	return t_Model;
+}
+
+const glm::vec4& Model::GetBoundingSphere() const
+{
+	return m_BoundingSphere;
+}
+
+const glm::vec3& Model::GetBoundsMin() const
+{
+	return m_BoundsMin;
+}
+
+const glm::vec3& Model::GetBoundsMax() const
+{
+	return m_BoundsMax;
+}
+
+void Model::SetOccluder(const bool a_Occluder)
+{
+	m_Occluder = a_Occluder;
+}
+
+bool Model::IsOccluder() const
+{
+	return m_Occluder;
 }
 
 void Model::LoadMesh(const char* a_ModelPath)
@@ -130,3 +238,37 @@ void Model::LoadMesh(const char* a_ModelPath)
 		}
 	}
 }
+
+void Model::ComputeBounds()
+{
+	if (m_Mesh.m_Vertices.empty())
+	{
+		m_BoundingSphere = glm::vec4(0.0f);
+		m_BoundsMin = glm::vec3(0.0f);
+		m_BoundsMax = glm::vec3(0.0f);
+		return;
+	}
+
+	glm::vec3 t_Min = m_Mesh.m_Vertices[0].m_Position;
+	glm::vec3 t_Max = t_Min;
+
+	for (const Vertex& t_Vertex : m_Mesh.m_Vertices)
+	{
+		t_Min = glm::min(t_Min, t_Vertex.m_Position);
+		t_Max = glm::max(t_Max, t_Vertex.m_Position);
+	}
+
+	m_BoundsMin = t_Min;
+	m_BoundsMax = t_Max;
+
+	const glm::vec3 t_Center = (t_Min + t_Max) * 0.5f;
+
+	float t_RadiusSquared = 0.0f;
+	for (const Vertex& t_Vertex : m_Mesh.m_Vertices)
+	{
+		const glm::vec3 t_Offset = t_Vertex.m_Position - t_Center;
+		t_RadiusSquared = std::max(t_RadiusSquared, glm::dot(t_Offset, t_Offset));
+	}
+
+	m_BoundingSphere = glm::vec4(t_Center, std::sqrt(t_RadiusSquared));
+}
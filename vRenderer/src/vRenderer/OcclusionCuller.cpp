@@ -0,0 +1,346 @@
+#include "pch.h"
+#include "vRenderer/OcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "vRenderer/DescriptorAllocator.h"
+#include "vRenderer/Device.h"
+#include "vRenderer/helpers/VulkanHelpers.h"
+
+OcclusionCuller::OcclusionCuller()
+= default;
+
+OcclusionCuller::~OcclusionCuller()
+= default;
+
+/// <summary>	Generates a compute stage binding of set 0. </summary>
+/// <param name="a_Binding">	   	The binding index.</param>
+/// <param name="a_DescriptorType">	The descriptor type.</param>
+/// <returns>	The binding. </returns>
+
+static VkDescriptorSetLayoutBinding GenComputeBinding(const uint32_t a_Binding, const VkDescriptorType a_DescriptorType)
+{
+	VkDescriptorSetLayoutBinding t_Binding = {};
+	t_Binding.binding = a_Binding;
+	t_Binding.descriptorType = a_DescriptorType;
+	t_Binding.descriptorCount = 1;
+	t_Binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+	return t_Binding;
+}
+
+void OcclusionCuller::Create(const Device& a_Device, const uint32_t a_MaxInstances, const uint32_t a_FramesInFlight)
+{
+	const VkDevice t_LogicalDevice = a_Device.GetLogicalDevice();
+	m_MaxInstances = a_MaxInstances;
+
+	// the depth copy reads the depth buffer and writes the first level of the pyramid
+	const std::vector<VkDescriptorSetLayoutBinding> t_CopyBindings = {
+		GenComputeBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER),
+		GenComputeBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+	};
+
+	// every reduction reads one level and writes the next one
+	const std::vector<VkDescriptorSetLayoutBinding> t_ReduceBindings = {
+		GenComputeBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE),
+		GenComputeBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+	};
+
+	// bounds, visibility, prepass draws, main draws and the pyramid
+	const std::vector<VkDescriptorSetLayoutBinding> t_CullBindings = {
+		GenComputeBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+		GenComputeBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+		GenComputeBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+		GenComputeBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+		GenComputeBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+	};
+
+	m_DepthCopyPipeline.Create(t_LogicalDevice, "../vRenderer/assets/shaders/compiled/hiz_depth.spv", t_CopyBindings,
+	                           sizeof(CopyParameters));
+	m_DepthCopyMSPipeline.Create(t_LogicalDevice, "../vRenderer/assets/shaders/compiled/hiz_depth_ms.spv",
+	                             t_CopyBindings, sizeof(CopyParameters));
+	m_ReducePipeline.Create(t_LogicalDevice, "../vRenderer/assets/shaders/compiled/hiz_reduce.spv", t_ReduceBindings);
+	m_CullPipeline.Create(t_LogicalDevice, "../vRenderer/assets/shaders/compiled/occlusion_cull.spv", t_CullBindings,
+	                      sizeof(CullParameters));
+
+	// the shaders fetch individual texels, so no filtering is needed
+	VkSamplerCreateInfo t_SamplerCreateInfo = {};
+	t_SamplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	t_SamplerCreateInfo.magFilter = VK_FILTER_NEAREST;
+	t_SamplerCreateInfo.minFilter = VK_FILTER_NEAREST;
+	t_SamplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	t_SamplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	t_SamplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	t_SamplerCreateInfo.anisotropyEnable = VK_FALSE;
+	t_SamplerCreateInfo.maxAnisotropy = 1.0f;
+	t_SamplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+	t_SamplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+	t_SamplerCreateInfo.compareEnable = VK_FALSE;
+	t_SamplerCreateInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+	t_SamplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	t_SamplerCreateInfo.minLod = 0.0f;
+	t_SamplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+	if (vkCreateSampler(t_LogicalDevice, &t_SamplerCreateInfo, nullptr, &m_Sampler) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Failed to create occlusion culling Sampler!");
+	}
+
+	// the bounds are written every frame, everything else only by the culling passes
+	m_BoundsBuffers.resize(a_FramesInFlight);
+	for (StorageBuffer& t_BoundsBuffer : m_BoundsBuffers)
+	{
+		t_BoundsBuffer.CreateStorageBuffer(a_Device, sizeof(InstanceBounds) * a_MaxInstances, true);
+	}
+
+	m_VisibilityBuffer.CreateStorageBuffer(a_Device, sizeof(uint32_t) * a_MaxInstances, false,
+	                                       VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+	m_PrepassDrawBuffer.CreateStorageBuffer(a_Device, s_DrawCommandStride * a_MaxInstances, false,
+	                                        VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+	m_DrawBuffer.CreateStorageBuffer(a_Device, s_DrawCommandStride * a_MaxInstances, false,
+	                                 VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+
+	m_ResetVisibility = true;
+}
+
+void OcclusionCuller::Destroy(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator)
+{
+	DestroyTargets(a_LogicalDevice, a_DescriptorAllocator);
+
+	for (StorageBuffer& t_BoundsBuffer : m_BoundsBuffers)
+	{
+		t_BoundsBuffer.DestroyBuffer(a_LogicalDevice);
+	}
+	m_BoundsBuffers.clear();
+
+	m_VisibilityBuffer.DestroyBuffer(a_LogicalDevice);
+	m_PrepassDrawBuffer.DestroyBuffer(a_LogicalDevice);
+	m_DrawBuffer.DestroyBuffer(a_LogicalDevice);
+
+	vkDestroySampler(a_LogicalDevice, m_Sampler, nullptr);
+	m_DepthCopyPipeline.Destroy(a_LogicalDevice);
+	m_DepthCopyMSPipeline.Destroy(a_LogicalDevice);
+	m_ReducePipeline.Destroy(a_LogicalDevice);
+	m_CullPipeline.Destroy(a_LogicalDevice);
+}
+
+void OcclusionCuller::CreateTargets(const Device& a_Device, DescriptorAllocator& a_DescriptorAllocator,
+                                    const Image& a_DepthImage, const VkExtent2D a_Extent,
+                                    const VkSampleCountFlagBits a_SampleCount)
+{
+	const VkDevice t_LogicalDevice = a_Device.GetLogicalDevice();
+	m_Extent = a_Extent;
+	m_SampleCount = a_SampleCount;
+
+	const uint32_t t_LevelCount = static_cast<uint32_t>(
+		std::floor(std::log2(std::max(a_Extent.width, a_Extent.height)))) + 1;
+
+	m_HiZ.CreateImage(a_Device, a_Extent.width, a_Extent.height, t_LevelCount, VK_SAMPLE_COUNT_1_BIT, s_Format,
+	                  VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+	                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+
+	// storage images are bound one level at a time
+	m_HiZLevelViews.resize(t_LevelCount);
+	for (uint32_t i = 0; i < t_LevelCount; i++)
+	{
+		VkImageViewCreateInfo t_ViewCreateInfo = {};
+		t_ViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		t_ViewCreateInfo.image = m_HiZ.GetImage();
+		t_ViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		t_ViewCreateInfo.format = s_Format;
+		t_ViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		t_ViewCreateInfo.subresourceRange.baseMipLevel = i;
+		t_ViewCreateInfo.subresourceRange.levelCount = 1;
+		t_ViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+		t_ViewCreateInfo.subresourceRange.layerCount = 1;
+
+		if (vkCreateImageView(t_LogicalDevice, &t_ViewCreateInfo, nullptr, &m_HiZLevelViews[i]) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Error! Could not create Hi-Z level Image View!");
+		}
+	}
+
+	CreateDescriptorSets(t_LogicalDevice, a_DescriptorAllocator, a_DepthImage);
+
+	// the slots of the previous targets may belong to different instances by now
+	m_ResetVisibility = true;
+}
+
+void OcclusionCuller::DestroyTargets(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator)
+{
+	// every set points to a level or the whole of the pyramid, the copy set to the depth buffer as well
+	std::vector<VkImageView> t_Views = m_HiZLevelViews;
+	t_Views.push_back(m_HiZ.GetImageView());
+	a_DescriptorAllocator.InvalidateImageViews(a_LogicalDevice, t_Views);
+
+	m_CopyDescriptorSet = VK_NULL_HANDLE;
+	m_ReduceDescriptorSets.clear();
+	m_CullDescriptorSets.clear();
+
+	for (const VkImageView t_View : m_HiZLevelViews)
+	{
+		vkDestroyImageView(a_LogicalDevice, t_View, nullptr);
+	}
+	m_HiZLevelViews.clear();
+
+	m_HiZ.DestroyImage(a_LogicalDevice);
+}
+
+void OcclusionCuller::UpdateInstances(const uint32_t a_Frame, const FrameVector<InstanceBounds>& a_Bounds)
+{
+	if (a_Bounds.size() > m_MaxInstances)
+	{
+		throw std::runtime_error("Error! Too many instances for occlusion culling!");
+	}
+
+	m_BoundsBuffers[a_Frame].FillBuffer(a_Bounds.data(), sizeof(InstanceBounds) * a_Bounds.size());
+	m_InstanceCount = static_cast<uint32_t>(a_Bounds.size());
+}
+
+void OcclusionCuller::RecordVisibilityReset(VkCommandBuffer a_CommandBuffer)
+{
+	if (m_ResetVisibility)
+	{
+		vkCmdFillBuffer(a_CommandBuffer, m_VisibilityBuffer.GetBuffer(), 0, VK_WHOLE_SIZE, 0);
+		m_ResetVisibility = false;
+	}
+}
+
+void OcclusionCuller::RecordPrepassCulling(VkCommandBuffer a_CommandBuffer, const uint32_t a_Frame,
+                                           const glm::mat4& a_ViewProjection) const
+{
+	DispatchCulling(a_CommandBuffer, a_Frame, a_ViewProjection, m_Extent, 0);
+}
+
+void OcclusionCuller::RecordPyramidBuild(VkCommandBuffer a_CommandBuffer, const VkExtent2D a_RenderExtent) const
+{
+	// nothing to test, the pyramid is rebuilt from scratch every frame anyway
+	if (m_InstanceCount == 0)
+	{
+		return;
+	}
+
+	// copy the depth prepass into the first level, outside of the rendered area counts as far away
+	CopyParameters t_CopyParameters = {};
+	t_CopyParameters.m_RenderExtent = {static_cast<int32_t>(a_RenderExtent.width), static_cast<int32_t>(a_RenderExtent.height)};
+	t_CopyParameters.m_SampleCount = static_cast<int32_t>(m_SampleCount);
+
+	const ComputePipeline& t_CopyPipeline = m_SampleCount == VK_SAMPLE_COUNT_1_BIT
+		                                        ? m_DepthCopyPipeline
+		                                        : m_DepthCopyMSPipeline;
+
+	t_CopyPipeline.Bind(a_CommandBuffer, m_CopyDescriptorSet);
+	t_CopyPipeline.PushConstants(a_CommandBuffer, &t_CopyParameters, sizeof(t_CopyParameters));
+	ComputePipeline::Dispatch2D(a_CommandBuffer, m_Extent.width, m_Extent.height);
+
+	// reduce level by level, each keeping the farthest depth of the texels it covers. Every level
+	// reads the previous one, the render graph only synchronizes the pyramid as a whole
+	uint32_t t_Width = m_Extent.width;
+	uint32_t t_Height = m_Extent.height;
+
+	for (uint32_t i = 1; i < static_cast<uint32_t>(m_HiZLevelViews.size()); i++)
+	{
+		InsertMemoryBarrier(a_CommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+		                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+		t_Width = std::max(1u, t_Width / 2);
+		t_Height = std::max(1u, t_Height / 2);
+
+		m_ReducePipeline.Bind(a_CommandBuffer, m_ReduceDescriptorSets[i - 1]);
+		ComputePipeline::Dispatch2D(a_CommandBuffer, t_Width, t_Height);
+	}
+}
+
+void OcclusionCuller::RecordOcclusionCulling(VkCommandBuffer a_CommandBuffer, const uint32_t a_Frame,
+                                             const glm::mat4& a_ViewProjection, const VkExtent2D a_RenderExtent) const
+{
+	DispatchCulling(a_CommandBuffer, a_Frame, a_ViewProjection, a_RenderExtent, 1);
+}
+
+const Image& OcclusionCuller::GetPyramid() const
+{
+	return m_HiZ;
+}
+
+VkBuffer OcclusionCuller::GetVisibilityBuffer() const
+{
+	return m_VisibilityBuffer.GetBuffer();
+}
+
+VkBuffer OcclusionCuller::GetPrepassDrawBuffer() const
+{
+	return m_PrepassDrawBuffer.GetBuffer();
+}
+
+VkBuffer OcclusionCuller::GetDrawBuffer() const
+{
+	return m_DrawBuffer.GetBuffer();
+}
+
+void OcclusionCuller::CreateDescriptorSets(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator,
+                                           const Image& a_DepthImage)
+{
+	const uint32_t t_LevelCount = static_cast<uint32_t>(m_HiZLevelViews.size());
+	const uint32_t t_FrameCount = static_cast<uint32_t>(m_BoundsBuffers.size());
+
+	const ComputePipeline& t_CopyPipeline = m_SampleCount == VK_SAMPLE_COUNT_1_BIT
+		                                        ? m_DepthCopyPipeline
+		                                        : m_DepthCopyMSPipeline;
+
+	// the depth buffer is sampled in the layout the depth prepass leaves it in
+	m_CopyDescriptorSet = a_DescriptorAllocator.GetCached(a_LogicalDevice, t_CopyPipeline.GetDescriptorSetLayout(), {
+		DescriptorBinding::Image(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, a_DepthImage.GetImageView(), m_Sampler,
+		                         VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL),
+		DescriptorBinding::Image(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, m_HiZLevelViews[0], VK_NULL_HANDLE,
+		                         VK_IMAGE_LAYOUT_GENERAL)
+	});
+
+	m_ReduceDescriptorSets.resize(t_LevelCount - 1);
+	for (uint32_t i = 1; i < t_LevelCount; i++)
+	{
+		m_ReduceDescriptorSets[i - 1] = a_DescriptorAllocator.GetCached(
+			a_LogicalDevice, m_ReducePipeline.GetDescriptorSetLayout(), {
+				DescriptorBinding::Image(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, m_HiZLevelViews[i - 1], VK_NULL_HANDLE,
+				                         VK_IMAGE_LAYOUT_GENERAL),
+				DescriptorBinding::Image(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, m_HiZLevelViews[i], VK_NULL_HANDLE,
+				                         VK_IMAGE_LAYOUT_GENERAL)
+			});
+	}
+
+	m_CullDescriptorSets.resize(t_FrameCount);
+	for (uint32_t i = 0; i < t_FrameCount; i++)
+	{
+		m_CullDescriptorSets[i] = a_DescriptorAllocator.GetCached(a_LogicalDevice, m_CullPipeline.GetDescriptorSetLayout(), {
+			DescriptorBinding::Buffer(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_BoundsBuffers[i].GetBuffer()),
+			DescriptorBinding::Buffer(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_VisibilityBuffer.GetBuffer()),
+			DescriptorBinding::Buffer(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_PrepassDrawBuffer.GetBuffer()),
+			DescriptorBinding::Buffer(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_DrawBuffer.GetBuffer()),
+			DescriptorBinding::Image(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_HiZ.GetImageView(), m_Sampler,
+			                         VK_IMAGE_LAYOUT_GENERAL)
+		});
+	}
+}
+
+void OcclusionCuller::DispatchCulling(VkCommandBuffer a_CommandBuffer, const uint32_t a_Frame,
+                                      const glm::mat4& a_ViewProjection, const VkExtent2D a_RenderExtent,
+                                      const uint32_t a_Phase) const
+{
+	if (m_InstanceCount == 0)
+	{
+		return;
+	}
+
+	CullParameters t_CullParameters = {};
+	t_CullParameters.m_ViewProjection = a_ViewProjection;
+	t_CullParameters.m_RenderExtent = {static_cast<float>(a_RenderExtent.width), static_cast<float>(a_RenderExtent.height)};
+	t_CullParameters.m_InstanceCount = m_InstanceCount;
+	t_CullParameters.m_Phase = a_Phase;
+
+	m_CullPipeline.Bind(a_CommandBuffer, m_CullDescriptorSets[a_Frame]);
+	m_CullPipeline.PushConstants(a_CommandBuffer, &t_CullParameters, sizeof(t_CullParameters));
+
+	// the shader culls one instance per invocation in groups of 64
+	vkCmdDispatch(a_CommandBuffer, (m_InstanceCount + 63) / 64, 1, 1);
+}
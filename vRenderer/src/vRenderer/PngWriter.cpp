@@ -0,0 +1,195 @@
+#include "pch.h"
+#include "vRenderer/PngWriter.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+	// a stored deflate block holds at most 65535 bytes
+	constexpr size_t s_MaxStoredBlockSize = 65535;
+
+	void AppendBigEndian(std::vector<uint8_t>& a_Data, const uint32_t a_Value)
+	{
+		a_Data.push_back(static_cast<uint8_t>(a_Value >> 24));
+		a_Data.push_back(static_cast<uint8_t>(a_Value >> 16));
+		a_Data.push_back(static_cast<uint8_t>(a_Value >> 8));
+		a_Data.push_back(static_cast<uint8_t>(a_Value));
+	}
+}
+
+PngWriter::PngWriter()
+= default;
+
+PngWriter::~PngWriter()
+= default;
+
+void PngWriter::Open(const std::string& a_FilePath, const uint32_t a_Width, const uint32_t a_Height)
+{
+	m_File.open(a_FilePath, std::ios::binary);
+
+	if (!m_File.is_open())
+	{
+		throw std::runtime_error("Error! Could not open PNG image for writing!");
+	}
+
+	m_Width = a_Width;
+	m_Height = a_Height;
+	m_RowsWritten = 0;
+	m_Adler = 1;
+
+	constexpr uint8_t t_Signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	m_File.write(reinterpret_cast<const char*>(t_Signature), sizeof(t_Signature));
+
+	// 8 bit RGB, no interlacing
+	std::vector<uint8_t> t_Header;
+	AppendBigEndian(t_Header, a_Width);
+	AppendBigEndian(t_Header, a_Height);
+	t_Header.insert(t_Header.end(), {8, 2, 0, 0, 0});
+	WriteChunk("IHDR", t_Header.data(), static_cast<uint32_t>(t_Header.size()));
+
+	// the zlib stream header, the deflate blocks follow in the data chunks of WriteRows
+	constexpr uint8_t t_ZlibHeader[] = {0x78, 0x01};
+	WriteChunk("IDAT", t_ZlibHeader, sizeof(t_ZlibHeader));
+}
+
+void PngWriter::WriteRows(const uint8_t* a_Pixels, const uint32_t a_RowCount)
+{
+	if (m_RowsWritten + a_RowCount > m_Height)
+	{
+		throw std::runtime_error("Error! Too many rows for the PNG image!");
+	}
+
+	// every row starts with its filter type, 0 leaves it unfiltered
+	const size_t t_RowSize = 1 + static_cast<size_t>(m_Width) * 3;
+	std::vector<uint8_t> t_Rows(t_RowSize * a_RowCount);
+
+	for (uint32_t t_Row = 0; t_Row < a_RowCount; t_Row++)
+	{
+		const uint8_t* t_Source = a_Pixels + static_cast<size_t>(t_Row) * m_Width * 4;
+		uint8_t* t_Destination = t_Rows.data() + t_Row * t_RowSize;
+		t_Destination[0] = 0;
+
+		for (uint32_t t_X = 0; t_X < m_Width; t_X++)
+		{
+			t_Destination[1 + t_X * 3 + 0] = t_Source[t_X * 4 + 0];
+			t_Destination[1 + t_X * 3 + 1] = t_Source[t_X * 4 + 1];
+			t_Destination[1 + t_X * 3 + 2] = t_Source[t_X * 4 + 2];
+		}
+	}
+
+	// Adler-32, the sums are reduced often enough not to overflow
+	uint32_t t_A = m_Adler & 0xFFFF;
+	uint32_t t_B = m_Adler >> 16;
+	for (size_t i = 0; i < t_Rows.size();)
+	{
+		const size_t t_End = std::min(t_Rows.size(), i + 5552);
+		for (; i < t_End; i++)
+		{
+			t_A += t_Rows[i];
+			t_B += t_A;
+		}
+
+		t_A %= 65521;
+		t_B %= 65521;
+	}
+	m_Adler = (t_B << 16) | t_A;
+
+	// split the rows into stored blocks, the final block is written by Close
+	std::vector<uint8_t> t_Blocks;
+	t_Blocks.reserve(t_Rows.size() + (t_Rows.size() / s_MaxStoredBlockSize + 1) * 5);
+
+	for (size_t t_Offset = 0; t_Offset < t_Rows.size(); t_Offset += s_MaxStoredBlockSize)
+	{
+		const uint16_t t_Length = static_cast<uint16_t>(std::min(s_MaxStoredBlockSize, t_Rows.size() - t_Offset));
+		const uint16_t t_InverseLength = static_cast<uint16_t>(~t_Length);
+
+		t_Blocks.insert(t_Blocks.end(), {
+			                0, static_cast<uint8_t>(t_Length), static_cast<uint8_t>(t_Length >> 8),
+			                static_cast<uint8_t>(t_InverseLength), static_cast<uint8_t>(t_InverseLength >> 8)
+		                });
+		t_Blocks.insert(t_Blocks.end(), t_Rows.begin() + t_Offset, t_Rows.begin() + t_Offset + t_Length);
+	}
+
+	WriteChunk("IDAT", t_Blocks.data(), static_cast<uint32_t>(t_Blocks.size()));
+	m_RowsWritten += a_RowCount;
+}
+
+void PngWriter::Close()
+{
+	if (m_RowsWritten != m_Height)
+	{
+		throw std::runtime_error("Error! Not all rows of the PNG image were written!");
+	}
+
+	// an empty final stored block ends the deflate stream, followed by the checksum
+	std::vector<uint8_t> t_End = {1, 0, 0, 0xFF, 0xFF};
+	AppendBigEndian(t_End, m_Adler);
+	WriteChunk("IDAT", t_End.data(), static_cast<uint32_t>(t_End.size()));
+	WriteChunk("IEND", nullptr, 0);
+
+	m_File.close();
+
+	if (m_File.fail())
+	{
+		throw std::runtime_error("Error! Could not write PNG image!");
+	}
+}
+
+void PngWriter::WriteImage(const std::string& a_FilePath, const uint8_t* a_Pixels, const uint32_t a_Width,
+                           const uint32_t a_Height)
+{
+	PngWriter t_Writer;
+	t_Writer.Open(a_FilePath, a_Width, a_Height);
+	t_Writer.WriteRows(a_Pixels, a_Height);
+	t_Writer.Close();
+}
+
+void PngWriter::WriteChunk(const char* a_Type, const uint8_t* a_Data, const uint32_t a_Size)
+{
+	std::vector<uint8_t> t_Length;
+	AppendBigEndian(t_Length, a_Size);
+	m_File.write(reinterpret_cast<const char*>(t_Length.data()), 4);
+
+	// the checksum covers the type and the data
+	const uint8_t* t_Type = reinterpret_cast<const uint8_t*>(a_Type);
+	uint32_t t_Crc = UpdateCrc(0xFFFFFFFF, t_Type, 4);
+	t_Crc = UpdateCrc(t_Crc, a_Data, a_Size) ^ 0xFFFFFFFF;
+
+	m_File.write(a_Type, 4);
+	if (a_Size > 0)
+	{
+		m_File.write(reinterpret_cast<const char*>(a_Data), a_Size);
+	}
+
+	std::vector<uint8_t> t_Checksum;
+	AppendBigEndian(t_Checksum, t_Crc);
+	m_File.write(reinterpret_cast<const char*>(t_Checksum.data()), 4);
+}
+
+uint32_t PngWriter::UpdateCrc(uint32_t a_Crc, const uint8_t* a_Data, const size_t a_Size)
+{
+	static const std::array<uint32_t, 256> s_Table = []
+	{
+		std::array<uint32_t, 256> t_Table = {};
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t t_Value = i;
+			for (int t_Bit = 0; t_Bit < 8; t_Bit++)
+			{
+				t_Value = (t_Value & 1) ? 0xEDB88320 ^ (t_Value >> 1) : t_Value >> 1;
+			}
+			t_Table[i] = t_Value;
+		}
+		return t_Table;
+	}();
+
+	for (size_t i = 0; i < a_Size; i++)
+	{
+		a_Crc = s_Table[(a_Crc ^ a_Data[i]) & 0xFF] ^ (a_Crc >> 8);
+	}
+
+	return a_Crc;
+}
@@ -0,0 +1,1078 @@
+#include "pch.h"
+#include "vRenderer/RenderGraph/RenderGraph.h"
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+
+#include "vRenderer/Device.h"
+#include "vRenderer/Buffer/Buffer.h"
+
+namespace
+{
+	// accesses that have to be made available before another access may touch the memory
+	constexpr VkAccessFlags s_WriteAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+		VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT |
+		VK_ACCESS_MEMORY_WRITE_BIT;
+
+	bool IsAttachment(const ResourceUsage a_Usage)
+	{
+		return a_Usage == ResourceUsage::ColorAttachment || a_Usage == ResourceUsage::DepthAttachment;
+	}
+}
+
+RenderGraph::RenderGraph()
+= default;
+
+RenderGraph::~RenderGraph()
+= default;
+
+RenderGraphResource RenderGraph::CreateImage(const std::string& a_Name, const TransientImageDesc& a_Description)
+{
+	Resource t_Resource = {};
+	t_Resource.m_Name = a_Name;
+	t_Resource.m_Description = a_Description;
+
+	m_Resources.push_back(t_Resource);
+	return static_cast<RenderGraphResource>(m_Resources.size() - 1);
+}
+
+RenderGraphResource RenderGraph::ImportImage(const std::string& a_Name, VkImage a_Image, VkImageView a_ImageView,
+                                             const TransientImageDesc& a_Description, const VkImageLayout a_InitialLayout,
+                                             const VkImageLayout a_FinalLayout)
+{
+	Resource t_Resource = {};
+	t_Resource.m_Name = a_Name;
+	t_Resource.m_Description = a_Description;
+	t_Resource.m_Imported = true;
+	t_Resource.m_Image = a_Image;
+	t_Resource.m_ImageView = a_ImageView;
+	t_Resource.m_InitialLayout = a_InitialLayout;
+	t_Resource.m_FinalLayout = a_FinalLayout;
+
+	m_Resources.push_back(t_Resource);
+	return static_cast<RenderGraphResource>(m_Resources.size() - 1);
+}
+
+RenderGraphResource RenderGraph::ImportBuffer(const std::string& a_Name, VkBuffer a_Buffer)
+{
+	Resource t_Resource = {};
+	t_Resource.m_Name = a_Name;
+	t_Resource.m_Imported = true;
+	t_Resource.m_IsBuffer = true;
+	t_Resource.m_Buffer = a_Buffer;
+
+	m_Resources.push_back(t_Resource);
+	return static_cast<RenderGraphResource>(m_Resources.size() - 1);
+}
+
+void RenderGraph::UpdateImportedImage(const RenderGraphResource a_Resource, VkImage a_Image, VkImageView a_ImageView,
+                                      const VkExtent2D a_Extent)
+{
+	Resource& t_Resource = m_Resources[a_Resource];
+
+	if (!t_Resource.m_Imported || t_Resource.m_IsBuffer)
+	{
+		throw std::runtime_error("Error! Render graph image " + t_Resource.m_Name + " is not imported!");
+	}
+
+	t_Resource.m_Image = a_Image;
+	t_Resource.m_ImageView = a_ImageView;
+	t_Resource.m_Description.m_Extent = a_Extent;
+
+	for (const BarrierLocation& t_Location : t_Resource.m_Barriers)
+	{
+		GetImageBarrier(t_Location).image = a_Image;
+	}
+}
+
+void RenderGraph::SetInitialLayout(const RenderGraphResource a_Resource, const VkImageLayout a_InitialLayout)
+{
+	Resource& t_Resource = m_Resources[a_Resource];
+
+	if (!t_Resource.m_Imported || t_Resource.m_IsBuffer)
+	{
+		throw std::runtime_error("Error! Render graph image " + t_Resource.m_Name + " is not imported!");
+	}
+
+	t_Resource.m_InitialLayout = a_InitialLayout;
+
+	// the first access of an imported image always has a barrier, it transitions from the initial layout
+	if (!t_Resource.m_Barriers.empty())
+	{
+		GetImageBarrier(t_Resource.m_Barriers.front()).oldLayout = a_InitialLayout;
+	}
+}
+
+RenderGraphPass RenderGraph::AddPass(const std::string& a_Name, const PassType a_Type, ExecuteCallback a_Callback)
+{
+	Pass t_Pass = {};
+	t_Pass.m_Name = a_Name;
+	t_Pass.m_Type = a_Type;
+	t_Pass.m_Callback = std::move(a_Callback);
+
+	m_Passes.push_back(std::move(t_Pass));
+	return static_cast<RenderGraphPass>(m_Passes.size() - 1);
+}
+
+void RenderGraph::Read(const RenderGraphPass a_Pass, const RenderGraphResource a_Resource, const ResourceUsage a_Usage)
+{
+	// attachments that are only read keep their contents
+	AddAccess(a_Pass, {a_Resource, a_Usage, VK_ATTACHMENT_LOAD_OP_LOAD, {}}, false);
+}
+
+void RenderGraph::Write(const RenderGraphPass a_Pass, const RenderGraphResource a_Resource, const ResourceUsage a_Usage,
+                        const VkAttachmentLoadOp a_LoadOp, const VkClearValue a_ClearValue)
+{
+	AddAccess(a_Pass, {a_Resource, a_Usage, a_LoadOp, a_ClearValue}, true);
+}
+
+void RenderGraph::SetRenderArea(const RenderGraphPass a_Pass, const VkExtent2D a_RenderArea)
+{
+	m_Passes[a_Pass].m_RenderArea = a_RenderArea;
+}
+
+void RenderGraph::Compile(const Device& a_Device)
+{
+	DestroyCompiledObjects();
+	m_LogicalDevice = a_Device.GetLogicalDevice();
+
+	SortPasses();
+	CullPasses();
+	ComputeLifetimes();
+	AllocateTransientImages(a_Device);
+	ComputeBarriers();
+	CreateRenderPasses(m_LogicalDevice);
+}
+
+void RenderGraph::Execute(VkCommandBuffer a_CommandBuffer)
+{
+	for (const uint32_t t_PassIndex : m_ExecutionOrder)
+	{
+		Pass& t_Pass = m_Passes[t_PassIndex];
+
+		RecordBarriers(a_CommandBuffer, t_Pass.m_Barriers);
+
+		if (t_Pass.m_Type != PassType::Graphics)
+		{
+			t_Pass.m_Callback(a_CommandBuffer);
+			continue;
+		}
+
+		const VkExtent2D t_RenderArea = t_Pass.m_RenderArea.width != 0
+			                                ? t_Pass.m_RenderArea
+			                                : m_Resources[t_Pass.m_Attachments[0]].m_Description.m_Extent;
+
+		VkRenderPassBeginInfo t_RenderPassBeginInfo = {};
+		t_RenderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		t_RenderPassBeginInfo.renderPass = t_Pass.m_RenderPass;
+		t_RenderPassBeginInfo.framebuffer = GetFramebuffer(t_Pass);
+		t_RenderPassBeginInfo.renderArea.offset = {0, 0};
+		t_RenderPassBeginInfo.renderArea.extent = t_RenderArea;
+		t_RenderPassBeginInfo.clearValueCount = static_cast<uint32_t>(t_Pass.m_ClearValues.size());
+		t_RenderPassBeginInfo.pClearValues = t_Pass.m_ClearValues.data();
+
+		vkCmdBeginRenderPass(a_CommandBuffer, &t_RenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+		t_Pass.m_Callback(a_CommandBuffer);
+		vkCmdEndRenderPass(a_CommandBuffer);
+	}
+
+	RecordBarriers(a_CommandBuffer, m_FinalBarriers);
+}
+
+void RenderGraph::InvalidateImageViews(const std::vector<VkImageView>& a_ImageViews)
+{
+	const auto t_IsInvalid = [&a_ImageViews](const VkImageView a_View)
+	{
+		return std::find(a_ImageViews.begin(), a_ImageViews.end(), a_View) != a_ImageViews.end();
+	};
+
+	for (Pass& t_Pass : m_Passes)
+	{
+		for (size_t i = t_Pass.m_Framebuffers.size(); i-- > 0;)
+		{
+			const CachedFramebuffer& t_Cached = t_Pass.m_Framebuffers[i];
+
+			if (std::any_of(t_Cached.m_Views.begin(), t_Cached.m_Views.end(), t_IsInvalid))
+			{
+				vkDestroyFramebuffer(m_LogicalDevice, t_Cached.m_Framebuffer, nullptr);
+				t_Pass.m_Framebuffers.erase(t_Pass.m_Framebuffers.begin() + static_cast<std::ptrdiff_t>(i));
+			}
+		}
+	}
+}
+
+void RenderGraph::Destroy(const VkDevice& a_LogicalDevice)
+{
+	m_LogicalDevice = a_LogicalDevice;
+	DestroyCompiledObjects();
+
+	m_Resources.clear();
+	m_Passes.clear();
+}
+
+VkRenderPass RenderGraph::GetRenderPass(const RenderGraphPass a_Pass) const
+{
+	return m_Passes[a_Pass].m_RenderPass;
+}
+
+VkImage RenderGraph::GetImage(const RenderGraphResource a_Resource) const
+{
+	return m_Resources[a_Resource].m_Image;
+}
+
+VkImageView RenderGraph::GetImageView(const RenderGraphResource a_Resource) const
+{
+	return m_Resources[a_Resource].m_ImageView;
+}
+
+bool RenderGraph::IsPassActive(const RenderGraphPass a_Pass) const
+{
+	return m_Passes[a_Pass].m_Active;
+}
+
+VkDeviceSize RenderGraph::GetTransientMemorySize() const
+{
+	VkDeviceSize t_Size = 0;
+
+	for (const MemoryBlock& t_Block : m_MemoryBlocks)
+	{
+		t_Size += t_Block.m_Size;
+	}
+
+	return t_Size;
+}
+
+RenderGraph::ResourceState RenderGraph::GetUsageState(const ResourceUsage a_Usage)
+{
+	switch (a_Usage)
+	{
+	case ResourceUsage::ColorAttachment:
+		return {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT};
+	case ResourceUsage::DepthAttachment:
+		return {VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT};
+	case ResourceUsage::SampledFragment:
+		return {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT};
+	case ResourceUsage::SampledCompute:
+		return {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT};
+	case ResourceUsage::DepthSampledCompute:
+		return {VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_ACCESS_SHADER_READ_BIT};
+	case ResourceUsage::StorageReadCompute:
+		return {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT};
+	case ResourceUsage::StorageWriteCompute:
+		return {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT};
+	case ResourceUsage::StorageReadWriteCompute:
+		return {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT};
+	case ResourceUsage::IndirectRead:
+		return {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT};
+	case ResourceUsage::TransferSource:
+		return {VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT};
+	case ResourceUsage::TransferDestination:
+		return {VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT};
+	}
+
+	throw std::runtime_error("Error! Unknown render graph resource usage!");
+}
+
+VkImageUsageFlags RenderGraph::GetUsageFlags(const ResourceUsage a_Usage)
+{
+	switch (a_Usage)
+	{
+	case ResourceUsage::ColorAttachment:
+		return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	case ResourceUsage::DepthAttachment:
+		return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+	case ResourceUsage::SampledFragment:
+	case ResourceUsage::SampledCompute:
+	case ResourceUsage::DepthSampledCompute:
+		return VK_IMAGE_USAGE_SAMPLED_BIT;
+	case ResourceUsage::StorageReadCompute:
+	case ResourceUsage::StorageWriteCompute:
+	case ResourceUsage::StorageReadWriteCompute:
+		return VK_IMAGE_USAGE_STORAGE_BIT;
+	case ResourceUsage::TransferSource:
+		return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	case ResourceUsage::TransferDestination:
+		return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	case ResourceUsage::IndirectRead:
+		break;
+	}
+
+	return 0;
+}
+
+bool RenderGraph::IsWrite(const ResourceUsage a_Usage)
+{
+	return (GetUsageState(a_Usage).m_Access & s_WriteAccessMask) != 0;
+}
+
+bool RenderGraph::SupportsUsage(const Resource& a_Resource, const ResourceUsage a_Usage)
+{
+	switch (a_Usage)
+	{
+	case ResourceUsage::IndirectRead:
+		return a_Resource.m_IsBuffer;
+	case ResourceUsage::StorageReadCompute:
+	case ResourceUsage::StorageWriteCompute:
+	case ResourceUsage::StorageReadWriteCompute:
+	case ResourceUsage::TransferSource:
+	case ResourceUsage::TransferDestination:
+		return true;
+	default:
+		return !a_Resource.m_IsBuffer;
+	}
+}
+
+bool RenderGraph::AccessesResource(const Pass& a_Pass, const RenderGraphResource a_Resource) const
+{
+	const auto t_Matches = [a_Resource](const ResourceAccess& a_Access) { return a_Access.m_Resource == a_Resource; };
+
+	return std::any_of(a_Pass.m_Reads.begin(), a_Pass.m_Reads.end(), t_Matches) ||
+		std::any_of(a_Pass.m_Writes.begin(), a_Pass.m_Writes.end(), t_Matches);
+}
+
+/// <summary>	Adds a read or write to a pass. </summary>
+/// <exception cref="std::runtime_error">
+/// 	Raised when the pass already accesses the resource or the usage does not apply to it.
+/// </exception>
+/// <param name="a_Pass">  	The pass.</param>
+/// <param name="a_Access">	The access.</param>
+/// <param name="a_Write"> 	True if the pass writes the resource.</param>
+
+void RenderGraph::AddAccess(const RenderGraphPass a_Pass, const ResourceAccess& a_Access, const bool a_Write)
+{
+	Pass& t_Pass = m_Passes[a_Pass];
+	const Resource& t_Resource = m_Resources[a_Access.m_Resource];
+
+	if (AccessesResource(t_Pass, a_Access.m_Resource))
+	{
+		throw std::runtime_error("Error! Render graph pass " + t_Pass.m_Name + " accesses " + t_Resource.m_Name +
+			" more than once!");
+	}
+
+	if (!SupportsUsage(t_Resource, a_Access.m_Usage))
+	{
+		throw std::runtime_error("Error! Render graph pass " + t_Pass.m_Name + " cannot access " + t_Resource.m_Name +
+			" with the given usage!");
+	}
+
+	if (a_Write)
+	{
+		t_Pass.m_Writes.push_back(a_Access);
+	}
+	else
+	{
+		t_Pass.m_Reads.push_back(a_Access);
+	}
+}
+
+/// <summary>
+/// 	Orders the passes so every pass runs after the passes it depends on. Passes writing the same
+/// 	resource keep the order they were added in and passes only reading it follow the last of
+/// 	them. Of the passes that are ready, the one added first runs first.
+/// </summary>
+/// <exception cref="std::runtime_error">	Raised when the passes depend on each other in a cycle.</exception>
+
+void RenderGraph::SortPasses()
+{
+	const uint32_t t_PassCount = static_cast<uint32_t>(m_Passes.size());
+
+	std::vector<std::vector<uint32_t>> t_Writers(m_Resources.size());
+
+	for (uint32_t i = 0; i < t_PassCount; i++)
+	{
+		for (const ResourceAccess& t_Write : m_Passes[i].m_Writes)
+		{
+			t_Writers[t_Write.m_Resource].push_back(i);
+		}
+	}
+
+	std::vector<std::vector<uint32_t>> t_Dependents(t_PassCount);
+	std::vector<uint32_t> t_DependencyCounts(t_PassCount, 0);
+
+	const auto t_AddDependency = [&t_Dependents, &t_DependencyCounts](const uint32_t a_Before, const uint32_t a_After)
+	{
+		t_Dependents[a_Before].push_back(a_After);
+		t_DependencyCounts[a_After]++;
+	};
+
+	for (const std::vector<uint32_t>& t_ResourceWriters : t_Writers)
+	{
+		for (size_t i = 1; i < t_ResourceWriters.size(); i++)
+		{
+			t_AddDependency(t_ResourceWriters[i - 1], t_ResourceWriters[i]);
+		}
+	}
+
+	for (uint32_t i = 0; i < t_PassCount; i++)
+	{
+		for (const ResourceAccess& t_Read : m_Passes[i].m_Reads)
+		{
+			if (!t_Writers[t_Read.m_Resource].empty())
+			{
+				t_AddDependency(t_Writers[t_Read.m_Resource].back(), i);
+			}
+		}
+	}
+
+	std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> t_Ready;
+
+	for (uint32_t i = 0; i < t_PassCount; i++)
+	{
+		if (t_DependencyCounts[i] == 0)
+		{
+			t_Ready.push(i);
+		}
+	}
+
+	m_ExecutionOrder.clear();
+
+	while (!t_Ready.empty())
+	{
+		const uint32_t t_PassIndex = t_Ready.top();
+		t_Ready.pop();
+		m_ExecutionOrder.push_back(t_PassIndex);
+
+		for (const uint32_t t_Dependent : t_Dependents[t_PassIndex])
+		{
+			if (--t_DependencyCounts[t_Dependent] == 0)
+			{
+				t_Ready.push(t_Dependent);
+			}
+		}
+	}
+
+	if (m_ExecutionOrder.size() != t_PassCount)
+	{
+		throw std::runtime_error("Error! Render graph passes depend on each other in a cycle!");
+	}
+}
+
+/// <summary>
+/// 	Marks the passes that contribute to an imported resource (or write nothing at all) as active,
+/// 	walking the execution order backwards, and removes the others from it.
+/// </summary>
+/// <exception cref="std::runtime_error">	Raised when a pass reads a transient image no previous pass wrote.</exception>
+
+void RenderGraph::CullPasses()
+{
+	std::vector<bool> t_Needed(m_Resources.size(), false);
+
+	for (size_t i = 0; i < m_Resources.size(); i++)
+	{
+		t_Needed[i] = m_Resources[i].m_Imported;
+	}
+
+	for (size_t i = m_ExecutionOrder.size(); i-- > 0;)
+	{
+		Pass& t_Pass = m_Passes[m_ExecutionOrder[i]];
+		t_Pass.m_Active = t_Pass.m_Writes.empty();
+
+		for (const ResourceAccess& t_Write : t_Pass.m_Writes)
+		{
+			t_Pass.m_Active = t_Pass.m_Active || t_Needed[t_Write.m_Resource];
+		}
+
+		if (!t_Pass.m_Active)
+		{
+			continue;
+		}
+
+		for (const ResourceAccess& t_Read : t_Pass.m_Reads)
+		{
+			t_Needed[t_Read.m_Resource] = true;
+		}
+	}
+
+	m_ExecutionOrder.erase(std::remove_if(m_ExecutionOrder.begin(), m_ExecutionOrder.end(),
+	                                      [this](const uint32_t a_Pass) { return !m_Passes[a_Pass].m_Active; }),
+	                       m_ExecutionOrder.end());
+
+	// transient images have to be written before they are read
+	std::vector<bool> t_Written(m_Resources.size(), false);
+
+	for (const uint32_t t_PassIndex : m_ExecutionOrder)
+	{
+		const Pass& t_Pass = m_Passes[t_PassIndex];
+
+		for (const ResourceAccess& t_Read : t_Pass.m_Reads)
+		{
+			if (!m_Resources[t_Read.m_Resource].m_Imported && !t_Written[t_Read.m_Resource])
+			{
+				throw std::runtime_error("Error! Render graph pass " + t_Pass.m_Name + " reads " +
+					m_Resources[t_Read.m_Resource].m_Name + " before it is written!");
+			}
+		}
+
+		for (const ResourceAccess& t_Write : t_Pass.m_Writes)
+		{
+			t_Written[t_Write.m_Resource] = true;
+		}
+	}
+}
+
+void RenderGraph::ComputeLifetimes()
+{
+	for (Resource& t_Resource : m_Resources)
+	{
+		t_Resource.m_Usage = 0;
+		t_Resource.m_FirstPass = -1;
+		t_Resource.m_LastPass = -1;
+		t_Resource.m_MemoryBlock = -1;
+	}
+
+	for (size_t t_Position = 0; t_Position < m_ExecutionOrder.size(); t_Position++)
+	{
+		const Pass& t_Pass = m_Passes[m_ExecutionOrder[t_Position]];
+
+		for (const std::vector<ResourceAccess>* t_Accesses : {&t_Pass.m_Reads, &t_Pass.m_Writes})
+		{
+			for (const ResourceAccess& t_Access : *t_Accesses)
+			{
+				Resource& t_Resource = m_Resources[t_Access.m_Resource];
+				t_Resource.m_Usage |= GetUsageFlags(t_Access.m_Usage);
+
+				if (t_Resource.m_FirstPass < 0)
+				{
+					t_Resource.m_FirstPass = static_cast<int>(t_Position);
+				}
+
+				t_Resource.m_LastPass = static_cast<int>(t_Position);
+			}
+		}
+	}
+}
+
+/// <summary>
+/// 	Creates the transient images and places them in memory blocks. Images whose pass ranges do
+/// 	not overlap share a block, which is sized for the largest of them.
+/// </summary>
+/// <exception cref="std::runtime_error">	Raised when an image could not be created or memory could not be allocated.</exception>
+/// <param name="a_Device">	The device.</param>
+
+void RenderGraph::AllocateTransientImages(const Device& a_Device)
+{
+	const VkDevice t_LogicalDevice = a_Device.GetLogicalDevice();
+
+	std::vector<RenderGraphResource> t_Transients;
+	std::vector<VkMemoryRequirements> t_Requirements(m_Resources.size());
+
+	for (RenderGraphResource i = 0; i < m_Resources.size(); i++)
+	{
+		Resource& t_Resource = m_Resources[i];
+
+		// imported and unused images do not need memory
+		if (t_Resource.m_Imported || t_Resource.m_FirstPass < 0)
+		{
+			continue;
+		}
+
+		VkImageCreateInfo t_ImageCreateInfo = {};
+		t_ImageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		t_ImageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+		t_ImageCreateInfo.extent = {t_Resource.m_Description.m_Extent.width, t_Resource.m_Description.m_Extent.height, 1};
+		t_ImageCreateInfo.mipLevels = 1;
+		t_ImageCreateInfo.arrayLayers = 1;
+		t_ImageCreateInfo.format = t_Resource.m_Description.m_Format;
+		t_ImageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		t_ImageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		t_ImageCreateInfo.usage = t_Resource.m_Usage;
+		t_ImageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		t_ImageCreateInfo.samples = t_Resource.m_Description.m_Samples;
+
+		if (vkCreateImage(t_LogicalDevice, &t_ImageCreateInfo, nullptr, &t_Resource.m_Image) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Error! Could not create render graph image " + t_Resource.m_Name + "!");
+		}
+
+		vkGetImageMemoryRequirements(t_LogicalDevice, t_Resource.m_Image, &t_Requirements[i]);
+		t_Transients.push_back(i);
+	}
+
+	// place the largest images first so smaller ones fill the blocks they leave
+	std::stable_sort(t_Transients.begin(), t_Transients.end(), [&t_Requirements](const RenderGraphResource a_Lhs,
+	                                                                              const RenderGraphResource a_Rhs)
+	{
+		return t_Requirements[a_Lhs].size > t_Requirements[a_Rhs].size;
+	});
+
+	for (const RenderGraphResource t_ResourceIndex : t_Transients)
+	{
+		Resource& t_Resource = m_Resources[t_ResourceIndex];
+		const VkMemoryRequirements& t_Requirement = t_Requirements[t_ResourceIndex];
+
+		int t_BlockIndex = -1;
+
+		for (size_t t_Block = 0; t_Block < m_MemoryBlocks.size() && t_BlockIndex < 0; t_Block++)
+		{
+			const MemoryBlock& t_MemoryBlock = m_MemoryBlocks[t_Block];
+
+			if ((t_MemoryBlock.m_MemoryTypeBits & t_Requirement.memoryTypeBits) == 0)
+			{
+				continue;
+			}
+
+			const bool t_Overlaps = std::any_of(t_MemoryBlock.m_Resources.begin(), t_MemoryBlock.m_Resources.end(),
+			                                    [this, &t_Resource](const RenderGraphResource a_Other)
+			                                    {
+				                                    const Resource& t_Other = m_Resources[a_Other];
+				                                    return t_Resource.m_FirstPass <= t_Other.m_LastPass &&
+					                                    t_Other.m_FirstPass <= t_Resource.m_LastPass;
+			                                    });
+
+			if (!t_Overlaps)
+			{
+				t_BlockIndex = static_cast<int>(t_Block);
+			}
+		}
+
+		if (t_BlockIndex < 0)
+		{
+			m_MemoryBlocks.emplace_back();
+			t_BlockIndex = static_cast<int>(m_MemoryBlocks.size() - 1);
+		}
+
+		MemoryBlock& t_MemoryBlock = m_MemoryBlocks[t_BlockIndex];
+		t_MemoryBlock.m_Size = std::max(t_MemoryBlock.m_Size, t_Requirement.size);
+		t_MemoryBlock.m_MemoryTypeBits &= t_Requirement.memoryTypeBits;
+		t_MemoryBlock.m_Resources.push_back(t_ResourceIndex);
+		t_Resource.m_MemoryBlock = t_BlockIndex;
+	}
+
+	for (MemoryBlock& t_MemoryBlock : m_MemoryBlocks)
+	{
+		// barriers between images sharing a block are generated in execution order
+		std::sort(t_MemoryBlock.m_Resources.begin(), t_MemoryBlock.m_Resources.end(),
+		          [this](const RenderGraphResource a_Lhs, const RenderGraphResource a_Rhs)
+		          {
+			          return m_Resources[a_Lhs].m_FirstPass < m_Resources[a_Rhs].m_FirstPass;
+		          });
+
+		VkMemoryAllocateInfo t_AllocateInfo = {};
+		t_AllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		t_AllocateInfo.allocationSize = t_MemoryBlock.m_Size;
+		t_AllocateInfo.memoryTypeIndex = Buffer::GetMemoryType(a_Device, t_MemoryBlock.m_MemoryTypeBits,
+		                                                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		if (vkAllocateMemory(t_LogicalDevice, &t_AllocateInfo, nullptr, &t_MemoryBlock.m_Memory) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Error! Could not allocate render graph memory!");
+		}
+
+		for (const RenderGraphResource t_ResourceIndex : t_MemoryBlock.m_Resources)
+		{
+			Resource& t_Resource = m_Resources[t_ResourceIndex];
+			vkBindImageMemory(t_LogicalDevice, t_Resource.m_Image, t_MemoryBlock.m_Memory, 0);
+
+			VkImageViewCreateInfo t_ViewCreateInfo = {};
+			t_ViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			t_ViewCreateInfo.image = t_Resource.m_Image;
+			t_ViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			t_ViewCreateInfo.format = t_Resource.m_Description.m_Format;
+			t_ViewCreateInfo.subresourceRange = {t_Resource.m_Description.m_Aspect, 0, 1, 0, 1};
+
+			if (vkCreateImageView(t_LogicalDevice, &t_ViewCreateInfo, nullptr, &t_Resource.m_ImageView) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Error! Could not create render graph image view " + t_Resource.m_Name + "!");
+			}
+		}
+	}
+}
+
+/// <summary>
+/// 	Simulates the state of every resource through one execution of the graph and records one
+/// 	batch of barriers per pass: for layout changes, for reads or writes after writes and for
+/// 	writes after reads. The batches hold the final Vulkan barriers, so executing the graph only
+/// 	records them.
+/// </summary>
+
+void RenderGraph::ComputeBarriers()
+{
+	// usage of every image in its last pass, used for hazards across frames and aliased images
+	std::vector<ResourceUsage> t_LastUsage(m_Resources.size(), ResourceUsage::SampledFragment);
+
+	for (const uint32_t t_PassIndex : m_ExecutionOrder)
+	{
+		const Pass& t_Pass = m_Passes[t_PassIndex];
+
+		for (const std::vector<ResourceAccess>* t_Accesses : {&t_Pass.m_Reads, &t_Pass.m_Writes})
+		{
+			for (const ResourceAccess& t_Access : *t_Accesses)
+			{
+				t_LastUsage[t_Access.m_Resource] = t_Access.m_Usage;
+			}
+		}
+	}
+
+	std::vector<ResourceState> t_States(m_Resources.size());
+
+	for (size_t i = 0; i < m_Resources.size(); i++)
+	{
+		const Resource& t_Resource = m_Resources[i];
+
+		if (t_Resource.m_Imported)
+		{
+			// waits for everything submitted before, including semaphore waits of any stage, and
+			// makes the writes of the commands recorded before the graph available
+			t_States[i] = {t_Resource.m_InitialLayout, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_WRITE_BIT};
+			continue;
+		}
+
+		if (t_Resource.m_MemoryBlock < 0)
+		{
+			continue;
+		}
+
+		// the contents are discarded, but the previous user of the memory has to be finished with it.
+		// For the first image in a block that is the last one of the previous frame
+		const std::vector<RenderGraphResource>& t_BlockResources = m_MemoryBlocks[t_Resource.m_MemoryBlock].m_Resources;
+		const auto t_Position = std::find(t_BlockResources.begin(), t_BlockResources.end(), i);
+		const RenderGraphResource t_Previous = t_Position == t_BlockResources.begin()
+			                                       ? t_BlockResources.back()
+			                                       : *(t_Position - 1);
+
+		const ResourceState t_PreviousState = GetUsageState(t_LastUsage[t_Previous]);
+		t_States[i] = {VK_IMAGE_LAYOUT_UNDEFINED, t_PreviousState.m_Stage, t_PreviousState.m_Access & s_WriteAccessMask};
+	}
+
+	for (const uint32_t t_PassIndex : m_ExecutionOrder)
+	{
+		const Pass& t_Pass = m_Passes[t_PassIndex];
+
+		for (const std::vector<ResourceAccess>* t_Accesses : {&t_Pass.m_Reads, &t_Pass.m_Writes})
+		{
+			for (const ResourceAccess& t_Access : *t_Accesses)
+			{
+				ResourceState& t_Current = t_States[t_Access.m_Resource];
+				const ResourceState t_Next = GetUsageState(t_Access.m_Usage);
+
+				const bool t_LayoutChange = !m_Resources[t_Access.m_Resource].m_IsBuffer &&
+					t_Current.m_Layout != t_Next.m_Layout;
+				const bool t_Hazard = (t_Current.m_Access & s_WriteAccessMask) != 0 || IsWrite(t_Access.m_Usage);
+
+				// consecutive reads in the same layout only have to be waited on by the next write. A read in
+				// a stage the previous barrier did not wait in extends the dependency chain to that stage
+				if (!t_LayoutChange && !t_Hazard)
+				{
+					if ((t_Next.m_Stage & ~t_Current.m_Stage) != 0 || (t_Next.m_Access & ~t_Current.m_Access) != 0)
+					{
+						AddBarrier(m_Passes[t_PassIndex].m_Barriers, static_cast<int>(t_PassIndex), t_Access.m_Resource,
+						           t_Current, t_Next);
+					}
+
+					t_Current.m_Stage |= t_Next.m_Stage;
+					t_Current.m_Access |= t_Next.m_Access;
+					continue;
+				}
+
+				AddBarrier(m_Passes[t_PassIndex].m_Barriers, static_cast<int>(t_PassIndex), t_Access.m_Resource,
+				           t_Current, t_Next);
+				t_Current = t_Next;
+			}
+		}
+	}
+
+	// hand imported resources back in the layout their owner expects, with the writes visible to
+	// the commands recorded after the graph
+	for (RenderGraphResource i = 0; i < m_Resources.size(); i++)
+	{
+		const Resource& t_Resource = m_Resources[i];
+
+		if (!t_Resource.m_Imported)
+		{
+			continue;
+		}
+
+		const bool t_LayoutChange = !t_Resource.m_IsBuffer && t_Resource.m_FinalLayout != VK_IMAGE_LAYOUT_UNDEFINED &&
+			t_States[i].m_Layout != t_Resource.m_FinalLayout;
+		const bool t_PendingWrite = t_Resource.m_FirstPass >= 0 && (t_States[i].m_Access & s_WriteAccessMask) != 0;
+
+		if (!t_LayoutChange && !t_PendingWrite)
+		{
+			continue;
+		}
+
+		const ResourceState t_Final = {
+			t_LayoutChange ? t_Resource.m_FinalLayout : t_States[i].m_Layout, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+			VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT
+		};
+
+		AddBarrier(m_FinalBarriers, -1, i, t_States[i], t_Final);
+	}
+}
+
+/// <summary>
+/// 	Creates a single subpass render pass for every active graphics pass. Layout transitions are
+/// 	done by the graph's barriers, so attachments stay in their attachment layout.
+/// </summary>
+/// <exception cref="std::runtime_error">	Raised when a render pass could not be created.</exception>
+/// <param name="a_LogicalDevice">	The logical device.</param>
+
+void RenderGraph::CreateRenderPasses(const VkDevice& a_LogicalDevice)
+{
+	for (uint32_t t_Position = 0; t_Position < m_ExecutionOrder.size(); t_Position++)
+	{
+		Pass& t_Pass = m_Passes[m_ExecutionOrder[t_Position]];
+
+		if (t_Pass.m_Type != PassType::Graphics)
+		{
+			continue;
+		}
+
+		std::vector<VkAttachmentDescription> t_AttachmentDescriptions;
+		std::vector<VkAttachmentReference> t_ColorReferences;
+		VkAttachmentReference t_DepthReference = {};
+		bool t_HasDepth = false;
+
+		for (const std::vector<ResourceAccess>* t_Accesses : {&t_Pass.m_Reads, &t_Pass.m_Writes})
+		{
+			for (const ResourceAccess& t_Access : *t_Accesses)
+			{
+				if (!IsAttachment(t_Access.m_Usage))
+				{
+					continue;
+				}
+
+				const Resource& t_Resource = m_Resources[t_Access.m_Resource];
+				const VkImageLayout t_Layout = GetUsageState(t_Access.m_Usage).m_Layout;
+
+				// contents that are not needed afterwards do not have to be written back to memory
+				const VkAttachmentStoreOp t_StoreOp = IsReadAfter(t_Access.m_Resource, t_Position)
+					                                      ? VK_ATTACHMENT_STORE_OP_STORE
+					                                      : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+				VkAttachmentDescription t_Description = {};
+				t_Description.format = t_Resource.m_Description.m_Format;
+				t_Description.samples = t_Resource.m_Description.m_Samples;
+				t_Description.loadOp = t_Access.m_LoadOp;
+				t_Description.storeOp = t_StoreOp;
+				t_Description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+				t_Description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				t_Description.initialLayout = t_Layout;
+				t_Description.finalLayout = t_Layout;
+
+				const uint32_t t_AttachmentIndex = static_cast<uint32_t>(t_AttachmentDescriptions.size());
+
+				if (t_Access.m_Usage == ResourceUsage::DepthAttachment)
+				{
+					t_DepthReference = {t_AttachmentIndex, t_Layout};
+					t_HasDepth = true;
+				}
+				else
+				{
+					t_ColorReferences.push_back({t_AttachmentIndex, t_Layout});
+				}
+
+				t_AttachmentDescriptions.push_back(t_Description);
+				t_Pass.m_Attachments.push_back(t_Access.m_Resource);
+				t_Pass.m_ClearValues.push_back(t_Access.m_ClearValue);
+			}
+		}
+
+		if (t_AttachmentDescriptions.empty())
+		{
+			throw std::runtime_error("Error! Render graph graphics pass " + t_Pass.m_Name + " has no attachments!");
+		}
+
+		VkSubpassDescription t_SubpassDescription = {};
+		t_SubpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		t_SubpassDescription.colorAttachmentCount = static_cast<uint32_t>(t_ColorReferences.size());
+		t_SubpassDescription.pColorAttachments = t_ColorReferences.data();
+		t_SubpassDescription.pDepthStencilAttachment = t_HasDepth ? &t_DepthReference : nullptr;
+
+		VkRenderPassCreateInfo t_RenderPassCreateInfo = {};
+		t_RenderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		t_RenderPassCreateInfo.attachmentCount = static_cast<uint32_t>(t_AttachmentDescriptions.size());
+		t_RenderPassCreateInfo.pAttachments = t_AttachmentDescriptions.data();
+		t_RenderPassCreateInfo.subpassCount = 1;
+		t_RenderPassCreateInfo.pSubpasses = &t_SubpassDescription;
+
+		if (vkCreateRenderPass(a_LogicalDevice, &t_RenderPassCreateInfo, nullptr, &t_Pass.m_RenderPass) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Error! Could not create render pass for render graph pass " + t_Pass.m_Name + "!");
+		}
+	}
+}
+
+void RenderGraph::AddBarrier(BarrierBatch& a_Batch, const int a_Pass, const RenderGraphResource a_Resource,
+                             const ResourceState& a_Current, const ResourceState& a_Next)
+{
+	Resource& t_Resource = m_Resources[a_Resource];
+
+	a_Batch.m_SourceStage |= a_Current.m_Stage;
+	a_Batch.m_DestinationStage |= a_Next.m_Stage;
+
+	if (t_Resource.m_IsBuffer)
+	{
+		VkBufferMemoryBarrier t_BufferBarrier = {};
+		t_BufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		t_BufferBarrier.srcAccessMask = a_Current.m_Access & s_WriteAccessMask;
+		t_BufferBarrier.dstAccessMask = a_Next.m_Access;
+		t_BufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		t_BufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		t_BufferBarrier.buffer = t_Resource.m_Buffer;
+		t_BufferBarrier.offset = 0;
+		t_BufferBarrier.size = VK_WHOLE_SIZE;
+
+		a_Batch.m_BufferBarriers.push_back(t_BufferBarrier);
+		return;
+	}
+
+	VkImageMemoryBarrier t_ImageBarrier = {};
+	t_ImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	t_ImageBarrier.oldLayout = a_Current.m_Layout;
+	t_ImageBarrier.newLayout = a_Next.m_Layout;
+	t_ImageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	t_ImageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	t_ImageBarrier.image = t_Resource.m_Image;
+	// imported images may have mip levels, e.g. a depth pyramid
+	t_ImageBarrier.subresourceRange = {t_Resource.m_Description.m_Aspect, 0, VK_REMAINING_MIP_LEVELS, 0, 1};
+	t_ImageBarrier.srcAccessMask = a_Current.m_Access & s_WriteAccessMask;
+	t_ImageBarrier.dstAccessMask = a_Next.m_Access;
+
+	t_Resource.m_Barriers.push_back({a_Pass, static_cast<uint32_t>(a_Batch.m_ImageBarriers.size())});
+	a_Batch.m_ImageBarriers.push_back(t_ImageBarrier);
+}
+
+VkImageMemoryBarrier& RenderGraph::GetImageBarrier(const BarrierLocation& a_Location)
+{
+	BarrierBatch& t_Batch = a_Location.m_Pass < 0 ? m_FinalBarriers : m_Passes[a_Location.m_Pass].m_Barriers;
+	return t_Batch.m_ImageBarriers[a_Location.m_Index];
+}
+
+bool RenderGraph::IsReadAfter(const RenderGraphResource a_Resource, const uint32_t a_Position) const
+{
+	if (m_Resources[a_Resource].m_Imported)
+	{
+		return true;
+	}
+
+	for (uint32_t i = a_Position + 1; i < m_ExecutionOrder.size(); i++)
+	{
+		if (AccessesResource(m_Passes[m_ExecutionOrder[i]], a_Resource))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void RenderGraph::RecordBarriers(VkCommandBuffer a_CommandBuffer, const BarrierBatch& a_Batch)
+{
+	if (a_Batch.m_ImageBarriers.empty() && a_Batch.m_BufferBarriers.empty())
+	{
+		return;
+	}
+
+	vkCmdPipelineBarrier(a_CommandBuffer, a_Batch.m_SourceStage, a_Batch.m_DestinationStage, 0, 0, nullptr,
+	                     static_cast<uint32_t>(a_Batch.m_BufferBarriers.size()), a_Batch.m_BufferBarriers.data(),
+	                     static_cast<uint32_t>(a_Batch.m_ImageBarriers.size()), a_Batch.m_ImageBarriers.data());
+}
+
+VkFramebuffer RenderGraph::GetFramebuffer(Pass& a_Pass)
+{
+	// compared in place, so only a new combination of views allocates
+	for (const CachedFramebuffer& t_Cached : a_Pass.m_Framebuffers)
+	{
+		bool t_Matches = true;
+
+		for (size_t i = 0; i < a_Pass.m_Attachments.size() && t_Matches; i++)
+		{
+			t_Matches = t_Cached.m_Views[i] == m_Resources[a_Pass.m_Attachments[i]].m_ImageView;
+		}
+
+		if (t_Matches)
+		{
+			return t_Cached.m_Framebuffer;
+		}
+	}
+
+	CachedFramebuffer t_Cached = {};
+
+	for (const RenderGraphResource t_Attachment : a_Pass.m_Attachments)
+	{
+		t_Cached.m_Views.push_back(m_Resources[t_Attachment].m_ImageView);
+	}
+
+	const VkExtent2D t_Extent = m_Resources[a_Pass.m_Attachments[0]].m_Description.m_Extent;
+
+	VkFramebufferCreateInfo t_FramebufferCreateInfo = {};
+	t_FramebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+	t_FramebufferCreateInfo.renderPass = a_Pass.m_RenderPass;
+	t_FramebufferCreateInfo.attachmentCount = static_cast<uint32_t>(t_Cached.m_Views.size());
+	t_FramebufferCreateInfo.pAttachments = t_Cached.m_Views.data();
+	t_FramebufferCreateInfo.width = t_Extent.width;
+	t_FramebufferCreateInfo.height = t_Extent.height;
+	t_FramebufferCreateInfo.layers = 1;
+
+	if (vkCreateFramebuffer(m_LogicalDevice, &t_FramebufferCreateInfo, nullptr, &t_Cached.m_Framebuffer) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not create frame buffer for render graph pass " + a_Pass.m_Name + "!");
+	}
+
+	a_Pass.m_Framebuffers.push_back(t_Cached);
+	return t_Cached.m_Framebuffer;
+}
+
+void RenderGraph::DestroyCompiledObjects()
+{
+	for (Pass& t_Pass : m_Passes)
+	{
+		t_Pass.m_Active = false;
+		t_Pass.m_Barriers = {};
+		t_Pass.m_Attachments.clear();
+		t_Pass.m_ClearValues.clear();
+	}
+
+	for (Resource& t_Resource : m_Resources)
+	{
+		t_Resource.m_Barriers.clear();
+	}
+
+	m_ExecutionOrder.clear();
+	m_FinalBarriers = {};
+
+	if (m_LogicalDevice == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	for (Pass& t_Pass : m_Passes)
+	{
+		for (const CachedFramebuffer& t_Cached : t_Pass.m_Framebuffers)
+		{
+			vkDestroyFramebuffer(m_LogicalDevice, t_Cached.m_Framebuffer, nullptr);
+		}
+
+		t_Pass.m_Framebuffers.clear();
+
+		vkDestroyRenderPass(m_LogicalDevice, t_Pass.m_RenderPass, nullptr);
+		t_Pass.m_RenderPass = VK_NULL_HANDLE;
+	}
+
+	for (Resource& t_Resource : m_Resources)
+	{
+		if (t_Resource.m_Imported)
+		{
+			continue;
+		}
+
+		vkDestroyImageView(m_LogicalDevice, t_Resource.m_ImageView, nullptr);
+		vkDestroyImage(m_LogicalDevice, t_Resource.m_Image, nullptr);
+		t_Resource.m_ImageView = VK_NULL_HANDLE;
+		t_Resource.m_Image = VK_NULL_HANDLE;
+	}
+
+	for (const MemoryBlock& t_MemoryBlock : m_MemoryBlocks)
+	{
+		vkFreeMemory(m_LogicalDevice, t_MemoryBlock.m_Memory, nullptr);
+	}
+
+	m_MemoryBlocks.clear();
+}
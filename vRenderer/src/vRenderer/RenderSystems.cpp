@@ -0,0 +1,220 @@
+#include "pch.h"
+#include "vRenderer/RenderSystems.h"
+
+#include <atomic>
+
+#include "vRenderer/DrawQueue.h"
+#include "vRenderer/JobSystem.h"
+#include "vRenderer/OcclusionCuller.h"
+#include "vRenderer/SceneBvh.h"
+#include "vRenderer/SoftwareOcclusionCuller.h"
+#include "vRenderer/TransformStore.h"
+#include "vRenderer/helper_structs/GpuMesh.h"
+
+void SyncRenderableTransforms(EntityStore& a_Entities, const TransformStore& a_Transforms, uint64_t& a_SyncedSerial,
+                              SceneBvh& a_SceneBvh, JobSystem& a_JobSystem)
+{
+	if (a_SyncedSerial == a_Transforms.GetUpdateSerial())
+	{
+		return;
+	}
+
+	const uint64_t t_SyncedSerial = a_SyncedSerial;
+
+	a_Entities.ParallelForEachChunk<TransformComponent, WorldMatrixComponent, BoundsComponent>(a_JobSystem,
+		[&](const uint32_t a_Count, const Entity*, const TransformComponent* a_Transform,
+		    WorldMatrixComponent* a_WorldMatrix, BoundsComponent* a_Bounds)
+		{
+			for (uint32_t i = 0; i < a_Count; i++)
+			{
+				if (a_Transforms.GetChangedSerial(a_Transform[i].m_Transform) > t_SyncedSerial)
+				{
+					a_WorldMatrix[i].m_Matrix = a_Transforms.GetWorldMatrix(a_Transform[i].m_Transform);
+					a_Bounds[i].m_World = a_Bounds[i].m_Local.Transform(a_WorldMatrix[i].m_Matrix);
+				}
+			}
+		}, "Renderable transform sync");
+
+	// the hierarchy only records the moved objects, which is cheap enough to do on one thread
+	a_Entities.ForEachChunk<TransformComponent, BoundsComponent>(
+		[&](const uint32_t a_Count, const Entity*, const TransformComponent* a_Transform, const BoundsComponent* a_Bounds)
+		{
+			for (uint32_t i = 0; i < a_Count; i++)
+			{
+				if (a_Transforms.GetChangedSerial(a_Transform[i].m_Transform) > t_SyncedSerial)
+				{
+					a_SceneBvh.SetBounds(a_Transform[i].m_Transform, a_Bounds[i].m_World);
+				}
+			}
+		});
+
+	a_SyncedSerial = a_Transforms.GetUpdateSerial();
+}
+
+uint32_t CullRenderables(EntityStore& a_Entities, const SceneBvh& a_SceneBvh, const glm::mat4& a_ViewProjection,
+                         const SoftwareOcclusionCuller* a_OcclusionCuller, LinearArena& a_Arena,
+                         JobSystem& a_JobSystem)
+{
+	FrameVector<uint32_t> t_InFrustum{ArenaAllocator<uint32_t>(&a_Arena)};
+	a_SceneBvh.QueryFrustum(a_ViewProjection, t_InFrustum);
+
+	// one flag per object, so each entity looks up its own instead of searching the list
+	FrameVector<uint8_t> t_Flags(a_SceneBvh.GetObjectCount(), 0, ArenaAllocator<uint8_t>(&a_Arena));
+	for (const uint32_t t_Object : t_InFrustum)
+	{
+		t_Flags[t_Object] = 1;
+	}
+
+	std::atomic<uint32_t> t_VisibleCount{0};
+
+	a_Entities.ParallelForEachChunk<TransformComponent, WorldMatrixComponent, BoundsComponent, VisibilityComponent>(
+		a_JobSystem, [&](const uint32_t a_Count, const Entity*, const TransformComponent* a_Transform,
+		                 const WorldMatrixComponent* a_WorldMatrix, const BoundsComponent* a_Bounds,
+		                 VisibilityComponent* a_Visibility)
+		{
+			uint32_t t_ChunkVisibleCount = 0;
+
+			for (uint32_t i = 0; i < a_Count; i++)
+			{
+				// objects added since the last build are not in the hierarchy yet
+				const uint32_t t_Object = a_Transform[i].m_Transform;
+				bool t_Visible = t_Object < t_Flags.size() && t_Flags[t_Object] &&
+					!(a_Visibility[i].m_Flags & VisibilityComponent::s_Hidden);
+
+				if (t_Visible && a_OcclusionCuller)
+				{
+					t_Visible = a_OcclusionCuller->IsVisible(a_Bounds[i].m_Local.m_Min, a_Bounds[i].m_Local.m_Max,
+					                                         a_WorldMatrix[i].m_Matrix);
+				}
+
+				if (t_Visible)
+				{
+					a_Visibility[i].m_Flags |= VisibilityComponent::s_Visible;
+					t_ChunkVisibleCount++;
+				}
+				else
+				{
+					a_Visibility[i].m_Flags &= ~VisibilityComponent::s_Visible;
+				}
+			}
+
+			t_VisibleCount += t_ChunkVisibleCount;
+		}, "Renderable culling");
+
+	return t_VisibleCount;
+}
+
+void AddRenderableOccluders(EntityStore& a_Entities, SoftwareOcclusionCuller& a_OcclusionCuller)
+{
+	a_Entities.ForEachChunk<OccluderComponent, WorldMatrixComponent, VisibilityComponent>(
+		[&](const uint32_t a_Count, const Entity*, const OccluderComponent* a_Occluder,
+		    const WorldMatrixComponent* a_WorldMatrix, const VisibilityComponent* a_Visibility)
+		{
+			for (uint32_t i = 0; i < a_Count; i++)
+			{
+				if (!(a_Visibility[i].m_Flags & VisibilityComponent::s_Hidden))
+				{
+					a_OcclusionCuller.AddOccluder(*a_Occluder[i].m_Mesh, a_WorldMatrix[i].m_Matrix);
+				}
+			}
+		});
+}
+
+void AddRenderableDraws(EntityStore& a_Entities, const ResourcePool<GpuMesh>& a_Meshes, const DrawItem& a_Template,
+                        const glm::mat4& a_View, const float a_FarPlane, DrawQueue& a_DrawQueue)
+{
+	a_Entities.ForEachChunk<TransformComponent, MeshComponent, MaterialComponent, BoundsComponent,
+	                        VisibilityComponent>(
+		[&](const uint32_t a_Count, const Entity*, const TransformComponent* a_Transform, const MeshComponent* a_Mesh,
+		    const MaterialComponent* a_Material, const BoundsComponent* a_Bounds,
+		    const VisibilityComponent* a_Visibility)
+		{
+			for (uint32_t i = 0; i < a_Count; i++)
+			{
+				if (!(a_Visibility[i].m_Flags & VisibilityComponent::s_Visible))
+				{
+					continue;
+				}
+
+				// linear view depth of the bounds' center, normalized by the far plane
+				const glm::vec4 t_ViewPosition = a_View * glm::vec4(a_Bounds[i].m_World.GetCenter(), 1.0f);
+				const float t_Depth = -t_ViewPosition.z / a_FarPlane;
+
+				const GpuMesh& t_Mesh = a_Meshes.Get(a_Mesh[i].m_Mesh);
+
+				DrawItem t_DrawItem = a_Template;
+				t_DrawItem.m_VertexBuffers[0] = t_Mesh.m_VertexBuffer.GetBuffer();
+				t_DrawItem.m_IndexBuffer = t_Mesh.m_IndexBuffer.GetBuffer();
+				t_DrawItem.m_IndexCount = a_Mesh[i].m_IndexCount;
+				t_DrawItem.m_FirstIndex = a_Mesh[i].m_FirstIndex;
+				t_DrawItem.m_VertexOffset = a_Mesh[i].m_VertexOffset;
+				t_DrawItem.m_FirstInstance = a_Transform[i].m_Transform;
+				t_DrawItem.m_SortKey = DrawQueue::MakeOpaqueKey(0, 0, a_Material[i].m_Material,
+				                                                a_Mesh[i].m_Mesh.GetIndex(), t_Depth);
+
+				a_DrawQueue.Add(t_DrawItem);
+			}
+		});
+}
+
+void AddRenderableIndirectDraws(EntityStore& a_Entities, const ResourcePool<GpuMesh>& a_Meshes,
+                                const DrawItem& a_Template, const DrawItem& a_PrepassTemplate,
+                                const glm::mat4& a_View, const float a_FarPlane,
+                                FrameVector<InstanceBounds>& a_Instances, DrawQueue& a_DrawQueue,
+                                DrawQueue& a_PrepassQueue)
+{
+	a_Instances.clear();
+
+	a_Entities.ForEachChunk<TransformComponent, MeshComponent, MaterialComponent, BoundsComponent,
+	                        VisibilityComponent>(
+		[&](const uint32_t a_Count, const Entity*, const TransformComponent* a_Transform, const MeshComponent* a_Mesh,
+		    const MaterialComponent* a_Material, const BoundsComponent* a_Bounds,
+		    const VisibilityComponent* a_Visibility)
+		{
+			for (uint32_t i = 0; i < a_Count; i++)
+			{
+				if (!(a_Visibility[i].m_Flags & VisibilityComponent::s_Visible))
+				{
+					continue;
+				}
+
+				const uint32_t t_Slot = a_Transform[i].m_Transform;
+				if (t_Slot >= a_Instances.size())
+				{
+					a_Instances.resize(t_Slot + 1);
+				}
+
+				// the culling tests the sphere around the world bounds
+				const glm::vec3 t_Center = a_Bounds[i].m_World.GetCenter();
+				const float t_Radius = glm::length(a_Bounds[i].m_World.m_Max - t_Center);
+
+				InstanceBounds& t_Instance = a_Instances[t_Slot];
+				t_Instance.m_Sphere = glm::vec4(t_Center, t_Radius);
+				t_Instance.m_IndexCount = a_Mesh[i].m_IndexCount;
+				t_Instance.m_FirstIndex = a_Mesh[i].m_FirstIndex;
+				t_Instance.m_VertexOffset = a_Mesh[i].m_VertexOffset;
+				t_Instance.m_FirstInstance = t_Slot;
+
+				const glm::vec4 t_ViewPosition = a_View * glm::vec4(t_Center, 1.0f);
+				const float t_Depth = -t_ViewPosition.z / a_FarPlane;
+
+				const GpuMesh& t_Mesh = a_Meshes.Get(a_Mesh[i].m_Mesh);
+				const uint32_t t_MeshIndex = a_Mesh[i].m_Mesh.GetIndex();
+
+				DrawItem t_DrawItem = a_Template;
+				t_DrawItem.m_VertexBuffers[0] = t_Mesh.m_VertexBuffer.GetBuffer();
+				t_DrawItem.m_IndexBuffer = t_Mesh.m_IndexBuffer.GetBuffer();
+				t_DrawItem.m_IndirectOffset = t_Slot * OcclusionCuller::s_DrawCommandStride;
+				t_DrawItem.m_SortKey = DrawQueue::MakeOpaqueKey(0, 0, a_Material[i].m_Material, t_MeshIndex, t_Depth);
+				a_DrawQueue.Add(t_DrawItem);
+
+				// depth only, so the material does not matter
+				DrawItem t_PrepassItem = a_PrepassTemplate;
+				t_PrepassItem.m_VertexBuffers[0] = t_DrawItem.m_VertexBuffers[0];
+				t_PrepassItem.m_IndexBuffer = t_DrawItem.m_IndexBuffer;
+				t_PrepassItem.m_IndirectOffset = t_DrawItem.m_IndirectOffset;
+				t_PrepassItem.m_SortKey = DrawQueue::MakeOpaqueKey(0, 0, 0, t_MeshIndex, t_Depth);
+				a_PrepassQueue.Add(t_PrepassItem);
+			}
+		});
+}
@@ -0,0 +1,977 @@
+#include "pch.h"
+#include "vRenderer/SceneBvh.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <immintrin.h>
+
+#include "vRenderer/JobSystem.h"
+
+namespace
+{
+	constexpr uint32_t s_ChunkSize = 16384;
+
+	// large ranges are binned and partitioned in chunks of about s_ChunkSize objects
+	uint32_t GetChunkCount(const uint32_t a_Count, const uint32_t a_Threshold)
+	{
+		return a_Count < a_Threshold ? 1 : (a_Count + s_ChunkSize - 1) / s_ChunkSize;
+	}
+
+	uint32_t GetChunkBegin(const uint32_t a_Begin, const uint32_t a_End, const uint32_t a_Chunk, const uint32_t a_ChunkCount)
+	{
+		return a_Begin + static_cast<uint32_t>(static_cast<uint64_t>(a_End - a_Begin) * a_Chunk / a_ChunkCount);
+	}
+
+	// lanes of the used children of a node
+	__m128 GetChildMask(const uint32_t a_ChildCount)
+	{
+		return _mm_castsi128_ps(_mm_cmplt_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(static_cast<int>(a_ChildCount))));
+	}
+
+	struct RayLanes
+	{
+		__m128 m_OriginX;
+		__m128 m_OriginY;
+		__m128 m_OriginZ;
+		__m128 m_InverseX;
+		__m128 m_InverseY;
+		__m128 m_InverseZ;
+	};
+
+	RayLanes MakeRayLanes(const BvhRay& a_Ray)
+	{
+		// a zero direction component gives an infinite inverse, which the slab test handles
+		const glm::vec3 t_Inverse = 1.0f / a_Ray.m_Direction;
+
+		return {
+			_mm_set1_ps(a_Ray.m_Origin.x), _mm_set1_ps(a_Ray.m_Origin.y), _mm_set1_ps(a_Ray.m_Origin.z),
+			_mm_set1_ps(t_Inverse.x), _mm_set1_ps(t_Inverse.y), _mm_set1_ps(t_Inverse.z)
+		};
+	}
+}
+
+SceneBvh::SceneBvh()
+= default;
+
+SceneBvh::~SceneBvh()
+= default;
+
+uint32_t SceneBvh::Insert(const BoundingBox& a_Bounds)
+{
+	m_Bounds.push_back(a_Bounds);
+	m_ObjectSlots.push_back(0);
+	m_Moved.push_back(0);
+
+	return static_cast<uint32_t>(m_Bounds.size() - 1);
+}
+
+void SceneBvh::SetBounds(const uint32_t a_Object, const BoundingBox& a_Bounds)
+{
+	m_Bounds[a_Object] = a_Bounds;
+
+	// objects added after the last build are placed by the next one
+	if (a_Object < m_BuiltObjectCount && !m_Moved[a_Object])
+	{
+		m_Moved[a_Object] = 1;
+		m_MovedObjects.push_back(a_Object);
+	}
+}
+
+const BoundingBox& SceneBvh::GetBounds(const uint32_t a_Object) const
+{
+	return m_Bounds[a_Object];
+}
+
+void SceneBvh::Clear()
+{
+	m_Bounds.clear();
+	m_ObjectSlots.clear();
+	m_MovedObjects.clear();
+	m_Moved.clear();
+	m_NodeCount = 0;
+	m_BuiltObjectCount = 0;
+}
+
+uint32_t SceneBvh::GetObjectCount() const
+{
+	return static_cast<uint32_t>(m_Bounds.size());
+}
+
+uint32_t SceneBvh::GetNodeCount() const
+{
+	return m_NodeCount;
+}
+
+bool SceneBvh::NeedsBuild() const
+{
+	return m_BuiltObjectCount != GetObjectCount();
+}
+
+void SceneBvh::Build(JobSystem& a_JobSystem)
+{
+	const uint32_t t_Count = GetObjectCount();
+
+	for (const uint32_t t_Object : m_MovedObjects)
+	{
+		m_Moved[t_Object] = 0;
+	}
+	m_MovedObjects.clear();
+
+	m_BuiltObjectCount = t_Count;
+	m_NodeCount = 0;
+
+	if (t_Count == 0)
+	{
+		return;
+	}
+
+	// every node has four children unless it holds less than four objects, which bounds the count.
+	// The nodes are not initialized, so pages beyond the actual tree are never touched
+	const uint32_t t_MaxNodes = t_Count / 3 * 2 + 2;
+	if (m_NodeCapacity < t_MaxNodes)
+	{
+		m_Nodes.reset(new Node[t_MaxNodes]);
+		m_NodeCapacity = t_MaxNodes;
+	}
+
+	m_BuildReferences.resize(t_Count);
+	m_BuildScratch.resize(t_Count);
+
+	a_JobSystem.ParallelFor(t_Count, 4096, [this](const size_t a_Begin, const size_t a_End)
+	{
+		for (size_t i = a_Begin; i < a_End; i++)
+		{
+			m_BuildReferences[i] = {m_Bounds[i], static_cast<uint32_t>(i)};
+		}
+	}, "BVH setup");
+
+	const BuildRange t_Root = ComputeRange(0, t_Count, a_JobSystem);
+
+	m_NodeCount = 1;
+	m_Nodes[0].m_Parent = 0;
+
+	JobCounter t_Counter;
+	BuildNode(0, t_Root, 0, a_JobSystem, t_Counter);
+	a_JobSystem.Wait(t_Counter);
+}
+
+void SceneBvh::Refit()
+{
+	if (m_MovedObjects.empty())
+	{
+		return;
+	}
+
+	for (const uint32_t t_Object : m_MovedObjects)
+	{
+		SetSlot(m_ObjectSlots[t_Object] >> 2, m_ObjectSlots[t_Object] & 3, m_Bounds[t_Object]);
+	}
+
+	if (m_MovedObjects.size() * 8 > m_NodeCount)
+	{
+		// children have higher indices than their parents, so one backwards pass refits every node
+		for (uint32_t t_Node = m_NodeCount - 1; t_Node > 0; t_Node--)
+		{
+			const uint32_t t_Parent = m_Nodes[t_Node].m_Parent;
+			SetSlot(t_Parent >> 2, t_Parent & 3, GetNodeBounds(t_Node));
+		}
+	}
+	else
+	{
+		// walk up from each moved object until a box stays the same, the rest of the path is up to date
+		for (const uint32_t t_Object : m_MovedObjects)
+		{
+			uint32_t t_Node = m_ObjectSlots[t_Object] >> 2;
+
+			while (t_Node != 0)
+			{
+				const BoundingBox t_Bounds = GetNodeBounds(t_Node);
+				const uint32_t t_Parent = m_Nodes[t_Node].m_Parent;
+				const BoundingBox t_Previous = GetSlot(t_Parent >> 2, t_Parent & 3);
+
+				if (t_Bounds.m_Min == t_Previous.m_Min && t_Bounds.m_Max == t_Previous.m_Max)
+				{
+					break;
+				}
+
+				SetSlot(t_Parent >> 2, t_Parent & 3, t_Bounds);
+				t_Node = t_Parent >> 2;
+			}
+		}
+	}
+
+	for (const uint32_t t_Object : m_MovedObjects)
+	{
+		m_Moved[t_Object] = 0;
+	}
+	m_MovedObjects.clear();
+}
+
+void SceneBvh::QueryFrustum(const glm::mat4& a_ViewProjection, FrameVector<uint32_t>& a_Objects) const
+{
+	if (m_NodeCount == 0)
+	{
+		return;
+	}
+
+	// planes from the rows of the matrix, pointing inwards. The near plane is the one of the [-1, 1]
+	// depth range, for the [0, 1] range it lies slightly behind the actual one, which is conservative
+	glm::vec4 t_Rows[4];
+	for (int i = 0; i < 4; i++)
+	{
+		t_Rows[i] = glm::vec4(a_ViewProjection[0][i], a_ViewProjection[1][i], a_ViewProjection[2][i],
+		                      a_ViewProjection[3][i]);
+	}
+
+	const glm::vec4 t_Planes[6] = {
+		t_Rows[3] + t_Rows[0], t_Rows[3] - t_Rows[0], t_Rows[3] + t_Rows[1], t_Rows[3] - t_Rows[1],
+		t_Rows[3] + t_Rows[2], t_Rows[3] - t_Rows[2]
+	};
+
+	uint32_t t_Stack[s_MaxStackSize];
+	uint32_t t_StackSize = 0;
+	t_Stack[t_StackSize++] = 0;
+
+	while (t_StackSize > 0)
+	{
+		const Node& t_Node = m_Nodes[t_Stack[--t_StackSize]];
+
+		const __m128 t_MinX = _mm_load_ps(t_Node.m_MinX);
+		const __m128 t_MinY = _mm_load_ps(t_Node.m_MinY);
+		const __m128 t_MinZ = _mm_load_ps(t_Node.m_MinZ);
+		const __m128 t_MaxX = _mm_load_ps(t_Node.m_MaxX);
+		const __m128 t_MaxY = _mm_load_ps(t_Node.m_MaxY);
+		const __m128 t_MaxZ = _mm_load_ps(t_Node.m_MaxZ);
+
+		__m128 t_Outside = _mm_setzero_ps();
+		__m128 t_Crossing = _mm_setzero_ps();
+
+		for (const glm::vec4& t_Plane : t_Planes)
+		{
+			// the corner farthest along the normal decides whether a box is outside, the nearest
+			// whether it is completely inside
+			const __m128 t_FarX = t_Plane.x >= 0.0f ? t_MaxX : t_MinX;
+			const __m128 t_FarY = t_Plane.y >= 0.0f ? t_MaxY : t_MinY;
+			const __m128 t_FarZ = t_Plane.z >= 0.0f ? t_MaxZ : t_MinZ;
+			const __m128 t_NearX = t_Plane.x >= 0.0f ? t_MinX : t_MaxX;
+			const __m128 t_NearY = t_Plane.y >= 0.0f ? t_MinY : t_MaxY;
+			const __m128 t_NearZ = t_Plane.z >= 0.0f ? t_MinZ : t_MaxZ;
+
+			const __m128 t_A = _mm_set1_ps(t_Plane.x);
+			const __m128 t_B = _mm_set1_ps(t_Plane.y);
+			const __m128 t_C = _mm_set1_ps(t_Plane.z);
+			const __m128 t_D = _mm_set1_ps(t_Plane.w);
+
+			const __m128 t_FarDistance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(t_A, t_FarX), _mm_mul_ps(t_B, t_FarY)), _mm_add_ps(_mm_mul_ps(t_C, t_FarZ), t_D));
+			const __m128 t_NearDistance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(t_A, t_NearX), _mm_mul_ps(t_B, t_NearY)), _mm_add_ps(_mm_mul_ps(t_C, t_NearZ), t_D));
+
+			t_Outside = _mm_or_ps(t_Outside, _mm_cmplt_ps(t_FarDistance, _mm_setzero_ps()));
+			t_Crossing = _mm_or_ps(t_Crossing, _mm_cmplt_ps(t_NearDistance, _mm_setzero_ps()));
+		}
+
+		const int t_Used = _mm_movemask_ps(GetChildMask(t_Node.m_ChildCount));
+		const int t_Visible = ~_mm_movemask_ps(t_Outside) & t_Used;
+		const int t_Inside = ~_mm_movemask_ps(t_Crossing) & t_Used;
+
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			if (!(t_Visible & (1 << i)))
+			{
+				continue;
+			}
+
+			const uint32_t t_Child = t_Node.m_Children[i];
+
+			if (t_Child & s_LeafBit)
+			{
+				a_Objects.push_back(t_Child & ~s_LeafBit);
+			}
+			else if (t_Inside & (1 << i))
+			{
+				CollectObjects(t_Child, a_Objects);
+			}
+			else
+			{
+				t_Stack[t_StackSize++] = t_Child;
+			}
+		}
+	}
+}
+
+void SceneBvh::QuerySphere(const glm::vec3& a_Center, const float a_Radius, FrameVector<uint32_t>& a_Objects) const
+{
+	if (m_NodeCount == 0)
+	{
+		return;
+	}
+
+	const __m128 t_CenterX = _mm_set1_ps(a_Center.x);
+	const __m128 t_CenterY = _mm_set1_ps(a_Center.y);
+	const __m128 t_CenterZ = _mm_set1_ps(a_Center.z);
+	const __m128 t_RadiusSquared = _mm_set1_ps(a_Radius * a_Radius);
+
+	uint32_t t_Stack[s_MaxStackSize];
+	uint32_t t_StackSize = 0;
+	t_Stack[t_StackSize++] = 0;
+
+	while (t_StackSize > 0)
+	{
+		const Node& t_Node = m_Nodes[t_Stack[--t_StackSize]];
+
+		// distance from the center to the closest point of each box, 0 inside
+		const __m128 t_DX = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(t_Node.m_MinX), t_CenterX),
+		                                          _mm_sub_ps(t_CenterX, _mm_load_ps(t_Node.m_MaxX))), _mm_setzero_ps());
+		const __m128 t_DY = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(t_Node.m_MinY), t_CenterY),
+		                                          _mm_sub_ps(t_CenterY, _mm_load_ps(t_Node.m_MaxY))), _mm_setzero_ps());
+		const __m128 t_DZ = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(t_Node.m_MinZ), t_CenterZ),
+		                                          _mm_sub_ps(t_CenterZ, _mm_load_ps(t_Node.m_MaxZ))), _mm_setzero_ps());
+
+		const __m128 t_DistanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(t_DX, t_DX), _mm_mul_ps(t_DY, t_DY)),
+		                                            _mm_mul_ps(t_DZ, t_DZ));
+		const __m128 t_Hit = _mm_and_ps(_mm_cmple_ps(t_DistanceSquared, t_RadiusSquared), GetChildMask(t_Node.m_ChildCount));
+		const int t_HitMask = _mm_movemask_ps(t_Hit);
+
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			if (!(t_HitMask & (1 << i)))
+			{
+				continue;
+			}
+
+			const uint32_t t_Child = t_Node.m_Children[i];
+
+			if (t_Child & s_LeafBit)
+			{
+				a_Objects.push_back(t_Child & ~s_LeafBit);
+			}
+			else
+			{
+				t_Stack[t_StackSize++] = t_Child;
+			}
+		}
+	}
+}
+
+bool SceneBvh::Raycast(const BvhRay& a_Ray, BvhRayHit& a_Hit, const BvhRayIntersector& a_Intersect) const
+{
+	a_Hit = {};
+
+	if (m_NodeCount == 0)
+	{
+		return false;
+	}
+
+	const RayLanes t_Ray = MakeRayLanes(a_Ray);
+	float t_Closest = a_Ray.m_MaxDistance;
+
+	struct Entry
+	{
+		uint32_t m_Node;
+		float m_Distance;
+	};
+
+	Entry t_Stack[s_MaxStackSize];
+	uint32_t t_StackSize = 0;
+	t_Stack[t_StackSize++] = {0, 0.0f};
+
+	while (t_StackSize > 0)
+	{
+		const Entry t_Entry = t_Stack[--t_StackSize];
+
+		// a closer hit was found since the node was pushed
+		if (t_Entry.m_Distance > t_Closest)
+		{
+			continue;
+		}
+
+		const Node& t_Node = m_Nodes[t_Entry.m_Node];
+
+		// slab test of the four boxes
+		const __m128 t_X0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(t_Node.m_MinX), t_Ray.m_OriginX), t_Ray.m_InverseX);
+		const __m128 t_X1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(t_Node.m_MaxX), t_Ray.m_OriginX), t_Ray.m_InverseX);
+		const __m128 t_Y0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(t_Node.m_MinY), t_Ray.m_OriginY), t_Ray.m_InverseY);
+		const __m128 t_Y1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(t_Node.m_MaxY), t_Ray.m_OriginY), t_Ray.m_InverseY);
+		const __m128 t_Z0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(t_Node.m_MinZ), t_Ray.m_OriginZ), t_Ray.m_InverseZ);
+		const __m128 t_Z1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(t_Node.m_MaxZ), t_Ray.m_OriginZ), t_Ray.m_InverseZ);
+
+		const __m128 t_Enter = _mm_max_ps(_mm_max_ps(_mm_min_ps(t_X0, t_X1), _mm_min_ps(t_Y0, t_Y1)),
+		                                  _mm_max_ps(_mm_min_ps(t_Z0, t_Z1), _mm_setzero_ps()));
+		const __m128 t_Exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(t_X0, t_X1), _mm_max_ps(t_Y0, t_Y1)),
+		                                 _mm_min_ps(_mm_max_ps(t_Z0, t_Z1), _mm_set1_ps(t_Closest)));
+		const int t_HitMask = _mm_movemask_ps(_mm_and_ps(_mm_cmple_ps(t_Enter, t_Exit), GetChildMask(t_Node.m_ChildCount)));
+
+		alignas(16) float t_Distances[4];
+		_mm_store_ps(t_Distances, t_Enter);
+
+		Entry t_Children[4];
+		uint32_t t_ChildCount = 0;
+
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			if (!(t_HitMask & (1 << i)))
+			{
+				continue;
+			}
+
+			const uint32_t t_Child = t_Node.m_Children[i];
+
+			if (t_Child & s_LeafBit)
+			{
+				float t_Distance = t_Distances[i];
+
+				if (t_Distance <= t_Closest && (!a_Intersect || a_Intersect(0, t_Child & ~s_LeafBit, t_Distance))
+					&& t_Distance <= t_Closest)
+				{
+					t_Closest = t_Distance;
+					a_Hit = {t_Child & ~s_LeafBit, t_Distance};
+				}
+			}
+			else
+			{
+				t_Children[t_ChildCount++] = {t_Child, t_Distances[i]};
+			}
+		}
+
+		// farthest first, so the nearest child is visited next
+		std::sort(t_Children, t_Children + t_ChildCount, [](const Entry& a_A, const Entry& a_B)
+		{
+			return a_A.m_Distance > a_B.m_Distance;
+		});
+
+		for (uint32_t i = 0; i < t_ChildCount; i++)
+		{
+			t_Stack[t_StackSize++] = t_Children[i];
+		}
+	}
+
+	return a_Hit.m_Object != s_NoObject;
+}
+
+void SceneBvh::RaycastPacket(const BvhRay* a_Rays, const uint32_t a_RayCount, BvhRayHit* a_Hits,
+                             const BvhRayIntersector& a_Intersect) const
+{
+	if (a_RayCount > s_MaxPacketSize)
+	{
+		throw std::runtime_error("Error! Too many rays in a packet!");
+	}
+
+	RayLanes t_Rays[s_MaxPacketSize];
+	float t_Closest[s_MaxPacketSize];
+
+	for (uint32_t r = 0; r < a_RayCount; r++)
+	{
+		a_Hits[r] = {};
+		t_Rays[r] = MakeRayLanes(a_Rays[r]);
+		t_Closest[r] = a_Rays[r].m_MaxDistance;
+	}
+
+	if (m_NodeCount == 0 || a_RayCount == 0)
+	{
+		return;
+	}
+
+	// each node is visited with the rays that hit its box
+	struct Entry
+	{
+		uint32_t m_Node;
+		uint32_t m_Rays;
+	};
+
+	Entry t_Stack[s_MaxStackSize];
+	uint32_t t_StackSize = 0;
+	t_Stack[t_StackSize++] = {0, a_RayCount == 32 ? UINT32_MAX : (1u << a_RayCount) - 1};
+
+	while (t_StackSize > 0)
+	{
+		const Entry t_Entry = t_Stack[--t_StackSize];
+		const Node& t_Node = m_Nodes[t_Entry.m_Node];
+
+		const __m128 t_MinX = _mm_load_ps(t_Node.m_MinX);
+		const __m128 t_MinY = _mm_load_ps(t_Node.m_MinY);
+		const __m128 t_MinZ = _mm_load_ps(t_Node.m_MinZ);
+		const __m128 t_MaxX = _mm_load_ps(t_Node.m_MaxX);
+		const __m128 t_MaxY = _mm_load_ps(t_Node.m_MaxY);
+		const __m128 t_MaxZ = _mm_load_ps(t_Node.m_MaxZ);
+		const __m128 t_Used = GetChildMask(t_Node.m_ChildCount);
+
+		uint32_t t_ChildRays[4] = {0, 0, 0, 0};
+
+		for (uint32_t r = 0; r < a_RayCount; r++)
+		{
+			if (!(t_Entry.m_Rays & (1u << r)))
+			{
+				continue;
+			}
+
+			const RayLanes& t_Ray = t_Rays[r];
+
+			const __m128 t_X0 = _mm_mul_ps(_mm_sub_ps(t_MinX, t_Ray.m_OriginX), t_Ray.m_InverseX);
+			const __m128 t_X1 = _mm_mul_ps(_mm_sub_ps(t_MaxX, t_Ray.m_OriginX), t_Ray.m_InverseX);
+			const __m128 t_Y0 = _mm_mul_ps(_mm_sub_ps(t_MinY, t_Ray.m_OriginY), t_Ray.m_InverseY);
+			const __m128 t_Y1 = _mm_mul_ps(_mm_sub_ps(t_MaxY, t_Ray.m_OriginY), t_Ray.m_InverseY);
+			const __m128 t_Z0 = _mm_mul_ps(_mm_sub_ps(t_MinZ, t_Ray.m_OriginZ), t_Ray.m_InverseZ);
+			const __m128 t_Z1 = _mm_mul_ps(_mm_sub_ps(t_MaxZ, t_Ray.m_OriginZ), t_Ray.m_InverseZ);
+
+			const __m128 t_Enter = _mm_max_ps(_mm_max_ps(_mm_min_ps(t_X0, t_X1), _mm_min_ps(t_Y0, t_Y1)),
+			                                  _mm_max_ps(_mm_min_ps(t_Z0, t_Z1), _mm_setzero_ps()));
+			const __m128 t_Exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(t_X0, t_X1), _mm_max_ps(t_Y0, t_Y1)),
+			                                 _mm_min_ps(_mm_max_ps(t_Z0, t_Z1), _mm_set1_ps(t_Closest[r])));
+			const int t_HitMask = _mm_movemask_ps(_mm_and_ps(_mm_cmple_ps(t_Enter, t_Exit), t_Used));
+
+			if (t_HitMask == 0)
+			{
+				continue;
+			}
+
+			alignas(16) float t_Distances[4];
+			_mm_store_ps(t_Distances, t_Enter);
+
+			for (uint32_t i = 0; i < 4; i++)
+			{
+				if (!(t_HitMask & (1 << i)))
+				{
+					continue;
+				}
+
+				const uint32_t t_Child = t_Node.m_Children[i];
+
+				if (t_Child & s_LeafBit)
+				{
+					float t_Distance = t_Distances[i];
+
+					if (t_Distance <= t_Closest[r] && (!a_Intersect || a_Intersect(r, t_Child & ~s_LeafBit, t_Distance))
+						&& t_Distance <= t_Closest[r])
+					{
+						t_Closest[r] = t_Distance;
+						a_Hits[r] = {t_Child & ~s_LeafBit, t_Distance};
+					}
+				}
+				else
+				{
+					t_ChildRays[i] |= 1u << r;
+				}
+			}
+		}
+
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			if (t_ChildRays[i] != 0)
+			{
+				t_Stack[t_StackSize++] = {t_Node.m_Children[i], t_ChildRays[i]};
+			}
+		}
+	}
+}
+
+SceneBvh::BuildRange SceneBvh::ComputeRange(const uint32_t a_Begin, const uint32_t a_End, JobSystem& a_JobSystem) const
+{
+	BuildRange t_Range;
+	t_Range.m_Begin = a_Begin;
+	t_Range.m_End = a_End;
+
+	const uint32_t t_ChunkCount = GetChunkCount(a_End - a_Begin, s_ParallelThreshold);
+
+	if (t_ChunkCount == 1)
+	{
+		GrowRange(a_Begin, a_End, t_Range);
+		return t_Range;
+	}
+
+	std::vector<BuildRange> t_Chunks(t_ChunkCount);
+
+	a_JobSystem.ParallelFor(t_ChunkCount, 1, [&](const size_t a_FirstChunk, const size_t a_EndChunk)
+	{
+		for (size_t t_Chunk = a_FirstChunk; t_Chunk < a_EndChunk; t_Chunk++)
+		{
+			GrowRange(GetChunkBegin(a_Begin, a_End, static_cast<uint32_t>(t_Chunk), t_ChunkCount),
+			          GetChunkBegin(a_Begin, a_End, static_cast<uint32_t>(t_Chunk) + 1, t_ChunkCount), t_Chunks[t_Chunk]);
+		}
+	}, "BVH bounds");
+
+	for (const BuildRange& t_Chunk : t_Chunks)
+	{
+		t_Range.m_Bounds.Grow(t_Chunk.m_Bounds);
+		t_Range.m_CentroidBounds.Grow(t_Chunk.m_CentroidBounds);
+	}
+
+	return t_Range;
+}
+
+void SceneBvh::GrowRange(const uint32_t a_Begin, const uint32_t a_End, BuildRange& a_Range) const
+{
+	for (uint32_t i = a_Begin; i < a_End; i++)
+	{
+		a_Range.m_Bounds.Grow(m_BuildReferences[i].m_Bounds);
+		a_Range.m_CentroidBounds.Grow(m_BuildReferences[i].GetCentroid());
+	}
+}
+
+void SceneBvh::BinObjects(const uint32_t a_Begin, const uint32_t a_End, const BinMapping& a_Mapping, BinGrid& a_Bins) const
+{
+	for (uint32_t i = a_Begin; i < a_End; i++)
+	{
+		const BuildReference& t_Reference = m_BuildReferences[i];
+		const glm::vec3 t_Centroid = t_Reference.GetCentroid();
+
+		Bin& t_Bin = a_Bins.m_Bins[a_Mapping.GetBin(t_Centroid)];
+		t_Bin.m_Bounds.Grow(t_Reference.m_Bounds);
+		t_Bin.m_CentroidBounds.Grow(t_Centroid);
+		t_Bin.m_Count++;
+	}
+}
+
+void SceneBvh::BuildNode(const uint32_t a_Node, const BuildRange& a_Range, const uint32_t a_Depth,
+                         JobSystem& a_JobSystem, JobCounter& a_Counter)
+{
+	// split the range into up to four children, always splitting the largest one next. Up to four
+	// objects all become children of this node, so their order does not matter
+	BuildRange t_Ranges[4];
+	uint32_t t_RangeCount = 0;
+
+	if (a_Range.GetCount() <= 4)
+	{
+		for (uint32_t i = a_Range.m_Begin; i < a_Range.m_End; i++)
+		{
+			t_Ranges[t_RangeCount].m_Begin = i;
+			t_Ranges[t_RangeCount].m_End = i + 1;
+			t_Ranges[t_RangeCount++].m_Bounds = m_BuildReferences[i].m_Bounds;
+		}
+	}
+	else
+	{
+		t_Ranges[t_RangeCount++] = a_Range;
+	}
+
+	while (t_RangeCount < 4)
+	{
+		int t_Largest = -1;
+
+		for (uint32_t i = 0; i < t_RangeCount; i++)
+		{
+			if (t_Ranges[i].GetCount() > 1 && (t_Largest < 0 ||
+				t_Ranges[i].m_Bounds.GetHalfArea() > t_Ranges[t_Largest].m_Bounds.GetHalfArea()))
+			{
+				t_Largest = static_cast<int>(i);
+			}
+		}
+
+		if (t_Largest < 0)
+		{
+			break;
+		}
+
+		const BuildRange t_Range = t_Ranges[t_Largest];
+		SplitRange(t_Range, a_Depth, a_JobSystem, t_Ranges[t_Largest], t_Ranges[t_RangeCount++]);
+	}
+
+	Node& t_Node = m_Nodes[a_Node];
+	t_Node.m_ChildCount = t_RangeCount;
+
+	uint32_t t_ChildNodes[4];
+
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		if (i >= t_RangeCount)
+		{
+			SetSlot(a_Node, i, BoundingBox());
+			t_Node.m_Children[i] = s_EmptyChild;
+			continue;
+		}
+
+		SetSlot(a_Node, i, t_Ranges[i].m_Bounds);
+
+		if (t_Ranges[i].GetCount() == 1)
+		{
+			const uint32_t t_Object = m_BuildReferences[t_Ranges[i].m_Begin].m_Object;
+			t_Node.m_Children[i] = t_Object | s_LeafBit;
+			m_ObjectSlots[t_Object] = a_Node * 4 + i;
+		}
+		else
+		{
+			// allocated after the parent, so children always have higher indices
+			t_ChildNodes[i] = m_NodeCount.fetch_add(1);
+			t_Node.m_Children[i] = t_ChildNodes[i];
+			m_Nodes[t_ChildNodes[i]].m_Parent = a_Node * 4 + i;
+		}
+	}
+
+	for (uint32_t i = 0; i < t_RangeCount; i++)
+	{
+		if (t_Ranges[i].GetCount() == 1)
+		{
+			continue;
+		}
+
+		if (t_Ranges[i].GetCount() >= s_ParallelThreshold)
+		{
+			const uint32_t t_Child = t_ChildNodes[i];
+			const BuildRange t_Range = t_Ranges[i];
+
+			a_JobSystem.Run([this, t_Child, t_Range, a_Depth, &a_JobSystem, &a_Counter]
+			{
+				BuildNode(t_Child, t_Range, a_Depth + 1, a_JobSystem, a_Counter);
+			}, &a_Counter, "BVH build");
+		}
+		else
+		{
+			BuildNode(t_ChildNodes[i], t_Ranges[i], a_Depth + 1, a_JobSystem, a_Counter);
+		}
+	}
+}
+
+void SceneBvh::SplitRange(const BuildRange& a_Range, const uint32_t a_Depth, JobSystem& a_JobSystem,
+                          BuildRange& a_Left, BuildRange& a_Right)
+{
+	const glm::vec3 t_CentroidMin = a_Range.m_CentroidBounds.m_Min;
+	const glm::vec3 t_Extent = a_Range.m_CentroidBounds.m_Max - t_CentroidMin;
+
+	// binning only along the longest axis is a third of the work and rarely finds a worse split
+	BinMapping t_Mapping;
+	t_Mapping.m_Axis = t_Extent.x >= t_Extent.y && t_Extent.x >= t_Extent.z ? 0 : t_Extent.y >= t_Extent.z ? 1 : 2;
+
+	if (a_Depth >= s_MaxSahDepth || a_Range.GetCount() < s_MinBinnedCount || t_Extent[t_Mapping.m_Axis] <= 0.0f)
+	{
+		SplitMedian(a_Range, a_JobSystem, a_Left, a_Right);
+		return;
+	}
+
+	t_Mapping.m_Min = t_CentroidMin[t_Mapping.m_Axis];
+	t_Mapping.m_Scale = static_cast<float>(s_BinCount) / t_Extent[t_Mapping.m_Axis];
+
+	// large ranges are binned in chunks on multiple threads
+	const uint32_t t_ChunkCount = GetChunkCount(a_Range.GetCount(), s_ParallelThreshold);
+	std::vector<BinGrid> t_ChunkBins;
+	BinGrid t_Bins;
+
+	if (t_ChunkCount == 1)
+	{
+		BinObjects(a_Range.m_Begin, a_Range.m_End, t_Mapping, t_Bins);
+	}
+	else
+	{
+		t_ChunkBins.resize(t_ChunkCount);
+
+		a_JobSystem.ParallelFor(t_ChunkCount, 1, [&](const size_t a_FirstChunk, const size_t a_EndChunk)
+		{
+			for (size_t t_Chunk = a_FirstChunk; t_Chunk < a_EndChunk; t_Chunk++)
+			{
+				BinObjects(GetChunkBegin(a_Range.m_Begin, a_Range.m_End, static_cast<uint32_t>(t_Chunk), t_ChunkCount),
+				           GetChunkBegin(a_Range.m_Begin, a_Range.m_End, static_cast<uint32_t>(t_Chunk) + 1, t_ChunkCount),
+				           t_Mapping, t_ChunkBins[t_Chunk]);
+			}
+		}, "BVH binning");
+
+		for (const BinGrid& t_ChunkGrid : t_ChunkBins)
+		{
+			for (uint32_t b = 0; b < s_BinCount; b++)
+			{
+				t_Bins.m_Bins[b].m_Bounds.Grow(t_ChunkGrid.m_Bins[b].m_Bounds);
+				t_Bins.m_Bins[b].m_CentroidBounds.Grow(t_ChunkGrid.m_Bins[b].m_CentroidBounds);
+				t_Bins.m_Bins[b].m_Count += t_ChunkGrid.m_Bins[b].m_Count;
+			}
+		}
+	}
+
+	// the split between two bins with the lowest surface area heuristic cost
+	const Bin* t_AxisBins = t_Bins.m_Bins;
+	bool t_Found = false;
+	uint32_t t_BestBin = 0;
+	float t_BestCost = FLT_MAX;
+
+	// area and count of the bins right of each split
+	float t_RightAreas[s_BinCount];
+	uint32_t t_RightCounts[s_BinCount];
+	BoundingBox t_Right;
+	uint32_t t_RightCount = 0;
+
+	for (uint32_t b = s_BinCount - 1; b > 0; b--)
+	{
+		t_Right.Grow(t_AxisBins[b].m_Bounds);
+		t_RightCount += t_AxisBins[b].m_Count;
+		t_RightAreas[b] = t_Right.GetHalfArea();
+		t_RightCounts[b] = t_RightCount;
+	}
+
+	BoundingBox t_Left;
+	uint32_t t_LeftSweepCount = 0;
+
+	for (uint32_t b = 0; b < s_BinCount - 1; b++)
+	{
+		t_Left.Grow(t_AxisBins[b].m_Bounds);
+		t_LeftSweepCount += t_AxisBins[b].m_Count;
+
+		if (t_LeftSweepCount == 0 || t_RightCounts[b + 1] == 0)
+		{
+			continue;
+		}
+
+		const float t_Cost = static_cast<float>(t_LeftSweepCount) * t_Left.GetHalfArea() +
+			static_cast<float>(t_RightCounts[b + 1]) * t_RightAreas[b + 1];
+
+		if (t_Cost < t_BestCost)
+		{
+			t_BestCost = t_Cost;
+			t_BestBin = b;
+			t_Found = true;
+		}
+	}
+
+	if (!t_Found)
+	{
+		SplitMedian(a_Range, a_JobSystem, a_Left, a_Right);
+		return;
+	}
+
+	a_Left = {};
+	a_Right = {};
+	uint32_t t_LeftCount = 0;
+
+	for (uint32_t b = 0; b < s_BinCount; b++)
+	{
+		const Bin& t_Bin = t_Bins.m_Bins[b];
+		BuildRange& t_Side = b <= t_BestBin ? a_Left : a_Right;
+
+		t_Side.m_Bounds.Grow(t_Bin.m_Bounds);
+		t_Side.m_CentroidBounds.Grow(t_Bin.m_CentroidBounds);
+
+		if (b <= t_BestBin)
+		{
+			t_LeftCount += t_Bin.m_Count;
+		}
+	}
+
+	a_Left.m_Begin = a_Range.m_Begin;
+	a_Left.m_End = a_Range.m_Begin + t_LeftCount;
+	a_Right.m_Begin = a_Left.m_End;
+	a_Right.m_End = a_Range.m_End;
+
+	const auto t_IsLeft = [&](const BuildReference& a_Reference)
+	{
+		return t_Mapping.GetBin(a_Reference.GetCentroid()) <= t_BestBin;
+	};
+
+	if (t_ChunkCount == 1)
+	{
+		std::partition(m_BuildReferences.begin() + a_Range.m_Begin, m_BuildReferences.begin() + a_Range.m_End, t_IsLeft);
+		return;
+	}
+
+	// every chunk knows from its bins where its objects go, so they are scattered in parallel
+	std::vector<uint32_t> t_LeftOffsets(t_ChunkCount);
+	std::vector<uint32_t> t_RightOffsets(t_ChunkCount);
+	uint32_t t_LeftOffset = a_Left.m_Begin;
+	uint32_t t_RightOffset = a_Right.m_Begin;
+
+	for (uint32_t t_Chunk = 0; t_Chunk < t_ChunkCount; t_Chunk++)
+	{
+		t_LeftOffsets[t_Chunk] = t_LeftOffset;
+		t_RightOffsets[t_Chunk] = t_RightOffset;
+
+		for (uint32_t b = 0; b < s_BinCount; b++)
+		{
+			(b <= t_BestBin ? t_LeftOffset : t_RightOffset) += t_ChunkBins[t_Chunk].m_Bins[b].m_Count;
+		}
+	}
+
+	a_JobSystem.ParallelFor(t_ChunkCount, 1, [&](const size_t a_FirstChunk, const size_t a_EndChunk)
+	{
+		for (size_t t_Chunk = a_FirstChunk; t_Chunk < a_EndChunk; t_Chunk++)
+		{
+			uint32_t t_Left = t_LeftOffsets[t_Chunk];
+			uint32_t t_Right = t_RightOffsets[t_Chunk];
+			const uint32_t t_End = GetChunkBegin(a_Range.m_Begin, a_Range.m_End, static_cast<uint32_t>(t_Chunk) + 1, t_ChunkCount);
+
+			for (uint32_t i = GetChunkBegin(a_Range.m_Begin, a_Range.m_End, static_cast<uint32_t>(t_Chunk), t_ChunkCount);
+			     i < t_End; i++)
+			{
+				const BuildReference& t_Reference = m_BuildReferences[i];
+				m_BuildScratch[t_IsLeft(t_Reference) ? t_Left++ : t_Right++] = t_Reference;
+			}
+		}
+	}, "BVH partition");
+
+	a_JobSystem.ParallelFor(a_Range.GetCount(), s_ChunkSize, [&](const size_t a_Begin, const size_t a_End)
+	{
+		std::copy(m_BuildScratch.begin() + a_Range.m_Begin + a_Begin, m_BuildScratch.begin() + a_Range.m_Begin + a_End,
+		          m_BuildReferences.begin() + a_Range.m_Begin + a_Begin);
+	}, "BVH partition");
+}
+
+void SceneBvh::SplitMedian(const BuildRange& a_Range, JobSystem& a_JobSystem, BuildRange& a_Left, BuildRange& a_Right)
+{
+	const glm::vec3 t_Extent = a_Range.m_CentroidBounds.m_Max - a_Range.m_CentroidBounds.m_Min;
+	const int t_Axis = t_Extent.x >= t_Extent.y && t_Extent.x >= t_Extent.z ? 0 : t_Extent.y >= t_Extent.z ? 1 : 2;
+
+	const uint32_t t_Middle = a_Range.m_Begin + a_Range.GetCount() / 2;
+
+	std::nth_element(m_BuildReferences.begin() + a_Range.m_Begin, m_BuildReferences.begin() + t_Middle,
+	                 m_BuildReferences.begin() + a_Range.m_End, [t_Axis](const BuildReference& a_A, const BuildReference& a_B)
+	                 {
+		                 return a_A.GetCentroid()[t_Axis] < a_B.GetCentroid()[t_Axis];
+	                 });
+
+	a_Left = ComputeRange(a_Range.m_Begin, t_Middle, a_JobSystem);
+	a_Right = ComputeRange(t_Middle, a_Range.m_End, a_JobSystem);
+}
+
+void SceneBvh::SetSlot(const uint32_t a_Node, const uint32_t a_Slot, const BoundingBox& a_Bounds)
+{
+	Node& t_Node = m_Nodes[a_Node];
+
+	t_Node.m_MinX[a_Slot] = a_Bounds.m_Min.x;
+	t_Node.m_MinY[a_Slot] = a_Bounds.m_Min.y;
+	t_Node.m_MinZ[a_Slot] = a_Bounds.m_Min.z;
+	t_Node.m_MaxX[a_Slot] = a_Bounds.m_Max.x;
+	t_Node.m_MaxY[a_Slot] = a_Bounds.m_Max.y;
+	t_Node.m_MaxZ[a_Slot] = a_Bounds.m_Max.z;
+}
+
+BoundingBox SceneBvh::GetSlot(const uint32_t a_Node, const uint32_t a_Slot) const
+{
+	const Node& t_Node = m_Nodes[a_Node];
+
+	return {
+		{t_Node.m_MinX[a_Slot], t_Node.m_MinY[a_Slot], t_Node.m_MinZ[a_Slot]},
+		{t_Node.m_MaxX[a_Slot], t_Node.m_MaxY[a_Slot], t_Node.m_MaxZ[a_Slot]}
+	};
+}
+
+BoundingBox SceneBvh::GetNodeBounds(const uint32_t a_Node) const
+{
+	BoundingBox t_Bounds;
+
+	for (uint32_t i = 0; i < m_Nodes[a_Node].m_ChildCount; i++)
+	{
+		t_Bounds.Grow(GetSlot(a_Node, i));
+	}
+
+	return t_Bounds;
+}
+
+void SceneBvh::CollectObjects(const uint32_t a_Node, FrameVector<uint32_t>& a_Objects) const
+{
+	uint32_t t_Stack[s_MaxStackSize];
+	uint32_t t_StackSize = 0;
+	t_Stack[t_StackSize++] = a_Node;
+
+	while (t_StackSize > 0)
+	{
+		const Node& t_Node = m_Nodes[t_Stack[--t_StackSize]];
+
+		for (uint32_t i = 0; i < t_Node.m_ChildCount; i++)
+		{
+			const uint32_t t_Child = t_Node.m_Children[i];
+
+			if (t_Child & s_LeafBit)
+			{
+				a_Objects.push_back(t_Child & ~s_LeafBit);
+			}
+			else
+			{
+				t_Stack[t_StackSize++] = t_Child;
+			}
+		}
+	}
+}
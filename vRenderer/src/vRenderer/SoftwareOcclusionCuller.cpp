@@ -0,0 +1,586 @@
+#include "pch.h"
+#include "vRenderer/SoftwareOcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <immintrin.h>
+#include <glm/glm.hpp>
+
+#include "vRenderer/JobSystem.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC accepts AVX2 intrinsics in any function, they are only called if SupportsAVX2 returns true
+#define AVX2_FUNCTION
+#else
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+#endif
+
+SoftwareOcclusionCuller::SoftwareOcclusionCuller()
+= default;
+
+SoftwareOcclusionCuller::~SoftwareOcclusionCuller()
+= default;
+
+void SoftwareOcclusionCuller::Resize(const uint32_t a_Width, const uint32_t a_Height)
+{
+	m_TilesX = std::max(1u, (a_Width + s_TileWidth - 1) / s_TileWidth);
+	m_TilesY = std::max(1u, (a_Height + s_TileHeight - 1) / s_TileHeight);
+	m_Width = m_TilesX * s_TileWidth;
+	m_Height = m_TilesY * s_TileHeight;
+
+	m_Depth.assign(static_cast<size_t>(m_TilesX) * m_TilesY * s_TileSize, 1.0f);
+	m_TileMaxDepth.assign(static_cast<size_t>(m_TilesX) * m_TilesY, 1.0f);
+
+	m_UseAVX2 = SupportsAVX2();
+}
+
+void SoftwareOcclusionCuller::BeginFrame(const glm::mat4& a_ViewProjection)
+{
+	m_ViewProjection = a_ViewProjection;
+	m_Occluders.clear();
+
+	std::fill(m_Depth.begin(), m_Depth.end(), 1.0f);
+	std::fill(m_TileMaxDepth.begin(), m_TileMaxDepth.end(), 1.0f);
+}
+
+void SoftwareOcclusionCuller::AddOccluder(const Mesh& a_Mesh, const glm::mat4& a_Model)
+{
+	m_Occluders.push_back({&a_Mesh, m_ViewProjection * a_Model});
+}
+
+void SoftwareOcclusionCuller::RasterizeOccluders(JobSystem& a_JobSystem)
+{
+	size_t t_TriangleCount = 0;
+	for (const Occluder& t_Occluder : m_Occluders)
+	{
+		t_TriangleCount += t_Occluder.m_Mesh->m_Indices.size() / 3;
+	}
+
+	m_ActiveBinCount = 0;
+
+	if (t_TriangleCount == 0)
+	{
+		return;
+	}
+
+	const uint32_t t_TileCount = m_TilesX * m_TilesY;
+
+	// below this many triangles per chunk queuing a job costs more than it saves
+	constexpr size_t t_MinTrianglesPerChunk = 1024;
+	const size_t t_NumChunks = std::clamp<size_t>(t_TriangleCount / t_MinTrianglesPerChunk, 1,
+	                                              a_JobSystem.GetThreadCount());
+	const size_t t_ChunkSize = (t_TriangleCount + t_NumChunks - 1) / t_NumChunks;
+
+	if (m_Bins.size() < t_NumChunks)
+	{
+		m_Bins.resize(t_NumChunks);
+	}
+
+	m_ActiveBinCount = t_NumChunks;
+
+	// transform, set up and bin a slice of the triangles per job, each into its own bin
+	a_JobSystem.ParallelFor(t_NumChunks, 1, [&](const size_t a_Begin, const size_t a_End)
+	{
+		for (size_t t_Chunk = a_Begin; t_Chunk < a_End; t_Chunk++)
+		{
+			Bin& t_Bin = m_Bins[t_Chunk];
+			t_Bin.m_Triangles.clear();
+			t_Bin.m_TileTriangles.resize(t_TileCount);
+
+			for (std::vector<uint32_t>& t_TileTriangles : t_Bin.m_TileTriangles)
+			{
+				t_TileTriangles.clear();
+			}
+
+			SetupTriangles(t_Bin, t_Chunk * t_ChunkSize, std::min(t_TriangleCount, (t_Chunk + 1) * t_ChunkSize));
+		}
+	}, "Occluder setup");
+
+	// each tile is only written by the job it belongs to, stealing balances tiles with many triangles
+	a_JobSystem.ParallelFor(t_TileCount, 1, [&](const size_t a_Begin, const size_t a_End)
+	{
+		for (size_t t_Tile = a_Begin; t_Tile < a_End; t_Tile++)
+		{
+			RasterizeTile(static_cast<uint32_t>(t_Tile));
+		}
+	}, "Occluder rasterization");
+}
+
+bool SoftwareOcclusionCuller::IsVisible(const glm::vec3& a_BoundsMin, const glm::vec3& a_BoundsMax,
+                                        const glm::mat4& a_Model) const
+{
+	const glm::mat4 t_ModelViewProjection = m_ViewProjection * a_Model;
+
+	glm::vec2 t_Min = glm::vec2(std::numeric_limits<float>::max());
+	glm::vec2 t_Max = glm::vec2(std::numeric_limits<float>::lowest());
+	float t_NearestDepth = 1.0f;
+
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		const glm::vec3 t_Corner = {
+			(i & 1) != 0 ? a_BoundsMax.x : a_BoundsMin.x,
+			(i & 2) != 0 ? a_BoundsMax.y : a_BoundsMin.y,
+			(i & 4) != 0 ? a_BoundsMax.z : a_BoundsMin.z
+		};
+
+		const glm::vec4 t_Clip = t_ModelViewProjection * glm::vec4(t_Corner, 1.0f);
+
+		// the box reaches behind the camera, its projection is unbounded
+		if (t_Clip.w <= 0.0f)
+		{
+			return true;
+		}
+
+		const glm::vec2 t_Screen = {
+			(t_Clip.x / t_Clip.w * 0.5f + 0.5f) * static_cast<float>(m_Width),
+			(t_Clip.y / t_Clip.w * 0.5f + 0.5f) * static_cast<float>(m_Height)
+		};
+
+		t_Min = glm::min(t_Min, t_Screen);
+		t_Max = glm::max(t_Max, t_Screen);
+		t_NearestDepth = std::min(t_NearestDepth, t_Clip.z / t_Clip.w);
+	}
+
+	// crossing the near plane, the visible part may be arbitrarily close
+	if (t_NearestDepth < 0.0f)
+	{
+		return true;
+	}
+
+	if (t_Max.x < 0.0f || t_Max.y < 0.0f || t_Min.x >= static_cast<float>(m_Width) ||
+		t_Min.y >= static_cast<float>(m_Height))
+	{
+		return false;
+	}
+
+	// every pixel the box touches
+	const int32_t t_MinX = std::max(0, static_cast<int32_t>(std::floor(t_Min.x)));
+	const int32_t t_MinY = std::max(0, static_cast<int32_t>(std::floor(t_Min.y)));
+	const int32_t t_MaxX = std::min(static_cast<int32_t>(m_Width) - 1, static_cast<int32_t>(std::floor(t_Max.x)));
+	const int32_t t_MaxY = std::min(static_cast<int32_t>(m_Height) - 1, static_cast<int32_t>(std::floor(t_Max.y)));
+
+	for (uint32_t t_TileY = t_MinY / s_TileHeight; t_TileY <= t_MaxY / s_TileHeight; t_TileY++)
+	{
+		for (uint32_t t_TileX = t_MinX / s_TileWidth; t_TileX <= t_MaxX / s_TileWidth; t_TileX++)
+		{
+			const uint32_t t_Tile = t_TileY * m_TilesX + t_TileX;
+
+			// everything in this tile is closer than the box
+			if (t_NearestDepth > m_TileMaxDepth[t_Tile])
+			{
+				continue;
+			}
+
+			const float* t_Depth = &m_Depth[static_cast<size_t>(t_Tile) * s_TileSize];
+
+			const bool t_Visible = m_UseAVX2
+				                       ? IsRectVisibleAVX2(t_Depth, t_TileX, t_TileY, t_MinX, t_MinY, t_MaxX, t_MaxY,
+				                                           t_NearestDepth)
+				                       : IsRectVisibleScalar(t_Depth, t_TileX, t_TileY, t_MinX, t_MinY, t_MaxX, t_MaxY,
+				                                             t_NearestDepth);
+
+			if (t_Visible)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void SoftwareOcclusionCuller::WriteDepthImage(const std::string& a_FilePath) const
+{
+	std::ofstream t_File(a_FilePath, std::ios::binary);
+
+	if (!t_File.is_open())
+	{
+		throw std::runtime_error("Error! Could not open occlusion buffer image for writing!");
+	}
+
+	// the range of the covered pixels is stretched over the image's range
+	float t_MinDepth = 1.0f;
+	float t_MaxDepth = 0.0f;
+	for (const float t_Depth : m_Depth)
+	{
+		if (t_Depth < 1.0f)
+		{
+			t_MinDepth = std::min(t_MinDepth, t_Depth);
+			t_MaxDepth = std::max(t_MaxDepth, t_Depth);
+		}
+	}
+
+	const float t_Range = std::max(t_MaxDepth - t_MinDepth, 1e-6f);
+
+	std::vector<uint8_t> t_Pixels(static_cast<size_t>(m_Width) * m_Height, 0);
+
+	for (uint32_t t_Y = 0; t_Y < m_Height; t_Y++)
+	{
+		for (uint32_t t_X = 0; t_X < m_Width; t_X++)
+		{
+			const uint32_t t_Tile = (t_Y / s_TileHeight) * m_TilesX + t_X / s_TileWidth;
+			const float t_Depth = m_Depth[static_cast<size_t>(t_Tile) * s_TileSize +
+				(t_Y % s_TileHeight) * s_TileWidth + t_X % s_TileWidth];
+
+			if (t_Depth < 1.0f)
+			{
+				const float t_Closeness = 1.0f - (t_Depth - t_MinDepth) / t_Range;
+				t_Pixels[static_cast<size_t>(t_Y) * m_Width + t_X] = static_cast<uint8_t>(32.0f + 223.0f * t_Closeness);
+			}
+		}
+	}
+
+	t_File << "P5\n" << m_Width << " " << m_Height << "\n255\n";
+	t_File.write(reinterpret_cast<const char*>(t_Pixels.data()), static_cast<std::streamsize>(t_Pixels.size()));
+
+	if (!t_File)
+	{
+		throw std::runtime_error("Error! Could not write occlusion buffer image!");
+	}
+}
+
+bool SoftwareOcclusionCuller::SupportsAVX2()
+{
+#if defined(_MSC_VER)
+	int t_Info[4];
+	__cpuid(t_Info, 0);
+
+	if (t_Info[0] < 7)
+	{
+		return false;
+	}
+
+	// the operating system has to save the AVX registers on context switches
+	__cpuid(t_Info, 1);
+	const bool t_OSXSave = (t_Info[2] & (1 << 27)) != 0;
+	const bool t_AVX = (t_Info[2] & (1 << 28)) != 0;
+
+	if (!t_OSXSave || !t_AVX || (_xgetbv(0) & 0x6) != 0x6)
+	{
+		return false;
+	}
+
+	__cpuidex(t_Info, 7, 0);
+	return (t_Info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+uint32_t SoftwareOcclusionCuller::GetWidth() const
+{
+	return m_Width;
+}
+
+uint32_t SoftwareOcclusionCuller::GetHeight() const
+{
+	return m_Height;
+}
+
+void SoftwareOcclusionCuller::SetupTriangles(Bin& a_Bin, const size_t a_FirstTriangle, const size_t a_EndTriangle) const
+{
+	const float t_Width = static_cast<float>(m_Width);
+	const float t_Height = static_cast<float>(m_Height);
+
+	// triangles are numbered across all occluders
+	size_t t_Offset = 0;
+
+	for (const Occluder& t_Occluder : m_Occluders)
+	{
+		const Mesh& t_Mesh = *t_Occluder.m_Mesh;
+		const size_t t_Count = t_Mesh.m_Indices.size() / 3;
+		const size_t t_Begin = std::max(a_FirstTriangle, t_Offset);
+		const size_t t_End = std::min(a_EndTriangle, t_Offset + t_Count);
+
+		for (size_t t_Triangle = t_Begin; t_Triangle < t_End; t_Triangle++)
+		{
+			const size_t t_BaseIndex = (t_Triangle - t_Offset) * 3;
+
+			glm::vec3 t_Screen[3];
+			bool t_Clipped = false;
+
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				const glm::vec3& t_Position = t_Mesh.m_Vertices[t_Mesh.m_Indices[t_BaseIndex + i]].m_Position;
+				const glm::vec4 t_Clip = t_Occluder.m_ModelViewProjection * glm::vec4(t_Position, 1.0f);
+
+				// triangles are not clipped, dropping the ones reaching past the near plane only loses occlusion
+				if (t_Clip.w <= 0.0f || t_Clip.z < 0.0f)
+				{
+					t_Clipped = true;
+					break;
+				}
+
+				t_Screen[i] = {
+					(t_Clip.x / t_Clip.w * 0.5f + 0.5f) * t_Width,
+					(t_Clip.y / t_Clip.w * 0.5f + 0.5f) * t_Height,
+					t_Clip.z / t_Clip.w
+				};
+			}
+
+			if (t_Clipped)
+			{
+				continue;
+			}
+
+			// counter clockwise front faces have a negative area in y down screen space, drop back faces
+			// and swap the winding of front faces so the edge functions are positive inside
+			const float t_Area = (t_Screen[1].x - t_Screen[0].x) * (t_Screen[2].y - t_Screen[0].y) -
+				(t_Screen[2].x - t_Screen[0].x) * (t_Screen[1].y - t_Screen[0].y);
+
+			if (t_Area >= 0.0f)
+			{
+				continue;
+			}
+
+			std::swap(t_Screen[1], t_Screen[2]);
+
+			// pixels are covered if their center is inside the triangle
+			ScreenTriangle t_Setup = {};
+			t_Setup.m_MinX = std::max(0, static_cast<int32_t>(std::ceil(std::min({t_Screen[0].x, t_Screen[1].x, t_Screen[2].x}) - 0.5f)));
+			t_Setup.m_MinY = std::max(0, static_cast<int32_t>(std::ceil(std::min({t_Screen[0].y, t_Screen[1].y, t_Screen[2].y}) - 0.5f)));
+			t_Setup.m_MaxX = std::min(static_cast<int32_t>(m_Width) - 1,
+			                          static_cast<int32_t>(std::floor(std::max({t_Screen[0].x, t_Screen[1].x, t_Screen[2].x}) - 0.5f)));
+			t_Setup.m_MaxY = std::min(static_cast<int32_t>(m_Height) - 1,
+			                          static_cast<int32_t>(std::floor(std::max({t_Screen[0].y, t_Screen[1].y, t_Screen[2].y}) - 0.5f)));
+
+			if (t_Setup.m_MinX > t_Setup.m_MaxX || t_Setup.m_MinY > t_Setup.m_MaxY)
+			{
+				continue;
+			}
+
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				const glm::vec3& t_A = t_Screen[i];
+				const glm::vec3& t_B = t_Screen[(i + 1) % 3];
+
+				t_Setup.m_EdgeA[i] = t_A.y - t_B.y;
+				t_Setup.m_EdgeB[i] = t_B.x - t_A.x;
+				t_Setup.m_EdgeC[i] = -(t_Setup.m_EdgeA[i] * t_A.x + t_Setup.m_EdgeB[i] * t_A.y);
+			}
+
+			// the depth is interpolated linearly in screen space
+			const glm::vec3 t_Edge1 = t_Screen[1] - t_Screen[0];
+			const glm::vec3 t_Edge2 = t_Screen[2] - t_Screen[0];
+			const float t_InverseArea = 1.0f / -t_Area;
+
+			t_Setup.m_DzDx = (t_Edge1.z * t_Edge2.y - t_Edge2.z * t_Edge1.y) * t_InverseArea;
+			t_Setup.m_DzDy = (t_Edge2.z * t_Edge1.x - t_Edge1.z * t_Edge2.x) * t_InverseArea;
+			t_Setup.m_Z = t_Screen[0].z - t_Setup.m_DzDx * t_Screen[0].x - t_Setup.m_DzDy * t_Screen[0].y;
+
+			const uint32_t t_TriangleIndex = static_cast<uint32_t>(a_Bin.m_Triangles.size());
+			a_Bin.m_Triangles.push_back(t_Setup);
+
+			for (int32_t t_TileY = t_Setup.m_MinY / s_TileHeight; t_TileY <= t_Setup.m_MaxY / static_cast<int32_t>(s_TileHeight); t_TileY++)
+			{
+				for (int32_t t_TileX = t_Setup.m_MinX / s_TileWidth; t_TileX <= t_Setup.m_MaxX / static_cast<int32_t>(s_TileWidth); t_TileX++)
+				{
+					a_Bin.m_TileTriangles[t_TileY * m_TilesX + t_TileX].push_back(t_TriangleIndex);
+				}
+			}
+		}
+
+		t_Offset += t_Count;
+	}
+}
+
+void SoftwareOcclusionCuller::RasterizeTile(const uint32_t a_Tile)
+{
+	const uint32_t t_TileX = a_Tile % m_TilesX;
+	const uint32_t t_TileY = a_Tile / m_TilesX;
+	float* t_Depth = &m_Depth[static_cast<size_t>(a_Tile) * s_TileSize];
+
+	for (size_t i = 0; i < m_ActiveBinCount; i++)
+	{
+		const Bin& t_Bin = m_Bins[i];
+
+		for (const uint32_t t_Triangle : t_Bin.m_TileTriangles[a_Tile])
+		{
+			if (m_UseAVX2)
+			{
+				RasterizeTriangleAVX2(t_Bin.m_Triangles[t_Triangle], t_TileX, t_TileY, t_Depth);
+			}
+			else
+			{
+				RasterizeTriangleScalar(t_Bin.m_Triangles[t_Triangle], t_TileX, t_TileY, t_Depth);
+			}
+		}
+	}
+
+	// the farthest depth lets occludee tests skip tiles that are closer than the occludee
+	m_TileMaxDepth[a_Tile] = *std::max_element(t_Depth, t_Depth + s_TileSize);
+}
+
+void SoftwareOcclusionCuller::RasterizeTriangleScalar(const ScreenTriangle& a_Triangle, const uint32_t a_TileX,
+                                                      const uint32_t a_TileY, float* a_Depth) const
+{
+	const int32_t t_TileMinX = static_cast<int32_t>(a_TileX * s_TileWidth);
+	const int32_t t_TileMinY = static_cast<int32_t>(a_TileY * s_TileHeight);
+
+	const int32_t t_MinX = std::max(a_Triangle.m_MinX, t_TileMinX);
+	const int32_t t_MinY = std::max(a_Triangle.m_MinY, t_TileMinY);
+	const int32_t t_MaxX = std::min(a_Triangle.m_MaxX, t_TileMinX + static_cast<int32_t>(s_TileWidth) - 1);
+	const int32_t t_MaxY = std::min(a_Triangle.m_MaxY, t_TileMinY + static_cast<int32_t>(s_TileHeight) - 1);
+
+	for (int32_t t_Y = t_MinY; t_Y <= t_MaxY; t_Y++)
+	{
+		const float t_PixelY = static_cast<float>(t_Y) + 0.5f;
+		float* t_Row = a_Depth + (t_Y - t_TileMinY) * s_TileWidth - t_TileMinX;
+
+		for (int32_t t_X = t_MinX; t_X <= t_MaxX; t_X++)
+		{
+			const float t_PixelX = static_cast<float>(t_X) + 0.5f;
+
+			bool t_Inside = true;
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				t_Inside &= a_Triangle.m_EdgeA[i] * t_PixelX + a_Triangle.m_EdgeB[i] * t_PixelY + a_Triangle.m_EdgeC[i] >= 0.0f;
+			}
+
+			if (t_Inside)
+			{
+				const float t_Z = a_Triangle.m_Z + a_Triangle.m_DzDx * t_PixelX + a_Triangle.m_DzDy * t_PixelY;
+				t_Row[t_X] = std::min(t_Row[t_X], t_Z);
+			}
+		}
+	}
+}
+
+AVX2_FUNCTION void SoftwareOcclusionCuller::RasterizeTriangleAVX2(const ScreenTriangle& a_Triangle, const uint32_t a_TileX,
+                                                                  const uint32_t a_TileY, float* a_Depth) const
+{
+	const int32_t t_TileMinX = static_cast<int32_t>(a_TileX * s_TileWidth);
+	const int32_t t_TileMinY = static_cast<int32_t>(a_TileY * s_TileHeight);
+
+	const int32_t t_MinY = std::max(a_Triangle.m_MinY, t_TileMinY);
+	const int32_t t_MaxY = std::min(a_Triangle.m_MaxY, t_TileMinY + static_cast<int32_t>(s_TileHeight) - 1);
+
+	// the tile is processed in groups of 8 pixels, groups outside the bounding box are skipped
+	const int32_t t_FirstGroup = (std::max(a_Triangle.m_MinX, t_TileMinX) - t_TileMinX) / 8;
+	const int32_t t_LastGroup = (std::min(a_Triangle.m_MaxX, t_TileMinX + static_cast<int32_t>(s_TileWidth) - 1) - t_TileMinX) / 8;
+
+	const __m256 t_Zero = _mm256_setzero_ps();
+	const __m256 t_LaneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+
+	__m256 t_EdgeA[3];
+	__m256 t_EdgeB[3];
+	__m256 t_EdgeC[3];
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		t_EdgeA[i] = _mm256_set1_ps(a_Triangle.m_EdgeA[i]);
+		t_EdgeB[i] = _mm256_set1_ps(a_Triangle.m_EdgeB[i]);
+		t_EdgeC[i] = _mm256_set1_ps(a_Triangle.m_EdgeC[i]);
+	}
+
+	const __m256 t_DzDx = _mm256_set1_ps(a_Triangle.m_DzDx);
+	const __m256 t_DzDy = _mm256_set1_ps(a_Triangle.m_DzDy);
+	const __m256 t_Z = _mm256_set1_ps(a_Triangle.m_Z);
+
+	for (int32_t t_Y = t_MinY; t_Y <= t_MaxY; t_Y++)
+	{
+		const __m256 t_PixelY = _mm256_set1_ps(static_cast<float>(t_Y) + 0.5f);
+
+		// the parts of the edge functions and the depth that are constant along the row
+		__m256 t_RowEdge[3];
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			t_RowEdge[i] = _mm256_add_ps(_mm256_mul_ps(t_EdgeB[i], t_PixelY), t_EdgeC[i]);
+		}
+		const __m256 t_RowZ = _mm256_add_ps(_mm256_mul_ps(t_DzDy, t_PixelY), t_Z);
+
+		float* t_Row = a_Depth + (t_Y - t_TileMinY) * s_TileWidth;
+
+		for (int32_t t_Group = t_FirstGroup; t_Group <= t_LastGroup; t_Group++)
+		{
+			const __m256 t_PixelX = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(t_TileMinX + t_Group * 8)), t_LaneOffsets);
+
+			__m256 t_Inside = _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(t_EdgeA[0], t_PixelX), t_RowEdge[0]), t_Zero, _CMP_GE_OQ);
+			t_Inside = _mm256_and_ps(t_Inside, _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(t_EdgeA[1], t_PixelX), t_RowEdge[1]), t_Zero, _CMP_GE_OQ));
+			t_Inside = _mm256_and_ps(t_Inside, _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(t_EdgeA[2], t_PixelX), t_RowEdge[2]), t_Zero, _CMP_GE_OQ));
+
+			if (_mm256_movemask_ps(t_Inside) == 0)
+			{
+				continue;
+			}
+
+			const __m256 t_PixelZ = _mm256_add_ps(_mm256_mul_ps(t_DzDx, t_PixelX), t_RowZ);
+			const __m256 t_Current = _mm256_loadu_ps(t_Row + t_Group * 8);
+
+			_mm256_storeu_ps(t_Row + t_Group * 8, _mm256_blendv_ps(t_Current, _mm256_min_ps(t_Current, t_PixelZ), t_Inside));
+		}
+	}
+}
+
+bool SoftwareOcclusionCuller::IsRectVisibleScalar(const float* a_Depth, const uint32_t a_TileX, const uint32_t a_TileY,
+                                                  const int32_t a_MinX, const int32_t a_MinY, const int32_t a_MaxX,
+                                                  const int32_t a_MaxY, const float a_NearestDepth) const
+{
+	const int32_t t_TileMinX = static_cast<int32_t>(a_TileX * s_TileWidth);
+	const int32_t t_TileMinY = static_cast<int32_t>(a_TileY * s_TileHeight);
+
+	const int32_t t_MinX = std::max(a_MinX, t_TileMinX);
+	const int32_t t_MinY = std::max(a_MinY, t_TileMinY);
+	const int32_t t_MaxX = std::min(a_MaxX, t_TileMinX + static_cast<int32_t>(s_TileWidth) - 1);
+	const int32_t t_MaxY = std::min(a_MaxY, t_TileMinY + static_cast<int32_t>(s_TileHeight) - 1);
+
+	for (int32_t t_Y = t_MinY; t_Y <= t_MaxY; t_Y++)
+	{
+		const float* t_Row = a_Depth + (t_Y - t_TileMinY) * s_TileWidth - t_TileMinX;
+
+		for (int32_t t_X = t_MinX; t_X <= t_MaxX; t_X++)
+		{
+			// the occluder is not in front of the box's nearest point
+			if (t_Row[t_X] >= a_NearestDepth)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+AVX2_FUNCTION bool SoftwareOcclusionCuller::IsRectVisibleAVX2(const float* a_Depth, const uint32_t a_TileX,
+                                                              const uint32_t a_TileY, const int32_t a_MinX,
+                                                              const int32_t a_MinY, const int32_t a_MaxX,
+                                                              const int32_t a_MaxY, const float a_NearestDepth) const
+{
+	const int32_t t_TileMinX = static_cast<int32_t>(a_TileX * s_TileWidth);
+	const int32_t t_TileMinY = static_cast<int32_t>(a_TileY * s_TileHeight);
+
+	const int32_t t_MinY = std::max(a_MinY, t_TileMinY);
+	const int32_t t_MaxY = std::min(a_MaxY, t_TileMinY + static_cast<int32_t>(s_TileHeight) - 1);
+
+	const int32_t t_FirstGroup = (std::max(a_MinX, t_TileMinX) - t_TileMinX) / 8;
+	const int32_t t_LastGroup = (std::min(a_MaxX, t_TileMinX + static_cast<int32_t>(s_TileWidth) - 1) - t_TileMinX) / 8;
+
+	const __m256 t_NearestDepth = _mm256_set1_ps(a_NearestDepth);
+	const __m256 t_LaneOffsets = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+	const __m256 t_RectMinX = _mm256_set1_ps(static_cast<float>(a_MinX));
+	const __m256 t_RectMaxX = _mm256_set1_ps(static_cast<float>(a_MaxX));
+
+	for (int32_t t_Group = t_FirstGroup; t_Group <= t_LastGroup; t_Group++)
+	{
+		// lanes of the group that lie inside the rectangle
+		const __m256 t_PixelX = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(t_TileMinX + t_Group * 8)), t_LaneOffsets);
+		const __m256 t_InRect = _mm256_and_ps(_mm256_cmp_ps(t_PixelX, t_RectMinX, _CMP_GE_OQ),
+		                                      _mm256_cmp_ps(t_PixelX, t_RectMaxX, _CMP_LE_OQ));
+
+		for (int32_t t_Y = t_MinY; t_Y <= t_MaxY; t_Y++)
+		{
+			const __m256 t_Depth = _mm256_loadu_ps(a_Depth + (t_Y - t_TileMinY) * s_TileWidth + t_Group * 8);
+			const __m256 t_NotOccluded = _mm256_cmp_ps(t_Depth, t_NearestDepth, _CMP_GE_OQ);
+
+			if (_mm256_movemask_ps(_mm256_and_ps(t_InRect, t_NotOccluded)) != 0)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,166 @@
+#include "pch.h"
+#include "vRenderer/SpatialUpscaler.h"
+
+#include <cmath>
+#include <stdexcept>
+
+#include "vRenderer/DescriptorAllocator.h"
+#include "vRenderer/Device.h"
+
+SpatialUpscaler::SpatialUpscaler()
+= default;
+
+SpatialUpscaler::~SpatialUpscaler()
+= default;
+
+void SpatialUpscaler::Create(const Device& a_Device)
+{
+	const VkDevice t_LogicalDevice = a_Device.GetLogicalDevice();
+
+	// both passes read one image and write one storage image
+	std::vector<VkDescriptorSetLayoutBinding> t_Bindings(2);
+	t_Bindings[0].binding = 0;
+	t_Bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	t_Bindings[0].descriptorCount = 1;
+	t_Bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	t_Bindings[1].binding = 1;
+	t_Bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	t_Bindings[1].descriptorCount = 1;
+	t_Bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+	m_EasuPipeline.Create(t_LogicalDevice, "../vRenderer/assets/shaders/compiled/easu.spv", t_Bindings,
+	                      sizeof(EasuParameters));
+	m_RcasPipeline.Create(t_LogicalDevice, "../vRenderer/assets/shaders/compiled/rcas.spv", t_Bindings,
+	                      sizeof(RcasParameters));
+
+	// the shaders fetch individual texels, so no filtering is needed
+	VkSamplerCreateInfo t_SamplerCreateInfo = {};
+	t_SamplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	t_SamplerCreateInfo.magFilter = VK_FILTER_NEAREST;
+	t_SamplerCreateInfo.minFilter = VK_FILTER_NEAREST;
+	t_SamplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	t_SamplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	t_SamplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	t_SamplerCreateInfo.anisotropyEnable = VK_FALSE;
+	t_SamplerCreateInfo.maxAnisotropy = 1.0f;
+	t_SamplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+	t_SamplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+	t_SamplerCreateInfo.compareEnable = VK_FALSE;
+	t_SamplerCreateInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+	t_SamplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+
+	if (vkCreateSampler(t_LogicalDevice, &t_SamplerCreateInfo, nullptr, &m_Sampler) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Failed to create upscaler Sampler!");
+	}
+}
+
+void SpatialUpscaler::Destroy(const VkDevice& a_LogicalDevice)
+{
+	DestroyTargets(a_LogicalDevice);
+
+	vkDestroySampler(a_LogicalDevice, m_Sampler, nullptr);
+	m_EasuPipeline.Destroy(a_LogicalDevice);
+	m_RcasPipeline.Destroy(a_LogicalDevice);
+}
+
+void SpatialUpscaler::CreateTargets(const Device& a_Device, const Image& a_Input, const VkExtent2D a_OutputExtent)
+{
+	m_OutputExtent = a_OutputExtent;
+
+	m_Upscaled.CreateImage(a_Device, a_OutputExtent.width, a_OutputExtent.height, 1, VK_SAMPLE_COUNT_1_BIT, s_Format,
+	                       VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+	                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+
+	m_Output.CreateImage(a_Device, a_OutputExtent.width, a_OutputExtent.height, 1, VK_SAMPLE_COUNT_1_BIT, s_Format,
+	                     VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+	                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+
+	m_InputView = a_Input.GetImageView();
+}
+
+void SpatialUpscaler::DestroyTargets(const VkDevice& a_LogicalDevice)
+{
+	m_Upscaled.DestroyImage(a_LogicalDevice);
+	m_Output.DestroyImage(a_LogicalDevice);
+}
+
+void SpatialUpscaler::Upscale(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator,
+                              VkCommandBuffer a_CommandBuffer, const VkExtent2D a_InputExtent) const
+{
+	EasuParameters t_EasuParameters = {};
+	t_EasuParameters.m_InputExtent = {static_cast<float>(a_InputExtent.width), static_cast<float>(a_InputExtent.height)};
+	t_EasuParameters.m_OutputExtent = {static_cast<float>(m_OutputExtent.width), static_cast<float>(m_OutputExtent.height)};
+
+	const VkDescriptorSet t_EasuDescriptorSet = a_DescriptorAllocator.AllocateTransient(
+		a_LogicalDevice, m_EasuPipeline.GetDescriptorSetLayout(), {
+			DescriptorBinding::Image(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_InputView, m_Sampler,
+			                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			DescriptorBinding::Image(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, m_Upscaled.GetImageView(), VK_NULL_HANDLE,
+			                         VK_IMAGE_LAYOUT_GENERAL)
+		});
+
+	m_EasuPipeline.Bind(a_CommandBuffer, t_EasuDescriptorSet);
+	m_EasuPipeline.PushConstants(a_CommandBuffer, &t_EasuParameters, sizeof(t_EasuParameters));
+	ComputePipeline::Dispatch2D(a_CommandBuffer, m_OutputExtent.width, m_OutputExtent.height);
+}
+
+void SpatialUpscaler::Sharpen(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator,
+                              VkCommandBuffer a_CommandBuffer, const float a_Sharpness) const
+{
+	// the strength is given in stops
+	RcasParameters t_RcasParameters = {};
+	t_RcasParameters.m_OutputExtent = {static_cast<float>(m_OutputExtent.width), static_cast<float>(m_OutputExtent.height)};
+	t_RcasParameters.m_Sharpness = std::exp2(-a_Sharpness);
+
+	const VkDescriptorSet t_RcasDescriptorSet = a_DescriptorAllocator.AllocateTransient(
+		a_LogicalDevice, m_RcasPipeline.GetDescriptorSetLayout(), {
+			DescriptorBinding::Image(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_Upscaled.GetImageView(), m_Sampler,
+			                         VK_IMAGE_LAYOUT_GENERAL),
+			DescriptorBinding::Image(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, m_Output.GetImageView(), VK_NULL_HANDLE,
+			                         VK_IMAGE_LAYOUT_GENERAL)
+		});
+
+	m_RcasPipeline.Bind(a_CommandBuffer, t_RcasDescriptorSet);
+	m_RcasPipeline.PushConstants(a_CommandBuffer, &t_RcasParameters, sizeof(t_RcasParameters));
+	ComputePipeline::Dispatch2D(a_CommandBuffer, m_OutputExtent.width, m_OutputExtent.height);
+}
+
+void SpatialUpscaler::CopyToSwapChain(VkCommandBuffer a_CommandBuffer, VkImage a_SwapChainImage) const
+{
+	// converts to the format of the swap chain
+	VkImageBlit t_Blit = {};
+	t_Blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+	t_Blit.srcOffsets[1] = {static_cast<int32_t>(m_OutputExtent.width), static_cast<int32_t>(m_OutputExtent.height), 1};
+	t_Blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+	t_Blit.dstOffsets[1] = t_Blit.srcOffsets[1];
+
+	vkCmdBlitImage(a_CommandBuffer, m_Output.GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+	               a_SwapChainImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &t_Blit, VK_FILTER_NEAREST);
+}
+
+const Image& SpatialUpscaler::GetUpscaled() const
+{
+	return m_Upscaled;
+}
+
+const Image& SpatialUpscaler::GetOutput() const
+{
+	return m_Output;
+}
+
+float SpatialUpscaler::GetRenderScale(const UpscalingPreset a_Preset)
+{
+	switch (a_Preset)
+	{
+	case UpscalingPreset::UltraQuality:
+		return 1.0f / 1.3f;
+	case UpscalingPreset::Quality:
+		return 1.0f / 1.5f;
+	case UpscalingPreset::Performance:
+		return 1.0f / 2.0f;
+	case UpscalingPreset::Native:
+	default:
+		return 1.0f;
+	}
+}
@@ -45,7 +45,21 @@ void SwapChain::Create(const Device& a_Device, const VkSurfaceKHR& a_WindowSurfa
 	t_SwapChainCreateInfo.imageColorSpace = t_SurfaceFormat.colorSpace;
 	t_SwapChainCreateInfo.imageExtent = t_Extent;
 	t_SwapChainCreateInfo.imageArrayLayers = 1;
-	t_SwapChainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+	// the TAA resolve, the upscaler and the final blit copy into the swap chain images, devices whose
+	// surface does not allow it are not picked
+	t_SwapChainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+	if (!(t_SwapChainInfo.m_SurfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT))
+	{
+		throw std::runtime_error("Error! The surface does not allow copying into Swap Chain images!");
+	}
+
+	// allow copying out of swap chain images for frame capture if the surface supports it
+	if (t_SwapChainInfo.m_SurfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+	{
+		t_SwapChainCreateInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	}
 
 	// define how the swap chain is supposed to handle images shared between multiple queues
 	SupportedQueueFamilies t_SupportedQueueFamilies = CheckSupportedQueueFamilies(a_Device.GetPhysicalDevice(), a_WindowSurface);
@@ -97,11 +111,50 @@ void SwapChain::Create(const Device& a_Device, const VkSurfaceKHR& a_WindowSurfa
 	// store swap chain format and extent
 	m_Format = t_SurfaceFormat.format;
 	m_Extent = t_Extent;
+	m_Usage = t_SwapChainCreateInfo.imageUsage;
+}
+
+void SwapChain::CreateHeadless(const Device& a_Device, const VkExtent2D a_Extent, const uint32_t a_ImageCount,
+                               const VkFormat a_Format)
+{
+	m_HeadlessImages.resize(a_ImageCount);
+	m_Images.resize(a_ImageCount);
+	m_ImageViews.resize(a_ImageCount);
+	m_Usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+	// rendered to like swap chain images, copied into them and read back from
+	for (uint32_t i = 0; i < a_ImageCount; i++)
+	{
+		m_HeadlessImages[i].CreateImage(a_Device, a_Extent.width, a_Extent.height, 1, VK_SAMPLE_COUNT_1_BIT, a_Format,
+		                                VK_IMAGE_TILING_OPTIMAL, m_Usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		                                VK_IMAGE_ASPECT_COLOR_BIT);
+
+		m_Images[i] = m_HeadlessImages[i].GetImage();
+		m_ImageViews[i] = m_HeadlessImages[i].GetImageView();
+	}
+
+	m_Format = a_Format;
+	m_Extent = a_Extent;
 }
 
 void SwapChain::Cleanup(VkDevice a_LogicalDevice, std::vector<VkFramebuffer>& a_FramebufferVector)
 {
 	DestroyFrameBuffers(a_FramebufferVector, a_LogicalDevice);
+
+	if (IsHeadless())
+	{
+		// the views are destroyed with the images
+		for (Image& t_Image : m_HeadlessImages)
+		{
+			t_Image.DestroyImage(a_LogicalDevice);
+		}
+
+		m_HeadlessImages.clear();
+		m_Images.clear();
+		m_ImageViews.clear();
+		return;
+	}
+
 	DestroyImageViews(a_LogicalDevice);
 	vkDestroySwapchainKHR(a_LogicalDevice, m_SwapChain, nullptr);
 }
@@ -177,6 +230,11 @@ void SwapChain::DestroyImageViews(VkDevice a_LogicalDevice)
 #endif
 }
 
+const std::vector<VkImage>& SwapChain::GetImages() const
+{
+	return m_Images;
+}
+
 std::vector<VkImageView>& SwapChain::GetImageViews()
 {
 	return m_ImageViews;
@@ -224,6 +282,16 @@ VkFormat SwapChain::GetFormat()
 	return m_Format;
 }
 
+VkImageUsageFlags SwapChain::GetUsage() const
+{
+	return m_Usage;
+}
+
+bool SwapChain::IsHeadless() const
+{
+	return !m_HeadlessImages.empty();
+}
+
 /// <summary>	Picks the swap chain surface format described by a_AvailableFormats. </summary>
 /// <param name="a_AvailableFormats">	The available formats.</param>
 /// <returns>
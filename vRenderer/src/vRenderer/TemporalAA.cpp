@@ -0,0 +1,188 @@
+#include "pch.h"
+#include "vRenderer/TemporalAA.h"
+
+#include <stdexcept>
+
+#include "vRenderer/DescriptorAllocator.h"
+#include "vRenderer/Device.h"
+#include "vRenderer/helpers/helpers.h"
+
+TemporalAA::TemporalAA()
+= default;
+
+TemporalAA::~TemporalAA()
+= default;
+
+void TemporalAA::Create(const Device& a_Device)
+{
+	const VkDevice t_LogicalDevice = a_Device.GetLogicalDevice();
+
+	// binding 0: current frame, 1: velocity, 2: previous history, 3: history written this frame
+	std::vector<VkDescriptorSetLayoutBinding> t_Bindings(4);
+	for (uint32_t i = 0; i < t_Bindings.size(); i++)
+	{
+		t_Bindings[i].binding = i;
+		t_Bindings[i].descriptorType = i < 3 ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		t_Bindings[i].descriptorCount = 1;
+		t_Bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		t_Bindings[i].pImmutableSamplers = nullptr;
+	}
+
+	m_ResolvePipeline.Create(t_LogicalDevice, "../vRenderer/assets/shaders/compiled/taa_resolve.spv", t_Bindings,
+	                         sizeof(ResolveParameters));
+
+	// bilinear sampler used to fetch the reprojected history
+	VkSamplerCreateInfo t_SamplerCreateInfo = {};
+	t_SamplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	t_SamplerCreateInfo.magFilter = VK_FILTER_LINEAR;
+	t_SamplerCreateInfo.minFilter = VK_FILTER_LINEAR;
+	t_SamplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	t_SamplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	t_SamplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	t_SamplerCreateInfo.anisotropyEnable = VK_FALSE;
+	t_SamplerCreateInfo.maxAnisotropy = 1.0f;
+	t_SamplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+	t_SamplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+	t_SamplerCreateInfo.compareEnable = VK_FALSE;
+	t_SamplerCreateInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+	t_SamplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	t_SamplerCreateInfo.minLod = 0.0f;
+	t_SamplerCreateInfo.maxLod = 0.0f;
+
+	if (vkCreateSampler(t_LogicalDevice, &t_SamplerCreateInfo, nullptr, &m_Sampler) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Failed to create TAA Sampler!");
+	}
+}
+
+void TemporalAA::Destroy(const VkDevice& a_LogicalDevice)
+{
+	DestroyTargets(a_LogicalDevice);
+
+	vkDestroySampler(a_LogicalDevice, m_Sampler, nullptr);
+	m_ResolvePipeline.Destroy(a_LogicalDevice);
+}
+
+void TemporalAA::CreateTargets(const Device& a_Device, const VkExtent2D a_Extent)
+{
+	m_Extent = a_Extent;
+
+	m_SceneColor.CreateImage(a_Device, a_Extent.width, a_Extent.height, 1, VK_SAMPLE_COUNT_1_BIT, s_ColorFormat,
+	                         VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+	                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+
+	m_Velocity.CreateImage(a_Device, a_Extent.width, a_Extent.height, 1, VK_SAMPLE_COUNT_1_BIT, s_VelocityFormat,
+	                       VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+	                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+
+	for (Image& t_History : m_History)
+	{
+		t_History.CreateImage(a_Device, a_Extent.width, a_Extent.height, 1, VK_SAMPLE_COUNT_1_BIT, s_ColorFormat,
+		                      VK_IMAGE_TILING_OPTIMAL,
+		                      VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+		                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+	}
+
+	ResetHistory();
+}
+
+void TemporalAA::DestroyTargets(const VkDevice& a_LogicalDevice)
+{
+	m_SceneColor.DestroyImage(a_LogicalDevice);
+	m_Velocity.DestroyImage(a_LogicalDevice);
+
+	for (Image& t_History : m_History)
+	{
+		t_History.DestroyImage(a_LogicalDevice);
+	}
+}
+
+glm::vec2 TemporalAA::GetJitter() const
+{
+	// Halton(2, 3) gives a well distributed set of sub-pixel offsets
+	const uint32_t t_Index = m_FrameIndex % m_JitterSequenceLength + 1;
+
+	// convert from [0, 1) pixel offsets to [-1, 1) pixels in normalized device coordinates
+	const float t_JitterX = (Halton(t_Index, 2) - 0.5f) * 2.0f / static_cast<float>(m_Extent.width);
+	const float t_JitterY = (Halton(t_Index, 3) - 0.5f) * 2.0f / static_cast<float>(m_Extent.height);
+
+	return {t_JitterX, t_JitterY};
+}
+
+void TemporalAA::Resolve(const VkDevice& a_LogicalDevice, DescriptorAllocator& a_DescriptorAllocator,
+                         VkCommandBuffer a_CommandBuffer) const
+{
+	const uint32_t t_Current = m_FrameIndex % 2;
+	const uint32_t t_Previous = 1 - t_Current;
+
+	ResolveParameters t_Parameters = {};
+	t_Parameters.m_TexelSize = {1.0f / static_cast<float>(m_Extent.width), 1.0f / static_cast<float>(m_Extent.height)};
+	t_Parameters.m_BlendFactor = m_BlendFactor;
+	t_Parameters.m_ResetHistory = m_HistoryValid ? 0.0f : 1.0f;
+
+	// reads the previous history and writes the current one, which swap every frame
+	const VkDescriptorSet t_DescriptorSet = a_DescriptorAllocator.AllocateTransient(
+		a_LogicalDevice, m_ResolvePipeline.GetDescriptorSetLayout(), {
+			DescriptorBinding::Image(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_SceneColor.GetImageView(), m_Sampler,
+			                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			DescriptorBinding::Image(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_Velocity.GetImageView(), m_Sampler,
+			                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			DescriptorBinding::Image(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_History[t_Previous].GetImageView(),
+			                         m_Sampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			DescriptorBinding::Image(3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, m_History[t_Current].GetImageView(),
+			                         VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL)
+		});
+
+	m_ResolvePipeline.Bind(a_CommandBuffer, t_DescriptorSet);
+	m_ResolvePipeline.PushConstants(a_CommandBuffer, &t_Parameters, sizeof(t_Parameters));
+	ComputePipeline::Dispatch2D(a_CommandBuffer, m_Extent.width, m_Extent.height);
+}
+
+void TemporalAA::CopyToSwapChain(VkCommandBuffer a_CommandBuffer, VkImage a_SwapChainImage,
+                                 const VkExtent2D a_SwapChainExtent) const
+{
+	VkImageBlit t_Blit = {};
+	t_Blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+	t_Blit.srcOffsets[1] = {static_cast<int32_t>(m_Extent.width), static_cast<int32_t>(m_Extent.height), 1};
+	t_Blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+	t_Blit.dstOffsets[1] = {static_cast<int32_t>(a_SwapChainExtent.width), static_cast<int32_t>(a_SwapChainExtent.height), 1};
+
+	vkCmdBlitImage(a_CommandBuffer, GetHistory().GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+	               a_SwapChainImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &t_Blit, VK_FILTER_LINEAR);
+}
+
+void TemporalAA::AdvanceFrame()
+{
+	m_HistoryValid = true;
+	m_FrameIndex++;
+}
+
+void TemporalAA::ResetHistory()
+{
+	m_HistoryValid = false;
+}
+
+const Image& TemporalAA::GetSceneColor() const
+{
+	return m_SceneColor;
+}
+
+const Image& TemporalAA::GetVelocity() const
+{
+	return m_Velocity;
+}
+
+const Image& TemporalAA::GetHistory() const
+{
+	return m_History[m_FrameIndex % 2];
+}
+
+const Image& TemporalAA::GetPreviousHistory() const
+{
+	return m_History[1 - m_FrameIndex % 2];
+}
+
+bool TemporalAA::IsHistoryValid() const
+{
+	return m_HistoryValid;
+}
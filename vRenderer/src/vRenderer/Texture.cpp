@@ -8,6 +8,11 @@
 #include "stb_image/stb_image.h"
 #include <cmath>
 
+void DecodedImage::PixelDeleter::operator()(uint8_t* a_Pixels) const
+{
+	stbi_image_free(a_Pixels);
+}
+
 Texture::Texture()
 = default;
 
@@ -22,21 +27,35 @@ void Texture::DestroyTexture(VkDevice a_LogicalDevice)
 
 void Texture::CreateTextureFromImage(const char* a_FilePath, const Device& a_Device,VkCommandPool& a_CommandPool, const VkQueue& a_GraphicsQueue)
 {
-	// load image
-	int t_TextureWidth = 0;
-	int t_TextureHeight = 0;
-	int t_TextureChannels = 0;
+	CreateTextureFromDecodedImage(DecodeImage(a_FilePath), a_Device, a_CommandPool, a_GraphicsQueue);
+}
 
-	stbi_uc* t_Pixels = stbi_load(a_FilePath, &t_TextureWidth, &t_TextureHeight, &t_TextureChannels, STBI_rgb_alpha);
+DecodedImage Texture::DecodeImage(const char* a_FilePath)
+{
+	// stb_image keeps no state between calls apart from global settings, so decoding is thread safe
+	int t_TextureChannels = 0;
+	DecodedImage t_DecodedImage;
 
-	// calculate buffer size
-	VkDeviceSize t_ImageSize = t_TextureWidth * t_TextureHeight * 4;
+	t_DecodedImage.m_Pixels.reset(stbi_load(a_FilePath, &t_DecodedImage.m_Width, &t_DecodedImage.m_Height,
+	                                        &t_TextureChannels, STBI_rgb_alpha));
 
-	if (!t_Pixels)
+	if (!t_DecodedImage.m_Pixels)
 	{
 		throw std::runtime_error("Error! Could not load texture!");
 	}
 
+	return t_DecodedImage;
+}
+
+void Texture::CreateTextureFromDecodedImage(const DecodedImage& a_DecodedImage, const Device& a_Device,
+                                            VkCommandPool& a_CommandPool, const VkQueue& a_GraphicsQueue)
+{
+	const int t_TextureWidth = a_DecodedImage.m_Width;
+	const int t_TextureHeight = a_DecodedImage.m_Height;
+
+	// calculate buffer size
+	VkDeviceSize t_ImageSize = static_cast<VkDeviceSize>(t_TextureWidth) * t_TextureHeight * 4;
+
 	// calculate mip levels
 
 	uint32_t t_MipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(t_TextureWidth, t_TextureHeight)))) + 1;
@@ -47,10 +66,7 @@ void Texture::CreateTextureFromImage(const char* a_FilePath, const Device& a_Dev
 	t_StagingBuffer.CreateBuffer(t_ImageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
 	                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, a_Device);
 
-	t_StagingBuffer.FillBuffer(t_ImageSize, a_Device.GetLogicalDevice(), t_Pixels);
-
-	// unload image
-	stbi_image_free(t_Pixels);
+	t_StagingBuffer.FillBuffer(t_ImageSize, a_Device.GetLogicalDevice(), a_DecodedImage.m_Pixels.get());
 
 	// create Image
 	m_Texture.CreateImage(a_Device, t_TextureWidth, t_TextureHeight, t_MipLevels, VK_SAMPLE_COUNT_1_BIT,
@@ -61,11 +77,11 @@ void Texture::CreateTextureFromImage(const char* a_FilePath, const Device& a_Dev
 
 	// transition image layout safely using image memory barrier
 	m_Texture.TransitionImageLayout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-	                                a_CommandPool, a_GraphicsQueue, a_Device.GetLogicalDevice(), t_MipLevels);
+	                                a_CommandPool, a_GraphicsQueue, a_Device, t_MipLevels);
 
 	t_StagingBuffer.CopyBufferToImage(m_Texture.GetImage(), static_cast<uint32_t>(t_TextureWidth),
 	                                  static_cast<uint32_t>(t_TextureHeight), a_CommandPool,
-	                                  a_Device.GetLogicalDevice(), a_GraphicsQueue);
+	                                  a_Device, a_GraphicsQueue);
 
 	GenMipMaps(t_TextureWidth, t_TextureHeight, t_MipLevels, a_CommandPool, a_Device, a_GraphicsQueue, VK_FORMAT_R8G8B8A8_SRGB);
 
@@ -211,5 +227,5 @@ void Texture::GenMipMaps(int32_t a_TexWidth, int32_t a_TexHeight, uint32_t a_Mip
 		0, nullptr,
 		1, &t_Barrier);
 
-	EndSingleTimeCommands(t_CommandBuffer, a_GraphicsQueue, a_Device.GetLogicalDevice(), a_CommandPool);
+	EndSingleTimeCommands(t_CommandBuffer, a_GraphicsQueue, a_Device, a_CommandPool);
 }
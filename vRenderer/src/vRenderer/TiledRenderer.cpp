@@ -0,0 +1,143 @@
+#include "pch.h"
+#include "vRenderer/TiledRenderer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "vRenderer/vRenderer.h"
+#include "vRenderer/camera/Camera.h"
+
+TiledRenderer::TiledRenderer()
+= default;
+
+TiledRenderer::~TiledRenderer()
+= default;
+
+void TiledRenderer::Render(VRenderer& a_Renderer, Camera& a_Camera, const BatchShot& a_Shot, const uint32_t a_Width,
+                           const uint32_t a_Height, const std::string& a_FilePath, const BatchImageFormat a_Format)
+{
+	if (!a_Renderer.IsHeadless())
+	{
+		throw std::runtime_error("Error! Tiled rendering requires a headless renderer!");
+	}
+
+	const glm::ivec2 t_TileExtent = a_Renderer.GetWindowExtent();
+
+	m_Format = a_Format;
+	m_Width = a_Width;
+	m_Height = a_Height;
+	m_TileWidth = static_cast<uint32_t>(t_TileExtent.x);
+	m_TileHeight = static_cast<uint32_t>(t_TileExtent.y);
+	m_TilesX = (a_Width + m_TileWidth - 1) / m_TileWidth;
+
+	const uint32_t t_TilesY = (a_Height + m_TileHeight - 1) / m_TileHeight;
+
+	if (m_Format == BatchImageFormat::Png)
+	{
+		m_Strip.assign(static_cast<size_t>(a_Width) * m_TileHeight * 4, 0);
+		m_PngWriter.Open(a_FilePath, a_Width, a_Height);
+	}
+	else
+	{
+		m_RawFile.open(a_FilePath, std::ios::binary | std::ios::trunc);
+
+		if (!m_RawFile.is_open())
+		{
+			throw std::runtime_error("Error! Could not open raw image for writing!");
+		}
+	}
+
+	// the aspect ratio is the one of the whole image, every tile shows a region of it
+	a_Camera.SetPosition(a_Shot.m_CameraPosition);
+	a_Camera.UpdateViewMat(a_Shot.m_CameraTarget);
+	a_Camera.UpdateAspectRatio(a_Width, a_Height);
+
+	for (const BatchPose& t_Pose : a_Shot.m_Poses)
+	{
+		a_Renderer.SetRenderableTransform(t_Pose.m_Entity, t_Pose.m_Transform);
+	}
+
+	const uint32_t t_TileCount = m_TilesX * t_TilesY;
+
+	for (uint32_t i = 0; i < t_TileCount; i++)
+	{
+		const uint32_t t_TileX = i % m_TilesX;
+		const uint32_t t_TileY = i / m_TilesX;
+
+		// edge tiles extend past the image, so every tile has the same pixel size and the excess is dropped
+		a_Camera.SetViewRegion(
+			{
+				static_cast<float>(t_TileX * m_TileWidth) / static_cast<float>(a_Width),
+				static_cast<float>(t_TileY * m_TileHeight) / static_cast<float>(a_Height)
+			},
+			{
+				static_cast<float>((t_TileX + 1) * m_TileWidth) / static_cast<float>(a_Width),
+				static_cast<float>((t_TileY + 1) * m_TileHeight) / static_cast<float>(a_Height)
+			});
+
+		// neighbouring tiles are unrelated views for the temporal history
+		a_Renderer.ResetTemporalHistory();
+		a_Renderer.Render(a_Camera);
+
+		// the previous tile is read back while this one renders
+		if (i > 0)
+		{
+			a_Renderer.ReadbackFrame(m_Tile, 1);
+			StoreTile((i - 1) % m_TilesX, (i - 1) / m_TilesX);
+		}
+	}
+
+	a_Renderer.ReadbackFrame(m_Tile, 0);
+	StoreTile((t_TileCount - 1) % m_TilesX, (t_TileCount - 1) / m_TilesX);
+
+	a_Camera.ResetViewRegion();
+
+	if (m_Format == BatchImageFormat::Png)
+	{
+		m_PngWriter.Close();
+	}
+	else
+	{
+		m_RawFile.close();
+
+		if (m_RawFile.fail())
+		{
+			throw std::runtime_error("Error! Could not write raw image!");
+		}
+	}
+
+	// nothing is kept between images
+	m_Tile = {};
+	m_Strip = {};
+}
+
+void TiledRenderer::StoreTile(const uint32_t a_TileX, const uint32_t a_TileY)
+{
+	const uint32_t t_X = a_TileX * m_TileWidth;
+	const uint32_t t_Y = a_TileY * m_TileHeight;
+	const uint32_t t_Width = std::min(m_TileWidth, m_Width - t_X);
+	const uint32_t t_Height = std::min(m_TileHeight, m_Height - t_Y);
+
+	for (uint32_t t_Row = 0; t_Row < t_Height; t_Row++)
+	{
+		const uint8_t* t_Source = m_Tile.data() + static_cast<size_t>(t_Row) * m_TileWidth * 4;
+
+		if (m_Format == BatchImageFormat::Png)
+		{
+			memcpy(m_Strip.data() + (static_cast<size_t>(t_Row) * m_Width + t_X) * 4, t_Source,
+			       static_cast<size_t>(t_Width) * 4);
+		}
+		else
+		{
+			m_RawFile.seekp(static_cast<std::streamoff>((static_cast<uint64_t>(t_Y + t_Row) * m_Width + t_X) * 4));
+			m_RawFile.write(reinterpret_cast<const char*>(t_Source), static_cast<std::streamsize>(t_Width) * 4);
+		}
+	}
+
+	// the strip is complete once its rightmost tile arrived
+	if (m_Format == BatchImageFormat::Png && a_TileX == m_TilesX - 1)
+	{
+		m_PngWriter.WriteRows(m_Strip.data(), t_Height);
+	}
+}
@@ -0,0 +1,137 @@
+#include "pch.h"
+#include "vRenderer/TimelineSemaphore.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+TimelineSemaphore::TimelineSemaphore()
+= default;
+
+TimelineSemaphore::~TimelineSemaphore()
+= default;
+
+void TimelineSemaphore::Create(const VkDevice& a_LogicalDevice)
+{
+	VkSemaphoreTypeCreateInfo t_TypeCreateInfo = {};
+	t_TypeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	t_TypeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	t_TypeCreateInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo t_SemaphoreCreateInfo = {};
+	t_SemaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	t_SemaphoreCreateInfo.pNext = &t_TypeCreateInfo;
+
+	if (vkCreateSemaphore(a_LogicalDevice, &t_SemaphoreCreateInfo, nullptr, &m_Semaphore) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not create timeline Semaphore!");
+	}
+
+	m_LastSubmittedValue = 0;
+	m_CompletedValue = 0;
+}
+
+void TimelineSemaphore::Destroy(const VkDevice& a_LogicalDevice)
+{
+	vkDestroySemaphore(a_LogicalDevice, m_Semaphore, nullptr);
+	m_Semaphore = VK_NULL_HANDLE;
+}
+
+uint64_t TimelineSemaphore::Submit(VkQueue a_Queue, const VkSubmitInfo& a_SubmitInfo, const uint64_t* a_WaitValues,
+                                   const uint64_t* a_SignalValues)
+{
+	const uint32_t t_SignalCount = a_SubmitInfo.signalSemaphoreCount;
+
+	if (t_SignalCount > s_MaxSignalSemaphores)
+	{
+		throw std::runtime_error("Error! Too many signal semaphores for a timeline submission!");
+	}
+
+	// only committed once the submission succeeded, a failed one never signals its value
+	const uint64_t t_Value = m_LastSubmittedValue + 1;
+
+	// append the timeline to the signal semaphores, values of binary semaphores are ignored. Fixed
+	// arrays keep the submission free of heap allocations
+	std::array<VkSemaphore, s_MaxSignalSemaphores + 1> t_SignalSemaphores = {};
+	std::array<uint64_t, s_MaxSignalSemaphores + 1> t_SignalValues = {};
+
+	std::copy_n(a_SubmitInfo.pSignalSemaphores, t_SignalCount, t_SignalSemaphores.begin());
+	if (a_SignalValues != nullptr)
+	{
+		std::copy_n(a_SignalValues, t_SignalCount, t_SignalValues.begin());
+	}
+
+	t_SignalSemaphores[t_SignalCount] = m_Semaphore;
+	t_SignalValues[t_SignalCount] = t_Value;
+
+	VkTimelineSemaphoreSubmitInfo t_TimelineSubmitInfo = {};
+	t_TimelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	t_TimelineSubmitInfo.pNext = a_SubmitInfo.pNext;
+	t_TimelineSubmitInfo.signalSemaphoreValueCount = t_SignalCount + 1;
+	t_TimelineSubmitInfo.pSignalSemaphoreValues = t_SignalValues.data();
+	t_TimelineSubmitInfo.waitSemaphoreValueCount = a_WaitValues != nullptr ? a_SubmitInfo.waitSemaphoreCount : 0;
+	t_TimelineSubmitInfo.pWaitSemaphoreValues = a_WaitValues;
+
+	VkSubmitInfo t_SubmitInfo = a_SubmitInfo;
+	t_SubmitInfo.pNext = &t_TimelineSubmitInfo;
+	t_SubmitInfo.signalSemaphoreCount = t_SignalCount + 1;
+	t_SubmitInfo.pSignalSemaphores = t_SignalSemaphores.data();
+
+	if (vkQueueSubmit(a_Queue, 1, &t_SubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Could not submit to queue!");
+	}
+
+	m_LastSubmittedValue = t_Value;
+	return t_Value;
+}
+
+bool TimelineSemaphore::IsComplete(const VkDevice& a_LogicalDevice, const uint64_t a_Value)
+{
+	return a_Value <= m_CompletedValue || a_Value <= GetCompletedValue(a_LogicalDevice);
+}
+
+void TimelineSemaphore::Wait(const VkDevice& a_LogicalDevice, const uint64_t a_Value)
+{
+	if (a_Value <= m_CompletedValue)
+	{
+		return;
+	}
+
+	VkSemaphoreWaitInfo t_WaitInfo = {};
+	t_WaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	t_WaitInfo.semaphoreCount = 1;
+	t_WaitInfo.pSemaphores = &m_Semaphore;
+	t_WaitInfo.pValues = &a_Value;
+
+	if (vkWaitSemaphores(a_LogicalDevice, &t_WaitInfo, UINT64_MAX) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Error! Failed to wait for timeline Semaphore!");
+	}
+
+	GetCompletedValue(a_LogicalDevice);
+}
+
+uint64_t TimelineSemaphore::GetCompletedValue(const VkDevice& a_LogicalDevice)
+{
+	uint64_t t_Value = 0;
+	vkGetSemaphoreCounterValue(a_LogicalDevice, m_Semaphore, &t_Value);
+
+	// other threads may have read a newer value in the meantime
+	uint64_t t_Cached = m_CompletedValue;
+	while (t_Cached < t_Value && !m_CompletedValue.compare_exchange_weak(t_Cached, t_Value))
+	{
+	}
+
+	return std::max(t_Cached, t_Value);
+}
+
+uint64_t TimelineSemaphore::GetLastSubmittedValue() const
+{
+	return m_LastSubmittedValue;
+}
+
+VkSemaphore TimelineSemaphore::GetSemaphore() const
+{
+	return m_Semaphore;
+}
@@ -0,0 +1,338 @@
+#include "pch.h"
+#include "vRenderer/TransformStore.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <immintrin.h>
+
+#include "vRenderer/JobSystem.h"
+#include "vRenderer/Buffer/InstanceBuffer.h"
+
+TransformStore::TransformStore()
+= default;
+
+TransformStore::~TransformStore()
+= default;
+
+uint32_t TransformStore::Create(const glm::vec3& a_Position, const glm::quat& a_Rotation, const glm::vec3& a_Scale,
+                                const uint32_t a_Parent)
+{
+	const uint32_t t_Index = GetCount();
+
+	if (a_Parent != s_NoParent && a_Parent >= t_Index)
+	{
+		throw std::runtime_error("Error! The parent of a transform has to be created before it!");
+	}
+
+	m_PositionX.push_back(a_Position.x);
+	m_PositionY.push_back(a_Position.y);
+	m_PositionZ.push_back(a_Position.z);
+	m_RotationX.push_back(a_Rotation.x);
+	m_RotationY.push_back(a_Rotation.y);
+	m_RotationZ.push_back(a_Rotation.z);
+	m_RotationW.push_back(a_Rotation.w);
+	m_ScaleX.push_back(a_Scale.x);
+	m_ScaleY.push_back(a_Scale.y);
+	m_ScaleZ.push_back(a_Scale.z);
+	m_Parents.push_back(a_Parent);
+
+	m_Dirty.push_back(1);
+	m_ChangedSerials.push_back(0);
+	m_WorldMatrices.emplace_back(1.0f);
+	m_PreviousWorldMatrices.emplace_back(1.0f);
+
+	return t_Index;
+}
+
+void TransformStore::Clear()
+{
+	for (std::vector<float>* t_Component : {
+		     &m_PositionX, &m_PositionY, &m_PositionZ, &m_RotationX, &m_RotationY, &m_RotationZ, &m_RotationW, &m_ScaleX,
+		     &m_ScaleY, &m_ScaleZ
+	     })
+	{
+		t_Component->clear();
+	}
+
+	m_Parents.clear();
+	m_Dirty.clear();
+	m_ChangedSerials.clear();
+	m_WorldMatrices.clear();
+	m_PreviousWorldMatrices.clear();
+	m_DirtyIndices.clear();
+	m_MovedIndices.clear();
+}
+
+uint32_t TransformStore::GetCount() const
+{
+	return static_cast<uint32_t>(m_Parents.size());
+}
+
+void TransformStore::SetPosition(const uint32_t a_Index, const glm::vec3& a_Position)
+{
+	m_PositionX[a_Index] = a_Position.x;
+	m_PositionY[a_Index] = a_Position.y;
+	m_PositionZ[a_Index] = a_Position.z;
+	m_Dirty[a_Index] = 1;
+}
+
+void TransformStore::SetRotation(const uint32_t a_Index, const glm::quat& a_Rotation)
+{
+	m_RotationX[a_Index] = a_Rotation.x;
+	m_RotationY[a_Index] = a_Rotation.y;
+	m_RotationZ[a_Index] = a_Rotation.z;
+	m_RotationW[a_Index] = a_Rotation.w;
+	m_Dirty[a_Index] = 1;
+}
+
+void TransformStore::SetScale(const uint32_t a_Index, const glm::vec3& a_Scale)
+{
+	m_ScaleX[a_Index] = a_Scale.x;
+	m_ScaleY[a_Index] = a_Scale.y;
+	m_ScaleZ[a_Index] = a_Scale.z;
+	m_Dirty[a_Index] = 1;
+}
+
+void TransformStore::Rotate(const uint32_t a_Index, const glm::quat& a_Rotation)
+{
+	// renormalize so repeated rotations do not accumulate scale
+	SetRotation(a_Index, glm::normalize(a_Rotation * GetRotation(a_Index)));
+}
+
+void TransformStore::Teleport(const uint32_t a_Index, const glm::vec3& a_Position, const glm::quat& a_Rotation,
+                              const glm::vec3& a_Scale)
+{
+	SetPosition(a_Index, a_Position);
+	SetRotation(a_Index, a_Rotation);
+	SetScale(a_Index, a_Scale);
+
+	// treated like a new transform by the next Update
+	m_ChangedSerials[a_Index] = 0;
+}
+
+glm::vec3 TransformStore::GetPosition(const uint32_t a_Index) const
+{
+	return {m_PositionX[a_Index], m_PositionY[a_Index], m_PositionZ[a_Index]};
+}
+
+glm::quat TransformStore::GetRotation(const uint32_t a_Index) const
+{
+	return {m_RotationW[a_Index], m_RotationX[a_Index], m_RotationY[a_Index], m_RotationZ[a_Index]};
+}
+
+glm::vec3 TransformStore::GetScale(const uint32_t a_Index) const
+{
+	return {m_ScaleX[a_Index], m_ScaleY[a_Index], m_ScaleZ[a_Index]};
+}
+
+uint32_t TransformStore::GetParent(const uint32_t a_Index) const
+{
+	return m_Parents[a_Index];
+}
+
+void TransformStore::MarkDirty(const uint32_t a_Index)
+{
+	m_Dirty[a_Index] = 1;
+}
+
+void TransformStore::Update(JobSystem& a_JobSystem)
+{
+	m_MovedIndices.swap(m_DirtyIndices);
+	m_DirtyIndices.clear();
+
+	// parents come first, so a changed parent has already passed its flag on when its children are reached
+	const uint32_t t_Count = GetCount();
+	for (uint32_t i = 0; i < t_Count; i++)
+	{
+		if (m_Parents[i] != s_NoParent && m_Dirty[m_Parents[i]])
+		{
+			m_Dirty[i] = 1;
+		}
+
+		if (m_Dirty[i])
+		{
+			m_DirtyIndices.push_back(i);
+		}
+	}
+
+	if (m_DirtyIndices.empty() && m_MovedIndices.empty())
+	{
+		return;
+	}
+
+	m_UpdateSerial++;
+
+	// the transforms that moved last time stop moving unless they changed again, either way their
+	// previous matrix is the one they were drawn with last frame
+	for (const uint32_t t_Index : m_MovedIndices)
+	{
+		m_PreviousWorldMatrices[t_Index] = m_WorldMatrices[t_Index];
+		m_ChangedSerials[t_Index] = m_UpdateSerial;
+	}
+
+	for (const uint32_t t_Index : m_DirtyIndices)
+	{
+		m_PreviousWorldMatrices[t_Index] = m_WorldMatrices[t_Index];
+	}
+
+	// local matrices in batches of four, independent of each other
+	const size_t t_BatchCount = (m_DirtyIndices.size() + 3) / 4;
+	a_JobSystem.ParallelFor(t_BatchCount, 256, [this](const size_t a_Begin, const size_t a_End)
+	{
+		for (size_t t_Batch = a_Begin; t_Batch < a_End; t_Batch++)
+		{
+			const size_t t_First = t_Batch * 4;
+			ComputeLocalMatrices(&m_DirtyIndices[t_First],
+			                     static_cast<uint32_t>(std::min<size_t>(4, m_DirtyIndices.size() - t_First)));
+		}
+	}, "Transform update");
+
+	// children in index order, their parents' world matrices are final by then
+	for (const uint32_t t_Index : m_DirtyIndices)
+	{
+		if (m_Parents[t_Index] != s_NoParent)
+		{
+			m_WorldMatrices[t_Index] = m_WorldMatrices[m_Parents[t_Index]] * m_WorldMatrices[t_Index];
+		}
+
+		// new transforms did not move, they were not drawn before
+		if (m_ChangedSerials[t_Index] == 0)
+		{
+			m_PreviousWorldMatrices[t_Index] = m_WorldMatrices[t_Index];
+		}
+
+		m_ChangedSerials[t_Index] = m_UpdateSerial;
+		m_Dirty[t_Index] = 0;
+	}
+}
+
+const glm::mat4& TransformStore::GetWorldMatrix(const uint32_t a_Index) const
+{
+	return m_WorldMatrices[a_Index];
+}
+
+const glm::mat4& TransformStore::GetPreviousWorldMatrix(const uint32_t a_Index) const
+{
+	return m_PreviousWorldMatrices[a_Index];
+}
+
+uint64_t TransformStore::GetChangedSerial(const uint32_t a_Index) const
+{
+	return m_ChangedSerials[a_Index];
+}
+
+uint64_t TransformStore::GetUpdateSerial() const
+{
+	return m_UpdateSerial;
+}
+
+void TransformStore::WriteWorldMatrices(InstanceBuffer& a_Buffer, uint64_t& a_WrittenSerial, JobSystem& a_JobSystem) const
+{
+	if (GetCount() > a_Buffer.GetCapacity())
+	{
+		throw std::runtime_error("Error! Too many transforms for the Instance Buffer!");
+	}
+
+	if (a_WrittenSerial == m_UpdateSerial)
+	{
+		return;
+	}
+
+	InstanceData* t_Instances = a_Buffer.GetMappedInstances();
+	const uint64_t t_WrittenSerial = a_WrittenSerial;
+
+	a_JobSystem.ParallelFor(GetCount(), 4096, [&](const size_t a_Begin, const size_t a_End)
+	{
+		for (size_t i = a_Begin; i < a_End; i++)
+		{
+			if (m_ChangedSerials[i] > t_WrittenSerial)
+			{
+				t_Instances[i].m_Model = m_WorldMatrices[i];
+				t_Instances[i].m_PreviousModel = m_PreviousWorldMatrices[i];
+			}
+		}
+	}, "Transform upload");
+
+	a_WrittenSerial = m_UpdateSerial;
+}
+
+void TransformStore::ComputeLocalMatrices(const uint32_t* a_Indices, const uint32_t a_Count)
+{
+	// gather the components of up to four transforms into one lane each, unused lanes repeat the first
+	uint32_t t_Indices[4];
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		t_Indices[i] = a_Indices[i < a_Count ? i : 0];
+	}
+
+	// runs of consecutive transforms, the usual case when most of them move, are loaded directly
+	const bool t_Consecutive = a_Count == 4 && t_Indices[3] == t_Indices[0] + 3;
+
+	const auto t_Gather = [&t_Indices, t_Consecutive](const std::vector<float>& a_Component)
+	{
+		if (t_Consecutive)
+		{
+			return _mm_loadu_ps(&a_Component[t_Indices[0]]);
+		}
+
+		return _mm_setr_ps(a_Component[t_Indices[0]], a_Component[t_Indices[1]], a_Component[t_Indices[2]],
+		                   a_Component[t_Indices[3]]);
+	};
+
+	const __m128 t_QX = t_Gather(m_RotationX);
+	const __m128 t_QY = t_Gather(m_RotationY);
+	const __m128 t_QZ = t_Gather(m_RotationZ);
+	const __m128 t_QW = t_Gather(m_RotationW);
+	const __m128 t_SX = t_Gather(m_ScaleX);
+	const __m128 t_SY = t_Gather(m_ScaleY);
+	const __m128 t_SZ = t_Gather(m_ScaleZ);
+
+	// rotation matrix of a unit quaternion, as in glm::mat3_cast
+	const __m128 t_X2 = _mm_add_ps(t_QX, t_QX);
+	const __m128 t_Y2 = _mm_add_ps(t_QY, t_QY);
+	const __m128 t_Z2 = _mm_add_ps(t_QZ, t_QZ);
+	const __m128 t_XX = _mm_mul_ps(t_QX, t_X2);
+	const __m128 t_YY = _mm_mul_ps(t_QY, t_Y2);
+	const __m128 t_ZZ = _mm_mul_ps(t_QZ, t_Z2);
+	const __m128 t_XY = _mm_mul_ps(t_QX, t_Y2);
+	const __m128 t_XZ = _mm_mul_ps(t_QX, t_Z2);
+	const __m128 t_YZ = _mm_mul_ps(t_QY, t_Z2);
+	const __m128 t_WX = _mm_mul_ps(t_QW, t_X2);
+	const __m128 t_WY = _mm_mul_ps(t_QW, t_Y2);
+	const __m128 t_WZ = _mm_mul_ps(t_QW, t_Z2);
+	const __m128 t_One = _mm_set1_ps(1.0f);
+	const __m128 t_Zero = _mm_setzero_ps();
+
+	// one register per matrix element, columns scaled by the scale along their axis
+	__m128 t_Columns[4][4] = {
+		{
+			_mm_mul_ps(_mm_sub_ps(t_One, _mm_add_ps(t_YY, t_ZZ)), t_SX), _mm_mul_ps(_mm_add_ps(t_XY, t_WZ), t_SX),
+			_mm_mul_ps(_mm_sub_ps(t_XZ, t_WY), t_SX), t_Zero
+		},
+		{
+			_mm_mul_ps(_mm_sub_ps(t_XY, t_WZ), t_SY), _mm_mul_ps(_mm_sub_ps(t_One, _mm_add_ps(t_XX, t_ZZ)), t_SY),
+			_mm_mul_ps(_mm_add_ps(t_YZ, t_WX), t_SY), t_Zero
+		},
+		{
+			_mm_mul_ps(_mm_add_ps(t_XZ, t_WY), t_SZ), _mm_mul_ps(_mm_sub_ps(t_YZ, t_WX), t_SZ),
+			_mm_mul_ps(_mm_sub_ps(t_One, _mm_add_ps(t_XX, t_YY)), t_SZ), t_Zero
+		},
+		{t_Gather(m_PositionX), t_Gather(m_PositionY), t_Gather(m_PositionZ), t_One}
+	};
+
+	// after transposing, lane i of each column holds the column of transform i
+	for (__m128 (&t_Column)[4] : t_Columns)
+	{
+		_MM_TRANSPOSE4_PS(t_Column[0], t_Column[1], t_Column[2], t_Column[3]);
+	}
+
+	for (uint32_t i = 0; i < a_Count; i++)
+	{
+		float* t_Matrix = &m_WorldMatrices[t_Indices[i]][0][0];
+
+		for (uint32_t t_Column = 0; t_Column < 4; t_Column++)
+		{
+			_mm_storeu_ps(t_Matrix + t_Column * 4, t_Columns[t_Column][i]);
+		}
+	}
+}
@@ -38,7 +38,62 @@ glm::mat4 Camera::GetViewMat() const
 
 glm::mat4 Camera::GetProjectionMat() const
 {
-	return glm::perspective(glm::radians(m_FOV), m_Aspect, m_Near, m_Far);
+	glm::mat4 t_Projection = GetUnjitteredProjectionMat();
+
+	// offsetting the third column shifts the projected position by the jitter after the perspective divide
+	t_Projection[2][0] += m_Jitter.x;
+	t_Projection[2][1] += m_Jitter.y;
+
+	return t_Projection;
+}
+
+glm::mat4 Camera::GetUnjitteredProjectionMat() const
+{
+	const glm::mat4 t_Projection = glm::perspective(glm::radians(m_FOV), m_Aspect, m_Near, m_Far);
+
+	// scale and shift the view region onto the whole image, in normalized device coordinates with y up
+	const glm::vec2 t_HalfExtent = m_ViewRegionMax - m_ViewRegionMin;
+	const glm::vec2 t_Center = {m_ViewRegionMin.x + m_ViewRegionMax.x - 1.0f, 1.0f - m_ViewRegionMin.y - m_ViewRegionMax.y};
+
+	glm::mat4 t_Region = glm::mat4(1.0f);
+	t_Region[0][0] = 1.0f / t_HalfExtent.x;
+	t_Region[1][1] = 1.0f / t_HalfExtent.y;
+	t_Region[3][0] = -t_Center.x / t_HalfExtent.x;
+	t_Region[3][1] = -t_Center.y / t_HalfExtent.y;
+
+	return t_Region * t_Projection;
+}
+
+void Camera::SetJitter(const glm::vec2& a_Jitter)
+{
+	m_Jitter = a_Jitter;
+}
+
+glm::vec2 Camera::GetJitter() const
+{
+	return m_Jitter;
+}
+
+void Camera::SetViewRegion(const glm::vec2& a_Min, const glm::vec2& a_Max)
+{
+	m_ViewRegionMin = a_Min;
+	m_ViewRegionMax = a_Max;
+}
+
+void Camera::ResetViewRegion()
+{
+	m_ViewRegionMin = {0.0f, 0.0f};
+	m_ViewRegionMax = {1.0f, 1.0f};
+}
+
+glm::vec2 Camera::GetViewRegionMin() const
+{
+	return m_ViewRegionMin;
+}
+
+glm::vec2 Camera::GetViewRegionMax() const
+{
+	return m_ViewRegionMax;
 }
 
 glm::vec3 Camera::GetPosition() const
@@ -46,6 +101,26 @@ glm::vec3 Camera::GetPosition() const
 	return m_Position;
 }
 
+float Camera::GetNearPlane() const
+{
+	return m_Near;
+}
+
+float Camera::GetFarPlane() const
+{
+	return m_Far;
+}
+
+float Camera::GetFOV() const
+{
+	return m_FOV;
+}
+
+float Camera::GetAspectRatio() const
+{
+	return m_Aspect;
+}
+
 void Camera::SetPosition(const glm::vec3& a_Position)
 {
 	m_Position = a_Position;
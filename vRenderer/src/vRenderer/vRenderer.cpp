@@ -8,8 +8,10 @@
 #include "vRenderer/helper_structs/RenderingHelpers.h"
 #include "vRenderer/helper_structs/UniformBufferObject.h"
 #include "vRenderer/helper_structs/Vertex.h"
+#include "vRenderer/RenderSystems.h"
 
 #define GLFW_INCLUDE_VULKAN
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 #include <vector>
@@ -17,19 +19,20 @@
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
-#include <chrono>
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 VRenderer::VRenderer(): m_Window(nullptr)
 {
 }
 
-bool VRenderer::Init(const int a_WindowWidth, const int a_WindowHeight,
+bool VRenderer::Init(const int a_WindowWidth, const int a_WindowHeight, const RenderSettings& a_RenderSettings,
                      const std::vector<const char*>& a_EnabledValidationLayers,
                      const std::vector<const char*>& a_RequestedDeviceExtensions)
 {
 	m_EnabledValidationLayers = a_EnabledValidationLayers;
 	m_RequestedDeviceExtensions = a_RequestedDeviceExtensions;
+	m_RenderSettings = a_RenderSettings;
 
 	EnableValidation();
 
@@ -40,16 +43,49 @@ bool VRenderer::Init(const int a_WindowWidth, const int a_WindowHeight,
 	return true;
 }
 
+bool VRenderer::InitHeadless(const uint32_t a_Width, const uint32_t a_Height, const RenderSettings& a_RenderSettings,
+                             const std::vector<const char*>& a_EnabledValidationLayers,
+                             const std::vector<const char*>& a_RequestedDeviceExtensions)
+{
+	m_Headless = true;
+	m_HeadlessExtent = {a_Width, a_Height};
+	m_EnabledValidationLayers = a_EnabledValidationLayers;
+	m_RenderSettings = a_RenderSettings;
+
+	// nothing is presented, so the swap chain extension is neither required nor enabled
+	m_RequestedDeviceExtensions.clear();
+	for (const char* t_Extension : a_RequestedDeviceExtensions)
+	{
+		if (strcmp(t_Extension, VK_KHR_SWAPCHAIN_EXTENSION_NAME) != 0)
+		{
+			m_RequestedDeviceExtensions.push_back(t_Extension);
+		}
+	}
+
+	EnableValidation();
+
+	InitVulkan();
+
+	return true;
+}
+
 bool VRenderer::Terminate()
 {
 	// wait for asynchronous processes to finish
 	vkDeviceWaitIdle(m_Device.GetLogicalDevice());
 
+	m_JobSystem.Stop();
+	m_FrameArena.Destroy();
+	m_FrameCapture.Stop(m_Device);
+	m_FrameExporter.Destroy(m_Device);
 	DestroySyncObjects();
 	vkDestroyCommandPool(m_Device.GetLogicalDevice(), m_CommandPool, nullptr);
-	vkDestroyPipeline(m_Device.GetLogicalDevice(), m_GraphicsPipeline, nullptr);
+	m_GraphicsPipeline.Reset();
+	m_DepthPrepassPipeline.Reset();
 	vkDestroyPipelineLayout(m_Device.GetLogicalDevice(), m_PipelineLayout, nullptr);
 	vkDestroyRenderPass(m_Device.GetLogicalDevice(), m_MainRenderPass, nullptr);
+	m_PrepassGraph.Destroy(m_Device.GetLogicalDevice());
+	m_PostProcessGraph.Destroy(m_Device.GetLogicalDevice());
 	m_SwapChain.Cleanup(m_Device.GetLogicalDevice(), m_Framebuffers);
 
 	//m_Texture.DestroyTexture(m_Device.GetLogicalDevice());
@@ -57,55 +93,127 @@ bool VRenderer::Terminate()
 
 	m_ColorImage.DestroyImage(m_Device.GetLogicalDevice());
 	m_DepthImage.DestroyImage(m_Device.GetLogicalDevice());
+	m_TemporalAA.Destroy(m_Device.GetLogicalDevice());
+	m_OffscreenImage.DestroyImage(m_Device.GetLogicalDevice());
+	m_SpatialUpscaler.Destroy(m_Device.GetLogicalDevice());
+	m_OcclusionCuller.Destroy(m_Device.GetLogicalDevice(), m_DescriptorAllocator);
+	m_LightCuller.Destroy(m_Device.GetLogicalDevice());
+	m_AsyncCompute.Destroy(m_Device.GetLogicalDevice());
+	m_DeferredLighting.Destroy(m_Device.GetLogicalDevice(), m_DescriptorAllocator);
+	m_GpuTimer.Destroy(m_Device.GetLogicalDevice());
+
+	for (ReadbackBuffer& t_ReadbackBuffer : m_ReadbackBuffers)
+	{
+		t_ReadbackBuffer.DestroyBuffer(m_Device.GetLogicalDevice());
+	}
 
 	for(size_t i = 0; i < m_UniformBuffers.size(); i++)
 	{
 		m_UniformBuffers[i].DestroyBuffer(m_Device.GetLogicalDevice());
 	}
 
-	vkDestroyDescriptorPool(m_Device.GetLogicalDevice(), m_DescriptorPool, nullptr);
+	m_DescriptorAllocator.Destroy(m_Device.GetLogicalDevice());
 
 	vkDestroyDescriptorSetLayout(m_Device.GetLogicalDevice(), m_DescriptorSetLayout, nullptr);
+	m_TextureTable.Destroy(m_Device.GetLogicalDevice());
+	m_TestMesh.Reset();
+	m_DeferredDestruction.Flush();
+	m_Meshes.DestroyAll();
+	m_Pipelines.DestroyAll();
 
-	m_VertexBuffer.DestroyBuffer(m_Device.GetLogicalDevice());
-	m_IndexBuffer.DestroyBuffer(m_Device.GetLogicalDevice());
+	for (InstanceBuffer& t_InstanceBuffer : m_InstanceBuffers)
+	{
+		t_InstanceBuffer.DestroyBuffer(m_Device.GetLogicalDevice());
+	}
 
+	m_Device.GetGraphicsTimeline().Destroy(m_Device.GetLogicalDevice());
+	m_Device.GetComputeTimeline().Destroy(m_Device.GetLogicalDevice());
 	vkDestroyDevice(m_Device.GetLogicalDevice(), nullptr);
-	vkDestroySurfaceKHR(m_VInstance, m_WindowSurface, nullptr);
+
+	if (!m_Headless)
+	{
+		vkDestroySurfaceKHR(m_VInstance, m_WindowSurface, nullptr);
+	}
+
 	vkDestroyInstance(m_VInstance, nullptr);
-	glfwDestroyWindow(m_Window);
+
+	if (!m_Headless)
+	{
+		glfwDestroyWindow(m_Window);
+	}
+
 	return true;
 }
 
 void VRenderer::Render(Camera& a_Camera)
 {
-	glfwPollEvents();
+	if (!m_Headless)
+	{
+		glfwPollEvents();
+	}
 
-	// wait for previous frame
-	vkWaitForFences(m_Device.GetLogicalDevice(), 1, &m_InFlightFences[m_CurrentFrame], VK_TRUE, UINT64_MAX);
+	TimelineSemaphore& t_Timeline = m_Device.GetGraphicsTimeline();
 
-	// acquire image from swap chain
-	uint32_t t_ImageIndex;
-	VkResult t_Result = vkAcquireNextImageKHR(m_Device.GetLogicalDevice(), m_SwapChain.GetSwapChain(), UINT64_MAX,
-	                                          m_ImageAcquiredSemaphores[m_CurrentFrame],
-	                                          VK_NULL_HANDLE, &t_ImageIndex);
+	// wait for the previous submission of this frame, later frames may still be in flight
+	t_Timeline.Wait(m_Device.GetLogicalDevice(), m_FrameTimelineValues[m_CurrentFrame]);
 
-	// recreate swap chain?
-	if (t_Result == VK_ERROR_OUT_OF_DATE_KHR)
-	{
-		HandleResize();
-		return;
-	} else if (t_Result != VK_SUCCESS && t_Result != VK_SUBOPTIMAL_KHR)
+	// release everything the GPU is done with, this may be further than the frame waited for
+	const uint64_t t_CompletedValue = t_Timeline.GetCompletedValue(m_Device.GetLogicalDevice());
+	m_TextureTable.Collect(t_CompletedValue);
+	m_DeferredDestruction.Collect(t_CompletedValue);
+	m_FrameCapture.Poll(t_CompletedValue);
+	m_FrameExporter.Poll(t_CompletedValue);
+
+	// transient descriptor sets and CPU data of this frame are no longer in use
+	m_DescriptorAllocator.BeginFrame(m_Device.GetLogicalDevice(), m_CurrentFrame);
+	m_FrameArena.BeginFrame(m_CurrentFrame);
+
+	// the previous submission of this frame has finished, so its timestamps can be read
+	if (m_GpuTimer.GetElapsedMilliseconds(m_Device.GetLogicalDevice(), m_CurrentFrame, m_GpuFrameTime) &&
+		m_RenderSettings.m_DynamicResolution)
 	{
-		throw std::runtime_error("Error! Failed to acquire swap chain image!");
+		m_DynamicResolution.Update(m_GpuFrameTime);
 	}
 
-	// reset fences if work is submitted
-	vkResetFences(m_Device.GetLogicalDevice(), 1, &m_InFlightFences[m_CurrentFrame]);
+	// headless frames render into the offscreen image of the frame in flight, its previous use has finished
+	uint32_t t_ImageIndex = m_CurrentFrame;
+
+	if (!m_Headless)
+	{
+		// acquire image from swap chain
+		const VkResult t_Result = vkAcquireNextImageKHR(m_Device.GetLogicalDevice(), m_SwapChain.GetSwapChain(),
+		                                                UINT64_MAX, m_ImageAcquiredSemaphores[m_CurrentFrame],
+		                                                VK_NULL_HANDLE, &t_ImageIndex);
+
+		// recreate swap chain?
+		if (t_Result == VK_ERROR_OUT_OF_DATE_KHR)
+		{
+			HandleResize();
+			return;
+		} else if (t_Result != VK_SUCCESS && t_Result != VK_SUBOPTIMAL_KHR)
+		{
+			throw std::runtime_error("Error! Failed to acquire swap chain image!");
+		}
+	}
 
 	// update uniform buffers
 	UpdateUniformBuffers(m_CurrentFrame, a_Camera);
 
+	// bin the lights into the clusters, this only depends on the lights uploaded above. On a separate
+	// compute queue it overlaps with the rasterization of the previous frame
+	const uint32_t t_Frame = m_CurrentFrame;
+	m_AsyncCompute.Schedule([this, t_Frame](VkCommandBuffer a_CommandBuffer)
+	{
+		m_LightCuller.RecordLightCulling(a_CommandBuffer, t_Frame);
+	}, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+	if (m_Device.HasAsyncCompute())
+	{
+		m_AsyncCompute.Submit(m_Device, m_CurrentFrame);
+	}
+
+	BuildDrawQueue(a_Camera);
+
 	// record command buffer
 	vkResetCommandBuffer(m_CommandBuffers[m_CurrentFrame], 0);
 	RecordCommandBuffer(m_CommandBuffers[m_CurrentFrame], t_ImageIndex);
@@ -114,28 +222,60 @@ void VRenderer::Render(Camera& a_Camera)
 	VkSubmitInfo t_CommandBufferSubmitInfo = {};
 	t_CommandBufferSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-	VkSemaphore t_WaitSemaphores[] = {m_ImageAcquiredSemaphores[m_CurrentFrame]};
-	VkPipelineStageFlags t_WaitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-	t_CommandBufferSubmitInfo.waitSemaphoreCount = 1;
-	t_CommandBufferSubmitInfo.pWaitSemaphores = t_WaitSemaphores;
-	t_CommandBufferSubmitInfo.pWaitDstStageMask = t_WaitStages;
+	FrameVector<VkSemaphore> t_WaitSemaphores = m_FrameArena.MakeVector<VkSemaphore>();
+	FrameVector<VkPipelineStageFlags> t_WaitStages = m_FrameArena.MakeVector<VkPipelineStageFlags>();
+	FrameVector<uint64_t> t_WaitValues = m_FrameArena.MakeVector<uint64_t>();
+
+	if (!m_Headless)
+	{
+		t_WaitSemaphores.push_back(m_ImageAcquiredSemaphores[m_CurrentFrame]);
+		// with TAA or the offscreen target the swap chain image is first written by a copy
+		t_WaitStages.push_back(UsesTAA() || UsesOffscreenTarget()
+			                       ? VK_PIPELINE_STAGE_TRANSFER_BIT
+			                       : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+		t_WaitValues.push_back(0);
+	}
+
+	// the stages reading the results of the async compute work wait for its submission
+	m_AsyncCompute.AddGraphicsWait(m_Device, t_WaitSemaphores, t_WaitStages, t_WaitValues);
+
+	t_CommandBufferSubmitInfo.waitSemaphoreCount = static_cast<uint32_t>(t_WaitSemaphores.size());
+	t_CommandBufferSubmitInfo.pWaitSemaphores = t_WaitSemaphores.data();
+	t_CommandBufferSubmitInfo.pWaitDstStageMask = t_WaitStages.data();
 
 	t_CommandBufferSubmitInfo.commandBufferCount = 1;
 	t_CommandBufferSubmitInfo.pCommandBuffers = &m_CommandBuffers[m_CurrentFrame];
 
-	VkSemaphore t_SignalSemaphores[] = {m_RenderFinishedSemaphores[m_CurrentFrame]};
-	t_CommandBufferSubmitInfo.signalSemaphoreCount = 1;
-	t_CommandBufferSubmitInfo.pSignalSemaphores = t_SignalSemaphores;
+	// headless frames are not presented, the graphics timeline alone tracks them
+	FrameVector<VkSemaphore> t_SignalSemaphores = m_FrameArena.MakeVector<VkSemaphore>();
+	FrameVector<uint64_t> t_SignalValues = m_FrameArena.MakeVector<uint64_t>();
 
-	if (vkQueueSubmit(m_GraphicsQueue, 1, &t_CommandBufferSubmitInfo, m_InFlightFences[m_CurrentFrame]) != VK_SUCCESS)
+	if (!m_Headless)
 	{
-		throw std::runtime_error("Could not submit Draw Command VertexBuffer!");
+		t_SignalSemaphores.push_back(m_RenderFinishedSemaphores[m_CurrentFrame]);
+		t_SignalValues.push_back(0);
+	}
+
+	m_FrameExporter.AddSignal(t_SignalSemaphores, t_SignalValues);
+
+	t_CommandBufferSubmitInfo.signalSemaphoreCount = static_cast<uint32_t>(t_SignalSemaphores.size());
+	t_CommandBufferSubmitInfo.pSignalSemaphores = t_SignalSemaphores.data();
+
+	m_FrameTimelineValues[m_CurrentFrame] = t_Timeline.Submit(m_GraphicsQueue, t_CommandBufferSubmitInfo,
+	                                                          t_WaitValues.data(), t_SignalValues.data());
+	m_FrameCapture.SetSubmitValue(m_FrameTimelineValues[m_CurrentFrame]);
+	m_FrameExporter.SetSubmitValue(m_FrameTimelineValues[m_CurrentFrame]);
+
+	if (m_Headless)
+	{
+		m_CurrentFrame = (m_CurrentFrame + 1) % m_MaxInFlightFrames;
+		return;
 	}
 
 	VkPresentInfoKHR t_PresentInfo = {};
 	t_PresentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 	t_PresentInfo.waitSemaphoreCount = 1;
-	t_PresentInfo.pWaitSemaphores = t_SignalSemaphores;
+	t_PresentInfo.pWaitSemaphores = &m_RenderFinishedSemaphores[m_CurrentFrame];
 
 	VkSwapchainKHR t_SwapChains[] = {m_SwapChain.GetSwapChain()};
 	t_PresentInfo.swapchainCount = 1;
@@ -143,7 +283,7 @@ void VRenderer::Render(Camera& a_Camera)
 	t_PresentInfo.pImageIndices = &t_ImageIndex;
 	t_PresentInfo.pResults = nullptr;
 
-	t_Result = vkQueuePresentKHR(m_PresentQueue, &t_PresentInfo);
+	const VkResult t_Result = vkQueuePresentKHR(m_PresentQueue, &t_PresentInfo);
 
 	// recreate swap chain?
 	if (t_Result == VK_ERROR_OUT_OF_DATE_KHR || t_Result == VK_SUBOPTIMAL_KHR || m_FrameBufferResized)
@@ -161,7 +301,40 @@ void VRenderer::Render(Camera& a_Camera)
 
 bool VRenderer::ShouldTerminate() const
 {
-	return glfwWindowShouldClose(m_Window);
+	// headless rendering has no window to close, the caller decides how many frames to render
+	return !m_Headless && glfwWindowShouldClose(m_Window);
+}
+
+bool VRenderer::IsHeadless() const
+{
+	return m_Headless;
+}
+
+void VRenderer::ReadbackFrame(std::vector<uint8_t>& a_Pixels, const uint32_t a_FramesAgo)
+{
+	if (!m_Headless)
+	{
+		throw std::runtime_error("Error! Frames can only be read back in headless mode!");
+	}
+
+	if (a_FramesAgo >= static_cast<uint32_t>(m_MaxInFlightFrames))
+	{
+		throw std::runtime_error("Error! The frame to read back is no longer in flight!");
+	}
+
+	// the frame rendered last is the one before the current frame in flight
+	const uint32_t t_Frame = (m_CurrentFrame + 2 * m_MaxInFlightFrames - 1 - a_FramesAgo) % m_MaxInFlightFrames;
+
+	if (m_FrameTimelineValues[t_Frame] == 0)
+	{
+		throw std::runtime_error("Error! No frame has been rendered yet!");
+	}
+
+	m_Device.GetGraphicsTimeline().Wait(m_Device.GetLogicalDevice(), m_FrameTimelineValues[t_Frame]);
+
+	const VkExtent2D t_Extent = m_SwapChain.GetExtent();
+	a_Pixels.resize(static_cast<size_t>(t_Extent.width) * t_Extent.height * 4);
+	m_ReadbackBuffers[t_Frame].Read(a_Pixels.data(), a_Pixels.size());
 }
 
 glm::ivec2 VRenderer::GetWindowExtent()
@@ -170,36 +343,420 @@ glm::ivec2 VRenderer::GetWindowExtent()
 	return {t_SwapExtent.width, t_SwapExtent.height};
 }
 
+void VRenderer::SetRenderSettings(const RenderSettings& a_RenderSettings)
+{
+	// make sure none of the resources about to be rebuilt are still in use
+	vkDeviceWaitIdle(m_Device.GetLogicalDevice());
+
+	DestroyRenderTargets();
+	vkDestroyPipelineLayout(m_Device.GetLogicalDevice(), m_PipelineLayout, nullptr);
+	m_DeferredLighting.DestroyPipeline(m_Device.GetLogicalDevice());
+	vkDestroyRenderPass(m_Device.GetLogicalDevice(), m_MainRenderPass, nullptr);
+	m_PrepassGraph.Destroy(m_Device.GetLogicalDevice());
+	m_PostProcessGraph.Destroy(m_Device.GetLogicalDevice());
+
+	ApplyRenderSettings(a_RenderSettings);
+
+	// the render pass attachments depend on the sample count, the anti-aliasing mode and the shading path, so everything
+	// referencing it is rebuilt
+	CreateRenderPass();
+	CreateGraphicsPipeline();
+	CreateRenderTargets();
+}
+
+const RenderSettings& VRenderer::GetRenderSettings() const
+{
+	return m_RenderSettings;
+}
+
+void VRenderer::SetJobSystemSettings(const JobSystemSettings& a_Settings)
+{
+	m_JobSystemSettings = a_Settings;
+
+	// jobs only run within a frame's CPU work, between frames the workers can be replaced safely
+	if (m_JobSystem.IsRunning())
+	{
+		m_JobSystem.Start(m_JobSystemSettings);
+	}
+}
+
+JobSystem& VRenderer::GetJobSystem()
+{
+	return m_JobSystem;
+}
+
+LinearArena& VRenderer::GetFrameArena()
+{
+	return m_FrameArena.GetCurrent();
+}
+
+float VRenderer::GetRenderScale() const
+{
+	return UsesOffscreenTarget() ? m_DynamicResolution.GetScale() : 1.0f;
+}
+
+float VRenderer::GetGpuFrameTime() const
+{
+	return m_GpuFrameTime;
+}
+
+const BindStatistics& VRenderer::GetUnsortedBindStatistics() const
+{
+	return m_UnsortedBindStatistics;
+}
+
+const BindStatistics& VRenderer::GetBindStatistics() const
+{
+	return m_CommandEncoder.GetStatistics();
+}
+
+void VRenderer::DumpOcclusionBuffer(const std::string& a_FilePath) const
+{
+	m_SoftwareOcclusionCuller.WriteDepthImage(a_FilePath);
+}
+
+void VRenderer::SetPointLights(const std::vector<PointLight>& a_Lights)
+{
+	if (a_Lights.size() > m_MaxLights)
+	{
+		throw std::runtime_error("Error! Too many point lights!");
+	}
+
+	m_PointLights = a_Lights;
+}
+
+void VRenderer::SetAmbientLight(const glm::vec3& a_Ambient)
+{
+	m_AmbientLight = a_Ambient;
+}
+
+std::optional<uint32_t> VRenderer::PickInstance(const Camera& a_Camera, const glm::vec2& a_ViewPosition) const
+{
+	// a point on the far plane under the position, normalized device coordinates have y up before
+	// the flip applied for rendering
+	const glm::mat4 t_InverseViewProjection = glm::inverse(a_Camera.GetUnjitteredProjectionMat() * a_Camera.GetViewMat());
+	const glm::vec4 t_FarPoint = t_InverseViewProjection * glm::vec4(a_ViewPosition.x * 2.0f - 1.0f,
+	                                                                 1.0f - a_ViewPosition.y * 2.0f, 1.0f, 1.0f);
+
+	BvhRay t_Ray;
+	t_Ray.m_Origin = a_Camera.GetPosition();
+	t_Ray.m_Direction = glm::normalize(glm::vec3(t_FarPoint) / t_FarPoint.w - t_Ray.m_Origin);
+
+	// the transforms of destroyed renderables stay in the hierarchy until they are reused
+	const auto t_IsRenderable = [this](uint32_t, const uint32_t a_Object, float&)
+	{
+		return m_Entities.IsAlive(m_TransformEntities[a_Object]);
+	};
+
+	BvhRayHit t_Hit;
+	if (!m_SceneBvh.Raycast(t_Ray, t_Hit, t_IsRenderable))
+	{
+		return std::nullopt;
+	}
+
+	return t_Hit.m_Object;
+}
+
+const SceneBvh& VRenderer::GetSceneBvh() const
+{
+	return m_SceneBvh;
+}
+
+void VRenderer::ResetTemporalHistory()
+{
+	m_TemporalAA.ResetHistory();
+}
+
+void VRenderer::StartCapture(const std::string& a_FilePath, const CaptureFormat a_Format, const uint32_t a_FrameRate)
+{
+	if (!(m_SwapChain.GetUsage() & VK_IMAGE_USAGE_TRANSFER_SRC_BIT))
+	{
+		throw std::runtime_error("Error! The swap chain images do not support being copied for frame capture!");
+	}
+
+	// one slot per frame in flight plus a few frames of slack for the writer
+	m_FrameCapture.Start(m_Device, m_SwapChain.GetExtent(), m_SwapChain.GetFormat(), a_FilePath, a_Format, a_FrameRate,
+	                     m_MaxInFlightFrames + 4);
+}
+
+void VRenderer::StopCapture()
+{
+	m_FrameCapture.Stop(m_Device);
+}
+
+bool VRenderer::IsCapturing() const
+{
+	return m_FrameCapture.IsCapturing();
+}
+
+uint64_t VRenderer::GetDroppedCaptureFrames() const
+{
+	return m_FrameCapture.GetDroppedFrames();
+}
+
+void VRenderer::StartFrameExport(const std::string& a_Name, const FrameExportMode a_PreferredMode)
+{
+	if (!(m_SwapChain.GetUsage() & VK_IMAGE_USAGE_TRANSFER_SRC_BIT))
+	{
+		throw std::runtime_error("Error! The swap chain images do not support being copied for frame export!");
+	}
+
+	// a slot is only reused once the frame last written to it has finished
+	m_FrameExporter.Create(m_Device, m_SwapChain.GetExtent(), m_SwapChain.GetFormat(), a_Name, m_MaxInFlightFrames + 1,
+	                       a_PreferredMode);
+}
+
+void VRenderer::StopFrameExport()
+{
+	vkDeviceWaitIdle(m_Device.GetLogicalDevice());
+	m_FrameExporter.Destroy(m_Device);
+}
+
+FrameExportMode VRenderer::GetFrameExportMode() const
+{
+	return m_FrameExporter.GetMode();
+}
+
+int VRenderer::ExportFrameMemoryFd() const
+{
+	return m_FrameExporter.ExportMemoryFd(m_Device);
+}
+
+int VRenderer::ExportFrameSemaphoreFd() const
+{
+	return m_FrameExporter.ExportSemaphoreFd(m_Device);
+}
+
+void VRenderer::DeferDestruction(std::function<void()> a_Destroy)
+{
+	m_DeferredDestruction.Push(m_Device.GetGraphicsTimeline().GetLastSubmittedValue(), std::move(a_Destroy));
+}
+
+ResourceHandle<GpuMesh> VRenderer::CreateMesh(const Mesh& a_Mesh)
+{
+	GpuMesh t_GpuMesh;
+	t_GpuMesh.m_VertexBuffer.CreateVertexBuffer(a_Mesh.m_Vertices, m_Device, m_GraphicsQueue, m_CommandPool);
+	t_GpuMesh.m_IndexBuffer.CreateIndexBuffer(a_Mesh.m_Indices, m_Device, m_GraphicsQueue, m_CommandPool);
+	t_GpuMesh.m_IndexCount = static_cast<uint32_t>(a_Mesh.m_Indices.size());
+
+	for (const Vertex& t_Vertex : a_Mesh.m_Vertices)
+	{
+		t_GpuMesh.m_Bounds.Grow(t_Vertex.m_Position);
+	}
+
+	return m_Meshes.Insert(std::move(t_GpuMesh));
+}
+
+void VRenderer::DestroyMesh(const ResourceHandle<GpuMesh> a_Mesh)
+{
+	m_Meshes.Release(a_Mesh);
+}
+
+uint32_t VRenderer::RegisterTexture(const Texture& a_Texture)
+{
+	return m_TextureTable.Register(m_Device.GetLogicalDevice(), a_Texture.GetImageView());
+}
+
+void VRenderer::ReleaseTexture(const uint32_t a_TextureIndex)
+{
+	m_TextureTable.Release(a_TextureIndex, m_Device.GetGraphicsTimeline().GetLastSubmittedValue());
+}
+
+Entity VRenderer::CreateRenderable(const ResourceHandle<GpuMesh> a_Mesh, const uint32_t a_TextureIndex,
+                                   const glm::vec3& a_Position, const glm::quat& a_Rotation, const glm::vec3& a_Scale,
+                                   const Mesh* a_Occluder)
+{
+	if (!m_Meshes.IsValid(a_Mesh))
+	{
+		throw std::runtime_error("Error! Created a renderable with a stale Mesh handle!");
+	}
+
+	const GpuMesh& t_Mesh = m_Meshes.Get(a_Mesh);
+
+	// the bounds are moved to world space with the next transform update
+	uint32_t t_Transform;
+	if (!m_FreeTransforms.empty())
+	{
+		t_Transform = m_FreeTransforms.back();
+		m_FreeTransforms.pop_back();
+
+		m_Transforms.Teleport(t_Transform, a_Position, a_Rotation, a_Scale);
+		m_SceneBvh.SetBounds(t_Transform, t_Mesh.m_Bounds);
+	}
+	else
+	{
+		// the instance buffers hold one slot per transform
+		if (m_Transforms.GetCount() == m_MaxInstances)
+		{
+			throw std::runtime_error("Error! Too many renderables for the instance buffers!");
+		}
+
+		t_Transform = m_Transforms.Create(a_Position, a_Rotation, a_Scale);
+		m_SceneBvh.Insert(t_Mesh.m_Bounds);
+		m_TransformEntities.emplace_back();
+	}
+
+	const TransformComponent t_TransformComponent = {t_Transform};
+	const MeshComponent t_MeshComponent = {a_Mesh, t_Mesh.m_IndexCount, 0, 0};
+	const MaterialComponent t_MaterialComponent = {a_TextureIndex};
+	const BoundsComponent t_BoundsComponent = {t_Mesh.m_Bounds, t_Mesh.m_Bounds};
+
+	Entity t_Entity;
+	if (a_Occluder)
+	{
+		t_Entity = m_Entities.Create(t_TransformComponent, WorldMatrixComponent{}, t_MeshComponent,
+		                             t_MaterialComponent, t_BoundsComponent, VisibilityComponent{},
+		                             OccluderComponent{a_Occluder});
+	}
+	else
+	{
+		t_Entity = m_Entities.Create(t_TransformComponent, WorldMatrixComponent{}, t_MeshComponent,
+		                             t_MaterialComponent, t_BoundsComponent, VisibilityComponent{});
+	}
+
+	m_TransformEntities[t_Transform] = t_Entity;
+	return t_Entity;
+}
+
+void VRenderer::DestroyRenderable(const Entity a_Entity)
+{
+	const uint32_t t_Transform = GetRenderableTransform(a_Entity);
+	m_Entities.Destroy(a_Entity);
+
+	m_TransformEntities[t_Transform] = {};
+	m_FreeTransforms.push_back(t_Transform);
+}
+
+uint32_t VRenderer::GetRenderableTransform(const Entity a_Entity)
+{
+	return m_Entities.Get<TransformComponent>(a_Entity).m_Transform;
+}
+
+TransformStore& VRenderer::GetTransforms()
+{
+	return m_Transforms;
+}
+
+void VRenderer::SetRenderableTransform(const Entity a_Entity, const glm::mat4& a_Transform)
+{
+	const uint32_t t_Transform = GetRenderableTransform(a_Entity);
+
+	// the columns of the upper 3x3 are the scaled axes, a mirroring matrix flips one of them
+	glm::vec3 t_Scale = {glm::length(a_Transform[0]), glm::length(a_Transform[1]), glm::length(a_Transform[2])};
+	if (glm::determinant(glm::mat3(a_Transform)) < 0.0f)
+	{
+		t_Scale.x = -t_Scale.x;
+	}
+
+	const glm::mat3 t_Rotation = {
+		glm::vec3(a_Transform[0]) / t_Scale.x, glm::vec3(a_Transform[1]) / t_Scale.y,
+		glm::vec3(a_Transform[2]) / t_Scale.z
+	};
+
+	m_Transforms.Teleport(t_Transform, glm::vec3(a_Transform[3]), glm::normalize(glm::quat_cast(t_Rotation)), t_Scale);
+}
+
+Entity VRenderer::GetTestModel() const
+{
+	return m_TestModelEntity;
+}
+
+void VRenderer::CreateResourcePools()
+{
+	const VkDevice t_LogicalDevice = m_Device.GetLogicalDevice();
+	const auto t_Defer = [this](std::function<void()> a_Destroy)
+	{
+		DeferDestruction(std::move(a_Destroy));
+	};
+
+	m_Meshes.Create([t_LogicalDevice](GpuMesh& a_Mesh)
+	{
+		a_Mesh.m_VertexBuffer.DestroyBuffer(t_LogicalDevice);
+		a_Mesh.m_IndexBuffer.DestroyBuffer(t_LogicalDevice);
+	}, t_Defer);
+
+	m_Pipelines.Create([t_LogicalDevice](VkPipeline& a_Pipeline)
+	{
+		vkDestroyPipeline(t_LogicalDevice, a_Pipeline, nullptr);
+	}, t_Defer);
+}
+
 void VRenderer::InitVulkan()
 {
+	m_JobSystem.Start(m_JobSystemSettings);
+	m_FrameArena.Create(m_MaxInFlightFrames);
+
 	CreateInstance();
-	CreateWindowSurface();
+
+	// without a surface the device is selected without requiring present support
+	if (!m_Headless)
+	{
+		CreateWindowSurface();
+	}
 
 	m_Device.ChoosePhysicalDevice(m_VInstance, m_WindowSurface, m_RequestedDeviceExtensions);
+	ApplyRenderSettings(m_RenderSettings);
 	m_Device.CreateLogicalDevice(m_WindowSurface, m_GraphicsQueue, m_PresentQueue, m_RequestedDeviceExtensions,
 	                             m_EnabledValidationLayers);
 
-	m_SwapChain.Create(m_Device, m_WindowSurface, m_Window);
-	m_SwapChain.CreateImageViews(m_Device.GetLogicalDevice());
+	if (m_Headless)
+	{
+		m_SwapChain.CreateHeadless(m_Device, m_HeadlessExtent, m_MaxInFlightFrames, s_HeadlessFormat);
+
+		m_ReadbackBuffers.resize(m_MaxInFlightFrames);
+		for (ReadbackBuffer& t_ReadbackBuffer : m_ReadbackBuffers)
+		{
+			t_ReadbackBuffer.CreateReadbackBuffer(
+				m_Device, static_cast<VkDeviceSize>(m_HeadlessExtent.width) * m_HeadlessExtent.height * 4);
+		}
+	}
+	else
+	{
+		m_SwapChain.Create(m_Device, m_WindowSurface, m_Window);
+		m_SwapChain.CreateImageViews(m_Device.GetLogicalDevice());
+	}
+
+	// the passes below get their descriptor sets from the allocator
+	m_DescriptorAllocator.Create(m_MaxInFlightFrames);
+
+	m_TemporalAA.Create(m_Device);
+	m_SpatialUpscaler.Create(m_Device);
+	m_OcclusionCuller.Create(m_Device, m_MaxInstances, m_MaxInFlightFrames);
+	m_SoftwareOcclusionCuller.Resize(s_SoftwareOcclusionWidth, s_SoftwareOcclusionHeight);
+	m_LightCuller.Create(m_Device, m_DescriptorAllocator, m_MaxLights, m_MaxInFlightFrames);
+	m_AsyncCompute.Create(m_Device, m_MaxInFlightFrames);
+	m_DeferredLighting.Create(m_Device);
+	m_GpuTimer.Create(m_Device, m_MaxInFlightFrames);
 	CreateRenderPass();
 	m_DescriptorSetLayout = UniformBuffer::CreateDescriptorSetLayout(m_Device.GetLogicalDevice());
+	m_TextureTable.Create(m_Device, 4096);
+	CreateResourcePools();
 	CreateGraphicsPipeline();
 
-	CreateColorResources();
-	CreateDepthResources();
-	CreateFrameBuffers();
+	CreateRenderTargets();
 
 	CreateCommandPool();
 
 	m_TestModel.Load("../vRenderer/assets/models/pomegranate.obj", "../vRenderer/assets/textures/pomegranate.jpg",
-	                 m_Device, m_CommandPool, m_GraphicsQueue);
+	                 m_Device, m_CommandPool, m_GraphicsQueue, &m_JobSystem);
+	m_TestModel.SetTextureIndex(m_TextureTable.Register(m_Device.GetLogicalDevice(),
+	                                                    m_TestModel.GetTexture().GetImageView()));
+
+	m_Transforms.Clear();
+	m_SceneBvh.Clear();
+	m_Entities.Clear();
+	m_TransformEntities.clear();
+	m_FreeTransforms.clear();
+
+	// the test model is the first renderable, so it is drawn as instance 0
+	m_TestMesh = UniqueResource<GpuMesh>(&m_Meshes, CreateMesh(m_TestModel.GetMesh()));
+	m_TestModelEntity = CreateRenderable(m_TestMesh.GetHandle(), m_TestModel.GetTextureIndex(), glm::vec3(0.0f),
+	                                     glm::angleAxis(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f)), glm::vec3(3.0f),
+	                                     m_TestModel.IsOccluder() ? &m_TestModel.GetMesh() : nullptr);
 
-	m_VertexBuffer.CreateVertexBuffer(m_TestModel.GetMesh().m_Vertices, m_Device, m_GraphicsQueue, m_CommandPool);
-	m_IndexBuffer.CreateIndexBuffer(m_TestModel.GetMesh().m_Indices, m_Device, m_GraphicsQueue, m_CommandPool);
 	CreateUniformBuffers();
-	m_DescriptorPool = CreateDescriptorPool(m_MaxInFlightFrames, m_Device.GetLogicalDevice());
-	CreateDescriptorSets(m_MaxInFlightFrames, m_Device.GetLogicalDevice(), m_DescriptorSetLayout, m_DescriptorPool,
-	                     m_DescriptorSets);
+	CreateInstanceBuffers();
+	CreateDescriptorSets();
 	
 	CreateCommandBuffers();
 	CreateSyncObjects();
@@ -314,7 +871,7 @@ void VRenderer::GenInstanceCreateData(const bool a_ValidationEnabled, InstanceCr
 	t_ApplicationInfo.applicationVersion = VK_MAKE_VERSION(1,0,0);
 	t_ApplicationInfo.pEngineName = "No Engine";
 	t_ApplicationInfo.engineVersion = VK_MAKE_VERSION(1,0,0);
-	t_ApplicationInfo.apiVersion = VK_API_VERSION_1_0;
+	t_ApplicationInfo.apiVersion = VK_API_VERSION_1_2;
 	t_ApplicationInfo.pNext = VK_NULL_HANDLE;
 
 	// make instance create info from application info
@@ -322,15 +879,24 @@ void VRenderer::GenInstanceCreateData(const bool a_ValidationEnabled, InstanceCr
 	t_InstanceDesc.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 	t_InstanceDesc.pApplicationInfo = &t_ApplicationInfo;
 
-	// get the extensions GLFW needs and pass it to the instance
-	uint32_t t_GlfwExtensionCount = 0;
-	const char** t_GlfwExtensions = glfwGetRequiredInstanceExtensions(&t_GlfwExtensionCount);
+	// headless rendering creates no surface and needs no instance extensions
+	if (m_Headless)
+	{
+		t_InstanceDesc.enabledExtensionCount = 0;
+		t_InstanceDesc.ppEnabledExtensionNames = nullptr;
+	}
+	else
+	{
+		// get the extensions GLFW needs and pass it to the instance
+		uint32_t t_GlfwExtensionCount = 0;
+		const char** t_GlfwExtensions = glfwGetRequiredInstanceExtensions(&t_GlfwExtensionCount);
 
-	// check whether the extensions required by GLFW are available
-	CheckExtensionSupport(t_GlfwExtensionCount, t_GlfwExtensions);
+		// check whether the extensions required by GLFW are available
+		CheckExtensionSupport(t_GlfwExtensionCount, t_GlfwExtensions);
 
-	t_InstanceDesc.enabledExtensionCount = t_GlfwExtensionCount;
-	t_InstanceDesc.ppEnabledExtensionNames = t_GlfwExtensions;
+		t_InstanceDesc.enabledExtensionCount = t_GlfwExtensionCount;
+		t_InstanceDesc.ppEnabledExtensionNames = t_GlfwExtensions;
+	}
 
 	// if validation is enabled, add validation information to instance create info
 	if (a_ValidationEnabled)
@@ -418,7 +984,10 @@ void VRenderer::CreateGraphicsPipeline()
 
 	// generate Shader modules
 	const auto t_VertexShaderByteCode = ReadFile("../vRenderer/assets/shaders/compiled/vertex_shader.spv");
-	const auto t_FragmentShaderByteCode = ReadFile("../vRenderer/assets/shaders/compiled/fragment_shader.spv");
+	// the deferred path uses the same fragment shader compiled to write the G-buffer
+	const auto t_FragmentShaderByteCode = ReadFile(UsesDeferredShading()
+		                                               ? "../vRenderer/assets/shaders/compiled/gbuffer.spv"
+		                                               : "../vRenderer/assets/shaders/compiled/fragment_shader.spv");
 
 	const VkShaderModule t_VertexShader = GenShaderModule(t_VertexShaderByteCode);
 	const VkShaderModule t_FragmentShader = GenShaderModule(t_FragmentShaderByteCode);
@@ -451,9 +1020,21 @@ void VRenderer::CreateGraphicsPipeline()
 
 	VkPipelineDynamicStateCreateInfo t_DynamicStateCreateInfo = GenDynamicStateCreateInfo(t_DynStates);
 
-	// create VertexInputStateCreateInfo
-	VkVertexInputBindingDescription t_BindingDesc = Vertex::GenInputBindingDesc();
-	std::array<VkVertexInputAttributeDescription, 3> t_AttributeDesc = Vertex::GenInputAttributeDesc();
+	// create VertexInputStateCreateInfo, binding 0 holds the vertices and binding 1 the per-instance data
+	const std::vector<VkVertexInputBindingDescription> t_BindingDesc = {
+		Vertex::GenInputBindingDesc(), InstanceData::GenInputBindingDesc()
+	};
+
+	std::vector<VkVertexInputAttributeDescription> t_AttributeDesc;
+	for (const VkVertexInputAttributeDescription& t_Attribute : Vertex::GenInputAttributeDesc())
+	{
+		t_AttributeDesc.push_back(t_Attribute);
+	}
+	for (const VkVertexInputAttributeDescription& t_Attribute : InstanceData::GenInputAttributeDesc())
+	{
+		t_AttributeDesc.push_back(t_Attribute);
+	}
+
 	VkPipelineVertexInputStateCreateInfo t_VertexInputStateCreateInfo = GenVertexInputStateCreateInfo(t_BindingDesc, t_AttributeDesc);
 
 	// generate Input Assembly stage
@@ -474,18 +1055,27 @@ void VRenderer::CreateGraphicsPipeline()
 	VkPipelineRasterizationStateCreateInfo t_RasterizationStateCreateInfo = GenRasterizationStateCreateInfo();
 
 	// generate Multisampling State Create Info
-	VkPipelineMultisampleStateCreateInfo t_MultisampleState = GenMultisamplingStateCreateInfo(m_Device.GetMSAASampleCount());
+	VkPipelineMultisampleStateCreateInfo t_MultisampleState = GenMultisamplingStateCreateInfo(
+		m_Device.GetMSAASampleCount(), m_RenderSettings.m_MinSampleShading);
 
 
-	// generate ColorBlendAttachementState CreateInfo
-	VkPipelineColorBlendAttachmentState t_ColorBlendAttachementState = GenColorBlendAttachStateCreateInfo();
+	// generate ColorBlendAttachementState CreateInfo, TAA additionally writes the velocity attachment and
+	// the G-buffer consists of albedo and normal
+	const std::array<VkPipelineColorBlendAttachmentState, 2> t_ColorBlendAttachementStates = {
+		GenColorBlendAttachStateCreateInfo(), GenColorBlendAttachStateCreateInfo()
+	};
 
 	// generate ColorBlendState CreateInfo
-	VkPipelineColorBlendStateCreateInfo t_ColorBlendStateCreateInfo = GenColorBlendStateCreateInfo(t_ColorBlendAttachementState);
+	VkPipelineColorBlendStateCreateInfo t_ColorBlendStateCreateInfo = GenColorBlendStateCreateInfo(
+		t_ColorBlendAttachementStates.data(), UsesTAA() || UsesDeferredShading() ? 2 : 1);
 
 
-	// generate Pipeline Layout
-	VkPipelineLayoutCreateInfo t_PipelineLayoutCreateInfo = GenPipelineCreateInfo(1, &m_DescriptorSetLayout);
+	// generate Pipeline Layout, set 0 holds the per-frame uniform buffer and set 1 the bindless texture table
+	const std::array<VkDescriptorSetLayout, 3> t_SetLayouts = {
+		m_DescriptorSetLayout, m_TextureTable.GetDescriptorSetLayout(), m_LightCuller.GetDescriptorSetLayout()
+	};
+	VkPipelineLayoutCreateInfo t_PipelineLayoutCreateInfo = GenPipelineCreateInfo(
+		static_cast<int>(t_SetLayouts.size()), t_SetLayouts.data());
 
 	if (vkCreatePipelineLayout(m_Device.GetLogicalDevice(), &t_PipelineLayoutCreateInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS)
 	{
@@ -497,7 +1087,8 @@ void VRenderer::CreateGraphicsPipeline()
 	t_DepthStencilCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 	t_DepthStencilCreateInfo.depthTestEnable = VK_TRUE;
 	t_DepthStencilCreateInfo.depthWriteEnable = VK_TRUE;
-	t_DepthStencilCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;
+	// equal depths pass so the main pass can draw over the depth prepass
+	t_DepthStencilCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
 	t_DepthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;
 	t_DepthStencilCreateInfo.minDepthBounds = 0.0f;
 	t_DepthStencilCreateInfo.maxDepthBounds = 1.0f;
@@ -532,12 +1123,48 @@ void VRenderer::CreateGraphicsPipeline()
 	t_PipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
 	t_PipelineCreateInfo.basePipelineIndex = -1;
 
-	if (vkCreateGraphicsPipelines(m_Device.GetLogicalDevice(), VK_NULL_HANDLE, 1, &t_PipelineCreateInfo, nullptr, &m_GraphicsPipeline) 
+	VkPipeline t_GraphicsPipeline;
+	if (vkCreateGraphicsPipelines(m_Device.GetLogicalDevice(), VK_NULL_HANDLE, 1, &t_PipelineCreateInfo, nullptr, &t_GraphicsPipeline) 
 		!= VK_SUCCESS)
 	{
 		throw std::runtime_error("Unable to create Graphics Pipeline!");
 	}
 
+	// replacing a pipeline releases the previous one
+	m_GraphicsPipeline = m_Pipelines.InsertUnique(t_GraphicsPipeline);
+
+	// the depth prepass shares the vertex stage and fixed function state, without fragment shading
+	// and color outputs. It is only drawn with GPU occlusion culling
+	if (UsesGpuOcclusionCulling())
+	{
+		t_DepthStencilCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;
+		t_MultisampleState.sampleShadingEnable = VK_FALSE;
+		t_MultisampleState.minSampleShading = 0.0f;
+
+		t_PipelineCreateInfo.stageCount = 1;
+		t_PipelineCreateInfo.pColorBlendState = nullptr;
+		t_PipelineCreateInfo.renderPass = m_PrepassGraph.GetRenderPass(m_DepthPrepass);
+
+		VkPipeline t_DepthPrepassPipeline;
+		if (vkCreateGraphicsPipelines(m_Device.GetLogicalDevice(), VK_NULL_HANDLE, 1, &t_PipelineCreateInfo, nullptr,
+		                              &t_DepthPrepassPipeline) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Unable to create depth prepass Pipeline!");
+		}
+
+		m_DepthPrepassPipeline = m_Pipelines.InsertUnique(t_DepthPrepassPipeline);
+	}
+	else
+	{
+		m_DepthPrepassPipeline.Reset();
+	}
+
+
+	// the lighting subpass reads the light lists as set 1
+	if (UsesDeferredShading())
+	{
+		m_DeferredLighting.CreatePipeline(m_Device, m_MainRenderPass, m_LightCuller.GetDescriptorSetLayout());
+	}
 
 	//destroy Shader modules as they are no longer needed
 	vkDestroyShaderModule(m_Device.GetLogicalDevice(), t_VertexShader, nullptr);
@@ -551,18 +1178,7 @@ void VRenderer::CreateGraphicsPipeline()
 
 VkShaderModule VRenderer::GenShaderModule(const std::vector<char>& a_CodeData)
 {
-	VkShaderModuleCreateInfo t_ShaderModuleCreateInfo = {};
-	t_ShaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-	t_ShaderModuleCreateInfo.codeSize = a_CodeData.size();
-	t_ShaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t*>(a_CodeData.data());
-
-	VkShaderModule t_Module;
-	if (vkCreateShaderModule(m_Device.GetLogicalDevice(), &t_ShaderModuleCreateInfo, nullptr, &t_Module) != VK_SUCCESS)
-	{
-		throw std::runtime_error("Could not create Shader Module!");
-	}
-
-	return t_Module;
+	return CreateShaderModule(a_CodeData, m_Device.GetLogicalDevice());
 }
 
 /// <summary>	Creates a render pass. </summary>
@@ -570,11 +1186,42 @@ VkShaderModule VRenderer::GenShaderModule(const std::vector<char>& a_CodeData)
 
 void VRenderer::CreateRenderPass()
 {
+	// the depth prepass renders into the same depth buffer and the post-processing reads the main pass'
+	// targets, so the render graphs depend on the sample count and anti-aliasing mode as well
+	CreateRenderGraphs();
+
+	if (UsesTAA())
+	{
+		CreateTemporalAARenderPass();
+		return;
+	}
+
+	if (UsesDeferredShading())
+	{
+		CreateDeferredRenderPass();
+		return;
+	}
+
+	// without MSAA the output image is rendered to directly and no resolve attachment is needed
+	const bool t_Resolve = UsesMSAAResolve();
+
+	// the offscreen target is upscaled or copied to the swap chain after the render pass, the swap chain is presented
+	VkImageLayout t_OutputLayout = GetPresentLayout();
+
+	if (UsesSpatialUpscaler())
+	{
+		t_OutputLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	}
+	else if (UsesOffscreenTarget())
+	{
+		t_OutputLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	}
+
 	// color buffer attachment
 	VkAttachmentDescription t_ColorAttachement = {};
-	t_ColorAttachement.format = m_SwapChain.GetFormat();
+	t_ColorAttachement.format = GetOutputFormat();
 
-	// set to maximum physical device-supported MSAA samples
+	// set to the MSAA sample count selected in the render settings
 	t_ColorAttachement.samples = m_Device.GetMSAASampleCount();
 
 	// clear the framebuffer before drawing a new frame
@@ -588,7 +1235,7 @@ void VRenderer::CreateRenderPass()
 
 	// specify the layout of the image before and after the render pass finishes
 	t_ColorAttachement.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	t_ColorAttachement.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	t_ColorAttachement.finalLayout = t_Resolve ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : t_OutputLayout;
 
 
 	// Depth Buffer Attachment
@@ -602,68 +1249,637 @@ void VRenderer::CreateRenderPass()
 	t_DepthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 	t_DepthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
+	// with occlusion culling the depth prepass has already filled the depth buffer
+	if (UsesGpuOcclusionCulling())
+	{
+		t_DepthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+		t_DepthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+	}
+
 	// resolve attachment
 	VkAttachmentDescription t_ColorResolveAttachment = {};
-	t_ColorResolveAttachment.format = m_SwapChain.GetFormat();
+	t_ColorResolveAttachment.format = GetOutputFormat();
 	t_ColorResolveAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
 	t_ColorResolveAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	t_ColorResolveAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	// the resolved image is presented, so its contents have to be stored
+	t_ColorResolveAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 	t_ColorResolveAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	t_ColorResolveAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	t_ColorResolveAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	t_ColorResolveAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	t_ColorResolveAttachment.finalLayout = t_OutputLayout;
 
 	// attachment references
 	VkAttachmentReference t_ColorAttachmentReference;
 	t_ColorAttachmentReference.attachment = 0;
 	t_ColorAttachmentReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
-	VkAttachmentReference t_DepthAttachmentReference;
-	t_DepthAttachmentReference.attachment = 1;
-	t_DepthAttachmentReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	VkAttachmentReference t_DepthAttachmentReference;
+	t_DepthAttachmentReference.attachment = 1;
+	t_DepthAttachmentReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	VkAttachmentReference t_ColorResolveAttachmentReference;
+	t_ColorResolveAttachmentReference.attachment = 2;
+	t_ColorResolveAttachmentReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+
+	// sub-passes
+	VkSubpassDescription t_SubpassDescription = {};
+
+	// describe this as a Graphics pass (and not a Compute pass)
+	t_SubpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+	t_SubpassDescription.colorAttachmentCount = 1;
+	t_SubpassDescription.pColorAttachments = &t_ColorAttachmentReference;
+	t_SubpassDescription.pDepthStencilAttachment = &t_DepthAttachmentReference;
+	t_SubpassDescription.pResolveAttachments = t_Resolve ? &t_ColorResolveAttachmentReference : nullptr;
+
+	// handle sub-pass dependencies
+	std::vector<VkSubpassDependency> t_SubpassDependencies(1);
+	VkSubpassDependency& t_SubpassDependency = t_SubpassDependencies[0];
+	t_SubpassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+	t_SubpassDependency.dstSubpass = 0;
+	t_SubpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	t_SubpassDependency.srcAccessMask = 0;
+	t_SubpassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	t_SubpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	if (UsesGpuOcclusionCulling())
+	{
+		// the depth prepass has to be written and the pyramid build done reading it
+		t_SubpassDependency.srcStageMask |= VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		t_SubpassDependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		t_SubpassDependency.dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+	}
+
+	if (UsesOffscreenTarget())
+	{
+		// the upscale or copy of the previous frame has to finish reading the offscreen target before
+		// it is overwritten, and the one of this frame has to wait for it to be written
+		const VkPipelineStageFlags t_ReadStage = UsesSpatialUpscaler()
+			                                         ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+			                                         : VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+		t_SubpassDependency.srcStageMask |= t_ReadStage;
+
+		VkSubpassDependency t_OutgoingDependency = {};
+		t_OutgoingDependency.srcSubpass = 0;
+		t_OutgoingDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+		t_OutgoingDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		t_OutgoingDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		t_OutgoingDependency.dstStageMask = t_ReadStage;
+		t_OutgoingDependency.dstAccessMask = UsesSpatialUpscaler() ? VK_ACCESS_SHADER_READ_BIT : VK_ACCESS_TRANSFER_READ_BIT;
+
+		t_SubpassDependencies.push_back(t_OutgoingDependency);
+	}
+
+	// create render pass
+	std::vector<VkAttachmentDescription> t_AttachmentDescriptions = {t_ColorAttachement, t_DepthAttachment};
+
+	if (t_Resolve)
+	{
+		t_AttachmentDescriptions.push_back(t_ColorResolveAttachment);
+	}
+
+	VkRenderPassCreateInfo t_RenderPassCreateInfo = {};
+	t_RenderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	t_RenderPassCreateInfo.attachmentCount = static_cast<uint32_t>(t_AttachmentDescriptions.size());
+	t_RenderPassCreateInfo.pAttachments = t_AttachmentDescriptions.data();
+	t_RenderPassCreateInfo.subpassCount = 1;
+	t_RenderPassCreateInfo.pSubpasses = &t_SubpassDescription;
+	t_RenderPassCreateInfo.dependencyCount = static_cast<uint32_t>(t_SubpassDependencies.size());
+	t_RenderPassCreateInfo.pDependencies = t_SubpassDependencies.data();
+
+	if (vkCreateRenderPass(m_Device.GetLogicalDevice(), &t_RenderPassCreateInfo, nullptr, &m_MainRenderPass) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Could not create Renderpass!");
+	}
+}
+
+void VRenderer::CreateTemporalAARenderPass()
+{
+	// scene color, read by the resolve pass
+	VkAttachmentDescription t_ColorAttachment = {};
+	t_ColorAttachment.format = TemporalAA::s_ColorFormat;
+	t_ColorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	t_ColorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	t_ColorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	t_ColorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	t_ColorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	t_ColorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	t_ColorAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	// Depth Buffer Attachment
+	VkAttachmentDescription t_DepthAttachment = {};
+	t_DepthAttachment.format = FindDepthFormat(m_Device.GetPhysicalDevice());
+	t_DepthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	t_DepthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	t_DepthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	t_DepthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	t_DepthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	t_DepthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	t_DepthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	// with occlusion culling the depth prepass has already filled the depth buffer
+	if (UsesGpuOcclusionCulling())
+	{
+		t_DepthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+		t_DepthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+	}
+
+	// velocity, read by the resolve pass to reproject the history
+	VkAttachmentDescription t_VelocityAttachment = t_ColorAttachment;
+	t_VelocityAttachment.format = TemporalAA::s_VelocityFormat;
+
+	// attachment references
+	std::array<VkAttachmentReference, 2> t_ColorAttachmentReferences = {};
+	t_ColorAttachmentReferences[0].attachment = 0;
+	t_ColorAttachmentReferences[0].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	t_ColorAttachmentReferences[1].attachment = 2;
+	t_ColorAttachmentReferences[1].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkAttachmentReference t_DepthAttachmentReference;
+	t_DepthAttachmentReference.attachment = 1;
+	t_DepthAttachmentReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	// sub-passes
+	VkSubpassDescription t_SubpassDescription = {};
+	t_SubpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	t_SubpassDescription.colorAttachmentCount = static_cast<uint32_t>(t_ColorAttachmentReferences.size());
+	t_SubpassDescription.pColorAttachments = t_ColorAttachmentReferences.data();
+	t_SubpassDescription.pDepthStencilAttachment = &t_DepthAttachmentReference;
+
+	// the previous resolve pass has to finish reading the targets before they are overwritten,
+	// and the next resolve pass has to wait for them to be written
+	std::array<VkSubpassDependency, 2> t_SubpassDependencies = {};
+	t_SubpassDependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+	t_SubpassDependencies[0].dstSubpass = 0;
+	t_SubpassDependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+		VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	t_SubpassDependencies[0].srcAccessMask = 0;
+	t_SubpassDependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	t_SubpassDependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	if (UsesGpuOcclusionCulling())
+	{
+		// the depth prepass has to be written and the pyramid build done reading it
+		t_SubpassDependencies[0].srcStageMask |= VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		t_SubpassDependencies[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		t_SubpassDependencies[0].dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+	}
+
+	t_SubpassDependencies[1].srcSubpass = 0;
+	t_SubpassDependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+	t_SubpassDependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	t_SubpassDependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	t_SubpassDependencies[1].dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	t_SubpassDependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	// create render pass
+	const std::array<VkAttachmentDescription, 3> t_AttachmentDescriptions = {
+		t_ColorAttachment, t_DepthAttachment, t_VelocityAttachment
+	};
+
+	VkRenderPassCreateInfo t_RenderPassCreateInfo = {};
+	t_RenderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	t_RenderPassCreateInfo.attachmentCount = static_cast<uint32_t>(t_AttachmentDescriptions.size());
+	t_RenderPassCreateInfo.pAttachments = t_AttachmentDescriptions.data();
+	t_RenderPassCreateInfo.subpassCount = 1;
+	t_RenderPassCreateInfo.pSubpasses = &t_SubpassDescription;
+	t_RenderPassCreateInfo.dependencyCount = static_cast<uint32_t>(t_SubpassDependencies.size());
+	t_RenderPassCreateInfo.pDependencies = t_SubpassDependencies.data();
+
+	if (vkCreateRenderPass(m_Device.GetLogicalDevice(), &t_RenderPassCreateInfo, nullptr, &m_MainRenderPass) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Could not create TAA Renderpass!");
+	}
+}
+
+void VRenderer::CreateDeferredRenderPass()
+{
+	// the offscreen target is upscaled or copied to the swap chain after the render pass, the swap chain is presented
+	VkImageLayout t_OutputLayout = GetPresentLayout();
+
+	if (UsesSpatialUpscaler())
+	{
+		t_OutputLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	}
+	else if (UsesOffscreenTarget())
+	{
+		t_OutputLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	}
+
+	// lit output, only written by the lighting subpass
+	VkAttachmentDescription t_OutputAttachment = {};
+	t_OutputAttachment.format = GetOutputFormat();
+	t_OutputAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	t_OutputAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	t_OutputAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	t_OutputAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	t_OutputAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	t_OutputAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	t_OutputAttachment.finalLayout = t_OutputLayout;
+
+	// Depth Buffer Attachment, read by the lighting subpass to reconstruct positions
+	VkAttachmentDescription t_DepthAttachment = {};
+	t_DepthAttachment.format = FindDepthFormat(m_Device.GetPhysicalDevice());
+	t_DepthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	t_DepthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	t_DepthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	t_DepthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	t_DepthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	t_DepthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	t_DepthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+	// with occlusion culling the depth prepass has already filled the depth buffer
+	if (UsesGpuOcclusionCulling())
+	{
+		t_DepthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+		t_DepthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+	}
+
+	// G-buffer, cleared and discarded within the render pass so it can stay in tile memory
+	VkAttachmentDescription t_AlbedoAttachment = {};
+	t_AlbedoAttachment.format = DeferredLighting::s_AlbedoFormat;
+	t_AlbedoAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	t_AlbedoAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	t_AlbedoAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	t_AlbedoAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	t_AlbedoAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	t_AlbedoAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	t_AlbedoAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	VkAttachmentDescription t_NormalAttachment = t_AlbedoAttachment;
+	t_NormalAttachment.format = DeferredLighting::s_NormalFormat;
+
+	// attachment references, the G-buffer subpass writes albedo and normal
+	std::array<VkAttachmentReference, 2> t_GBufferReferences = {};
+	t_GBufferReferences[0].attachment = 2;
+	t_GBufferReferences[0].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	t_GBufferReferences[1].attachment = 3;
+	t_GBufferReferences[1].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkAttachmentReference t_DepthAttachmentReference;
+	t_DepthAttachmentReference.attachment = 1;
+	t_DepthAttachmentReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	VkAttachmentReference t_OutputAttachmentReference;
+	t_OutputAttachmentReference.attachment = 0;
+	t_OutputAttachmentReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	// the order has to match the input attachment indices in deferred_lighting.frag
+	std::array<VkAttachmentReference, 3> t_InputReferences = {};
+	t_InputReferences[0].attachment = 2;
+	t_InputReferences[0].layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	t_InputReferences[1].attachment = 3;
+	t_InputReferences[1].layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	t_InputReferences[2].attachment = 1;
+	t_InputReferences[2].layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+	// sub-passes
+	std::array<VkSubpassDescription, 2> t_SubpassDescriptions = {};
+	t_SubpassDescriptions[0].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	t_SubpassDescriptions[0].colorAttachmentCount = static_cast<uint32_t>(t_GBufferReferences.size());
+	t_SubpassDescriptions[0].pColorAttachments = t_GBufferReferences.data();
+	t_SubpassDescriptions[0].pDepthStencilAttachment = &t_DepthAttachmentReference;
+
+	t_SubpassDescriptions[1].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	t_SubpassDescriptions[1].colorAttachmentCount = 1;
+	t_SubpassDescriptions[1].pColorAttachments = &t_OutputAttachmentReference;
+	t_SubpassDescriptions[1].inputAttachmentCount = static_cast<uint32_t>(t_InputReferences.size());
+	t_SubpassDescriptions[1].pInputAttachments = t_InputReferences.data();
+
+	// the upscale or copy of the previous frame has to finish reading the offscreen target before
+	// it is overwritten, and the one of this frame has to wait for it to be written
+	const VkPipelineStageFlags t_ReadStage = UsesSpatialUpscaler()
+		                                         ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+		                                         : VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+	// handle sub-pass dependencies
+	std::vector<VkSubpassDependency> t_SubpassDependencies(3);
+
+	VkSubpassDependency& t_GBufferDependency = t_SubpassDependencies[0];
+	t_GBufferDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+	t_GBufferDependency.dstSubpass = 0;
+	t_GBufferDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	t_GBufferDependency.srcAccessMask = 0;
+	t_GBufferDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	t_GBufferDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	if (UsesGpuOcclusionCulling())
+	{
+		// the depth prepass has to be written and the pyramid build done reading it
+		t_GBufferDependency.srcStageMask |= VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		t_GBufferDependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		t_GBufferDependency.dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+	}
+
+	// the output is first used by the lighting subpass, its layout transition has to wait for the
+	// swap chain image to be acquired or the offscreen target to be read
+	VkSubpassDependency& t_OutputDependency = t_SubpassDependencies[1];
+	t_OutputDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+	t_OutputDependency.dstSubpass = 1;
+	t_OutputDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	t_OutputDependency.srcAccessMask = 0;
+	t_OutputDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	t_OutputDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+	// each pixel is lit from the G-buffer texels at the same position, so the dependency is by region
+	// and the G-buffer does not have to leave tile memory between the subpasses
+	VkSubpassDependency& t_LightingDependency = t_SubpassDependencies[2];
+	t_LightingDependency.srcSubpass = 0;
+	t_LightingDependency.dstSubpass = 1;
+	t_LightingDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	t_LightingDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	t_LightingDependency.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	t_LightingDependency.dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+	t_LightingDependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+	if (UsesOffscreenTarget())
+	{
+		t_OutputDependency.srcStageMask |= t_ReadStage;
+
+		VkSubpassDependency t_OutgoingDependency = {};
+		t_OutgoingDependency.srcSubpass = 1;
+		t_OutgoingDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+		t_OutgoingDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		t_OutgoingDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		t_OutgoingDependency.dstStageMask = t_ReadStage;
+		t_OutgoingDependency.dstAccessMask = UsesSpatialUpscaler() ? VK_ACCESS_SHADER_READ_BIT : VK_ACCESS_TRANSFER_READ_BIT;
+
+		t_SubpassDependencies.push_back(t_OutgoingDependency);
+	}
+
+	// create render pass
+	const std::array<VkAttachmentDescription, 4> t_AttachmentDescriptions = {
+		t_OutputAttachment, t_DepthAttachment, t_AlbedoAttachment, t_NormalAttachment
+	};
+
+	VkRenderPassCreateInfo t_RenderPassCreateInfo = {};
+	t_RenderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	t_RenderPassCreateInfo.attachmentCount = static_cast<uint32_t>(t_AttachmentDescriptions.size());
+	t_RenderPassCreateInfo.pAttachments = t_AttachmentDescriptions.data();
+	t_RenderPassCreateInfo.subpassCount = static_cast<uint32_t>(t_SubpassDescriptions.size());
+	t_RenderPassCreateInfo.pSubpasses = t_SubpassDescriptions.data();
+	t_RenderPassCreateInfo.dependencyCount = static_cast<uint32_t>(t_SubpassDependencies.size());
+	t_RenderPassCreateInfo.pDependencies = t_SubpassDependencies.data();
+
+	if (vkCreateRenderPass(m_Device.GetLogicalDevice(), &t_RenderPassCreateInfo, nullptr, &m_MainRenderPass) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Could not create deferred Renderpass!");
+	}
+}
+
+void VRenderer::CreateRenderGraphs()
+{
+	m_GraphResources = {};
+
+	// cull last frame's visible instances, draw them into the depth buffer and cull all instances
+	// against the pyramid built from it
+	if (UsesGpuOcclusionCulling())
+	{
+		const VkFormat t_DepthFormat = FindDepthFormat(m_Device.GetPhysicalDevice());
+
+		TransientImageDesc t_DepthDescription = {};
+		t_DepthDescription.m_Format = t_DepthFormat;
+		t_DepthDescription.m_Extent = m_SwapChain.GetExtent();
+		t_DepthDescription.m_Aspect = HasStencilComponent(t_DepthFormat)
+			                              ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT
+			                              : VK_IMAGE_ASPECT_DEPTH_BIT;
+		t_DepthDescription.m_Samples = m_Device.GetMSAASampleCount();
+
+		TransientImageDesc t_PyramidDescription = {};
+		t_PyramidDescription.m_Format = OcclusionCuller::s_Format;
+		t_PyramidDescription.m_Extent = m_SwapChain.GetExtent();
+
+		// the main pass loads the depth buffer, the pyramid is rebuilt every frame
+		m_GraphResources.m_Depth = m_PrepassGraph.ImportImage("Depth", VK_NULL_HANDLE, VK_NULL_HANDLE, t_DepthDescription,
+		                                                      VK_IMAGE_LAYOUT_UNDEFINED,
+		                                                      VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
+		m_GraphResources.m_Pyramid = m_PrepassGraph.ImportImage("Hi-Z pyramid", VK_NULL_HANDLE, VK_NULL_HANDLE,
+		                                                        t_PyramidDescription, VK_IMAGE_LAYOUT_UNDEFINED,
+		                                                        VK_IMAGE_LAYOUT_UNDEFINED);
+		m_GraphResources.m_Visibility = m_PrepassGraph.ImportBuffer("Visibility", m_OcclusionCuller.GetVisibilityBuffer());
+		m_GraphResources.m_PrepassDraws = m_PrepassGraph.ImportBuffer("Prepass draws",
+		                                                              m_OcclusionCuller.GetPrepassDrawBuffer());
+		m_GraphResources.m_Draws = m_PrepassGraph.ImportBuffer("Draws", m_OcclusionCuller.GetDrawBuffer());
+
+		const RenderGraphPass t_ResetPass = m_PrepassGraph.AddPass(
+			"Visibility reset", PassType::Transfer, [this](VkCommandBuffer a_CommandBuffer)
+			{
+				m_OcclusionCuller.RecordVisibilityReset(a_CommandBuffer);
+			});
+		m_PrepassGraph.Write(t_ResetPass, m_GraphResources.m_Visibility, ResourceUsage::TransferDestination);
+
+		// the first phase only reads the visibility, it is declared written to run before the second phase
+		const RenderGraphPass t_PrepassCulling = m_PrepassGraph.AddPass(
+			"Prepass culling", PassType::Compute, [this](VkCommandBuffer a_CommandBuffer)
+			{
+				m_OcclusionCuller.RecordPrepassCulling(a_CommandBuffer, m_CurrentFrame, m_ViewProjection);
+			});
+		m_PrepassGraph.Write(t_PrepassCulling, m_GraphResources.m_Visibility, ResourceUsage::StorageReadWriteCompute);
+		m_PrepassGraph.Write(t_PrepassCulling, m_GraphResources.m_PrepassDraws, ResourceUsage::StorageWriteCompute);
+
+		VkClearValue t_DepthClearValue = {};
+		t_DepthClearValue.depthStencil = {1.0f, 0};
+
+		m_DepthPrepass = m_PrepassGraph.AddPass("Depth prepass", PassType::Graphics, [this](VkCommandBuffer a_CommandBuffer)
+		{
+			const VkExtent2D t_RenderExtent = GetRenderExtent();
+
+			m_CommandEncoder.Begin(a_CommandBuffer);
+			m_CommandEncoder.SetViewport(GenViewportData(t_RenderExtent));
+			m_CommandEncoder.SetScissor({{0, 0}, t_RenderExtent});
+			m_DepthPrepassQueue.Record(m_CommandEncoder);
+		});
+		m_PrepassGraph.Write(m_DepthPrepass, m_GraphResources.m_Depth, ResourceUsage::DepthAttachment,
+		                     VK_ATTACHMENT_LOAD_OP_CLEAR, t_DepthClearValue);
+		m_PrepassGraph.Read(m_DepthPrepass, m_GraphResources.m_PrepassDraws, ResourceUsage::IndirectRead);
+
+		const RenderGraphPass t_PyramidBuild = m_PrepassGraph.AddPass(
+			"Hi-Z build", PassType::Compute, [this](VkCommandBuffer a_CommandBuffer)
+			{
+				m_OcclusionCuller.RecordPyramidBuild(a_CommandBuffer, GetRenderExtent());
+			});
+		m_PrepassGraph.Read(t_PyramidBuild, m_GraphResources.m_Depth, ResourceUsage::DepthSampledCompute);
+		m_PrepassGraph.Write(t_PyramidBuild, m_GraphResources.m_Pyramid, ResourceUsage::StorageWriteCompute);
+
+		const RenderGraphPass t_OcclusionCulling = m_PrepassGraph.AddPass(
+			"Occlusion culling", PassType::Compute, [this](VkCommandBuffer a_CommandBuffer)
+			{
+				m_OcclusionCuller.RecordOcclusionCulling(a_CommandBuffer, m_CurrentFrame, m_ViewProjection,
+				                                         GetRenderExtent());
+			});
+		m_PrepassGraph.Read(t_OcclusionCulling, m_GraphResources.m_Pyramid, ResourceUsage::StorageReadCompute);
+		m_PrepassGraph.Write(t_OcclusionCulling, m_GraphResources.m_Visibility, ResourceUsage::StorageReadWriteCompute);
+		m_PrepassGraph.Write(t_OcclusionCulling, m_GraphResources.m_Draws, ResourceUsage::StorageWriteCompute);
+
+		m_PrepassGraph.Compile(m_Device);
+	}
+
+	if (!UsesTAA() && !UsesOffscreenTarget())
+	{
+		return;
+	}
+
+	// the frame is resolved, upscaled or copied into the swap chain image acquired this frame
+	TransientImageDesc t_SwapChainDescription = {};
+	t_SwapChainDescription.m_Format = m_SwapChain.GetFormat();
+	t_SwapChainDescription.m_Extent = m_SwapChain.GetExtent();
+
+	m_GraphResources.m_SwapChain = m_PostProcessGraph.ImportImage("Swap chain", VK_NULL_HANDLE, VK_NULL_HANDLE,
+	                                                              t_SwapChainDescription, VK_IMAGE_LAYOUT_UNDEFINED,
+	                                                              GetPresentLayout());
+
+	if (UsesTAA())
+	{
+		TransientImageDesc t_ColorDescription = {};
+		t_ColorDescription.m_Format = TemporalAA::s_ColorFormat;
+		t_ColorDescription.m_Extent = m_SwapChain.GetExtent();
+
+		TransientImageDesc t_VelocityDescription = t_ColorDescription;
+		t_VelocityDescription.m_Format = TemporalAA::s_VelocityFormat;
+
+		// the main pass leaves its targets readable, the history written this frame is read by the next
+		// resolve. The previous history's initial layout is set every frame
+		m_GraphResources.m_SceneColor = m_PostProcessGraph.ImportImage(
+			"Scene color", VK_NULL_HANDLE, VK_NULL_HANDLE, t_ColorDescription,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_UNDEFINED);
+		m_GraphResources.m_Velocity = m_PostProcessGraph.ImportImage(
+			"Velocity", VK_NULL_HANDLE, VK_NULL_HANDLE, t_VelocityDescription,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_UNDEFINED);
+		m_GraphResources.m_History = m_PostProcessGraph.ImportImage(
+			"History", VK_NULL_HANDLE, VK_NULL_HANDLE, t_ColorDescription,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		m_GraphResources.m_PreviousHistory = m_PostProcessGraph.ImportImage(
+			"Previous history", VK_NULL_HANDLE, VK_NULL_HANDLE, t_ColorDescription,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+		const RenderGraphPass t_Resolve = m_PostProcessGraph.AddPass(
+			"TAA resolve", PassType::Compute, [this](VkCommandBuffer a_CommandBuffer)
+			{
+				m_TemporalAA.Resolve(m_Device.GetLogicalDevice(), m_DescriptorAllocator, a_CommandBuffer);
+			});
+		m_PostProcessGraph.Read(t_Resolve, m_GraphResources.m_SceneColor, ResourceUsage::SampledCompute);
+		m_PostProcessGraph.Read(t_Resolve, m_GraphResources.m_Velocity, ResourceUsage::SampledCompute);
+		m_PostProcessGraph.Read(t_Resolve, m_GraphResources.m_PreviousHistory, ResourceUsage::SampledCompute);
+		m_PostProcessGraph.Write(t_Resolve, m_GraphResources.m_History, ResourceUsage::StorageWriteCompute);
+
+		const RenderGraphPass t_Copy = m_PostProcessGraph.AddPass(
+			"TAA copy", PassType::Transfer, [this](VkCommandBuffer a_CommandBuffer)
+			{
+				m_TemporalAA.CopyToSwapChain(a_CommandBuffer, m_PostProcessGraph.GetImage(m_GraphResources.m_SwapChain),
+				                             m_SwapChain.GetExtent());
+			});
+		m_PostProcessGraph.Read(t_Copy, m_GraphResources.m_History, ResourceUsage::TransferSource);
+		m_PostProcessGraph.Write(t_Copy, m_GraphResources.m_SwapChain, ResourceUsage::TransferDestination);
+	}
+
+	if (UsesSpatialUpscaler())
+	{
+		TransientImageDesc t_OffscreenDescription = {};
+		t_OffscreenDescription.m_Format = m_OffscreenFormat;
+		t_OffscreenDescription.m_Extent = m_SwapChain.GetExtent();
+
+		TransientImageDesc t_UpscaledDescription = t_OffscreenDescription;
+		t_UpscaledDescription.m_Format = SpatialUpscaler::s_Format;
+
+		// the main pass leaves the offscreen target readable, the upscaler's targets are rewritten every frame
+		m_GraphResources.m_Offscreen = m_PostProcessGraph.ImportImage(
+			"Offscreen", VK_NULL_HANDLE, VK_NULL_HANDLE, t_OffscreenDescription,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_UNDEFINED);
+		m_GraphResources.m_Upscaled = m_PostProcessGraph.ImportImage(
+			"Upscaled", VK_NULL_HANDLE, VK_NULL_HANDLE, t_UpscaledDescription,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED);
+		m_GraphResources.m_UpscalerOutput = m_PostProcessGraph.ImportImage(
+			"Upscaler output", VK_NULL_HANDLE, VK_NULL_HANDLE, t_UpscaledDescription,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED);
+
+		const RenderGraphPass t_Easu = m_PostProcessGraph.AddPass(
+			"EASU", PassType::Compute, [this](VkCommandBuffer a_CommandBuffer)
+			{
+				m_SpatialUpscaler.Upscale(m_Device.GetLogicalDevice(), m_DescriptorAllocator, a_CommandBuffer,
+				                          GetRenderExtent());
+			});
+		m_PostProcessGraph.Read(t_Easu, m_GraphResources.m_Offscreen, ResourceUsage::SampledCompute);
+		m_PostProcessGraph.Write(t_Easu, m_GraphResources.m_Upscaled, ResourceUsage::StorageWriteCompute);
+
+		const RenderGraphPass t_Rcas = m_PostProcessGraph.AddPass(
+			"RCAS", PassType::Compute, [this](VkCommandBuffer a_CommandBuffer)
+			{
+				m_SpatialUpscaler.Sharpen(m_Device.GetLogicalDevice(), m_DescriptorAllocator, a_CommandBuffer,
+				                          m_RenderSettings.m_Sharpness);
+			});
+		m_PostProcessGraph.Read(t_Rcas, m_GraphResources.m_Upscaled, ResourceUsage::StorageReadCompute);
+		m_PostProcessGraph.Write(t_Rcas, m_GraphResources.m_UpscalerOutput, ResourceUsage::StorageWriteCompute);
+
+		const RenderGraphPass t_Copy = m_PostProcessGraph.AddPass(
+			"Upscale copy", PassType::Transfer, [this](VkCommandBuffer a_CommandBuffer)
+			{
+				m_SpatialUpscaler.CopyToSwapChain(a_CommandBuffer,
+				                                  m_PostProcessGraph.GetImage(m_GraphResources.m_SwapChain));
+			});
+		m_PostProcessGraph.Read(t_Copy, m_GraphResources.m_UpscalerOutput, ResourceUsage::TransferSource);
+		m_PostProcessGraph.Write(t_Copy, m_GraphResources.m_SwapChain, ResourceUsage::TransferDestination);
+	}
+	else if (UsesOffscreenTarget())
+	{
+		TransientImageDesc t_OffscreenDescription = {};
+		t_OffscreenDescription.m_Format = m_OffscreenFormat;
+		t_OffscreenDescription.m_Extent = m_SwapChain.GetExtent();
 
-	VkAttachmentReference t_ColorResolveAttachmentReference;
-	t_ColorResolveAttachmentReference.attachment = 2;
-	t_ColorResolveAttachmentReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		// the main pass leaves the offscreen target in the transfer source layout
+		m_GraphResources.m_Offscreen = m_PostProcessGraph.ImportImage(
+			"Offscreen", VK_NULL_HANDLE, VK_NULL_HANDLE, t_OffscreenDescription,
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_UNDEFINED);
 
+		const RenderGraphPass t_Copy = m_PostProcessGraph.AddPass(
+			"Offscreen copy", PassType::Transfer, [this](VkCommandBuffer a_CommandBuffer)
+			{
+				BlitToSwapChain(a_CommandBuffer, m_PostProcessGraph.GetImage(m_GraphResources.m_SwapChain));
+			});
+		m_PostProcessGraph.Read(t_Copy, m_GraphResources.m_Offscreen, ResourceUsage::TransferSource);
+		m_PostProcessGraph.Write(t_Copy, m_GraphResources.m_SwapChain, ResourceUsage::TransferDestination);
+	}
 
-	// sub-passes
-	VkSubpassDescription t_SubpassDescription = {};
+	m_PostProcessGraph.Compile(m_Device);
+}
 
-	// describe this as a Graphics pass (and not a Compute pass)
-	t_SubpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+void VRenderer::BindRenderGraphImages()
+{
+	const VkExtent2D t_Extent = m_SwapChain.GetExtent();
 
-	t_SubpassDescription.colorAttachmentCount = 1;
-	t_SubpassDescription.pColorAttachments = &t_ColorAttachmentReference;
-	t_SubpassDescription.pDepthStencilAttachment = &t_DepthAttachmentReference;
-	t_SubpassDescription.pResolveAttachments = &t_ColorResolveAttachmentReference;
+	if (UsesGpuOcclusionCulling())
+	{
+		const Image& t_Pyramid = m_OcclusionCuller.GetPyramid();
 
-	// handle sub-pass dependencies
-	VkSubpassDependency t_SubpassDependency = {};
-	t_SubpassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-	t_SubpassDependency.dstSubpass = 0;
-	t_SubpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-	t_SubpassDependency.srcAccessMask = 0;
-	t_SubpassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-	t_SubpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		m_PrepassGraph.UpdateImportedImage(m_GraphResources.m_Depth, m_DepthImage.GetImage(),
+		                                   m_DepthImage.GetImageView(), t_Extent);
+		m_PrepassGraph.UpdateImportedImage(m_GraphResources.m_Pyramid, t_Pyramid.GetImage(), t_Pyramid.GetImageView(),
+		                                   t_Extent);
+	}
 
-	// create render pass
-	std::array<VkAttachmentDescription, 3> t_AttachmentDescriptions = {
-		t_ColorAttachement, t_DepthAttachment, t_ColorResolveAttachment
-	};
+	// the swap chain image and the TAA histories change every frame and are bound when recording
+	if (UsesTAA())
+	{
+		m_PostProcessGraph.UpdateImportedImage(m_GraphResources.m_SceneColor, m_TemporalAA.GetSceneColor().GetImage(),
+		                                       m_TemporalAA.GetSceneColor().GetImageView(), t_Extent);
+		m_PostProcessGraph.UpdateImportedImage(m_GraphResources.m_Velocity, m_TemporalAA.GetVelocity().GetImage(),
+		                                       m_TemporalAA.GetVelocity().GetImageView(), t_Extent);
+	}
 
-	VkRenderPassCreateInfo t_RenderPassCreateInfo = {};
-	t_RenderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-	t_RenderPassCreateInfo.attachmentCount = static_cast<uint32_t>(t_AttachmentDescriptions.size());
-	t_RenderPassCreateInfo.pAttachments = t_AttachmentDescriptions.data();
-	t_RenderPassCreateInfo.subpassCount = 1;
-	t_RenderPassCreateInfo.pSubpasses = &t_SubpassDescription;
-	t_RenderPassCreateInfo.dependencyCount = 1;
-	t_RenderPassCreateInfo.pDependencies = &t_SubpassDependency;
+	if (UsesOffscreenTarget())
+	{
+		m_PostProcessGraph.UpdateImportedImage(m_GraphResources.m_Offscreen, m_OffscreenImage.GetImage(),
+		                                       m_OffscreenImage.GetImageView(), t_Extent);
+	}
 
-	if (vkCreateRenderPass(m_Device.GetLogicalDevice(), &t_RenderPassCreateInfo, nullptr, &m_MainRenderPass) != VK_SUCCESS)
+	if (UsesSpatialUpscaler())
 	{
-		throw std::runtime_error("Could not create Renderpass!");
+		m_PostProcessGraph.UpdateImportedImage(m_GraphResources.m_Upscaled, m_SpatialUpscaler.GetUpscaled().GetImage(),
+		                                       m_SpatialUpscaler.GetUpscaled().GetImageView(), t_Extent);
+		m_PostProcessGraph.UpdateImportedImage(m_GraphResources.m_UpscalerOutput,
+		                                       m_SpatialUpscaler.GetOutput().GetImage(),
+		                                       m_SpatialUpscaler.GetOutput().GetImageView(), t_Extent);
 	}
 }
 
@@ -672,18 +1888,42 @@ void VRenderer::CreateFrameBuffers()
 	// resize Framebuffers vector to be able to hold one frame buffer per swap chain image
 	m_Framebuffers.resize(m_SwapChain.GetImageViews().size());
 
-	std::vector<VkImageView> t_SwapChainImageViews = m_SwapChain.GetImageViews();
+	const std::vector<VkImageView>& t_SwapChainImageViews = m_SwapChain.GetImageViews();
 	const VkExtent2D t_SwapChainExtent = m_SwapChain.GetExtent();
 
 	// iterate over the SwapChainImageViews vector and create a frame buffer per image
 	for (size_t i = 0; i < t_SwapChainImageViews.size(); i++)
 	{
-		const std::array<VkImageView, 3> t_Attachments = 
+		// attachment order has to match the render pass: MSAA color, depth, resolve target,
+		// scene color, depth, velocity for TAA, output color, depth, albedo, normal for deferred shading
+		// or output color, depth when rendering without MSAA
+		std::vector<VkImageView> t_Attachments;
+
+		// the output is either the swap chain image or the offscreen target used for dynamic resolution
+		const VkImageView t_OutputView = UsesOffscreenTarget() ? m_OffscreenImage.GetImageView() : t_SwapChainImageViews[i];
+
+		if (UsesTAA())
+		{
+			t_Attachments = {
+				m_TemporalAA.GetSceneColor().GetImageView(), m_DepthImage.GetImageView(),
+				m_TemporalAA.GetVelocity().GetImageView()
+			};
+		}
+		else if (UsesDeferredShading())
+		{
+			t_Attachments = {
+				t_OutputView, m_DepthImage.GetImageView(), m_DeferredLighting.GetAlbedo().GetImageView(),
+				m_DeferredLighting.GetNormal().GetImageView()
+			};
+		}
+		else if (UsesMSAAResolve())
+		{
+			t_Attachments = {m_ColorImage.GetImageView(), m_DepthImage.GetImageView(), t_OutputView};
+		}
+		else
 		{
-			m_ColorImage.GetImageView(),
-			m_DepthImage.GetImageView(),
-			t_SwapChainImageViews[i]
-		};
+			t_Attachments = {t_OutputView, m_DepthImage.GetImageView()};
+		}
 
 		VkFramebufferCreateInfo t_BufferCreateInfo = {};
 		t_BufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
@@ -756,6 +1996,39 @@ void VRenderer::RecordCommandBuffer(VkCommandBuffer a_CommandBuffer, uint32_t a_
 		throw std::runtime_error("Could not begin recording the Command VertexBuffer!");
 	}
 
+	m_GpuTimer.Begin(m_CommandBuffers[m_CurrentFrame], m_CurrentFrame);
+
+	// with dynamic resolution only the top left part of the offscreen target is rendered to
+	const VkExtent2D t_RenderExtent = GetRenderExtent();
+
+	// TODO store this somewhere for reuse
+	// Set Viewport
+	VkViewport t_Viewport = {};
+	t_Viewport.x = 0.0f;
+	t_Viewport.y = 0.0f;
+	t_Viewport.width = static_cast<float>(t_RenderExtent.width);
+	t_Viewport.height = static_cast<float>(t_RenderExtent.height);
+	t_Viewport.minDepth = 0.0f;
+	t_Viewport.maxDepth = 1.0f;
+
+	// TODO store this somewhere for reuse
+	// Set Scissors
+	VkRect2D t_Scissor = {};
+	t_Scissor.offset = {0,0};
+	t_Scissor.extent = t_RenderExtent;
+
+	// without a separate compute queue the scheduled compute work runs before the main pass
+	if (!m_Device.HasAsyncCompute())
+	{
+		m_AsyncCompute.RecordInline(m_CommandBuffers[m_CurrentFrame]);
+	}
+
+	// draw last frame's visible instances into the depth buffer and cull all instances against it
+	if (UsesGpuOcclusionCulling())
+	{
+		m_PrepassGraph.SetRenderArea(m_DepthPrepass, t_RenderExtent);
+		m_PrepassGraph.Execute(m_CommandBuffers[m_CurrentFrame]);
+	}
 
 	// start render pass
 	VkRenderPassBeginInfo t_RenderPassBeginInfo = {};
@@ -763,13 +2036,14 @@ void VRenderer::RecordCommandBuffer(VkCommandBuffer a_CommandBuffer, uint32_t a_
 	t_RenderPassBeginInfo.renderPass = m_MainRenderPass;
 	t_RenderPassBeginInfo.framebuffer = m_Framebuffers[a_ImageIndex];
 	t_RenderPassBeginInfo.renderArea.offset = {0,0};
-	t_RenderPassBeginInfo.renderArea.extent = m_SwapChain.GetExtent();
+	t_RenderPassBeginInfo.renderArea.extent = t_RenderExtent;
 
 	// clear values
-	std::array<VkClearValue, 3> t_ClearValues = {};
+	std::array<VkClearValue, 4> t_ClearValues = {};
 	t_ClearValues[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
 	t_ClearValues[1].depthStencil = { 1.0f, 0 };
 	t_ClearValues[2].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+	t_ClearValues[3].color = {{0.0f, 0.0f, 0.0f, 0.0f}};
 
 	t_RenderPassBeginInfo.clearValueCount = static_cast<uint32_t>(t_ClearValues.size());
 	t_RenderPassBeginInfo.pClearValues = t_ClearValues.data();
@@ -777,49 +2051,72 @@ void VRenderer::RecordCommandBuffer(VkCommandBuffer a_CommandBuffer, uint32_t a_
 	// begin render pass
 	vkCmdBeginRenderPass(m_CommandBuffers[m_CurrentFrame], &t_RenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-	// Bind graphics pipeline
-	vkCmdBindPipeline(m_CommandBuffers[m_CurrentFrame], VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline);
+	// binds are issued through the encoder, which skips the ones the previous draw already made
+	m_CommandEncoder.Begin(m_CommandBuffers[m_CurrentFrame]);
+	m_CommandEncoder.SetViewport(t_Viewport);
+	m_CommandEncoder.SetScissor(t_Scissor);
 
-	// Bind Vertex VertexBuffer
-	const VkBuffer t_VertexBuffers[] = {m_VertexBuffer.GetBuffer()};
-	const VkDeviceSize t_Offsets[] = {0};
-	vkCmdBindVertexBuffers(m_CommandBuffers[m_CurrentFrame], 0, 1, t_VertexBuffers, t_Offsets);
+	// Draw
+	m_DrawQueue.Record(m_CommandEncoder);
 
-	// Bind Index Buffer
-	vkCmdBindIndexBuffer(m_CommandBuffers[m_CurrentFrame], m_IndexBuffer.GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
+	// light the G-buffer in the second subpass, the frame is rendered without jitter so the view
+	// projection matches the depth buffer
+	if (UsesDeferredShading())
+	{
+		m_DeferredLighting.RecordLighting(m_CommandBuffers[m_CurrentFrame], m_LightCuller.GetDescriptorSet(m_CurrentFrame),
+		                                  glm::inverse(m_ViewProjection), t_RenderExtent);
+	}
 
-	const VkExtent2D t_SwapChainExtent = m_SwapChain.GetExtent();
 
-	// TODO store this somewhere for reuse
-	// Set Viewport
-	VkViewport t_Viewport = {};
-	t_Viewport.x = 0.0f;
-	t_Viewport.y = 0.0f;
-	t_Viewport.width = static_cast<float>(t_SwapChainExtent.width);
-	t_Viewport.height = static_cast<float>(t_SwapChainExtent.height);
-	t_Viewport.minDepth = 0.0f;
-	t_Viewport.maxDepth = 1.0f;
+	// end render pass
+	vkCmdEndRenderPass(m_CommandBuffers[m_CurrentFrame]);
 
-	vkCmdSetViewport(m_CommandBuffers[m_CurrentFrame], 0, 1, &t_Viewport);
+	// resolve the jittered frame, upscale or copy the offscreen target into the swap chain image
+	if (UsesTAA() || UsesOffscreenTarget())
+	{
+		m_PostProcessGraph.UpdateImportedImage(m_GraphResources.m_SwapChain, m_SwapChain.GetImages()[a_ImageIndex],
+		                                       m_SwapChain.GetImageViews()[a_ImageIndex], m_SwapChain.GetExtent());
 
-	// TODO store this somewhere for reuse
-	// Set Scissors
-	VkRect2D t_Scissor = {};
-	t_Scissor.offset = {0,0};
-	t_Scissor.extent = t_SwapChainExtent;
+		// the histories swap every frame, a history that was never written is discarded
+		if (UsesTAA())
+		{
+			const Image& t_History = m_TemporalAA.GetHistory();
+			const Image& t_PreviousHistory = m_TemporalAA.GetPreviousHistory();
+
+			m_PostProcessGraph.UpdateImportedImage(m_GraphResources.m_History, t_History.GetImage(),
+			                                       t_History.GetImageView(), m_SwapChain.GetExtent());
+			m_PostProcessGraph.UpdateImportedImage(m_GraphResources.m_PreviousHistory, t_PreviousHistory.GetImage(),
+			                                       t_PreviousHistory.GetImageView(), m_SwapChain.GetExtent());
+			m_PostProcessGraph.SetInitialLayout(m_GraphResources.m_PreviousHistory,
+			                                    m_TemporalAA.IsHistoryValid()
+				                                    ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+				                                    : VK_IMAGE_LAYOUT_UNDEFINED);
+		}
 
-	vkCmdSetScissor(m_CommandBuffers[m_CurrentFrame], 0, 1, &t_Scissor);
+		m_PostProcessGraph.Execute(m_CommandBuffers[m_CurrentFrame]);
+
+		if (UsesTAA())
+		{
+			m_TemporalAA.AdvanceFrame();
+		}
+	}
 
-	// Bind Descriptor Sets
-	vkCmdBindDescriptorSets(m_CommandBuffers[m_CurrentFrame], VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1,
-	                        &m_DescriptorSets[m_CurrentFrame], 0, nullptr);
+	// copy the finished frame for ReadbackFrame, whichever pass wrote it last left it in the transfer source layout
+	if (m_Headless)
+	{
+		InsertMemoryBarrier(m_CommandBuffers[m_CurrentFrame], VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+		                    VK_ACCESS_MEMORY_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
 
-	// Draw
-	vkCmdDrawIndexed(m_CommandBuffers[m_CurrentFrame], static_cast<uint32_t>(m_TestModel.GetMesh().m_Indices.size()), 1, 0, 0, 0);
+		m_ReadbackBuffers[m_CurrentFrame].RecordImageCopy(m_CommandBuffers[m_CurrentFrame],
+		                                                  m_SwapChain.GetImages()[a_ImageIndex], m_SwapChain.GetExtent(), 4);
+	}
 
+	m_FrameCapture.RecordCapture(m_CommandBuffers[m_CurrentFrame], m_SwapChain.GetImages()[a_ImageIndex],
+	                             m_SwapChain.GetExtent(), GetPresentLayout());
+	m_FrameExporter.RecordExport(m_CommandBuffers[m_CurrentFrame], m_SwapChain.GetImages()[a_ImageIndex],
+	                             m_SwapChain.GetExtent(), GetPresentLayout());
 
-	// end render pass
-	vkCmdEndRenderPass(m_CommandBuffers[m_CurrentFrame]);
+	m_GpuTimer.End(m_CommandBuffers[m_CurrentFrame], m_CurrentFrame);
 
 	// finish recording the command buffer
 	if (vkEndCommandBuffer(m_CommandBuffers[m_CurrentFrame]) != VK_SUCCESS)
@@ -839,135 +2136,162 @@ void VRenderer::CreateUniformBuffers()
 	}
 }
 
+void VRenderer::CreateInstanceBuffers()
+{
+	m_InstanceBuffers.resize(m_MaxInFlightFrames);
+	m_WrittenTransformSerials.assign(m_MaxInFlightFrames, 0);
+
+	for (InstanceBuffer& t_InstanceBuffer : m_InstanceBuffers)
+	{
+		t_InstanceBuffer.CreateInstanceBuffer(m_Device, m_MaxInstances);
+	}
+}
+
 void VRenderer::UpdateUniformBuffers(uint32_t a_CurrentImage, Camera& a_Camera)
 {
+	UniformBufferObject t_UBO = {};
 
-	// TODO implement better
-	// delta time
-	static auto  t_Start = std::chrono::high_resolution_clock::now();
+	m_Transforms.Update(m_JobSystem);
 
-	const auto t_CurrTime = std::chrono::high_resolution_clock::now();
-	float t_Delta = std::chrono::duration<float, std::chrono::seconds::period>(t_CurrTime - t_Start).count();
+	// the entities copy the changed world matrices and move their bounds in the hierarchy
+	SyncRenderableTransforms(m_Entities, m_Transforms, m_SyncedTransformSerial, m_SceneBvh, m_JobSystem);
 
-	UniformBufferObject t_UBO = {};
-	m_TestModel.Rotate(90, glm::vec3(1.0f, 0.0f, 0.0f));
-	m_TestModel.Rotate(t_Delta * 90.f * 0.2, glm::vec3(1.0f, 0.0f, 0.0f));
-	m_TestModel.SetScale(3.f);
+	// moved instances only refit the hierarchy, added ones need it to be rebuilt
+	if (m_SceneBvh.NeedsBuild())
+	{
+		m_SceneBvh.Build(m_JobSystem);
+	}
+	else
+	{
+		m_SceneBvh.Refit();
+	}
+
+	// TAA jitters the projection by a different sub-pixel offset every frame
+	a_Camera.SetJitter(UsesTAA() ? m_TemporalAA.GetJitter() : glm::vec2(0.0f));
 
-	t_UBO.m_Model = m_TestModel.GetModelMatrix();
 	t_UBO.m_View = a_Camera.GetViewMat();
 	t_UBO.m_Projection = a_Camera.GetProjectionMat();
 
 	// TODO remove (crutch to avoid image being upside down due to glm coordinate system)
 	t_UBO.m_Projection[1][1] *= -1;
 
+	// the velocity buffer is written from unjittered matrices so the jitter does not show up as motion
+	glm::mat4 t_UnjitteredProjection = a_Camera.GetUnjitteredProjectionMat();
+	t_UnjitteredProjection[1][1] *= -1;
+
+	t_UBO.m_ViewProjection = t_UnjitteredProjection * t_UBO.m_View;
+	t_UBO.m_PreviousViewProjection = m_PreviousViewProjection;
+	m_PreviousViewProjection = t_UBO.m_ViewProjection;
+
 	m_UniformBuffers[a_CurrentImage].FillBuffer(t_UBO);
+
+	// per-instance world matrices, only the ones that changed since the buffer was last written
+	m_Transforms.WriteWorldMatrices(m_InstanceBuffers[a_CurrentImage], m_WrittenTransformSerials[a_CurrentImage],
+	                                m_JobSystem);
+
+	// per-instance material data
+	InstanceData* t_Instances = m_InstanceBuffers[a_CurrentImage].GetMappedInstances();
+	m_Entities.ForEachChunk<TransformComponent, MaterialComponent>(
+		[t_Instances](const uint32_t a_Count, const Entity*, const TransformComponent* a_Transform,
+		              const MaterialComponent* a_Material)
+		{
+			for (uint32_t i = 0; i < a_Count; i++)
+			{
+				t_Instances[a_Transform[i].m_Transform].m_TextureIndex = a_Material[i].m_Material;
+			}
+		});
+
+	// lights are culled against clusters of the rendered part of the target
+	m_LightCuller.UpdateLights(a_CurrentImage, a_Camera, GetRenderExtent(), m_PointLights, m_AmbientLight);
 }
 
-VkDescriptorPool VRenderer::CreateDescriptorPool(const int a_DescriptorCount, const VkDevice& a_LogicalDevice)
+void VRenderer::BuildDrawQueue(const Camera& a_Camera)
 {
-	std::array<VkDescriptorPoolSize, 2> t_DescriptorPoolSizes = {};
-	// pool size for Uniform Buffer
-	t_DescriptorPoolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	t_DescriptorPoolSizes[0].descriptorCount = static_cast<uint32_t>(a_DescriptorCount);
+	// the queues are recorded into this frame's command buffer, so they live as long as its arena
+	m_DrawQueue.Clear(&m_FrameArena.GetCurrent());
+
+	DrawItem t_DrawItem = {};
+	t_DrawItem.m_Pipeline = *m_GraphicsPipeline;
+	t_DrawItem.m_PipelineLayout = m_PipelineLayout;
 
-	// pool size for CombinedImageSampler
-	t_DescriptorPoolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	t_DescriptorPoolSizes[1].descriptorCount = static_cast<uint32_t>(a_DescriptorCount);
+	// textures are indexed through the instance data, so the sets are the same for every draw
+	t_DrawItem.m_DescriptorSets[0] = m_DescriptorSets[m_CurrentFrame];
+	t_DrawItem.m_DescriptorSets[1] = m_TextureTable.GetDescriptorSet();
+	t_DrawItem.m_DescriptorSets[2] = m_LightCuller.GetDescriptorSet(m_CurrentFrame);
+	t_DrawItem.m_DescriptorSetCount = 3;
 
+	// the mesh's vertices come first, then the instance data
+	t_DrawItem.m_VertexBuffers[1] = m_InstanceBuffers[m_CurrentFrame].GetBuffer();
+	t_DrawItem.m_VertexBufferCount = 2;
 
-	VkDescriptorPoolCreateInfo t_DescriptorPoolCreateInfo = {};
-	t_DescriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	t_DescriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(t_DescriptorPoolSizes.size());
-	t_DescriptorPoolCreateInfo.pPoolSizes = t_DescriptorPoolSizes.data();
-	t_DescriptorPoolCreateInfo.maxSets = static_cast<uint32_t>(a_DescriptorCount);
+	m_DepthPrepassQueue.Clear(&m_FrameArena.GetCurrent());
 
-	VkDescriptorPool t_DescriptorPool;
+	// the culling tests against the depth buffer, so it uses the same (jittered) matrices
+	glm::mat4 t_Projection = a_Camera.GetProjectionMat();
+	t_Projection[1][1] *= -1;
+	m_ViewProjection = t_Projection * a_Camera.GetViewMat();
 
-	if (vkCreateDescriptorPool(a_LogicalDevice, &t_DescriptorPoolCreateInfo, nullptr, &t_DescriptorPool) != VK_SUCCESS)
+	if (UsesCpuOcclusionCulling())
 	{
-		throw std::runtime_error("Error! Could not create Descriptor Pool!");
+		m_SoftwareOcclusionCuller.BeginFrame(m_ViewProjection);
+		AddRenderableOccluders(m_Entities, m_SoftwareOcclusionCuller);
+		m_SoftwareOcclusionCuller.RasterizeOccluders(m_JobSystem);
 	}
 
-	return t_DescriptorPool;
-}
-
-void VRenderer::CreateDescriptorSets(int a_Count, VkDevice a_LogicalDevice,
-                                     VkDescriptorSetLayout& a_DescriptorSetLayout,
-                                     VkDescriptorPool& a_DescriptorPool, std::vector<VkDescriptorSet>& a_DescriptorSets)
-{
-	// allocate descriptor sets
-	std::vector<VkDescriptorSetLayout> t_DescriptorSetLayouts(a_Count, a_DescriptorSetLayout);
-
-	VkDescriptorSetAllocateInfo t_AllocateInfo = {};
-	t_AllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	t_AllocateInfo.descriptorPool = a_DescriptorPool;
-	t_AllocateInfo.descriptorSetCount = static_cast<uint32_t>(a_Count);
-	t_AllocateInfo.pSetLayouts = t_DescriptorSetLayouts.data();
+	// entities outside the view frustum or hidden behind the occluders are not drawn at all
+	CullRenderables(m_Entities, m_SceneBvh, m_ViewProjection,
+	                UsesCpuOcclusionCulling() ? &m_SoftwareOcclusionCuller : nullptr, m_FrameArena.GetCurrent(),
+	                m_JobSystem);
 
-	a_DescriptorSets.resize(a_Count);
-	if (vkAllocateDescriptorSets(a_LogicalDevice, &t_AllocateInfo, a_DescriptorSets.data()) != VK_SUCCESS)
+	if (!UsesGpuOcclusionCulling())
 	{
-		throw std::runtime_error("Error! Could not allocate Descriptor Sets!");
+		AddRenderableDraws(m_Entities, m_Meshes, t_DrawItem, a_Camera.GetViewMat(), a_Camera.GetFarPlane(),
+		                   m_DrawQueue);
 	}
-
-	// populate descriptor sets
-	for (size_t i = 0; i < a_Count; i++)
+	else
 	{
-		// for Uniform Buffer
-		VkDescriptorBufferInfo t_BufferInfo = {};
-		t_BufferInfo.buffer = m_UniformBuffers[i].GetBuffer();
-		t_BufferInfo.offset = 0;
-		t_BufferInfo.range = sizeof(UniformBufferObject);
-
-		// for image sampler
-		VkDescriptorImageInfo t_ImageInfo = {};
-		t_ImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		t_ImageInfo.imageView = m_TestModel.GetTexture().GetImageView();
-		t_ImageInfo.sampler = m_TestModel.GetTexture().GetSampler();
-
-		std::array<VkWriteDescriptorSet, 2> t_DescriptorWrites = {};
+		DrawItem t_PrepassItem = t_DrawItem;
+		t_PrepassItem.m_Pipeline = *m_DepthPrepassPipeline;
+		t_PrepassItem.m_IndirectBuffer = m_OcclusionCuller.GetPrepassDrawBuffer();
+		t_DrawItem.m_IndirectBuffer = m_OcclusionCuller.GetDrawBuffer();
+
+		// uploaded even when nothing is visible, so the culling never tests last frame's instances
+		FrameVector<InstanceBounds> t_Instances = m_FrameArena.MakeVector<InstanceBounds>();
+		AddRenderableIndirectDraws(m_Entities, m_Meshes, t_DrawItem, t_PrepassItem, a_Camera.GetViewMat(),
+		                           a_Camera.GetFarPlane(), t_Instances, m_DrawQueue, m_DepthPrepassQueue);
+		m_OcclusionCuller.UpdateInstances(m_CurrentFrame, t_Instances);
+	}
 
-		// for Uniform Buffer
-		t_DescriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		t_DescriptorWrites[0].dstSet = a_DescriptorSets[i];
-		t_DescriptorWrites[0].dstBinding = 0;
-		t_DescriptorWrites[0].dstArrayElement = 0;
-		t_DescriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		t_DescriptorWrites[0].descriptorCount = 1;
-		t_DescriptorWrites[0].pBufferInfo = &t_BufferInfo;
-		t_DescriptorWrites[0].pImageInfo = nullptr;
-		t_DescriptorWrites[0].pTexelBufferView = nullptr;
+	m_UnsortedBindStatistics = m_DrawQueue.CountBinds();
+	m_DrawQueue.Sort(m_JobSystem);
+	m_DepthPrepassQueue.Sort(m_JobSystem);
+}
 
-		// for image sampler
-		t_DescriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		t_DescriptorWrites[1].dstSet = a_DescriptorSets[i];
-		t_DescriptorWrites[1].dstBinding = 1;
-		t_DescriptorWrites[1].dstArrayElement = 0;
-		t_DescriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		t_DescriptorWrites[1].descriptorCount = 1;
-		t_DescriptorWrites[1].pImageInfo = &t_ImageInfo;
+void VRenderer::CreateDescriptorSets()
+{
+	// the per-frame uniform buffer sets never change, so they are allocated once through the cache
+	m_DescriptorSets.resize(m_MaxInFlightFrames);
 
-		vkUpdateDescriptorSets(a_LogicalDevice, static_cast<uint32_t>(t_DescriptorWrites.size()),
-		                       t_DescriptorWrites.data(), 0, nullptr);
+	for (size_t i = 0; i < m_DescriptorSets.size(); i++)
+	{
+		m_DescriptorSets[i] = m_DescriptorAllocator.GetCached(m_Device.GetLogicalDevice(), m_DescriptorSetLayout, {
+			DescriptorBinding::Buffer(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_UniformBuffers[i].GetBuffer(), 0,
+			                          sizeof(UniformBufferObject))
+		});
 	}
 }
 
 void VRenderer::CreateSyncObjects()
 {
-	//resize semaphore & fence vectors
+	//resize semaphore vectors
 	m_ImageAcquiredSemaphores.resize(m_MaxInFlightFrames);
 	m_RenderFinishedSemaphores.resize(m_MaxInFlightFrames);
-	m_InFlightFences.resize(m_MaxInFlightFrames);
 
+	// the timeline starts at 0, so waiting for a frame that was never submitted returns immediately
+	m_FrameTimelineValues.assign(m_MaxInFlightFrames, 0);
 
 	VkSemaphoreCreateInfo t_SemaphoreCreateInfo = {};
 	t_SemaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-	
-	VkFenceCreateInfo t_FenceCreateInfo = {};
-	t_FenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-	// create fence signaled to avoid waiting for it forever on the first frame
-	t_FenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT; 
 
 	// for each frame in flight
 	for (int i = 0; i < m_MaxInFlightFrames; i++)
@@ -978,12 +2302,6 @@ void VRenderer::CreateSyncObjects()
 		{
 			throw std::runtime_error("Could not create Semaphores!");
 		}
-
-		// create Fence
-		if (vkCreateFence(m_Device.GetLogicalDevice(), &t_FenceCreateInfo, nullptr, &m_InFlightFences[i]) != VK_SUCCESS)
-		{
-			throw std::runtime_error("Could not create Fence!");
-		}
 	}
 }
 
@@ -993,7 +2311,6 @@ void VRenderer::DestroySyncObjects()
 	{
 		vkDestroySemaphore(m_Device.GetLogicalDevice(), m_ImageAcquiredSemaphores[i], nullptr);
 		vkDestroySemaphore(m_Device.GetLogicalDevice(), m_RenderFinishedSemaphores[i], nullptr);
-		vkDestroyFence(m_Device.GetLogicalDevice(), m_InFlightFences[i], nullptr);
 	}
 }
 
@@ -1001,6 +2318,19 @@ void VRenderer::CreateDepthResources()
 {
 	VkFormat t_DepthFormat = FindDepthFormat(m_Device.GetPhysicalDevice());
 
+	// the occlusion culling pyramid is built from the depth buffer
+	VkImageUsageFlags t_Usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+	if (UsesGpuOcclusionCulling())
+	{
+		t_Usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+	}
+
+	// the deferred lighting subpass reconstructs positions from it
+	if (UsesDeferredShading())
+	{
+		t_Usage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+	}
+
 	m_DepthImage.CreateImage(
 		m_Device, 
 		m_SwapChain.GetExtent().width, m_SwapChain.GetExtent().height,
@@ -1008,14 +2338,14 @@ void VRenderer::CreateDepthResources()
 		m_Device.GetMSAASampleCount(),
 		t_DepthFormat,
 		VK_IMAGE_TILING_OPTIMAL,
-		VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_DEPTH_BIT
+		t_Usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_DEPTH_BIT
 	);
 }
 
 /// <summary>	Creates color resources used for MSAA. </summary>
 void VRenderer::CreateColorResources()
 {
-	VkFormat t_ColorFormat = m_SwapChain.GetFormat();
+	VkFormat t_ColorFormat = GetOutputFormat();
 	VkExtent2D t_SwapExtent = m_SwapChain.GetExtent();
 
 	m_ColorImage.CreateImage(m_Device, t_SwapExtent.width, t_SwapExtent.height, 1, m_Device.GetMSAASampleCount(),
@@ -1024,6 +2354,203 @@ void VRenderer::CreateColorResources()
 	                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
 }
 
+bool VRenderer::UsesMSAAResolve() const
+{
+	return m_Device.GetMSAASampleCount() != VK_SAMPLE_COUNT_1_BIT;
+}
+
+bool VRenderer::UsesTAA() const
+{
+	return m_RenderSettings.m_AntiAliasingMode == AntiAliasingMode::TAA;
+}
+
+bool VRenderer::UsesGpuOcclusionCulling() const
+{
+	return m_RenderSettings.m_OcclusionCullingMode == OcclusionCullingMode::GPU;
+}
+
+bool VRenderer::UsesCpuOcclusionCulling() const
+{
+	return m_RenderSettings.m_OcclusionCullingMode == OcclusionCullingMode::CPU;
+}
+
+bool VRenderer::UsesDeferredShading() const
+{
+	return m_RenderSettings.m_ShadingPath == ShadingPath::Deferred;
+}
+
+bool VRenderer::UsesOffscreenTarget() const
+{
+	return m_RenderSettings.m_DynamicResolution || UsesSpatialUpscaler();
+}
+
+bool VRenderer::UsesSpatialUpscaler() const
+{
+	return m_RenderSettings.m_UpscalingPreset != UpscalingPreset::Native;
+}
+
+VkFormat VRenderer::GetOutputFormat()
+{
+	return UsesOffscreenTarget() ? m_OffscreenFormat : m_SwapChain.GetFormat();
+}
+
+VkExtent2D VRenderer::GetRenderExtent()
+{
+	if (UsesOffscreenTarget())
+	{
+		return m_DynamicResolution.GetRenderExtent(m_SwapChain.GetExtent());
+	}
+
+	return m_SwapChain.GetExtent();
+}
+
+/// <summary>
+/// 	Creates the offscreen target used for dynamic resolution and spatial upscaling. It is
+/// 	allocated at swap chain resolution so changing the render scale does not require recreating it.
+/// </summary>
+void VRenderer::CreateOffscreenResources()
+{
+	const VkExtent2D t_SwapExtent = m_SwapChain.GetExtent();
+
+	m_OffscreenImage.CreateImage(m_Device, t_SwapExtent.width, t_SwapExtent.height, 1, VK_SAMPLE_COUNT_1_BIT,
+	                             m_OffscreenFormat, VK_IMAGE_TILING_OPTIMAL,
+	                             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+	                             VK_IMAGE_USAGE_SAMPLED_BIT,
+	                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+}
+
+void VRenderer::BlitToSwapChain(VkCommandBuffer a_CommandBuffer, VkImage a_SwapChainImage)
+{
+	const VkExtent2D t_RenderExtent = GetRenderExtent();
+	const VkExtent2D t_SwapExtent = m_SwapChain.GetExtent();
+
+	VkImageBlit t_Blit = {};
+	t_Blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+	t_Blit.srcOffsets[1] = {static_cast<int32_t>(t_RenderExtent.width), static_cast<int32_t>(t_RenderExtent.height), 1};
+	t_Blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+	t_Blit.dstOffsets[1] = {static_cast<int32_t>(t_SwapExtent.width), static_cast<int32_t>(t_SwapExtent.height), 1};
+
+	vkCmdBlitImage(a_CommandBuffer, m_OffscreenImage.GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+	               a_SwapChainImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &t_Blit, VK_FILTER_LINEAR);
+}
+
+/// <summary>
+/// 	Stores the requested render settings after clamping them to what the physical device
+/// 	supports. Does not rebuild any resources.
+/// </summary>
+/// <param name="a_RenderSettings">	The requested render settings.</param>
+
+void VRenderer::ApplyRenderSettings(const RenderSettings& a_RenderSettings)
+{
+	m_RenderSettings = a_RenderSettings;
+
+	// the G-buffer is single sampled and the lighting subpass writes no velocity, so deferred shading
+	// renders without MSAA and TAA
+	if (UsesDeferredShading())
+	{
+		m_RenderSettings.m_AntiAliasingMode = AntiAliasingMode::MSAA;
+		m_RenderSettings.m_MSAASampleCount = VK_SAMPLE_COUNT_1_BIT;
+		m_RenderSettings.m_MinSampleShading = 0.0f;
+	}
+
+	// TAA renders at one sample per pixel, anti-aliasing comes from accumulating jittered frames
+	if (UsesTAA())
+	{
+		m_RenderSettings.m_MSAASampleCount = VK_SAMPLE_COUNT_1_BIT;
+		m_RenderSettings.m_MinSampleShading = 0.0f;
+	}
+
+	m_RenderSettings.m_MSAASampleCount = m_Device.SetMSAASampleCount(m_RenderSettings.m_MSAASampleCount);
+	m_RenderSettings.m_MinSampleShading = std::clamp(m_RenderSettings.m_MinSampleShading, 0.0f, 1.0f);
+
+	if (!m_Device.SupportsSampleRateShading())
+	{
+		m_RenderSettings.m_MinSampleShading = 0.0f;
+	}
+
+	// the TAA history is not rescaled, so dynamic resolution and upscaling are only used with MSAA
+	if (UsesTAA())
+	{
+		m_RenderSettings.m_DynamicResolution = false;
+		m_RenderSettings.m_UpscalingPreset = UpscalingPreset::Native;
+	}
+
+	m_RenderSettings.m_MinRenderScale = std::clamp(m_RenderSettings.m_MinRenderScale, 0.1f, 1.0f);
+	m_RenderSettings.m_Sharpness = std::clamp(m_RenderSettings.m_Sharpness, 0.0f, 2.0f);
+
+	// the preset scale is used as is without dynamic resolution, else as its upper limit
+	m_DynamicResolution.Configure(m_RenderSettings.m_TargetFrameTime, m_RenderSettings.m_MinRenderScale,
+	                              SpatialUpscaler::GetRenderScale(m_RenderSettings.m_UpscalingPreset));
+}
+
+/// <summary>	Destroys the frame buffers and the images attached to them. </summary>
+void VRenderer::DestroyRenderTargets()
+{
+	DestroyFrameBuffers(m_Framebuffers, m_Device.GetLogicalDevice());
+	m_Framebuffers.clear();
+
+	// new views may reuse the handles, so the cached sets pointing to the old ones have to go
+	m_DescriptorAllocator.InvalidateImageViews(m_Device.GetLogicalDevice(), {
+		m_DepthImage.GetImageView(), m_ColorImage.GetImageView(), m_OffscreenImage.GetImageView()
+	});
+
+	// the depth prepass frame buffer is attached to the depth buffer
+	m_PrepassGraph.InvalidateImageViews({m_DepthImage.GetImageView()});
+
+	m_DepthImage.DestroyImage(m_Device.GetLogicalDevice());
+	m_ColorImage.DestroyImage(m_Device.GetLogicalDevice());
+	m_TemporalAA.DestroyTargets(m_Device.GetLogicalDevice());
+	m_OffscreenImage.DestroyImage(m_Device.GetLogicalDevice());
+	m_SpatialUpscaler.DestroyTargets(m_Device.GetLogicalDevice());
+	m_OcclusionCuller.DestroyTargets(m_Device.GetLogicalDevice(), m_DescriptorAllocator);
+	m_DeferredLighting.DestroyTargets(m_Device.GetLogicalDevice(), m_DescriptorAllocator);
+}
+
+/// <summary>
+/// 	Creates the MSAA color target (only if MSAA is enabled), the TAA targets (only if TAA is
+/// 	enabled), the offscreen target (only if dynamic resolution is enabled), the depth target, the
+/// 	occlusion culling pyramid (only if occlusion culling is enabled), the G-buffer (only if
+/// 	deferred shading is enabled) and the frame buffers.
+/// </summary>
+void VRenderer::CreateRenderTargets()
+{
+	if (UsesMSAAResolve())
+	{
+		CreateColorResources();
+	}
+
+	if (UsesTAA())
+	{
+		m_TemporalAA.CreateTargets(m_Device, m_SwapChain.GetExtent());
+	}
+
+	if (UsesOffscreenTarget())
+	{
+		CreateOffscreenResources();
+	}
+
+	if (UsesSpatialUpscaler())
+	{
+		m_SpatialUpscaler.CreateTargets(m_Device, m_OffscreenImage, m_SwapChain.GetExtent());
+	}
+
+	CreateDepthResources();
+
+	if (UsesGpuOcclusionCulling())
+	{
+		m_OcclusionCuller.CreateTargets(m_Device, m_DescriptorAllocator, m_DepthImage, m_SwapChain.GetExtent(),
+		                                m_Device.GetMSAASampleCount());
+	}
+
+	if (UsesDeferredShading())
+	{
+		m_DeferredLighting.CreateTargets(m_Device, m_DescriptorAllocator, m_SwapChain.GetExtent(), m_DepthImage);
+	}
+
+	CreateFrameBuffers();
+	BindRenderGraphImages();
+}
+
 /// <summary>	Handles resizing the window by recreating the swap chain.</summary>
 void VRenderer::HandleResize()
 {
@@ -1039,16 +2566,23 @@ void VRenderer::HandleResize()
 
 	vkDeviceWaitIdle(m_Device.GetLogicalDevice());
 
-	// cleanup swap chain
+	// cleanup render targets & swap chain
+	DestroyRenderTargets();
 	m_SwapChain.Cleanup(m_Device.GetLogicalDevice(), m_Framebuffers);
 
 	// recreate swap chain
 	m_SwapChain.Create(m_Device, m_WindowSurface, m_Window);
 	m_SwapChain.CreateImageViews(m_Device.GetLogicalDevice());
-	m_DepthImage.DestroyImage(m_Device.GetLogicalDevice());
-	m_ColorImage.DestroyImage(m_Device.GetLogicalDevice());
 
-	CreateColorResources();
-	CreateDepthResources();
-	CreateFrameBuffers();
+	CreateRenderTargets();
+
+	// the capture's file and the export ring have the old size, both continue in new ones
+	m_FrameCapture.Restart(m_Device, m_SwapChain.GetExtent(), m_SwapChain.GetFormat());
+	m_FrameExporter.Resize(m_Device, m_SwapChain.GetExtent());
+}
+
+VkImageLayout VRenderer::GetPresentLayout() const
+{
+	// headless frames are copied into a readback buffer instead of being presented
+	return m_Headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 }
@@ -2,5 +2,16 @@ mkdir ..\assets\shaders\compiled
 
 CALL "glslc.exe" ../assets/shaders/fragment_shader.frag -o ../assets/shaders/compiled/fragment_shader.spv
 CALL "glslc.exe" ../assets/shaders/vertex_shader.vert -o ../assets/shaders/compiled/vertex_shader.spv
+CALL "glslc.exe" ../assets/shaders/taa_resolve.comp -o ../assets/shaders/compiled/taa_resolve.spv
+CALL "glslc.exe" ../assets/shaders/easu.comp -o ../assets/shaders/compiled/easu.spv
+CALL "glslc.exe" ../assets/shaders/rcas.comp -o ../assets/shaders/compiled/rcas.spv
+CALL "glslc.exe" ../assets/shaders/hiz_depth.comp -o ../assets/shaders/compiled/hiz_depth.spv
+CALL "glslc.exe" ../assets/shaders/hiz_depth.comp -DMULTISAMPLED -o ../assets/shaders/compiled/hiz_depth_ms.spv
+CALL "glslc.exe" ../assets/shaders/hiz_reduce.comp -o ../assets/shaders/compiled/hiz_reduce.spv
+CALL "glslc.exe" ../assets/shaders/occlusion_cull.comp -o ../assets/shaders/compiled/occlusion_cull.spv
+CALL "glslc.exe" ../assets/shaders/light_cull.comp -o ../assets/shaders/compiled/light_cull.spv
+CALL "glslc.exe" ../assets/shaders/fragment_shader.frag -DGBUFFER -o ../assets/shaders/compiled/gbuffer.spv
+CALL "glslc.exe" ../assets/shaders/deferred_lighting.vert -o ../assets/shaders/compiled/deferred_lighting_vert.spv
+CALL "glslc.exe" ../assets/shaders/deferred_lighting.frag -o ../assets/shaders/compiled/deferred_lighting_frag.spv
 
 pause
\ No newline at end of file
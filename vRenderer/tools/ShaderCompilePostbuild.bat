@@ -2,5 +2,16 @@ mkdir ..\vRenderer\assets\shaders\compiled
 
 CALL "glslc.exe" ../vRenderer/assets/shaders/fragment_shader.frag -o ../vRenderer/assets/shaders/compiled/fragment_shader.spv
 CALL "glslc.exe" ../vRenderer/assets/shaders/vertex_shader.vert -o ../vRenderer/assets/shaders/compiled/vertex_shader.spv
+CALL "glslc.exe" ../vRenderer/assets/shaders/taa_resolve.comp -o ../vRenderer/assets/shaders/compiled/taa_resolve.spv
+CALL "glslc.exe" ../vRenderer/assets/shaders/easu.comp -o ../vRenderer/assets/shaders/compiled/easu.spv
+CALL "glslc.exe" ../vRenderer/assets/shaders/rcas.comp -o ../vRenderer/assets/shaders/compiled/rcas.spv
+CALL "glslc.exe" ../vRenderer/assets/shaders/hiz_depth.comp -o ../vRenderer/assets/shaders/compiled/hiz_depth.spv
+CALL "glslc.exe" ../vRenderer/assets/shaders/hiz_depth.comp -DMULTISAMPLED -o ../vRenderer/assets/shaders/compiled/hiz_depth_ms.spv
+CALL "glslc.exe" ../vRenderer/assets/shaders/hiz_reduce.comp -o ../vRenderer/assets/shaders/compiled/hiz_reduce.spv
+CALL "glslc.exe" ../vRenderer/assets/shaders/occlusion_cull.comp -o ../vRenderer/assets/shaders/compiled/occlusion_cull.spv
+CALL "glslc.exe" ../vRenderer/assets/shaders/light_cull.comp -o ../vRenderer/assets/shaders/compiled/light_cull.spv
+CALL "glslc.exe" ../vRenderer/assets/shaders/fragment_shader.frag -DGBUFFER -o ../vRenderer/assets/shaders/compiled/gbuffer.spv
+CALL "glslc.exe" ../vRenderer/assets/shaders/deferred_lighting.vert -o ../vRenderer/assets/shaders/compiled/deferred_lighting_vert.spv
+CALL "glslc.exe" ../vRenderer/assets/shaders/deferred_lighting.frag -o ../vRenderer/assets/shaders/compiled/deferred_lighting_frag.spv
 
 pause
\ No newline at end of file